@@ -822,6 +822,300 @@ namespace RcppCWB {
         return Rcpp::as<int >(rcpp_result_gen);
     }
 
+    inline Rcpp::IntegerMatrix _cl_cpos2alg(SEXP corpus, SEXP a_attribute, Rcpp::IntegerVector cpos, SEXP registry) {
+        typedef SEXP(*Ptr__cl_cpos2alg)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cl_cpos2alg p__cl_cpos2alg = NULL;
+        if (p__cl_cpos2alg == NULL) {
+            validateSignature("Rcpp::IntegerMatrix(*_cl_cpos2alg)(SEXP,SEXP,Rcpp::IntegerVector,SEXP)");
+            p__cl_cpos2alg = (Ptr__cl_cpos2alg)R_GetCCallable("RcppCWB", "_RcppCWB__cl_cpos2alg");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_cpos2alg(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(a_attribute)), Shield<SEXP>(Rcpp::wrap(cpos)), Shield<SEXP>(Rcpp::wrap(registry)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::IntegerMatrix >(rcpp_result_gen);
+    }
+
+    inline Rcpp::IntegerMatrix _cl_alg2cpos(SEXP corpus, SEXP a_attribute, Rcpp::IntegerVector alg, SEXP registry) {
+        typedef SEXP(*Ptr__cl_alg2cpos)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cl_alg2cpos p__cl_alg2cpos = NULL;
+        if (p__cl_alg2cpos == NULL) {
+            validateSignature("Rcpp::IntegerMatrix(*_cl_alg2cpos)(SEXP,SEXP,Rcpp::IntegerVector,SEXP)");
+            p__cl_alg2cpos = (Ptr__cl_alg2cpos)R_GetCCallable("RcppCWB", "_RcppCWB__cl_alg2cpos");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_alg2cpos(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(a_attribute)), Shield<SEXP>(Rcpp::wrap(alg)), Shield<SEXP>(Rcpp::wrap(registry)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::IntegerMatrix >(rcpp_result_gen);
+    }
+
+    inline int _cl_dynamic_register(SEXP corpus, SEXP d_attribute, SEXP f, SEXP registry) {
+        typedef SEXP(*Ptr__cl_dynamic_register)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cl_dynamic_register p__cl_dynamic_register = NULL;
+        if (p__cl_dynamic_register == NULL) {
+            validateSignature("int(*_cl_dynamic_register)(SEXP,SEXP,SEXP,SEXP)");
+            p__cl_dynamic_register = (Ptr__cl_dynamic_register)R_GetCCallable("RcppCWB", "_RcppCWB__cl_dynamic_register");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_dynamic_register(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(d_attribute)), Shield<SEXP>(Rcpp::wrap(f)), Shield<SEXP>(Rcpp::wrap(registry)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline SEXP _cl_dynamic_call(SEXP corpus, SEXP d_attribute, Rcpp::List args, SEXP registry) {
+        typedef SEXP(*Ptr__cl_dynamic_call)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cl_dynamic_call p__cl_dynamic_call = NULL;
+        if (p__cl_dynamic_call == NULL) {
+            validateSignature("SEXP(*_cl_dynamic_call)(SEXP,SEXP,Rcpp::List,SEXP)");
+            p__cl_dynamic_call = (Ptr__cl_dynamic_call)R_GetCCallable("RcppCWB", "_RcppCWB__cl_dynamic_call");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_dynamic_call(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(d_attribute)), Shield<SEXP>(Rcpp::wrap(args)), Shield<SEXP>(Rcpp::wrap(registry)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline int _cl_set_optimize(int state) {
+        typedef SEXP(*Ptr__cl_set_optimize)(SEXP);
+        static Ptr__cl_set_optimize p__cl_set_optimize = NULL;
+        if (p__cl_set_optimize == NULL) {
+            validateSignature("int(*_cl_set_optimize)(int)");
+            p__cl_set_optimize = (Ptr__cl_set_optimize)R_GetCCallable("RcppCWB", "_RcppCWB__cl_set_optimize");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_set_optimize(Shield<SEXP>(Rcpp::wrap(state)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline int _cl_get_optimize() {
+        typedef SEXP(*Ptr__cl_get_optimize)();
+        static Ptr__cl_get_optimize p__cl_get_optimize = NULL;
+        if (p__cl_get_optimize == NULL) {
+            validateSignature("int(*_cl_get_optimize)()");
+            p__cl_get_optimize = (Ptr__cl_get_optimize)R_GetCCallable("RcppCWB", "_RcppCWB__cl_get_optimize");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_get_optimize();
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline Rcpp::IntegerVector _cl_regopt_count(bool reset) {
+        typedef SEXP(*Ptr__cl_regopt_count)(SEXP);
+        static Ptr__cl_regopt_count p__cl_regopt_count = NULL;
+        if (p__cl_regopt_count == NULL) {
+            validateSignature("Rcpp::IntegerVector(*_cl_regopt_count)(bool)");
+            p__cl_regopt_count = (Ptr__cl_regopt_count)R_GetCCallable("RcppCWB", "_RcppCWB__cl_regopt_count");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_regopt_count(Shield<SEXP>(Rcpp::wrap(reset)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::IntegerVector >(rcpp_result_gen);
+    }
+
+    inline int _cl_set_threads(int n) {
+        typedef SEXP(*Ptr__cl_set_threads)(SEXP);
+        static Ptr__cl_set_threads p__cl_set_threads = NULL;
+        if (p__cl_set_threads == NULL) {
+            validateSignature("int(*_cl_set_threads)(int)");
+            p__cl_set_threads = (Ptr__cl_set_threads)R_GetCCallable("RcppCWB", "_RcppCWB__cl_set_threads");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_set_threads(Shield<SEXP>(Rcpp::wrap(n)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline int _cl_get_threads() {
+        typedef SEXP(*Ptr__cl_get_threads)();
+        static Ptr__cl_get_threads p__cl_get_threads = NULL;
+        if (p__cl_get_threads == NULL) {
+            validateSignature("int(*_cl_get_threads)()");
+            p__cl_get_threads = (Ptr__cl_get_threads)R_GetCCallable("RcppCWB", "_RcppCWB__cl_get_threads");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_get_threads();
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline int _cl_set_registry_cache(SEXP file) {
+        typedef SEXP(*Ptr__cl_set_registry_cache)(SEXP);
+        static Ptr__cl_set_registry_cache p__cl_set_registry_cache = NULL;
+        if (p__cl_set_registry_cache == NULL) {
+            validateSignature("int(*_cl_set_registry_cache)(SEXP)");
+            p__cl_set_registry_cache = (Ptr__cl_set_registry_cache)R_GetCCallable("RcppCWB", "_RcppCWB__cl_set_registry_cache");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_set_registry_cache(Shield<SEXP>(Rcpp::wrap(file)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline Rcpp::StringVector _cl_get_registry_cache() {
+        typedef SEXP(*Ptr__cl_get_registry_cache)();
+        static Ptr__cl_get_registry_cache p__cl_get_registry_cache = NULL;
+        if (p__cl_get_registry_cache == NULL) {
+            validateSignature("Rcpp::StringVector(*_cl_get_registry_cache)()");
+            p__cl_get_registry_cache = (Ptr__cl_get_registry_cache)R_GetCCallable("RcppCWB", "_RcppCWB__cl_get_registry_cache");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_get_registry_cache();
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::StringVector >(rcpp_result_gen);
+    }
+
+    inline int _cl_registry_prefetch(SEXP registry) {
+        typedef SEXP(*Ptr__cl_registry_prefetch)(SEXP);
+        static Ptr__cl_registry_prefetch p__cl_registry_prefetch = NULL;
+        if (p__cl_registry_prefetch == NULL) {
+            validateSignature("int(*_cl_registry_prefetch)(SEXP)");
+            p__cl_registry_prefetch = (Ptr__cl_registry_prefetch)R_GetCCallable("RcppCWB", "_RcppCWB__cl_registry_prefetch");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_registry_prefetch(Shield<SEXP>(Rcpp::wrap(registry)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline int _cl_registry_cache_write() {
+        typedef SEXP(*Ptr__cl_registry_cache_write)();
+        static Ptr__cl_registry_cache_write p__cl_registry_cache_write = NULL;
+        if (p__cl_registry_cache_write == NULL) {
+            validateSignature("int(*_cl_registry_cache_write)()");
+            p__cl_registry_cache_write = (Ptr__cl_registry_cache_write)R_GetCCallable("RcppCWB", "_RcppCWB__cl_registry_cache_write");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_registry_cache_write();
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline Rcpp::DataFrame _cl_registry_timings(bool reset) {
+        typedef SEXP(*Ptr__cl_registry_timings)(SEXP);
+        static Ptr__cl_registry_timings p__cl_registry_timings = NULL;
+        if (p__cl_registry_timings == NULL) {
+            validateSignature("Rcpp::DataFrame(*_cl_registry_timings)(bool)");
+            p__cl_registry_timings = (Ptr__cl_registry_timings)R_GetCCallable("RcppCWB", "_RcppCWB__cl_registry_timings");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cl_registry_timings(Shield<SEXP>(Rcpp::wrap(reset)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::DataFrame >(rcpp_result_gen);
+    }
+
     inline Rcpp::StringVector _corpus_data_dir(SEXP corpus, SEXP registry) {
         typedef SEXP(*Ptr__corpus_data_dir)(SEXP,SEXP);
         static Ptr__corpus_data_dir p__corpus_data_dir = NULL;
@@ -1345,6 +1639,300 @@ namespace RcppCWB {
         return Rcpp::as<SEXP >(rcpp_result_gen);
     }
 
+    inline SEXP _cqp_cursor_open(SEXP corpus, SEXP query, int chunk) {
+        typedef SEXP(*Ptr__cqp_cursor_open)(SEXP,SEXP,SEXP);
+        static Ptr__cqp_cursor_open p__cqp_cursor_open = NULL;
+        if (p__cqp_cursor_open == NULL) {
+            validateSignature("SEXP(*_cqp_cursor_open)(SEXP,SEXP,int)");
+            p__cqp_cursor_open = (Ptr__cqp_cursor_open)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_cursor_open");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_cursor_open(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(query)), Shield<SEXP>(Rcpp::wrap(chunk)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline Rcpp::IntegerMatrix _cqp_cursor_fetch(SEXP cursor, int n) {
+        typedef SEXP(*Ptr__cqp_cursor_fetch)(SEXP,SEXP);
+        static Ptr__cqp_cursor_fetch p__cqp_cursor_fetch = NULL;
+        if (p__cqp_cursor_fetch == NULL) {
+            validateSignature("Rcpp::IntegerMatrix(*_cqp_cursor_fetch)(SEXP,int)");
+            p__cqp_cursor_fetch = (Ptr__cqp_cursor_fetch)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_cursor_fetch");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_cursor_fetch(Shield<SEXP>(Rcpp::wrap(cursor)), Shield<SEXP>(Rcpp::wrap(n)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::IntegerMatrix >(rcpp_result_gen);
+    }
+
+    inline Rcpp::NumericVector _cqp_cursor_status(SEXP cursor) {
+        typedef SEXP(*Ptr__cqp_cursor_status)(SEXP);
+        static Ptr__cqp_cursor_status p__cqp_cursor_status = NULL;
+        if (p__cqp_cursor_status == NULL) {
+            validateSignature("Rcpp::NumericVector(*_cqp_cursor_status)(SEXP)");
+            p__cqp_cursor_status = (Ptr__cqp_cursor_status)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_cursor_status");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_cursor_status(Shield<SEXP>(Rcpp::wrap(cursor)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::NumericVector >(rcpp_result_gen);
+    }
+
+    inline SEXP _cqp_cursor_close(SEXP cursor) {
+        typedef SEXP(*Ptr__cqp_cursor_close)(SEXP);
+        static Ptr__cqp_cursor_close p__cqp_cursor_close = NULL;
+        if (p__cqp_cursor_close == NULL) {
+            validateSignature("SEXP(*_cqp_cursor_close)(SEXP)");
+            p__cqp_cursor_close = (Ptr__cqp_cursor_close)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_cursor_close");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_cursor_close(Shield<SEXP>(Rcpp::wrap(cursor)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline int _cqp_query_cache_set(int memory, SEXP dir) {
+        typedef SEXP(*Ptr__cqp_query_cache_set)(SEXP,SEXP);
+        static Ptr__cqp_query_cache_set p__cqp_query_cache_set = NULL;
+        if (p__cqp_query_cache_set == NULL) {
+            validateSignature("int(*_cqp_query_cache_set)(int,SEXP)");
+            p__cqp_query_cache_set = (Ptr__cqp_query_cache_set)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_query_cache_set");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_query_cache_set(Shield<SEXP>(Rcpp::wrap(memory)), Shield<SEXP>(Rcpp::wrap(dir)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<int >(rcpp_result_gen);
+    }
+
+    inline Rcpp::NumericVector _cqp_query_cache_stats() {
+        typedef SEXP(*Ptr__cqp_query_cache_stats)();
+        static Ptr__cqp_query_cache_stats p__cqp_query_cache_stats = NULL;
+        if (p__cqp_query_cache_stats == NULL) {
+            validateSignature("Rcpp::NumericVector(*_cqp_query_cache_stats)()");
+            p__cqp_query_cache_stats = (Ptr__cqp_query_cache_stats)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_query_cache_stats");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_query_cache_stats();
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::NumericVector >(rcpp_result_gen);
+    }
+
+    inline SEXP _cqp_query_cache_clear() {
+        typedef SEXP(*Ptr__cqp_query_cache_clear)();
+        static Ptr__cqp_query_cache_clear p__cqp_query_cache_clear = NULL;
+        if (p__cqp_query_cache_clear == NULL) {
+            validateSignature("SEXP(*_cqp_query_cache_clear)()");
+            p__cqp_query_cache_clear = (Ptr__cqp_query_cache_clear)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_query_cache_clear");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_query_cache_clear();
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline SEXP _cqp_prepare(SEXP corpus, SEXP query) {
+        typedef SEXP(*Ptr__cqp_prepare)(SEXP,SEXP);
+        static Ptr__cqp_prepare p__cqp_prepare = NULL;
+        if (p__cqp_prepare == NULL) {
+            validateSignature("SEXP(*_cqp_prepare)(SEXP,SEXP)");
+            p__cqp_prepare = (Ptr__cqp_prepare)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_prepare");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_prepare(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(query)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline SEXP _cqp_execute(SEXP prepared, SEXP corpus, SEXP subcorpus, SEXP args) {
+        typedef SEXP(*Ptr__cqp_execute)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cqp_execute p__cqp_execute = NULL;
+        if (p__cqp_execute == NULL) {
+            validateSignature("SEXP(*_cqp_execute)(SEXP,SEXP,SEXP,SEXP)");
+            p__cqp_execute = (Ptr__cqp_execute)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_execute");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_execute(Shield<SEXP>(Rcpp::wrap(prepared)), Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(subcorpus)), Shield<SEXP>(Rcpp::wrap(args)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline Rcpp::IntegerMatrix _cqp_query_batch(SEXP corpus, SEXP queries, SEXP subcorpora, SEXP s_attribute) {
+        typedef SEXP(*Ptr__cqp_query_batch)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cqp_query_batch p__cqp_query_batch = NULL;
+        if (p__cqp_query_batch == NULL) {
+            validateSignature("Rcpp::IntegerMatrix(*_cqp_query_batch)(SEXP,SEXP,SEXP,SEXP)");
+            p__cqp_query_batch = (Ptr__cqp_query_batch)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_query_batch");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_query_batch(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(queries)), Shield<SEXP>(Rcpp::wrap(subcorpora)), Shield<SEXP>(Rcpp::wrap(s_attribute)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::IntegerMatrix >(rcpp_result_gen);
+    }
+
+    inline SEXP _cqp_query_sample(SEXP corpus, SEXP subcorpus, SEXP query, int size) {
+        typedef SEXP(*Ptr__cqp_query_sample)(SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cqp_query_sample p__cqp_query_sample = NULL;
+        if (p__cqp_query_sample == NULL) {
+            validateSignature("SEXP(*_cqp_query_sample)(SEXP,SEXP,SEXP,int)");
+            p__cqp_query_sample = (Ptr__cqp_query_sample)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_query_sample");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_query_sample(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(subcorpus)), Shield<SEXP>(Rcpp::wrap(query)), Shield<SEXP>(Rcpp::wrap(size)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<SEXP >(rcpp_result_gen);
+    }
+
+    inline Rcpp::NumericVector _cqp_count_sample(SEXP corpus, SEXP query, int size) {
+        typedef SEXP(*Ptr__cqp_count_sample)(SEXP,SEXP,SEXP);
+        static Ptr__cqp_count_sample p__cqp_count_sample = NULL;
+        if (p__cqp_count_sample == NULL) {
+            validateSignature("Rcpp::NumericVector(*_cqp_count_sample)(SEXP,SEXP,int)");
+            p__cqp_count_sample = (Ptr__cqp_count_sample)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_count_sample");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_count_sample(Shield<SEXP>(Rcpp::wrap(corpus)), Shield<SEXP>(Rcpp::wrap(query)), Shield<SEXP>(Rcpp::wrap(size)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::NumericVector >(rcpp_result_gen);
+    }
+
+    inline Rcpp::List _cqp_kwic(SEXP scorpus, Rcpp::StringVector p_attribute, SEXP boundary, int left, int right, SEXP sep) {
+        typedef SEXP(*Ptr__cqp_kwic)(SEXP,SEXP,SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cqp_kwic p__cqp_kwic = NULL;
+        if (p__cqp_kwic == NULL) {
+            validateSignature("Rcpp::List(*_cqp_kwic)(SEXP,Rcpp::StringVector,SEXP,int,int,SEXP)");
+            p__cqp_kwic = (Ptr__cqp_kwic)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_kwic");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_kwic(Shield<SEXP>(Rcpp::wrap(scorpus)), Shield<SEXP>(Rcpp::wrap(p_attribute)), Shield<SEXP>(Rcpp::wrap(boundary)), Shield<SEXP>(Rcpp::wrap(left)), Shield<SEXP>(Rcpp::wrap(right)), Shield<SEXP>(Rcpp::wrap(sep)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::List >(rcpp_result_gen);
+    }
+
+    inline Rcpp::List _cqp_tabulate(SEXP scorpus, Rcpp::StringVector anchor, Rcpp::IntegerVector offset, Rcpp::StringVector attribute, bool factor) {
+        typedef SEXP(*Ptr__cqp_tabulate)(SEXP,SEXP,SEXP,SEXP,SEXP);
+        static Ptr__cqp_tabulate p__cqp_tabulate = NULL;
+        if (p__cqp_tabulate == NULL) {
+            validateSignature("Rcpp::List(*_cqp_tabulate)(SEXP,Rcpp::StringVector,Rcpp::IntegerVector,Rcpp::StringVector,bool)");
+            p__cqp_tabulate = (Ptr__cqp_tabulate)R_GetCCallable("RcppCWB", "_RcppCWB__cqp_tabulate");
+        }
+        RObject rcpp_result_gen;
+        {
+            RNGScope RCPP_rngScope_gen;
+            rcpp_result_gen = p__cqp_tabulate(Shield<SEXP>(Rcpp::wrap(scorpus)), Shield<SEXP>(Rcpp::wrap(anchor)), Shield<SEXP>(Rcpp::wrap(offset)), Shield<SEXP>(Rcpp::wrap(attribute)), Shield<SEXP>(Rcpp::wrap(factor)));
+        }
+        if (rcpp_result_gen.inherits("interrupted-error"))
+            throw Rcpp::internal::InterruptedException();
+        if (Rcpp::internal::isLongjumpSentinel(rcpp_result_gen))
+            throw Rcpp::LongjumpException(rcpp_result_gen);
+        if (rcpp_result_gen.inherits("try-error"))
+            throw Rcpp::exception(Rcpp::as<std::string>(rcpp_result_gen).c_str());
+        return Rcpp::as<Rcpp::List >(rcpp_result_gen);
+    }
+
     inline int _cwb_makeall(SEXP x, SEXP registry_dir, SEXP p_attribute) {
         typedef SEXP(*Ptr__cwb_makeall)(SEXP,SEXP,SEXP);
         static Ptr__cwb_makeall p__cwb_makeall = NULL;
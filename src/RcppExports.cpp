@@ -1518,22 +1518,24 @@ RcppExport SEXP _RcppCWB__cl_struc_values(SEXP corpusSEXP, SEXP s_attributeSEXP,
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// _corpus_data_dir
-Rcpp::StringVector _corpus_data_dir(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB__corpus_data_dir_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_cpos2alg
+Rcpp::IntegerMatrix _cl_cpos2alg(SEXP corpus, SEXP a_attribute, Rcpp::IntegerVector cpos, SEXP registry);
+static SEXP _RcppCWB__cl_cpos2alg_try(SEXP corpusSEXP, SEXP a_attributeSEXP, SEXP cposSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type a_attribute(a_attributeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type cpos(cposSEXP);
     Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(_corpus_data_dir(corpus, registry));
+    rcpp_result_gen = Rcpp::wrap(_cl_cpos2alg(corpus, a_attribute, cpos, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB__corpus_data_dir(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_cpos2alg(SEXP corpusSEXP, SEXP a_attributeSEXP, SEXP cposSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB__corpus_data_dir_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_cpos2alg_try(corpusSEXP, a_attributeSEXP, cposSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1553,22 +1555,24 @@ RcppExport SEXP _RcppCWB__corpus_data_dir(SEXP corpusSEXP, SEXP registrySEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// _corpus_info_file
-Rcpp::StringVector _corpus_info_file(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB__corpus_info_file_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_alg2cpos
+Rcpp::IntegerMatrix _cl_alg2cpos(SEXP corpus, SEXP a_attribute, Rcpp::IntegerVector alg, SEXP registry);
+static SEXP _RcppCWB__cl_alg2cpos_try(SEXP corpusSEXP, SEXP a_attributeSEXP, SEXP algSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type a_attribute(a_attributeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type alg(algSEXP);
     Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(_corpus_info_file(corpus, registry));
+    rcpp_result_gen = Rcpp::wrap(_cl_alg2cpos(corpus, a_attribute, alg, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB__corpus_info_file(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_alg2cpos(SEXP corpusSEXP, SEXP a_attributeSEXP, SEXP algSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB__corpus_info_file_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_alg2cpos_try(corpusSEXP, a_attributeSEXP, algSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1588,22 +1592,24 @@ RcppExport SEXP _RcppCWB__corpus_info_file(SEXP corpusSEXP, SEXP registrySEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// _corpus_full_name
-Rcpp::StringVector _corpus_full_name(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB__corpus_full_name_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_dynamic_register
+int _cl_dynamic_register(SEXP corpus, SEXP d_attribute, SEXP f, SEXP registry);
+static SEXP _RcppCWB__cl_dynamic_register_try(SEXP corpusSEXP, SEXP d_attributeSEXP, SEXP fSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type d_attribute(d_attributeSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type f(fSEXP);
     Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(_corpus_full_name(corpus, registry));
+    rcpp_result_gen = Rcpp::wrap(_cl_dynamic_register(corpus, d_attribute, f, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB__corpus_full_name(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_dynamic_register(SEXP corpusSEXP, SEXP d_attributeSEXP, SEXP fSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB__corpus_full_name_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_dynamic_register_try(corpusSEXP, d_attributeSEXP, fSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1623,22 +1629,24 @@ RcppExport SEXP _RcppCWB__corpus_full_name(SEXP corpusSEXP, SEXP registrySEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// corpus_p_attributes
-Rcpp::StringVector corpus_p_attributes(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB_corpus_p_attributes_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_dynamic_call
+SEXP _cl_dynamic_call(SEXP corpus, SEXP d_attribute, Rcpp::List args, SEXP registry);
+static SEXP _RcppCWB__cl_dynamic_call_try(SEXP corpusSEXP, SEXP d_attributeSEXP, SEXP argsSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type d_attribute(d_attributeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type args(argsSEXP);
     Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(corpus_p_attributes(corpus, registry));
+    rcpp_result_gen = Rcpp::wrap(_cl_dynamic_call(corpus, d_attribute, args, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_corpus_p_attributes(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_dynamic_call(SEXP corpusSEXP, SEXP d_attributeSEXP, SEXP argsSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_corpus_p_attributes_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_dynamic_call_try(corpusSEXP, d_attributeSEXP, argsSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1658,22 +1666,21 @@ RcppExport SEXP _RcppCWB_corpus_p_attributes(SEXP corpusSEXP, SEXP registrySEXP)
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// corpus_s_attributes
-Rcpp::StringVector corpus_s_attributes(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB_corpus_s_attributes_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_set_optimize
+int _cl_set_optimize(int state);
+static SEXP _RcppCWB__cl_set_optimize_try(SEXP stateSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(corpus_s_attributes(corpus, registry));
+    Rcpp::traits::input_parameter< int >::type state(stateSEXP);
+    rcpp_result_gen = Rcpp::wrap(_cl_set_optimize(state));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_corpus_s_attributes(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_set_optimize(SEXP stateSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_corpus_s_attributes_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_set_optimize_try(stateSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1693,22 +1700,20 @@ RcppExport SEXP _RcppCWB_corpus_s_attributes(SEXP corpusSEXP, SEXP registrySEXP)
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// corpus_properties
-Rcpp::StringVector corpus_properties(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB_corpus_properties_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_get_optimize
+int _cl_get_optimize();
+static SEXP _RcppCWB__cl_get_optimize_try() {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(corpus_properties(corpus, registry));
+    rcpp_result_gen = Rcpp::wrap(_cl_get_optimize());
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_corpus_properties(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_get_optimize() {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_corpus_properties_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_get_optimize_try());
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1728,23 +1733,21 @@ RcppExport SEXP _RcppCWB_corpus_properties(SEXP corpusSEXP, SEXP registrySEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// corpus_property
-Rcpp::StringVector corpus_property(SEXP corpus, SEXP registry, SEXP property);
-static SEXP _RcppCWB_corpus_property_try(SEXP corpusSEXP, SEXP registrySEXP, SEXP propertySEXP) {
+// _cl_regopt_count
+Rcpp::IntegerVector _cl_regopt_count(bool reset);
+static SEXP _RcppCWB__cl_regopt_count_try(SEXP resetSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    Rcpp::traits::input_parameter< SEXP >::type property(propertySEXP);
-    rcpp_result_gen = Rcpp::wrap(corpus_property(corpus, registry, property));
+    Rcpp::traits::input_parameter< bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(_cl_regopt_count(reset));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_corpus_property(SEXP corpusSEXP, SEXP registrySEXP, SEXP propertySEXP) {
+RcppExport SEXP _RcppCWB__cl_regopt_count(SEXP resetSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_corpus_property_try(corpusSEXP, registrySEXP, propertySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_regopt_count_try(resetSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1764,22 +1767,21 @@ RcppExport SEXP _RcppCWB_corpus_property(SEXP corpusSEXP, SEXP registrySEXP, SEX
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cl_load_corpus
-int cl_load_corpus(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB_cl_load_corpus_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// _cl_set_threads
+int _cl_set_threads(int n);
+static SEXP _RcppCWB__cl_set_threads_try(SEXP nSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(cl_load_corpus(corpus, registry));
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(_cl_set_threads(n));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cl_load_corpus(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB__cl_set_threads(SEXP nSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cl_load_corpus_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_set_threads_try(nSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1799,20 +1801,20 @@ RcppExport SEXP _RcppCWB_cl_load_corpus(SEXP corpusSEXP, SEXP registrySEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cl_list_corpora
-Rcpp::StringVector cl_list_corpora();
-static SEXP _RcppCWB_cl_list_corpora_try() {
+// _cl_get_threads
+int _cl_get_threads();
+static SEXP _RcppCWB__cl_get_threads_try() {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    rcpp_result_gen = Rcpp::wrap(cl_list_corpora());
+    rcpp_result_gen = Rcpp::wrap(_cl_get_threads());
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cl_list_corpora() {
+RcppExport SEXP _RcppCWB__cl_get_threads() {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cl_list_corpora_try());
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_get_threads_try());
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1832,21 +1834,21 @@ RcppExport SEXP _RcppCWB_cl_list_corpora() {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// corpus_registry_dir
-Rcpp::StringVector corpus_registry_dir(SEXP corpus);
-static SEXP _RcppCWB_corpus_registry_dir_try(SEXP corpusSEXP) {
+// _cl_set_registry_cache
+int _cl_set_registry_cache(SEXP file);
+static SEXP _RcppCWB__cl_set_registry_cache_try(SEXP fileSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(corpus_registry_dir(corpus));
+    Rcpp::traits::input_parameter< SEXP >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(_cl_set_registry_cache(file));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_corpus_registry_dir(SEXP corpusSEXP) {
+RcppExport SEXP _RcppCWB__cl_set_registry_cache(SEXP fileSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_corpus_registry_dir_try(corpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_set_registry_cache_try(fileSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1866,19 +1868,20 @@ RcppExport SEXP _RcppCWB_corpus_registry_dir(SEXP corpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// init_cqp
-void init_cqp();
-static SEXP _RcppCWB_init_cqp_try() {
+// _cl_get_registry_cache
+Rcpp::StringVector _cl_get_registry_cache();
+static SEXP _RcppCWB__cl_get_registry_cache_try() {
 BEGIN_RCPP
-    init_cqp();
-    return R_NilValue;
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(_cl_get_registry_cache());
+    return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_init_cqp() {
+RcppExport SEXP _RcppCWB__cl_get_registry_cache() {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_init_cqp_try());
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_get_registry_cache_try());
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1898,21 +1901,21 @@ RcppExport SEXP _RcppCWB_init_cqp() {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_verbosity
-void cqp_verbosity(int quietly, int verbose);
-static SEXP _RcppCWB_cqp_verbosity_try(SEXP quietlySEXP, SEXP verboseSEXP) {
+// _cl_registry_prefetch
+int _cl_registry_prefetch(SEXP registry);
+static SEXP _RcppCWB__cl_registry_prefetch_try(SEXP registrySEXP) {
 BEGIN_RCPP
-    Rcpp::traits::input_parameter< int >::type quietly(quietlySEXP);
-    Rcpp::traits::input_parameter< int >::type verbose(verboseSEXP);
-    cqp_verbosity(quietly, verbose);
-    return R_NilValue;
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(_cl_registry_prefetch(registry));
+    return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_verbosity(SEXP quietlySEXP, SEXP verboseSEXP) {
+RcppExport SEXP _RcppCWB__cl_registry_prefetch(SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_verbosity_try(quietlySEXP, verboseSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_registry_prefetch_try(registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1932,20 +1935,20 @@ RcppExport SEXP _RcppCWB_cqp_verbosity(SEXP quietlySEXP, SEXP verboseSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_get_registry
-Rcpp::StringVector cqp_get_registry();
-static SEXP _RcppCWB_cqp_get_registry_try() {
+// _cl_registry_cache_write
+int _cl_registry_cache_write();
+static SEXP _RcppCWB__cl_registry_cache_write_try() {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    rcpp_result_gen = Rcpp::wrap(cqp_get_registry());
+    rcpp_result_gen = Rcpp::wrap(_cl_registry_cache_write());
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_get_registry() {
+RcppExport SEXP _RcppCWB__cl_registry_cache_write() {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_get_registry_try());
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_registry_cache_write_try());
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1965,20 +1968,21 @@ RcppExport SEXP _RcppCWB_cqp_get_registry() {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_get_status
-int cqp_get_status();
-static SEXP _RcppCWB_cqp_get_status_try() {
+// _cl_registry_timings
+Rcpp::DataFrame _cl_registry_timings(bool reset);
+static SEXP _RcppCWB__cl_registry_timings_try(SEXP resetSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    rcpp_result_gen = Rcpp::wrap(cqp_get_status());
+    Rcpp::traits::input_parameter< bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(_cl_registry_timings(reset));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_get_status() {
+RcppExport SEXP _RcppCWB__cl_registry_timings(SEXP resetSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_get_status_try());
+        rcpp_result_gen = PROTECT(_RcppCWB__cl_registry_timings_try(resetSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -1998,21 +2002,22 @@ RcppExport SEXP _RcppCWB_cqp_get_status() {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_set_registry
-SEXP cqp_set_registry(SEXP registry_dir);
-static SEXP _RcppCWB_cqp_set_registry_try(SEXP registry_dirSEXP) {
+// _corpus_data_dir
+Rcpp::StringVector _corpus_data_dir(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB__corpus_data_dir_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type registry_dir(registry_dirSEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_set_registry(registry_dir));
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(_corpus_data_dir(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_set_registry(SEXP registry_dirSEXP) {
+RcppExport SEXP _RcppCWB__corpus_data_dir(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_set_registry_try(registry_dirSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__corpus_data_dir_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2032,20 +2037,22 @@ RcppExport SEXP _RcppCWB_cqp_set_registry(SEXP registry_dirSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_list_corpora
-Rcpp::StringVector cqp_list_corpora();
-static SEXP _RcppCWB_cqp_list_corpora_try() {
+// _corpus_info_file
+Rcpp::StringVector _corpus_info_file(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB__corpus_info_file_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    rcpp_result_gen = Rcpp::wrap(cqp_list_corpora());
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(_corpus_info_file(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_list_corpora() {
+RcppExport SEXP _RcppCWB__corpus_info_file(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_list_corpora_try());
+        rcpp_result_gen = PROTECT(_RcppCWB__corpus_info_file_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2065,23 +2072,22 @@ RcppExport SEXP _RcppCWB_cqp_list_corpora() {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_query
-SEXP cqp_query(SEXP corpus, SEXP subcorpus, SEXP query);
-static SEXP _RcppCWB_cqp_query_try(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP querySEXP) {
+// _corpus_full_name
+Rcpp::StringVector _corpus_full_name(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB__corpus_full_name_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_query(corpus, subcorpus, query));
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(_corpus_full_name(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_query(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP querySEXP) {
+RcppExport SEXP _RcppCWB__corpus_full_name(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_try(corpusSEXP, subcorpusSEXP, querySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB__corpus_full_name_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2101,21 +2107,22 @@ RcppExport SEXP _RcppCWB_cqp_query(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP que
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_subcorpus_size
-int cqp_subcorpus_size(SEXP scorpus);
-static SEXP _RcppCWB_cqp_subcorpus_size_try(SEXP scorpusSEXP) {
+// corpus_p_attributes
+Rcpp::StringVector corpus_p_attributes(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB_corpus_p_attributes_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type scorpus(scorpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_subcorpus_size(scorpus));
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_p_attributes(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_subcorpus_size(SEXP scorpusSEXP) {
+RcppExport SEXP _RcppCWB_corpus_p_attributes(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_subcorpus_size_try(scorpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_corpus_p_attributes_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2135,21 +2142,22 @@ RcppExport SEXP _RcppCWB_cqp_subcorpus_size(SEXP scorpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_list_subcorpora
-Rcpp::StringVector cqp_list_subcorpora(SEXP inCorpus);
-static SEXP _RcppCWB_cqp_list_subcorpora_try(SEXP inCorpusSEXP) {
+// corpus_s_attributes
+Rcpp::StringVector corpus_s_attributes(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB_corpus_s_attributes_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type inCorpus(inCorpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_list_subcorpora(inCorpus));
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_s_attributes(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_list_subcorpora(SEXP inCorpusSEXP) {
+RcppExport SEXP _RcppCWB_corpus_s_attributes(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_list_subcorpora_try(inCorpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_corpus_s_attributes_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2169,21 +2177,22 @@ RcppExport SEXP _RcppCWB_cqp_list_subcorpora(SEXP inCorpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_dump_subcorpus
-Rcpp::IntegerMatrix cqp_dump_subcorpus(SEXP inSubcorpus);
-static SEXP _RcppCWB_cqp_dump_subcorpus_try(SEXP inSubcorpusSEXP) {
+// corpus_properties
+Rcpp::StringVector corpus_properties(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB_corpus_properties_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type inSubcorpus(inSubcorpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_dump_subcorpus(inSubcorpus));
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_properties(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_dump_subcorpus(SEXP inSubcorpusSEXP) {
+RcppExport SEXP _RcppCWB_corpus_properties(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_dump_subcorpus_try(inSubcorpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_corpus_properties_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2203,21 +2212,23 @@ RcppExport SEXP _RcppCWB_cqp_dump_subcorpus(SEXP inSubcorpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_subcorpus_regions
-Rcpp::IntegerMatrix cqp_subcorpus_regions(SEXP subcorpus);
-static SEXP _RcppCWB_cqp_subcorpus_regions_try(SEXP subcorpusSEXP) {
+// corpus_property
+Rcpp::StringVector corpus_property(SEXP corpus, SEXP registry, SEXP property);
+static SEXP _RcppCWB_corpus_property_try(SEXP corpusSEXP, SEXP registrySEXP, SEXP propertySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_subcorpus_regions(subcorpus));
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    Rcpp::traits::input_parameter< SEXP >::type property(propertySEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_property(corpus, registry, property));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_subcorpus_regions(SEXP subcorpusSEXP) {
+RcppExport SEXP _RcppCWB_corpus_property(SEXP corpusSEXP, SEXP registrySEXP, SEXP propertySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_subcorpus_regions_try(subcorpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_corpus_property_try(corpusSEXP, registrySEXP, propertySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2237,21 +2248,22 @@ RcppExport SEXP _RcppCWB_cqp_subcorpus_regions(SEXP subcorpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_drop_subcorpus
-SEXP cqp_drop_subcorpus(SEXP inSubcorpus);
-static SEXP _RcppCWB_cqp_drop_subcorpus_try(SEXP inSubcorpusSEXP) {
+// cl_load_corpus
+int cl_load_corpus(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB_cl_load_corpus_try(SEXP corpusSEXP, SEXP registrySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type inSubcorpus(inSubcorpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_drop_subcorpus(inSubcorpus));
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(cl_load_corpus(corpus, registry));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_drop_subcorpus(SEXP inSubcorpusSEXP) {
+RcppExport SEXP _RcppCWB_cl_load_corpus(SEXP corpusSEXP, SEXP registrySEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_drop_subcorpus_try(inSubcorpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_cl_load_corpus_try(corpusSEXP, registrySEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2271,21 +2283,20 @@ RcppExport SEXP _RcppCWB_cqp_drop_subcorpus(SEXP inSubcorpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// check_corpus
-int check_corpus(SEXP corpus);
-static SEXP _RcppCWB_check_corpus_try(SEXP corpusSEXP) {
+// cl_list_corpora
+Rcpp::StringVector cl_list_corpora();
+static SEXP _RcppCWB_cl_list_corpora_try() {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(check_corpus(corpus));
+    rcpp_result_gen = Rcpp::wrap(cl_list_corpora());
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_check_corpus(SEXP corpusSEXP) {
+RcppExport SEXP _RcppCWB_cl_list_corpora() {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_check_corpus_try(corpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_cl_list_corpora_try());
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2305,22 +2316,21 @@ RcppExport SEXP _RcppCWB_check_corpus(SEXP corpusSEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// cqp_load_corpus
-int cqp_load_corpus(SEXP corpus, SEXP registry);
-static SEXP _RcppCWB_cqp_load_corpus_try(SEXP corpusSEXP, SEXP registrySEXP) {
+// corpus_registry_dir
+Rcpp::StringVector corpus_registry_dir(SEXP corpus);
+static SEXP _RcppCWB_corpus_registry_dir_try(SEXP corpusSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
-    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
-    rcpp_result_gen = Rcpp::wrap(cqp_load_corpus(corpus, registry));
+    rcpp_result_gen = Rcpp::wrap(corpus_registry_dir(corpus));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_cqp_load_corpus(SEXP corpusSEXP, SEXP registrySEXP) {
+RcppExport SEXP _RcppCWB_corpus_registry_dir(SEXP corpusSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_cqp_load_corpus_try(corpusSEXP, registrySEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_corpus_registry_dir_try(corpusSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2340,23 +2350,996 @@ RcppExport SEXP _RcppCWB_cqp_load_corpus(SEXP corpusSEXP, SEXP registrySEXP) {
     UNPROTECT(1);
     return rcpp_result_gen;
 }
-// region_matrix_to_subcorpus
-SEXP region_matrix_to_subcorpus(Rcpp::IntegerMatrix region_matrix, SEXP corpus, SEXP subcorpus);
-static SEXP _RcppCWB_region_matrix_to_subcorpus_try(SEXP region_matrixSEXP, SEXP corpusSEXP, SEXP subcorpusSEXP) {
+// init_cqp
+void init_cqp();
+static SEXP _RcppCWB_init_cqp_try() {
+BEGIN_RCPP
+    init_cqp();
+    return R_NilValue;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_init_cqp() {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_init_cqp_try());
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_verbosity
+void cqp_verbosity(int quietly, int verbose);
+static SEXP _RcppCWB_cqp_verbosity_try(SEXP quietlySEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::traits::input_parameter< int >::type quietly(quietlySEXP);
+    Rcpp::traits::input_parameter< int >::type verbose(verboseSEXP);
+    cqp_verbosity(quietly, verbose);
+    return R_NilValue;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_verbosity(SEXP quietlySEXP, SEXP verboseSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_verbosity_try(quietlySEXP, verboseSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_get_registry
+Rcpp::StringVector cqp_get_registry();
+static SEXP _RcppCWB_cqp_get_registry_try() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(cqp_get_registry());
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_get_registry() {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_get_registry_try());
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_get_status
+int cqp_get_status();
+static SEXP _RcppCWB_cqp_get_status_try() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(cqp_get_status());
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_get_status() {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_get_status_try());
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_set_registry
+SEXP cqp_set_registry(SEXP registry_dir);
+static SEXP _RcppCWB_cqp_set_registry_try(SEXP registry_dirSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type registry_dir(registry_dirSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_set_registry(registry_dir));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_set_registry(SEXP registry_dirSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_set_registry_try(registry_dirSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_list_corpora
+Rcpp::StringVector cqp_list_corpora();
+static SEXP _RcppCWB_cqp_list_corpora_try() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(cqp_list_corpora());
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_list_corpora() {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_list_corpora_try());
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_query
+SEXP cqp_query(SEXP corpus, SEXP subcorpus, SEXP query);
+static SEXP _RcppCWB_cqp_query_try(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP querySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_query(corpus, subcorpus, query));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_query(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP querySEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_try(corpusSEXP, subcorpusSEXP, querySEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_subcorpus_size
+int cqp_subcorpus_size(SEXP scorpus);
+static SEXP _RcppCWB_cqp_subcorpus_size_try(SEXP scorpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type scorpus(scorpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_subcorpus_size(scorpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_subcorpus_size(SEXP scorpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_subcorpus_size_try(scorpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_list_subcorpora
+Rcpp::StringVector cqp_list_subcorpora(SEXP inCorpus);
+static SEXP _RcppCWB_cqp_list_subcorpora_try(SEXP inCorpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type inCorpus(inCorpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_list_subcorpora(inCorpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_list_subcorpora(SEXP inCorpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_list_subcorpora_try(inCorpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_dump_subcorpus
+Rcpp::IntegerMatrix cqp_dump_subcorpus(SEXP inSubcorpus);
+static SEXP _RcppCWB_cqp_dump_subcorpus_try(SEXP inSubcorpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type inSubcorpus(inSubcorpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_dump_subcorpus(inSubcorpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_dump_subcorpus(SEXP inSubcorpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_dump_subcorpus_try(inSubcorpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_subcorpus_regions
+Rcpp::IntegerMatrix cqp_subcorpus_regions(SEXP subcorpus);
+static SEXP _RcppCWB_cqp_subcorpus_regions_try(SEXP subcorpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_subcorpus_regions(subcorpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_subcorpus_regions(SEXP subcorpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_subcorpus_regions_try(subcorpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_drop_subcorpus
+SEXP cqp_drop_subcorpus(SEXP inSubcorpus);
+static SEXP _RcppCWB_cqp_drop_subcorpus_try(SEXP inSubcorpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type inSubcorpus(inSubcorpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_drop_subcorpus(inSubcorpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_drop_subcorpus(SEXP inSubcorpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_drop_subcorpus_try(inSubcorpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// check_corpus
+int check_corpus(SEXP corpus);
+static SEXP _RcppCWB_check_corpus_try(SEXP corpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(check_corpus(corpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_check_corpus(SEXP corpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_check_corpus_try(corpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_load_corpus
+int cqp_load_corpus(SEXP corpus, SEXP registry);
+static SEXP _RcppCWB_cqp_load_corpus_try(SEXP corpusSEXP, SEXP registrySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type registry(registrySEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_load_corpus(corpus, registry));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_load_corpus(SEXP corpusSEXP, SEXP registrySEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_load_corpus_try(corpusSEXP, registrySEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// region_matrix_to_subcorpus
+SEXP region_matrix_to_subcorpus(Rcpp::IntegerMatrix region_matrix, SEXP corpus, SEXP subcorpus);
+static SEXP _RcppCWB_region_matrix_to_subcorpus_try(SEXP region_matrixSEXP, SEXP corpusSEXP, SEXP subcorpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerMatrix >::type region_matrix(region_matrixSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(region_matrix_to_subcorpus(region_matrix, corpus, subcorpus));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_region_matrix_to_subcorpus(SEXP region_matrixSEXP, SEXP corpusSEXP, SEXP subcorpusSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_region_matrix_to_subcorpus_try(region_matrixSEXP, corpusSEXP, subcorpusSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_cursor_open
+SEXP cqp_cursor_open(SEXP corpus, SEXP query, int chunk);
+static SEXP _RcppCWB_cqp_cursor_open_try(SEXP corpusSEXP, SEXP querySEXP, SEXP chunkSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
+    Rcpp::traits::input_parameter< int >::type chunk(chunkSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_cursor_open(corpus, query, chunk));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_cursor_open(SEXP corpusSEXP, SEXP querySEXP, SEXP chunkSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_cursor_open_try(corpusSEXP, querySEXP, chunkSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_cursor_fetch
+Rcpp::IntegerMatrix cqp_cursor_fetch(SEXP cursor, int n);
+static SEXP _RcppCWB_cqp_cursor_fetch_try(SEXP cursorSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type cursor(cursorSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_cursor_fetch(cursor, n));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_cursor_fetch(SEXP cursorSEXP, SEXP nSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_cursor_fetch_try(cursorSEXP, nSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_cursor_status
+Rcpp::NumericVector cqp_cursor_status(SEXP cursor);
+static SEXP _RcppCWB_cqp_cursor_status_try(SEXP cursorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type cursor(cursorSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_cursor_status(cursor));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_cursor_status(SEXP cursorSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_cursor_status_try(cursorSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_cursor_close
+SEXP cqp_cursor_close(SEXP cursor);
+static SEXP _RcppCWB_cqp_cursor_close_try(SEXP cursorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type cursor(cursorSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_cursor_close(cursor));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_cursor_close(SEXP cursorSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_cursor_close_try(cursorSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_query_cache_set
+int cqp_query_cache_set(int memory, SEXP dir);
+static SEXP _RcppCWB_cqp_query_cache_set_try(SEXP memorySEXP, SEXP dirSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< int >::type memory(memorySEXP);
+    Rcpp::traits::input_parameter< SEXP >::type dir(dirSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_query_cache_set(memory, dir));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_query_cache_set(SEXP memorySEXP, SEXP dirSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_cache_set_try(memorySEXP, dirSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_query_cache_stats
+Rcpp::NumericVector cqp_query_cache_stats();
+static SEXP _RcppCWB_cqp_query_cache_stats_try() {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< Rcpp::IntegerMatrix >::type region_matrix(region_matrixSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_query_cache_stats());
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_query_cache_stats() {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_cache_stats_try());
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_query_cache_clear
+SEXP cqp_query_cache_clear();
+static SEXP _RcppCWB_cqp_query_cache_clear_try() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    rcpp_result_gen = Rcpp::wrap(cqp_query_cache_clear());
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_query_cache_clear() {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_cache_clear_try());
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_prepare
+SEXP cqp_prepare(SEXP corpus, SEXP query);
+static SEXP _RcppCWB_cqp_prepare_try(SEXP corpusSEXP, SEXP querySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_prepare(corpus, query));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_prepare(SEXP corpusSEXP, SEXP querySEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_prepare_try(corpusSEXP, querySEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_execute
+SEXP cqp_execute(SEXP prepared, SEXP corpus, SEXP subcorpus, SEXP args);
+static SEXP _RcppCWB_cqp_execute_try(SEXP preparedSEXP, SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP argsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type prepared(preparedSEXP);
     Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
     Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
-    rcpp_result_gen = Rcpp::wrap(region_matrix_to_subcorpus(region_matrix, corpus, subcorpus));
+    Rcpp::traits::input_parameter< SEXP >::type args(argsSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_execute(prepared, corpus, subcorpus, args));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppCWB_region_matrix_to_subcorpus(SEXP region_matrixSEXP, SEXP corpusSEXP, SEXP subcorpusSEXP) {
+RcppExport SEXP _RcppCWB_cqp_execute(SEXP preparedSEXP, SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP argsSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppCWB_region_matrix_to_subcorpus_try(region_matrixSEXP, corpusSEXP, subcorpusSEXP));
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_execute_try(preparedSEXP, corpusSEXP, subcorpusSEXP, argsSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_query_batch
+Rcpp::IntegerMatrix cqp_query_batch(SEXP corpus, SEXP queries, SEXP subcorpora, SEXP s_attribute);
+static SEXP _RcppCWB_cqp_query_batch_try(SEXP corpusSEXP, SEXP queriesSEXP, SEXP subcorporaSEXP, SEXP s_attributeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type queries(queriesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type subcorpora(subcorporaSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type s_attribute(s_attributeSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_query_batch(corpus, queries, subcorpora, s_attribute));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_query_batch(SEXP corpusSEXP, SEXP queriesSEXP, SEXP subcorporaSEXP, SEXP s_attributeSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_batch_try(corpusSEXP, queriesSEXP, subcorporaSEXP, s_attributeSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_query_sample
+SEXP cqp_query_sample(SEXP corpus, SEXP subcorpus, SEXP query, int size);
+static SEXP _RcppCWB_cqp_query_sample_try(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP querySEXP, SEXP sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type subcorpus(subcorpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_query_sample(corpus, subcorpus, query, size));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_query_sample(SEXP corpusSEXP, SEXP subcorpusSEXP, SEXP querySEXP, SEXP sizeSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_query_sample_try(corpusSEXP, subcorpusSEXP, querySEXP, sizeSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_count_sample
+Rcpp::NumericVector cqp_count_sample(SEXP corpus, SEXP query, int size);
+static SEXP _RcppCWB_cqp_count_sample_try(SEXP corpusSEXP, SEXP querySEXP, SEXP sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_count_sample(corpus, query, size));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_count_sample(SEXP corpusSEXP, SEXP querySEXP, SEXP sizeSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_count_sample_try(corpusSEXP, querySEXP, sizeSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_kwic
+Rcpp::List cqp_kwic(SEXP scorpus, Rcpp::StringVector p_attribute, SEXP boundary, int left, int right, SEXP sep);
+static SEXP _RcppCWB_cqp_kwic_try(SEXP scorpusSEXP, SEXP p_attributeSEXP, SEXP boundarySEXP, SEXP leftSEXP, SEXP rightSEXP, SEXP sepSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type scorpus(scorpusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type p_attribute(p_attributeSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type boundary(boundarySEXP);
+    Rcpp::traits::input_parameter< int >::type left(leftSEXP);
+    Rcpp::traits::input_parameter< int >::type right(rightSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type sep(sepSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_kwic(scorpus, p_attribute, boundary, left, right, sep));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_kwic(SEXP scorpusSEXP, SEXP p_attributeSEXP, SEXP boundarySEXP, SEXP leftSEXP, SEXP rightSEXP, SEXP sepSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_kwic_try(scorpusSEXP, p_attributeSEXP, boundarySEXP, leftSEXP, rightSEXP, sepSEXP));
+    }
+    Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
+    if (rcpp_isInterrupt_gen) {
+        UNPROTECT(1);
+        Rf_onintr();
+    }
+    bool rcpp_isLongjump_gen = Rcpp::internal::isLongjumpSentinel(rcpp_result_gen);
+    if (rcpp_isLongjump_gen) {
+        Rcpp::internal::resumeJump(rcpp_result_gen);
+    }
+    Rboolean rcpp_isError_gen = Rf_inherits(rcpp_result_gen, "try-error");
+    if (rcpp_isError_gen) {
+        SEXP rcpp_msgSEXP_gen = Rf_asChar(rcpp_result_gen);
+        UNPROTECT(1);
+        Rf_error("%s", CHAR(rcpp_msgSEXP_gen));
+    }
+    UNPROTECT(1);
+    return rcpp_result_gen;
+}
+// cqp_tabulate
+Rcpp::List cqp_tabulate(SEXP scorpus, Rcpp::StringVector anchor, Rcpp::IntegerVector offset, Rcpp::StringVector attribute, bool factor);
+static SEXP _RcppCWB_cqp_tabulate_try(SEXP scorpusSEXP, SEXP anchorSEXP, SEXP offsetSEXP, SEXP attributeSEXP, SEXP factorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::traits::input_parameter< SEXP >::type scorpus(scorpusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type anchor(anchorSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type offset(offsetSEXP);
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type attribute(attributeSEXP);
+    Rcpp::traits::input_parameter< bool >::type factor(factorSEXP);
+    rcpp_result_gen = Rcpp::wrap(cqp_tabulate(scorpus, anchor, offset, attribute, factor));
+    return rcpp_result_gen;
+END_RCPP_RETURN_ERROR
+}
+RcppExport SEXP _RcppCWB_cqp_tabulate(SEXP scorpusSEXP, SEXP anchorSEXP, SEXP offsetSEXP, SEXP attributeSEXP, SEXP factorSEXP) {
+    SEXP rcpp_result_gen;
+    {
+        Rcpp::RNGScope rcpp_rngScope_gen;
+        rcpp_result_gen = PROTECT(_RcppCWB_cqp_tabulate_try(scorpusSEXP, anchorSEXP, offsetSEXP, attributeSEXP, factorSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -2572,6 +3555,20 @@ static int _RcppCWB_RcppExport_validate(const char* sig) {
         signatures.insert("int(*.corpus_is_loaded)(SEXP,SEXP)");
         signatures.insert("Rcpp::StringVector(*.cl_charset_name)(SEXP,SEXP)");
         signatures.insert("int(*.cl_struc_values)(SEXP,SEXP,SEXP)");
+        signatures.insert("Rcpp::IntegerMatrix(*.cl_cpos2alg)(SEXP,SEXP,Rcpp::IntegerVector,SEXP)");
+        signatures.insert("Rcpp::IntegerMatrix(*.cl_alg2cpos)(SEXP,SEXP,Rcpp::IntegerVector,SEXP)");
+        signatures.insert("int(*.cl_dynamic_register)(SEXP,SEXP,SEXP,SEXP)");
+        signatures.insert("SEXP(*.cl_dynamic_call)(SEXP,SEXP,Rcpp::List,SEXP)");
+        signatures.insert("int(*.cl_set_optimize)(int)");
+        signatures.insert("int(*.cl_get_optimize)()");
+        signatures.insert("Rcpp::IntegerVector(*.cl_regopt_count)(bool)");
+        signatures.insert("int(*.cl_set_threads)(int)");
+        signatures.insert("int(*.cl_get_threads)()");
+        signatures.insert("int(*.cl_set_registry_cache)(SEXP)");
+        signatures.insert("Rcpp::StringVector(*.cl_get_registry_cache)()");
+        signatures.insert("int(*.cl_registry_prefetch)(SEXP)");
+        signatures.insert("int(*.cl_registry_cache_write)()");
+        signatures.insert("Rcpp::DataFrame(*.cl_registry_timings)(bool)");
         signatures.insert("Rcpp::StringVector(*.corpus_data_dir)(SEXP,SEXP)");
         signatures.insert("Rcpp::StringVector(*.corpus_info_file)(SEXP,SEXP)");
         signatures.insert("Rcpp::StringVector(*.corpus_full_name)(SEXP,SEXP)");
@@ -2597,6 +3594,20 @@ static int _RcppCWB_RcppExport_validate(const char* sig) {
         signatures.insert("int(*.check_corpus)(SEXP)");
         signatures.insert("int(*.cqp_load_corpus)(SEXP,SEXP)");
         signatures.insert("SEXP(*.region_matrix_to_subcorpus)(Rcpp::IntegerMatrix,SEXP,SEXP)");
+        signatures.insert("SEXP(*.cqp_cursor_open)(SEXP,SEXP,int)");
+        signatures.insert("Rcpp::IntegerMatrix(*.cqp_cursor_fetch)(SEXP,int)");
+        signatures.insert("Rcpp::NumericVector(*.cqp_cursor_status)(SEXP)");
+        signatures.insert("SEXP(*.cqp_cursor_close)(SEXP)");
+        signatures.insert("int(*.cqp_query_cache_set)(int,SEXP)");
+        signatures.insert("Rcpp::NumericVector(*.cqp_query_cache_stats)()");
+        signatures.insert("SEXP(*.cqp_query_cache_clear)()");
+        signatures.insert("SEXP(*.cqp_prepare)(SEXP,SEXP)");
+        signatures.insert("SEXP(*.cqp_execute)(SEXP,SEXP,SEXP,SEXP)");
+        signatures.insert("Rcpp::IntegerMatrix(*.cqp_query_batch)(SEXP,SEXP,SEXP,SEXP)");
+        signatures.insert("SEXP(*.cqp_query_sample)(SEXP,SEXP,SEXP,int)");
+        signatures.insert("Rcpp::NumericVector(*.cqp_count_sample)(SEXP,SEXP,int)");
+        signatures.insert("Rcpp::List(*.cqp_kwic)(SEXP,Rcpp::StringVector,SEXP,int,int,SEXP)");
+        signatures.insert("Rcpp::List(*.cqp_tabulate)(SEXP,Rcpp::StringVector,Rcpp::IntegerVector,Rcpp::StringVector,bool)");
         signatures.insert("int(*.cwb_makeall)(SEXP,SEXP,SEXP)");
         signatures.insert("int(*.cwb_huffcode)(SEXP,SEXP,SEXP)");
         signatures.insert("int(*.cwb_compress_rdx)(SEXP,SEXP,SEXP)");
@@ -2645,6 +3656,20 @@ RcppExport SEXP _RcppCWB_RcppExport_registerCCallable() {
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.corpus_is_loaded", (DL_FUNC)_RcppCWB__corpus_is_loaded_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_charset_name", (DL_FUNC)_RcppCWB__cl_charset_name_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_struc_values", (DL_FUNC)_RcppCWB__cl_struc_values_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_cpos2alg", (DL_FUNC)_RcppCWB__cl_cpos2alg_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_alg2cpos", (DL_FUNC)_RcppCWB__cl_alg2cpos_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_dynamic_register", (DL_FUNC)_RcppCWB__cl_dynamic_register_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_dynamic_call", (DL_FUNC)_RcppCWB__cl_dynamic_call_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_set_optimize", (DL_FUNC)_RcppCWB__cl_set_optimize_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_get_optimize", (DL_FUNC)_RcppCWB__cl_get_optimize_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_regopt_count", (DL_FUNC)_RcppCWB__cl_regopt_count_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_set_threads", (DL_FUNC)_RcppCWB__cl_set_threads_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_get_threads", (DL_FUNC)_RcppCWB__cl_get_threads_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_set_registry_cache", (DL_FUNC)_RcppCWB__cl_set_registry_cache_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_get_registry_cache", (DL_FUNC)_RcppCWB__cl_get_registry_cache_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_registry_prefetch", (DL_FUNC)_RcppCWB__cl_registry_prefetch_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_registry_cache_write", (DL_FUNC)_RcppCWB__cl_registry_cache_write_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cl_registry_timings", (DL_FUNC)_RcppCWB__cl_registry_timings_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.corpus_data_dir", (DL_FUNC)_RcppCWB__corpus_data_dir_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.corpus_info_file", (DL_FUNC)_RcppCWB__corpus_info_file_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.corpus_full_name", (DL_FUNC)_RcppCWB__corpus_full_name_try);
@@ -2670,6 +3695,20 @@ RcppExport SEXP _RcppCWB_RcppExport_registerCCallable() {
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.check_corpus", (DL_FUNC)_RcppCWB_check_corpus_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_load_corpus", (DL_FUNC)_RcppCWB_cqp_load_corpus_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.region_matrix_to_subcorpus", (DL_FUNC)_RcppCWB_region_matrix_to_subcorpus_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_cursor_open", (DL_FUNC)_RcppCWB_cqp_cursor_open_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_cursor_fetch", (DL_FUNC)_RcppCWB_cqp_cursor_fetch_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_cursor_status", (DL_FUNC)_RcppCWB_cqp_cursor_status_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_cursor_close", (DL_FUNC)_RcppCWB_cqp_cursor_close_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_query_cache_set", (DL_FUNC)_RcppCWB_cqp_query_cache_set_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_query_cache_stats", (DL_FUNC)_RcppCWB_cqp_query_cache_stats_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_query_cache_clear", (DL_FUNC)_RcppCWB_cqp_query_cache_clear_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_prepare", (DL_FUNC)_RcppCWB_cqp_prepare_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_execute", (DL_FUNC)_RcppCWB_cqp_execute_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_query_batch", (DL_FUNC)_RcppCWB_cqp_query_batch_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_query_sample", (DL_FUNC)_RcppCWB_cqp_query_sample_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_count_sample", (DL_FUNC)_RcppCWB_cqp_count_sample_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_kwic", (DL_FUNC)_RcppCWB_cqp_kwic_try);
+    R_RegisterCCallable("RcppCWB", "_RcppCWB_.cqp_tabulate", (DL_FUNC)_RcppCWB_cqp_tabulate_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.cwb_makeall", (DL_FUNC)_RcppCWB_cwb_makeall_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.cwb_huffcode", (DL_FUNC)_RcppCWB_cwb_huffcode_try);
     R_RegisterCCallable("RcppCWB", "_RcppCWB_.cwb_compress_rdx", (DL_FUNC)_RcppCWB_cwb_compress_rdx_try);
@@ -2728,6 +3767,20 @@ static const R_CallMethodDef CallEntries[] = {
     {"_RcppCWB__corpus_is_loaded", (DL_FUNC) &_RcppCWB__corpus_is_loaded, 2},
     {"_RcppCWB__cl_charset_name", (DL_FUNC) &_RcppCWB__cl_charset_name, 2},
     {"_RcppCWB__cl_struc_values", (DL_FUNC) &_RcppCWB__cl_struc_values, 3},
+    {"_RcppCWB__cl_cpos2alg", (DL_FUNC) &_RcppCWB__cl_cpos2alg, 4},
+    {"_RcppCWB__cl_alg2cpos", (DL_FUNC) &_RcppCWB__cl_alg2cpos, 4},
+    {"_RcppCWB__cl_dynamic_register", (DL_FUNC) &_RcppCWB__cl_dynamic_register, 4},
+    {"_RcppCWB__cl_dynamic_call", (DL_FUNC) &_RcppCWB__cl_dynamic_call, 4},
+    {"_RcppCWB__cl_set_optimize", (DL_FUNC) &_RcppCWB__cl_set_optimize, 1},
+    {"_RcppCWB__cl_get_optimize", (DL_FUNC) &_RcppCWB__cl_get_optimize, 0},
+    {"_RcppCWB__cl_regopt_count", (DL_FUNC) &_RcppCWB__cl_regopt_count, 1},
+    {"_RcppCWB__cl_set_threads", (DL_FUNC) &_RcppCWB__cl_set_threads, 1},
+    {"_RcppCWB__cl_get_threads", (DL_FUNC) &_RcppCWB__cl_get_threads, 0},
+    {"_RcppCWB__cl_set_registry_cache", (DL_FUNC) &_RcppCWB__cl_set_registry_cache, 1},
+    {"_RcppCWB__cl_get_registry_cache", (DL_FUNC) &_RcppCWB__cl_get_registry_cache, 0},
+    {"_RcppCWB__cl_registry_prefetch", (DL_FUNC) &_RcppCWB__cl_registry_prefetch, 1},
+    {"_RcppCWB__cl_registry_cache_write", (DL_FUNC) &_RcppCWB__cl_registry_cache_write, 0},
+    {"_RcppCWB__cl_registry_timings", (DL_FUNC) &_RcppCWB__cl_registry_timings, 1},
     {"_RcppCWB__corpus_data_dir", (DL_FUNC) &_RcppCWB__corpus_data_dir, 2},
     {"_RcppCWB__corpus_info_file", (DL_FUNC) &_RcppCWB__corpus_info_file, 2},
     {"_RcppCWB__corpus_full_name", (DL_FUNC) &_RcppCWB__corpus_full_name, 2},
@@ -2753,6 +3806,20 @@ static const R_CallMethodDef CallEntries[] = {
     {"_RcppCWB_check_corpus", (DL_FUNC) &_RcppCWB_check_corpus, 1},
     {"_RcppCWB_cqp_load_corpus", (DL_FUNC) &_RcppCWB_cqp_load_corpus, 2},
     {"_RcppCWB_region_matrix_to_subcorpus", (DL_FUNC) &_RcppCWB_region_matrix_to_subcorpus, 3},
+    {"_RcppCWB_cqp_cursor_open", (DL_FUNC) &_RcppCWB_cqp_cursor_open, 3},
+    {"_RcppCWB_cqp_cursor_fetch", (DL_FUNC) &_RcppCWB_cqp_cursor_fetch, 2},
+    {"_RcppCWB_cqp_cursor_status", (DL_FUNC) &_RcppCWB_cqp_cursor_status, 1},
+    {"_RcppCWB_cqp_cursor_close", (DL_FUNC) &_RcppCWB_cqp_cursor_close, 1},
+    {"_RcppCWB_cqp_query_cache_set", (DL_FUNC) &_RcppCWB_cqp_query_cache_set, 2},
+    {"_RcppCWB_cqp_query_cache_stats", (DL_FUNC) &_RcppCWB_cqp_query_cache_stats, 0},
+    {"_RcppCWB_cqp_query_cache_clear", (DL_FUNC) &_RcppCWB_cqp_query_cache_clear, 0},
+    {"_RcppCWB_cqp_prepare", (DL_FUNC) &_RcppCWB_cqp_prepare, 2},
+    {"_RcppCWB_cqp_execute", (DL_FUNC) &_RcppCWB_cqp_execute, 4},
+    {"_RcppCWB_cqp_query_batch", (DL_FUNC) &_RcppCWB_cqp_query_batch, 4},
+    {"_RcppCWB_cqp_query_sample", (DL_FUNC) &_RcppCWB_cqp_query_sample, 4},
+    {"_RcppCWB_cqp_count_sample", (DL_FUNC) &_RcppCWB_cqp_count_sample, 3},
+    {"_RcppCWB_cqp_kwic", (DL_FUNC) &_RcppCWB_cqp_kwic, 6},
+    {"_RcppCWB_cqp_tabulate", (DL_FUNC) &_RcppCWB_cqp_tabulate, 5},
     {"_RcppCWB_cwb_makeall", (DL_FUNC) &_RcppCWB_cwb_makeall, 3},
     {"_RcppCWB_cwb_huffcode", (DL_FUNC) &_RcppCWB_cwb_huffcode, 3},
     {"_RcppCWB_cwb_compress_rdx", (DL_FUNC) &_RcppCWB_cwb_compress_rdx, 3},
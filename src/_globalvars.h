@@ -52,6 +52,7 @@ extern int private_server;
 extern int server_port;
 extern int localhost;
 extern int server_quit;
+extern int shared_server;
 extern int query_lock;
 extern int query_lock_violation;
 extern int enable_macros;
@@ -104,6 +105,10 @@ extern int UseExternalSort;
 extern char *ExternalSortCommand;
 extern int UseExternalGroup;
 extern char *ExternalGroupCommand;
+extern int QueryCacheMemory;
+extern char *QueryCacheDir;
+extern SubcorpusFormat subcorpus_format;
+extern char *subcorpus_format_name;
 extern int user_level;
 extern int output_binary_ranges;
 extern int child_process;
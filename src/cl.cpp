@@ -651,6 +651,379 @@ int _cl_struc_values(SEXP corpus, SEXP s_attribute, SEXP registry){
   Attribute* att = make_s_attribute(corpus, s_attribute, registry);
   return cl_struc_values(att);
 }
+
+
+Attribute* make_a_attribute(SEXP corpus, SEXP a_attribute, SEXP registry){
+  
+  char* reg_dir = strdup(Rcpp::as<std::string>(registry).c_str());
+  char* a_attr = strdup(Rcpp::as<std::string>(a_attribute).c_str());
+  char* corpus_pointer  = strdup(Rcpp::as<std::string>(corpus).c_str());
+  
+  Corpus *corpus_obj = cl_new_corpus(reg_dir, corpus_pointer);
+  Attribute* att = cl_new_attribute(corpus_obj, a_attr, ATT_ALIGN);
+  
+  return att;
+}
+
+
+// [[Rcpp::export(name=".cl_cpos2alg")]]
+Rcpp::IntegerMatrix _cl_cpos2alg(SEXP corpus, SEXP a_attribute, Rcpp::IntegerVector cpos, SEXP registry){
+  Attribute* att = make_a_attribute(corpus, a_attribute, registry);
+  if (att == NULL) Rcpp::stop("alignment attribute is not available");
+
+  int i;
+  int len = cpos.length();
+  Rcpp::IntegerMatrix result(len, 5);
+  if (len == 0) return( result );
+
+  /* one pass for all positions - fast if cpos are sorted */
+  std::vector<int> alg(len), s1(len), s2(len), t1(len), t2(len);
+  cl_cpos2alg_list(att, cpos.begin(), len, alg.data());
+  cl_alg2cpos_list(att, alg.data(), len, s1.data(), s2.data(), t1.data(), t2.data());
+
+  for (i = 0; i < len; i++){
+    if (alg[i] < 0){
+      result(i,0) = result(i,1) = result(i,2) = result(i,3) = result(i,4) = NA_INTEGER;
+    } else {
+      result(i,0) = alg[i];
+      result(i,1) = s1[i];
+      result(i,2) = s2[i];
+      result(i,3) = t1[i];
+      result(i,4) = t2[i];
+    }
+  }
+  return( result );
+}
+
+
+// [[Rcpp::export(name=".cl_alg2cpos")]]
+Rcpp::IntegerMatrix _cl_alg2cpos(SEXP corpus, SEXP a_attribute, Rcpp::IntegerVector alg, SEXP registry){
+  Attribute* att = make_a_attribute(corpus, a_attribute, registry);
+  if (att == NULL) Rcpp::stop("alignment attribute is not available");
+
+  int i;
+  int len = alg.length();
+  Rcpp::IntegerMatrix result(len, 4);
+  if (len == 0) return( result );
+
+  std::vector<int> s1(len), s2(len), t1(len), t2(len);
+  cl_alg2cpos_list(att, alg.begin(), len, s1.data(), s2.data(), t1.data(), t2.data());
+
+  for (i = 0; i < len; i++){
+    if (s1[i] < 0){
+      result(i,0) = result(i,1) = result(i,2) = result(i,3) = NA_INTEGER;
+    } else {
+      result(i,0) = s1[i];
+      result(i,1) = s2[i];
+      result(i,2) = t1[i];
+      result(i,3) = t2[i];
+    }
+  }
+  return( result );
+}
+
+
+Attribute* make_d_attribute(SEXP corpus, SEXP d_attribute, SEXP registry){
+  
+  char* reg_dir = strdup(Rcpp::as<std::string>(registry).c_str());
+  char* d_attr = strdup(Rcpp::as<std::string>(d_attribute).c_str());
+  char* corpus_pointer  = strdup(Rcpp::as<std::string>(corpus).c_str());
+  
+  Corpus *corpus_obj = cl_new_corpus(reg_dir, corpus_pointer);
+  Attribute* att = cl_new_attribute(corpus_obj, d_attr, ATT_DYN);
+  
+  return att;
+}
+
+
+/* R functions registered as implementations of dynamic attributes (protected from gc) */
+static std::map<Attribute*, SEXP> dynamic_functions;
+
+/* ClDynamicFunction calling an R function: one vector for each argument, one result for each call */
+static int r_dynamic_function(DynCallResult *dcr, DynCallResult *args, int nr_args, int n_calls, void *data){
+  static Rcpp::Function do_call("do.call");
+  int i, j;
+
+  try {
+    Rcpp::List rargs(nr_args);
+    for (j = 0; j < nr_args; j++){
+      int type = args[j].type;
+      for (i = 0; i < n_calls; i++) if (args[i * nr_args + j].type != type) return 0;
+      if (type == ATTAT_INT || type == ATTAT_POS){
+        Rcpp::IntegerVector v(n_calls);
+        for (i = 0; i < n_calls; i++) v[i] = args[i * nr_args + j].value.intres;
+        rargs[j] = v;
+      } else if (type == ATTAT_FLOAT){
+        Rcpp::NumericVector v(n_calls);
+        for (i = 0; i < n_calls; i++) v[i] = args[i * nr_args + j].value.floatres;
+        rargs[j] = v;
+      } else if (type == ATTAT_STRING){
+        Rcpp::CharacterVector v(n_calls);
+        for (i = 0; i < n_calls; i++) v[i] = args[i * nr_args + j].value.charres;
+        rargs[j] = v;
+      } else {
+        return 0;
+      }
+    }
+
+    SEXP res = do_call((SEXP)data, rargs);
+    if (Rf_length(res) != n_calls) return 0;
+
+    switch (dcr[0].type){
+    case ATTAT_INT:
+    case ATTAT_POS:
+      {
+        Rcpp::IntegerVector v = Rcpp::as<Rcpp::IntegerVector>(res);
+        for (i = 0; i < n_calls; i++){
+          if (v[i] == NA_INTEGER) dcr[i].type = ATTAT_NONE; else dcr[i].value.intres = v[i];
+        }
+      }
+      break;
+    case ATTAT_FLOAT:
+      {
+        Rcpp::NumericVector v = Rcpp::as<Rcpp::NumericVector>(res);
+        for (i = 0; i < n_calls; i++){
+          if (Rcpp::NumericVector::is_na(v[i])) dcr[i].type = ATTAT_NONE; else dcr[i].value.floatres = v[i];
+        }
+      }
+      break;
+    case ATTAT_STRING:
+      {
+        Rcpp::CharacterVector v = Rcpp::as<Rcpp::CharacterVector>(res);
+        for (i = 0; i < n_calls; i++){
+          if (STRING_ELT(v, i) == NA_STRING){
+            dcr[i].type = ATTAT_NONE;
+          } else {
+            strncpy(dcr[i].dynamic_string_buffer, CHAR(STRING_ELT(v, i)), CL_DYN_STRING_SIZE - 1);
+            dcr[i].dynamic_string_buffer[CL_DYN_STRING_SIZE - 1] = '\0';
+            dcr[i].value.charres = dcr[i].dynamic_string_buffer;
+          }
+        }
+      }
+      break;
+    default:
+      return 0;
+    }
+  } catch (...) {
+    /* errors must not propagate into the C code of CQP */
+    return 0;
+  }
+  return 1;
+}
+
+
+// [[Rcpp::export(name=".cl_dynamic_register")]]
+int _cl_dynamic_register(SEXP corpus, SEXP d_attribute, SEXP f, SEXP registry){
+  Attribute* att = make_d_attribute(corpus, d_attribute, registry);
+  if (att == NULL) Rcpp::stop("dynamic attribute is not available");
+
+  std::map<Attribute*, SEXP>::iterator it = dynamic_functions.find(att);
+  if (it != dynamic_functions.end()){
+    R_ReleaseObject(it->second);
+    dynamic_functions.erase(it);
+  }
+
+  if (Rf_isNull(f)){
+    cl_dynamic_register(att, NULL, NULL);
+  } else {
+    R_PreserveObject(f);
+    dynamic_functions[att] = f;
+    cl_dynamic_register(att, r_dynamic_function, (void *)f);
+  }
+  return 1;
+}
+
+
+// [[Rcpp::export(name=".cl_dynamic_call")]]
+SEXP _cl_dynamic_call(SEXP corpus, SEXP d_attribute, Rcpp::List args, SEXP registry){
+  Attribute* att = make_d_attribute(corpus, d_attribute, registry);
+  if (att == NULL) Rcpp::stop("dynamic attribute is not available");
+
+  int nr_args = args.length();
+  if (nr_args == 0) Rcpp::stop("no arguments for dynamic attribute");
+
+  int i, j, k;
+  int n = Rf_length(args[0]);
+  std::vector<int> types(nr_args);
+  Rcpp::List rargs(nr_args);
+  DynArg *arg = att->dyn.arglist;
+  for (j = 0; j < nr_args; j++){
+    if (Rf_length(args[j]) != n) Rcpp::stop("arguments for dynamic attribute need to have the same length");
+    if (arg != NULL && arg->type != ATTAT_VAR){
+      types[j] = arg->type == ATTAT_POS ? ATTAT_INT : arg->type;
+      arg = arg->next;
+    } else {
+      types[j] = Rf_isString(args[j]) ? ATTAT_STRING : (Rf_isReal(args[j]) ? ATTAT_FLOAT : ATTAT_INT);
+    }
+    if (types[j] == ATTAT_INT) rargs[j] = Rcpp::as<Rcpp::IntegerVector>(args[j]);
+    else if (types[j] == ATTAT_FLOAT) rargs[j] = Rcpp::as<Rcpp::NumericVector>(args[j]);
+    else if (types[j] == ATTAT_STRING) rargs[j] = Rcpp::as<Rcpp::CharacterVector>(args[j]);
+    else Rcpp::stop("unsupported argument type of dynamic attribute");
+  }
+
+  int res_type = att->dyn.res_type;
+  Rcpp::IntegerVector int_result(res_type == ATTAT_INT || res_type == ATTAT_POS ? n : 0);
+  Rcpp::NumericVector float_result(res_type == ATTAT_FLOAT ? n : 0);
+  Rcpp::CharacterVector str_result(res_type == ATTAT_STRING ? n : 0);
+
+  /* calls are passed to cl_dynamic_call_list() in chunks, to limit memory use;
+     calls with missing arguments are skipped and yield NA */
+  const int chunk_size = 1024;
+  std::vector<DynCallResult> dcr(chunk_size);
+  std::vector<DynCallResult> dargs((size_t)chunk_size * nr_args);
+  std::vector<int> idx(chunk_size);
+
+  i = 0;
+  while (i < n){
+    int start = i;
+    int n_calls = 0;
+    for (; i < n && n_calls < chunk_size; i++){
+      bool na = false;
+      for (j = 0; j < nr_args; j++){
+        DynCallResult *a = &dargs[(size_t)n_calls * nr_args + j];
+        a->type = types[j];
+        if (types[j] == ATTAT_INT){
+          a->value.intres = INTEGER(rargs[j])[i];
+          if (a->value.intres == NA_INTEGER) na = true;
+        } else if (types[j] == ATTAT_FLOAT){
+          a->value.floatres = REAL(rargs[j])[i];
+          if (ISNA(a->value.floatres)) na = true;
+        } else {
+          SEXP el = STRING_ELT(rargs[j], i);
+          if (el == NA_STRING) na = true; else a->value.charres = (char *)CHAR(el);
+        }
+      }
+      if (!na) idx[n_calls++] = i;
+    }
+
+    if (n_calls > 0 && cl_dynamic_call_list(att, dcr.data(), dargs.data(), nr_args, n_calls) < 0)
+      Rcpp::stop("arguments do not match the declaration of the dynamic attribute");
+
+    /* results default to NA, i.e. for skipped calls */
+    for (k = start; k < i; k++){
+      if (res_type == ATTAT_STRING) str_result[k] = NA_STRING;
+      else if (res_type == ATTAT_FLOAT) float_result[k] = NA_REAL;
+      else int_result[k] = NA_INTEGER;
+    }
+    for (k = 0; k < n_calls; k++){
+      if (dcr[k].type == ATTAT_NONE) continue;
+      if (res_type == ATTAT_STRING){
+        str_result[idx[k]] = dcr[k].value.charres;
+        /* strings read from popen() are allocated by cl_dynamic_call() */
+        if (dcr[k].value.charres != dcr[k].dynamic_string_buffer) cl_free(dcr[k].value.charres);
+      }
+      else if (res_type == ATTAT_FLOAT) float_result[idx[k]] = dcr[k].value.floatres;
+      else int_result[idx[k]] = dcr[k].value.intres;
+    }
+  }
+
+  if (res_type == ATTAT_STRING) return str_result;
+  if (res_type == ATTAT_FLOAT) return float_result;
+  return int_result;
+}
+
+
+// [[Rcpp::export(name=".cl_set_optimize")]]
+int _cl_set_optimize(int state){
+  cl_set_optimize(state);
+  return cl_get_optimize();
+}
+
+
+// [[Rcpp::export(name=".cl_get_optimize")]]
+int _cl_get_optimize(){
+  return cl_get_optimize();
+}
+
+
+// [[Rcpp::export(name=".cl_regopt_count")]]
+Rcpp::IntegerVector _cl_regopt_count(bool reset){
+  Rcpp::IntegerVector result = Rcpp::IntegerVector::create(
+    Rcpp::Named("tested") = cl_regopt_count_trials(),
+    Rcpp::Named("avoided") = cl_regopt_count_get()
+  );
+  if (reset) cl_regopt_count_reset();
+  return( result );
+}
+
+
+// [[Rcpp::export(name=".cl_set_threads")]]
+int _cl_set_threads(int n){
+  cl_set_threads(n);
+  return cl_get_threads();
+}
+
+
+// [[Rcpp::export(name=".cl_get_threads")]]
+int _cl_get_threads(){
+  return cl_get_threads();
+}
+
+
+// [[Rcpp::export(name=".cl_set_registry_cache")]]
+int _cl_set_registry_cache(SEXP file){
+  if (Rf_isNull(file)) return cl_set_registry_cache(NULL);
+  std::string filename = Rcpp::as<std::string>(file);
+  return cl_set_registry_cache((char*)filename.c_str());
+}
+
+
+// [[Rcpp::export(name=".cl_get_registry_cache")]]
+Rcpp::StringVector _cl_get_registry_cache(){
+  Rcpp::StringVector result(1);
+  char *filename = cl_get_registry_cache();
+  if (filename == NULL){
+    result(0) = NA_STRING;
+  } else {
+    result(0) = filename;
+  }
+  return( result );
+}
+
+
+// [[Rcpp::export(name=".cl_registry_prefetch")]]
+int _cl_registry_prefetch(SEXP registry){
+  std::string registry_dir = Rcpp::as<std::string>(registry);
+  return cl_registry_prefetch((char*)registry_dir.c_str());
+}
+
+
+// [[Rcpp::export(name=".cl_registry_cache_write")]]
+int _cl_registry_cache_write(){
+  return cl_registry_cache_write();
+}
+
+
+// [[Rcpp::export(name=".cl_registry_timings")]]
+Rcpp::DataFrame _cl_registry_timings(bool reset){
+  int n = cl_registry_log_size();
+  int source;
+  double seconds;
+  char *registry_dir;
+  char *registry_name;
+
+  Rcpp::StringVector corpus(n);
+  Rcpp::StringVector registry(n);
+  Rcpp::StringVector src(n);
+  Rcpp::NumericVector secs(n);
+
+  for (int i = 0; i < n; i++){
+    cl_registry_log_entry(i, &registry_dir, &registry_name, &source, &seconds);
+    corpus(i) = registry_name;
+    registry(i) = registry_dir;
+    src(i) = (source == 1) ? "cache" : ((source == 0) ? "parsed" : "failed");
+    secs(i) = seconds;
+  }
+  if (reset) cl_registry_log_reset();
+
+  return Rcpp::DataFrame::create(
+    Rcpp::Named("corpus") = corpus,
+    Rcpp::Named("registry") = registry,
+    Rcpp::Named("source") = src,
+    Rcpp::Named("seconds") = secs,
+    Rcpp::Named("stringsAsFactors") = false
+  );
+}
   
 
 // [[Rcpp::export(name=".corpus_data_dir")]]
@@ -5,6 +5,7 @@ extern "C" {
   #include <stdlib.h>
   #include <unistd.h>
   #include <string.h>
+  #include <limits.h>
   #include "cl.h"
   #include "cqp.h"
   
@@ -16,15 +17,28 @@ extern "C" {
   #include "server.h"
   
   #include "cwb/cqp/corpmanag.h"
+  #include "cwb/cqp/querycache.h"
+  #include "cwb/cqp/concordance.h"
+  #include "cwb/cqp/output.h"
+  #include "cwb/cqp/batch.h"
   
   #include "_globalvars.h"
   #include "_eval.h"
 
+  /* prepared queries (see cwb/cqp/prepared.h, which cannot be included next to _eval.h) */
+  typedef struct _PreparedQuery PreparedQuery;
+  PreparedQuery *prepare_query(CorpusList *cl, char *query);
+  CorpusList *execute_prepared_query(PreparedQuery *pq, CorpusList *cl, char **args, int n_args, char *subcorpus);
+  void free_prepared_query(PreparedQuery **pq);
+
   /* includes for utils */
   #include <attributes.h>
 }
 
 #include <Rcpp.h>
+#include <map>
+#include <string>
+#include <vector>
 /* do not use namespace - would create conflict with Range type */
 /* using namespace Rcpp; */
 
@@ -122,7 +136,8 @@ SEXP cqp_query(SEXP corpus, SEXP subcorpus, SEXP query){
   char * child = (char*)CHAR(STRING_ELT(subcorpus,0));
   char * q = (char*)CHAR(STRING_ELT(query,0));
   char * cqp_query;
-  CorpusList *cl;
+  char * key;
+  CorpusList *cl, *childcl;
   SEXP result;
   
   /* is this necessary */
@@ -146,12 +161,19 @@ SEXP cqp_query(SEXP corpus, SEXP subcorpus, SEXP query){
     Rprintf("checking subcorpus name failed \n");
   }
   
+  /* identical queries are answered from the query cache (if enabled) */
+  key = query_cache_key(cl, q);
+  childcl = query_cache_lookup(cl, key, child);
+  if (childcl != NULL){
+    cl_free(key);
+    return R_MakeExternalPtr(childcl, R_NilValue, R_NilValue);
+  }
+  
   if (!cqp_parse_string(cqp_query)){
     Rprintf("ERROR: Cannot parse the CQP query.\n");
     result = R_NilValue;
   } else {
     char *			full_child;
-    CorpusList *	childcl;
     
     if (strlen(c) > 0){
       full_child = combine_subcorpus_spec(c, child);
@@ -164,9 +186,11 @@ SEXP cqp_query(SEXP corpus, SEXP subcorpus, SEXP query){
       Rprintf("subcorpus not found\n");
       result = R_NilValue;
     } else {
+      query_cache_store(key, childcl);
       result = R_MakeExternalPtr(childcl, R_NilValue, R_NilValue);
     }
   }
+  cl_free(key);
 
   return result;
 }
@@ -392,3 +416,636 @@ SEXP region_matrix_to_subcorpus(Rcpp::IntegerMatrix region_matrix, SEXP corpus,
   sc = R_MakeExternalPtr(cl, R_NilValue, R_NilValue);
   return(sc);
 }
+
+
+/* Cursors evaluate a query incrementally: matches are computed for one chunk
+ * of start positions at a time and buffered until they are fetched. Matches
+ * that may still be removed by the matching strategy (longest, shortest, standard)
+ * are kept in a pending subcorpus until the next chunk has been evaluated. */
+
+#define CURSOR_CHUNK "RcppCWBChunk"
+#define CURSOR_PENDING "RcppCWBCursor"
+
+static int cqp_cursor_count = 0;
+
+typedef struct _CqpCursor {
+  char *corpus;       /* query corpus (system corpus or subcorpus) */
+  char *result;       /* name of the temporary subcorpus with the matches of a chunk */
+  char *pending;      /* name of the temporary subcorpus with pending matches */
+  char *query;        /* CQP query assigned to the temporary subcorpus */
+  int first_cpos;     /* first possible start position */
+  int last_cpos;      /* last possible start position */
+  int next_cpos;      /* first start position of the next chunk */
+  int chunk;          /* number of start positions in the next chunk */
+  int n_found;        /* number of final matches found so far */
+  int n_buffered;     /* number of final matches not fetched yet */
+  int n_alloc;
+  int *buffer;        /* start, end, target and keyword of buffered matches */
+} CqpCursor;
+
+static void cqp_cursor_free(CqpCursor *cur){
+  CorpusList *pending;
+
+  if (cur == NULL) return;
+  pending = cqi_find_corpus(cur->pending);
+  if (pending != NULL) dropcorpus(pending, NULL);
+  cl_free(cur->corpus);
+  cl_free(cur->result);
+  cl_free(cur->pending);
+  cl_free(cur->query);
+  cl_free(cur->buffer);
+  cl_free(cur);
+}
+
+static void cqp_cursor_finalize(SEXP ptr){
+  cqp_cursor_free((CqpCursor*)R_ExternalPtrAddr(ptr));
+  R_ClearExternalPtr(ptr);
+}
+
+/* evaluate query for next chunk of start positions and append final matches to buffer */
+static void cqp_cursor_next_chunk(CqpCursor *cur){
+  CorpusList *cl, *childcl, *pending;
+  int i, ok, n_final, chunk_end;
+
+  cl = cqi_find_corpus(cur->corpus);
+  if (cl == NULL) Rcpp::stop("corpus not found");
+  set_current_corpus(cl, 0);
+  cqi_activate_corpus(cur->corpus);
+
+  query_start_min = cur->next_cpos;
+  query_start_max = (cur->last_cpos - cur->next_cpos < cur->chunk) ? cur->last_cpos : cur->next_cpos + cur->chunk - 1;
+  query_start_strategy = traditional;
+  chunk_end = query_start_max;
+  ok = cqp_parse_string(cur->query);
+  query_start_min = 0;
+  query_start_max = -1;
+  if (!ok) Rcpp::stop("cannot evaluate the CQP query");
+
+  childcl = cqi_find_corpus(cur->result);
+  if (childcl == NULL) Rcpp::stop("cannot evaluate the CQP query (subcorpus not found)");
+  /* the chunk is only done once its matches have been found */
+  cur->next_cpos = chunk_end + 1;
+
+  pending = cqi_find_corpus(cur->pending);
+  if (pending == NULL){
+    pending = duplicate_corpus(childcl, strchr(cur->pending, ':') + 1, True);
+    n_final = merge_query_chunk(pending, NULL, (cur->next_cpos > cur->last_cpos) ? -1 : cur->next_cpos);
+  } else {
+    n_final = merge_query_chunk(pending, childcl, (cur->next_cpos > cur->last_cpos) ? -1 : cur->next_cpos);
+  }
+  dropcorpus(childcl, NULL);
+
+  if (cur->n_buffered + n_final > cur->n_alloc){
+    cur->n_alloc = cur->n_buffered + n_final;
+    cur->buffer = (int *) cl_realloc(cur->buffer, sizeof(int) * 4 * cur->n_alloc);
+  }
+  for (i = 0; i < n_final; i++){
+    int *row = cur->buffer + 4 * (cur->n_buffered + i);
+    row[0] = pending->range[i].start;
+    row[1] = pending->range[i].end;
+    row[2] = pending->targets ? pending->targets[i] : -1;
+    row[3] = pending->keywords ? pending->keywords[i] : -1;
+  }
+  cur->n_buffered += n_final;
+  cur->n_found += n_final;
+
+  /* remove final matches from pending subcorpus */
+  pending->size -= n_final;
+  if (n_final > 0 && pending->size > 0){
+    memmove(pending->range, pending->range + n_final, sizeof(Range) * pending->size);
+    if (pending->targets) memmove(pending->targets, pending->targets + n_final, sizeof(int) * pending->size);
+    if (pending->keywords) memmove(pending->keywords, pending->keywords + n_final, sizeof(int) * pending->size);
+  }
+}
+
+
+// [[Rcpp::export(name=".cqp_cursor_open")]]
+SEXP cqp_cursor_open(SEXP corpus, SEXP query, int chunk){
+
+  char * mother = (char*)CHAR(STRING_ELT(corpus,0));
+  char * q = (char*)CHAR(STRING_ELT(query,0));
+  char *c, *sc, *sc_pending;
+  CorpusList *cl;
+  CqpCursor *cur;
+  SEXP result;
+  int len;
+
+  cl = cqi_find_corpus(mother);
+  if (cl == NULL || !split_subcorpus_spec(mother, &c, &sc)){
+    Rprintf("corpus not found\n");
+    return R_NilValue;
+  }
+
+  cur = (CqpCursor *) cl_calloc(1, sizeof(CqpCursor));
+  cur->corpus = cl_strdup(mother);
+  cur->result = combine_subcorpus_spec(c, (char *)CURSOR_CHUNK);
+  len = strlen(CURSOR_PENDING) + 12;
+  sc_pending = (char *) cl_malloc(len);
+  snprintf(sc_pending, len, "%s%d", CURSOR_PENDING, ++cqp_cursor_count);
+  cur->pending = combine_subcorpus_spec(c, sc_pending);
+  cl_free(sc_pending);
+  len = strlen(CURSOR_CHUNK) + strlen(q) + 10;
+  cur->query = (char *) cl_malloc(len);
+  snprintf(cur->query, len, "%s = %s", CURSOR_CHUNK, q);
+  cl_free(c);
+  cl_free(sc);
+
+  if (cl->size > 0 && cl->range != NULL){
+    cur->first_cpos = cl->range[0].start;
+    cur->last_cpos = cl->range[cl->size - 1].end;
+  } else {
+    cur->first_cpos = 0;
+    cur->last_cpos = -1;
+  }
+  cur->next_cpos = cur->first_cpos;
+  cur->chunk = (chunk > 0) ? chunk : 1;
+
+  result = PROTECT(R_MakeExternalPtr(cur, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(result, cqp_cursor_finalize, TRUE);
+  UNPROTECT(1);
+  return result;
+}
+
+
+// [[Rcpp::export(name=".cqp_cursor_fetch")]]
+Rcpp::IntegerMatrix cqp_cursor_fetch(SEXP cursor, int n){
+
+  CqpCursor *cur = (CqpCursor*)R_ExternalPtrAddr(cursor);
+  int i, j, nrows;
+
+  if (cur == NULL){
+    Rcpp::stop("cursor has been closed");
+  }
+
+  /* the chunk size doubles while matches are missing, so that rare matches are found in few steps */
+  while (cur->n_buffered < n && cur->next_cpos <= cur->last_cpos){
+    cqp_cursor_next_chunk(cur);
+    if (cur->n_buffered < n && cur->chunk <= INT_MAX / 2) cur->chunk *= 2;
+  }
+
+  nrows = (cur->n_buffered < n) ? cur->n_buffered : n;
+  Rcpp::IntegerMatrix result(nrows, 4);
+  for (i = 0; i < nrows; i++){
+    for (j = 0; j < 4; j++) result(i,j) = cur->buffer[4 * i + j];
+  }
+  Rcpp::colnames(result) = Rcpp::CharacterVector::create("match", "matchend", "target", "keyword");
+
+  cur->n_buffered -= nrows;
+  if (cur->n_buffered > 0){
+    memmove(cur->buffer, cur->buffer + 4 * nrows, sizeof(int) * 4 * cur->n_buffered);
+  }
+
+  return result;
+}
+
+
+// [[Rcpp::export(name=".cqp_cursor_status")]]
+Rcpp::NumericVector cqp_cursor_status(SEXP cursor){
+
+  CqpCursor *cur = (CqpCursor*)R_ExternalPtrAddr(cursor);
+  double evaluated, total;
+
+  if (cur == NULL){
+    Rcpp::stop("cursor has been closed");
+  }
+
+  evaluated = (double)cur->next_cpos - cur->first_cpos;
+  total = (double)cur->last_cpos - cur->first_cpos + 1;
+
+  Rcpp::NumericVector result = Rcpp::NumericVector::create(
+    Rcpp::Named("found") = cur->n_found,
+    Rcpp::Named("buffered") = cur->n_buffered,
+    Rcpp::Named("evaluated") = (total > 0) ? evaluated / total : 1.0,
+    Rcpp::Named("estimate") = (cur->next_cpos > cur->last_cpos) ? cur->n_found : (evaluated > 0) ? cur->n_found * total / evaluated : NA_REAL
+  );
+  return result;
+}
+
+
+// [[Rcpp::export(name=".cqp_cursor_close")]]
+SEXP cqp_cursor_close(SEXP cursor){
+  cqp_cursor_finalize(cursor);
+  return R_NilValue;
+}
+
+
+// [[Rcpp::export(name=".cqp_query_cache_set")]]
+int cqp_query_cache_set(int memory, SEXP dir){
+  QueryCacheMemory = (memory > 0) ? memory : 0;
+  cl_free(QueryCacheDir);
+  if (!Rf_isNull(dir)){
+    QueryCacheDir = cl_strdup((char*)CHAR(STRING_ELT(dir,0)));
+  }
+  query_cache_trim();
+  return QueryCacheMemory;
+}
+
+
+// [[Rcpp::export(name=".cqp_query_cache_stats")]]
+Rcpp::NumericVector cqp_query_cache_stats(){
+  Rcpp::NumericVector result = Rcpp::NumericVector::create(
+    Rcpp::Named("lookups") = query_cache_stats.lookups,
+    Rcpp::Named("hits") = query_cache_stats.hits,
+    Rcpp::Named("disk_hits") = query_cache_stats.disk_hits,
+    Rcpp::Named("misses") = query_cache_stats.lookups - query_cache_stats.hits - query_cache_stats.disk_hits,
+    Rcpp::Named("stores") = query_cache_stats.stores,
+    Rcpp::Named("evictions") = query_cache_stats.evictions,
+    Rcpp::Named("entries") = query_cache_stats.entries,
+    Rcpp::Named("bytes") = (double)query_cache_stats.bytes
+  );
+  return result;
+}
+
+
+// [[Rcpp::export(name=".cqp_query_cache_clear")]]
+SEXP cqp_query_cache_clear(){
+  query_cache_clear();
+  return R_NilValue;
+}
+
+
+/* Prepared queries are compiled once and run for different arguments of their
+ * parameters ?1, ?2, ... (see cwb/cqp/prepared.c). */
+
+static void cqp_prepared_finalize(SEXP ptr){
+  PreparedQuery *pq = (PreparedQuery*)R_ExternalPtrAddr(ptr);
+  free_prepared_query(&pq);
+  R_ClearExternalPtr(ptr);
+}
+
+
+// [[Rcpp::export(name=".cqp_prepare")]]
+SEXP cqp_prepare(SEXP corpus, SEXP query){
+
+  char * mother = (char*)CHAR(STRING_ELT(corpus,0));
+  char * q = (char*)CHAR(STRING_ELT(query,0));
+  CorpusList *cl;
+  PreparedQuery *pq;
+  SEXP result;
+
+  cl = cqi_find_corpus(mother);
+  if (cl == NULL){
+    Rprintf("corpus not found\n");
+    return R_NilValue;
+  }
+  cqi_activate_corpus(mother);
+
+  pq = prepare_query(cl, q);
+  if (pq == NULL){
+    Rprintf("ERROR: Cannot prepare the CQP query.\n");
+    return R_NilValue;
+  }
+
+  result = PROTECT(R_MakeExternalPtr(pq, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(result, cqp_prepared_finalize, TRUE);
+  UNPROTECT(1);
+  return result;
+}
+
+
+// [[Rcpp::export(name=".cqp_execute")]]
+SEXP cqp_execute(SEXP prepared, SEXP corpus, SEXP subcorpus, SEXP args){
+
+  PreparedQuery *pq = (PreparedQuery*)R_ExternalPtrAddr(prepared);
+  char * mother = (char*)CHAR(STRING_ELT(corpus,0));
+  char * child = (char*)CHAR(STRING_ELT(subcorpus,0));
+  char **argv;
+  int i, n_args = Rf_length(args);
+  CorpusList *cl, *childcl;
+
+  if (pq == NULL){
+    Rcpp::stop("prepared query has been freed");
+  }
+
+  cl = cqi_find_corpus(mother);
+  if (cl == NULL){
+    Rprintf("corpus not found\n");
+    return R_NilValue;
+  }
+  cqi_activate_corpus(mother);
+  if (!check_subcorpus_name(child)){
+    Rprintf("checking subcorpus name failed \n");
+  }
+
+  argv = (char **) cl_malloc(sizeof(char *) * (n_args + 1));
+  for (i = 0; i < n_args; i++) argv[i] = (char*)CHAR(STRING_ELT(args,i));
+  childcl = execute_prepared_query(pq, cl, argv, n_args, child);
+  cl_free(argv);
+
+  if (childcl == NULL){
+    Rprintf("ERROR: Cannot execute the prepared query.\n");
+    return R_NilValue;
+  }
+  return R_MakeExternalPtr(childcl, R_NilValue, R_NilValue);
+}
+
+
+// [[Rcpp::export(name=".cqp_query_batch")]]
+Rcpp::IntegerMatrix cqp_query_batch(SEXP corpus, SEXP queries, SEXP subcorpora, SEXP s_attribute){
+
+  char * mother = (char*)CHAR(STRING_ELT(corpus,0));
+  char **q, **sub = NULL;
+  int i, n_queries = Rf_length(queries), n_columns;
+  int *counts;
+  CorpusList *cl;
+  Attribute *regions = NULL;
+
+  cl = cqi_find_corpus(mother);
+  if (cl == NULL) Rcpp::stop("corpus not found");
+  cqi_activate_corpus(mother);
+  if (!Rf_isNull(s_attribute)){
+    regions = cl_new_attribute(cl->corpus, (char*)CHAR(STRING_ELT(s_attribute,0)), ATT_STRUC);
+    if (regions == NULL) Rcpp::stop("s-attribute not found");
+  }
+
+  q = (char **) cl_malloc(sizeof(char *) * (n_queries + 1));
+  for (i = 0; i < n_queries; i++) q[i] = (char*)CHAR(STRING_ELT(queries,i));
+  if (!Rf_isNull(subcorpora)){
+    sub = (char **) cl_malloc(sizeof(char *) * (n_queries + 1));
+    for (i = 0; i < n_queries; i++){
+      sub[i] = (char*)CHAR(STRING_ELT(subcorpora,i));
+      if (!check_subcorpus_name(sub[i])){
+        cl_free(q);
+        cl_free(sub);
+        Rcpp::stop("invalid subcorpus name");
+      }
+    }
+  }
+
+  counts = query_batch(cl, q, n_queries, sub, regions, &n_columns);
+  cl_free(q);
+  cl_free(sub);
+  if (counts == NULL) Rcpp::stop("cannot evaluate query batch");
+
+  /* counts are stored column by column, as in R; failed queries are NA */
+  Rcpp::IntegerMatrix result(n_queries, n_columns);
+  for (i = 0; i < n_queries * n_columns; i++){
+    result[i] = (counts[i] < 0) ? NA_INTEGER : counts[i];
+  }
+  cl_free(counts);
+  return result;
+}
+
+
+#define SAMPLE_RESULT "RcppCWBSample"
+
+/* evaluate query for a random sample of start positions (see query_sample_size in eval.c) */
+static CorpusList *cqp_query_sampled(char *mother, char *child, char *q, int size, int matches){
+  char *c, *sc, *full_child, *cqp_query;
+  CorpusList *cl, *childcl = NULL;
+  int len, ok;
+
+  cl = cqi_find_corpus(mother);
+  if (cl == NULL || !split_subcorpus_spec(mother, &c, &sc)){
+    Rprintf("corpus not found\n");
+    return NULL;
+  }
+  set_current_corpus(cl, 0);
+  cqi_activate_corpus(mother);
+
+  len = strlen(child) + strlen(q) + 10;
+  cqp_query = (char *) cl_malloc(len);
+  snprintf(cqp_query, len, "%s = %s", child, q);
+
+  /* draw the seed from R's random number generator, so that samples are reproducible with set.seed() */
+  cl_set_seed((unsigned int)(R::unif_rand() * UINT_MAX));
+  query_sample_size = size;
+  query_sample_matches = matches;
+  query_sample_candidates = -1;
+  query_sample_evaluated = 0;
+  ok = cqp_parse_string(cqp_query);
+  query_sample_size = 0;
+  query_sample_matches = 0;
+  cl_free(cqp_query);
+
+  if (!ok){
+    Rprintf("ERROR: Cannot parse the CQP query.\n");
+  } else {
+    full_child = combine_subcorpus_spec((strlen(c) > 0) ? c : mother, child);
+    childcl = cqi_find_corpus(full_child);
+    if (childcl == NULL) Rprintf("subcorpus not found\n");
+    cl_free(full_child);
+  }
+  cl_free(c);
+  cl_free(sc);
+  return childcl;
+}
+
+
+// [[Rcpp::export(name=".cqp_query_sample")]]
+SEXP cqp_query_sample(SEXP corpus, SEXP subcorpus, SEXP query, int size){
+
+  char * mother = (char*)CHAR(STRING_ELT(corpus,0));
+  char * child = (char*)CHAR(STRING_ELT(subcorpus,0));
+  char * q = (char*)CHAR(STRING_ELT(query,0));
+  char * cqp_reduce;
+  CorpusList *childcl;
+  int len;
+
+  if (!check_subcorpus_name(child)){
+    Rprintf("checking subcorpus name failed \n");
+  }
+
+  childcl = cqp_query_sampled(mother, child, q, size, 1);
+  if (childcl == NULL) return R_NilValue;
+
+  /* more matches than requested may have been found (and queries that cannot be sampled are evaluated completely) */
+  if (childcl->size > size){
+    len = strlen(child) + 30;
+    cqp_reduce = (char *) cl_malloc(len);
+    snprintf(cqp_reduce, len, "reduce %s to %d;", child, size);
+    cqp_parse_string(cqp_reduce);
+    cl_free(cqp_reduce);
+  }
+  return R_MakeExternalPtr(childcl, R_NilValue, R_NilValue);
+}
+
+
+// [[Rcpp::export(name=".cqp_count_sample")]]
+Rcpp::NumericVector cqp_count_sample(SEXP corpus, SEXP query, int size){
+
+  char * mother = (char*)CHAR(STRING_ELT(corpus,0));
+  char * q = (char*)CHAR(STRING_ELT(query,0));
+  CorpusList *childcl;
+  double candidates, evaluated, matches;
+  int biased;
+
+  childcl = cqp_query_sampled(mother, (char *)SAMPLE_RESULT, q, size, 0);
+  if (childcl == NULL) Rcpp::stop("cannot evaluate query");
+
+  matches = childcl->size;
+  if (query_sample_candidates < 0){
+    /* the query was evaluated completely */
+    candidates = evaluated = matches;
+    biased = 0;
+  } else {
+    candidates = query_sample_candidates;
+    evaluated = query_sample_evaluated;
+    biased = query_sample_biased;
+  }
+  dropcorpus(childcl, NULL);
+
+  Rcpp::NumericVector result = Rcpp::NumericVector::create(
+    Rcpp::Named("candidates") = candidates,
+    Rcpp::Named("evaluated") = evaluated,
+    Rcpp::Named("matches") = matches,
+    Rcpp::Named("biased") = biased
+  );
+  return result;
+}
+
+
+// [[Rcpp::export(name=".cqp_kwic")]]
+Rcpp::List cqp_kwic(SEXP scorpus, Rcpp::StringVector p_attribute, SEXP boundary, int left, int right, SEXP sep){
+
+  char * subcorpus = (char*)CHAR(STRING_ELT(scorpus,0));
+  CorpusList * cl;
+  Attribute ** atts;
+  Attribute * s_att = NULL;
+  KwicBatch batch;
+  int i, n_atts = p_attribute.length();
+  size_t * off;
+
+  cl = cqi_find_corpus(subcorpus);
+  if (cl == NULL) Rcpp::stop("subcorpus not found");
+  if (!Rf_isNull(boundary)){
+    s_att = cl_new_attribute(cl->corpus, (char*)CHAR(STRING_ELT(boundary,0)), ATT_STRUC);
+    if (s_att == NULL) Rcpp::stop("s-attribute not found");
+  }
+
+  atts = (Attribute **) cl_malloc(n_atts * sizeof(Attribute *));
+  for (i = 0; i < n_atts; i++){
+    atts[i] = cl_new_attribute(cl->corpus, (char*)CHAR(STRING_ELT(p_attribute,i)), ATT_POS);
+    if (atts[i] == NULL){
+      cl_free(atts);
+      Rcpp::stop("p-attribute not found");
+    }
+  }
+
+  i = compose_kwic_batch(cl, atts, n_atts, s_att, left, right, (char*)CHAR(STRING_ELT(sep,0)), &batch);
+  cl_free(atts);
+  if (!i){
+    free_kwic_batch(&batch);
+    Rcpp::stop("cannot decode p-attribute");
+  }
+
+  Rcpp::IntegerVector match(batch.nr_lines);
+  Rcpp::IntegerVector matchend(batch.nr_lines);
+  Rcpp::StringVector left_context(batch.nr_lines);
+  Rcpp::StringVector node(batch.nr_lines);
+  Rcpp::StringVector right_context(batch.nr_lines);
+
+  off = batch.offsets;
+  for (i = 0; i < batch.nr_lines; i++){
+    match[i] = cl->range[i].start;
+    matchend[i] = cl->range[i].end;
+    SET_STRING_ELT(left_context, i, Rf_mkCharLen(batch.data + off[3*i], off[3*i+1] - off[3*i]));
+    SET_STRING_ELT(node, i, Rf_mkCharLen(batch.data + off[3*i+1], off[3*i+2] - off[3*i+1]));
+    SET_STRING_ELT(right_context, i, Rf_mkCharLen(batch.data + off[3*i+2], off[3*i+3] - off[3*i+2]));
+  }
+  free_kwic_batch(&batch);
+
+  return Rcpp::List::create(
+    Rcpp::Named("match") = match,
+    Rcpp::Named("matchend") = matchend,
+    Rcpp::Named("left") = left_context,
+    Rcpp::Named("node") = node,
+    Rcpp::Named("right") = right_context
+  );
+}
+
+
+/* turn a column of IDs (p-attribute) or region numbers (s-attribute with values) into a factor */
+static void tabulate_column_to_factor(Rcpp::IntegerVector column, TabulationItem item){
+
+  std::vector<int> code;
+  std::vector<std::string> levels;
+  std::map<std::string,int> seen;
+  int i, n_values;
+  char * value;
+
+  if (item->attribute_type == ATT_POS){
+    n_values = cl_max_id(item->attribute);
+  } else if (item->attribute_type == ATT_STRUC && cl_struc_values(item->attribute)){
+    n_values = cl_max_struc(item->attribute);
+  } else {
+    return;
+  }
+  if (n_values < 0) n_values = 0;
+
+  code.assign(n_values, 0);
+  for (i = 0; i < column.length(); i++){
+    if (column[i] != NA_INTEGER) code[column[i]] = 1;
+  }
+
+  /* levels are in the order of the lexicon (or of the regions) */
+  for (i = 0; i < n_values; i++){
+    if (!code[i]) continue;
+    if (item->attribute_type == ATT_POS){
+      levels.push_back(cl_id2str(item->attribute, i));
+      code[i] = levels.size();
+    } else {
+      value = cl_struc2str(item->attribute, i);
+      std::string v(value ? value : "");
+      std::map<std::string,int>::iterator it = seen.find(v);
+      if (it == seen.end()){
+        levels.push_back(v);
+        it = seen.insert(std::make_pair(v, (int)levels.size())).first;
+      }
+      code[i] = it->second;
+    }
+  }
+
+  for (i = 0; i < column.length(); i++){
+    if (column[i] != NA_INTEGER) column[i] = code[column[i]];
+  }
+  column.attr("levels") = Rcpp::wrap(levels);
+  column.attr("class") = "factor";
+}
+
+
+// [[Rcpp::export(name=".cqp_tabulate")]]
+Rcpp::List cqp_tabulate(SEXP scorpus, Rcpp::StringVector anchor, Rcpp::IntegerVector offset, Rcpp::StringVector attribute, bool factor){
+
+  char * subcorpus = (char*)CHAR(STRING_ELT(scorpus,0));
+  CorpusList * cl;
+  TabulationItem items = NULL, item, last = NULL;
+  int i, ok, n_items = anchor.length();
+  int ** columns;
+
+  cl = cqi_find_corpus(subcorpus);
+  if (cl == NULL) Rcpp::stop("subcorpus not found");
+
+  Rcpp::List result(n_items);
+  columns = (int **) cl_malloc(n_items * sizeof(int *));
+
+  for (i = 0; i < n_items; i++){
+    item = new_tabulation_item();
+    item->anchor1 = item->anchor2 = field_name_to_type(CHAR(STRING_ELT(anchor,i)));
+    item->offset1 = item->offset2 = offset[i];
+    if (STRING_ELT(attribute,i) != NA_STRING) item->attribute_name = cl_strdup(CHAR(STRING_ELT(attribute,i)));
+    if (last) last->next = item; else items = item;
+    last = item;
+
+    /* the columns are filled in by tabulate_columns() directly */
+    Rcpp::IntegerVector column(cl->size);
+    result[i] = column;
+    columns[i] = INTEGER(column);
+  }
+
+  ok = tabulate_columns(cl, items, columns);
+
+  for (item = items, i = 0; item; item = item->next, i++){
+    if (ok && factor && item->attribute_type != ATT_NONE) tabulate_column_to_factor(result[i], item);
+  }
+  while (items){
+    item = items->next;
+    cl_free(items->attribute_name);
+    cl_free(items);
+    items = item;
+  }
+  cl_free(columns);
+
+  if (!ok) Rcpp::stop("cannot tabulate query result");
+  return result;
+}
@@ -81,6 +81,17 @@
 #define CQI_DATA_INT_INT 0x0309
 #define CQI_DATA_INT_INT_INT_INT 0x030A
 #define CQI_DATA_INT_TABLE 0x030B
+#define CQI_DATA_PACKED_INT_LIST 0x030C
+/* only sent if CQI_EXT_PACKED has been negotiated (see CQI_CTRL_EXTENSIONS) */
+/* (INT n, chunks): the integers are packed into chunks (INT bytes, BYTE[bytes]) */
+/* until all <n> integers have been sent; each integer is stored as the  */
+/* difference to the previous one (the first one to 0), zigzag-encoded   */
+/* (0, -1, 1, -2, ... => 0, 1, 2, 3, ...) and written as a varint (7 bits */
+/* per byte, lowest first, high bit set on all but the last byte)       */
+#define CQI_DATA_PACKED_INT_TABLE 0x030D
+/* only sent if CQI_EXT_PACKED has been negotiated (see CQI_CTRL_EXTENSIONS) */
+/* (INT rows, INT columns, chunks): the table is sent column by column, */
+/* each column packed like a CQI_DATA_PACKED_INT_LIST (without <n>)      */
 
 #define CQI_CL_ERROR 0x04
 
@@ -149,6 +160,14 @@
 /* full-text error message for the last general error reported by        */
 /* the CQi server                                                        */
 
+#define CQI_CTRL_EXTENSIONS 0x1106
+/* INPUT: (INT extensions)                                               */
+/* OUTPUT: CQI_DATA_INT                                                  */
+/* requests protocol extensions (CQI_EXT_* flags, or-ed together) for the */
+/* rest of the connection; returns those supported by the server. Should */
+/* be sent directly after CQI_CTRL_CONNECT. Servers that don't know the  */
+/* command close the connection (check with CQI_ASK_FEATURE_EXTENSIONS). */
+
 
 
 #define CQI_ASK_FEATURE 0x12
@@ -165,6 +184,17 @@
 /* INPUT: ()                                                             */
 /* OUTPUT: CQI_DATA_BOOL                                                 */
 
+#define CQI_ASK_FEATURE_CL_BULK 0x1204
+/* INPUT: ()                                                             */
+/* OUTPUT: CQI_DATA_BOOL                                                 */
+/* true if the server supports the bulk access commands                  */
+/* CQI_CL_CPOS_RANGE2ID ... CQI_CL_LEXICON_FREQS                         */
+
+#define CQI_ASK_FEATURE_EXTENSIONS 0x1205
+/* INPUT: ()                                                             */
+/* OUTPUT: CQI_DATA_BOOL                                                 */
+/* true if the server supports CQI_CTRL_EXTENSIONS                       */
+
 
 
 #define CQI_CORPUS 0x13
@@ -315,6 +345,31 @@
 /* OUTPUT: CQI_DATA_INT_INT_INT_INT                                      */
 /* returns (src_start, src_end, target_start, target_end)                */
 
+/* bulk access commands (check CQI_ASK_FEATURE_CL_BULK first)            */
+#define CQI_CL_CPOS_RANGE2ID 0x1411
+/* INPUT:  (STRING attribute, INT_LIST start, INT_LIST end)              */
+/* OUTPUT: CQI_DATA_INT_LIST                                             */
+/* returns the lexicon IDs of all tokens from <start>[i] to <end>[i],    */
+/* range by range; a range with end < start is empty; returns -1 for     */
+/* every corpus position that is out of range                            */
+
+#define CQI_CL_CPOS_RANGE2STR 0x1412
+/* INPUT:  (STRING attribute, INT_LIST start, INT_LIST end)              */
+/* OUTPUT: CQI_DATA_STRING_LIST                                          */
+/* returns the strings of all tokens from <start>[i] to <end>[i], range  */
+/* by range; returns "" for every corpus position that is out of range   */
+
+#define CQI_CL_STRUC_RANGE2CPOS 0x1413
+/* INPUT:  (STRING attribute, INT first, INT last)                       */
+/* OUTPUT: CQI_DATA_INT_TABLE                                            */
+/* returns a table with one row (start, end) for each structure region   */
+/* from <first> to <last>; (-1, -1) for regions that are out of range    */
+
+#define CQI_CL_LEXICON_FREQS 0x1414
+/* INPUT:  (STRING attribute)                                            */
+/* OUTPUT: CQI_DATA_INT_LIST                                             */
+/* returns the frequencies of all lexicon IDs 0 .. (lexicon_size - 1)    */
+
 
 
 #define CQI_CQP 0x15
@@ -341,6 +396,7 @@
 /* OUTPUT: CQI_DATA_INT_LIST                                             */
 /* Dump the values of <field> for match ranges <first> .. <last>         */
 /* in <subcorpus>. <field> is one of the CQI_CONST_FIELD_* constants.    */
+/* with CQI_EXT_PACKED, the result is a CQI_DATA_PACKED_INT_LIST         */
 
 #define CQI_CQP_DROP_SUBCORPUS 0x1509
 /* INPUT:  (STRING subcorpus)                                            */
@@ -355,6 +411,7 @@
 /* returns <n> (id, frequency) pairs flattened into a list of size 2*<n> */
 /* field is one of CQI_CONST_FIELD_MATCH, CQI_CONST_FIELD_TARGET, CQI_CONST_FIELD_KEYWORD */
 /* NB: pairs are sorted by frequency desc.                               */
+/* with CQI_EXT_PACKED, the result is a CQI_DATA_PACKED_INT_TABLE        */
 
 /* frequency distribution of pairs of tokens                             */
 #define CQI_CQP_FDIST_2 0x1511
@@ -362,6 +419,7 @@
 /* OUTPUT: CQI_DATA_INT_LIST                                             */
 /* returns <n> (id1, id2, frequency) pairs flattened into a list of size 3*<n> */
 /* NB: triples are sorted by frequency desc.                             */
+/* with CQI_EXT_PACKED, the result is a CQI_DATA_PACKED_INT_TABLE        */
 
 
 
@@ -402,6 +460,18 @@
 #define CQI_CONST_FIELD_KEYWORD 0x09
 
 
+/* Protocol extensions (see CQI_CTRL_EXTENSIONS)                        */
+
+/* Pipelining: every request carries an INT request ID directly after the */
+/* command word, and the server sends the ID back before the response.  */
+/* Clients may send several requests without waiting for the responses; */
+/* these are returned in order and may be transmitted together.          */
+#define CQI_EXT_PIPELINE 0x01
+/* Packed lists: CQI_CQP_DUMP_SUBCORPUS returns CQI_DATA_PACKED_INT_LIST, */
+/* CQI_CQP_FDIST_1 and CQI_CQP_FDIST_2 return CQI_DATA_PACKED_INT_TABLE  */
+#define CQI_EXT_PACKED 0x02
+
+
 /* CQi version is CQI_MAJOR_VERSION.CQI_MINOR_VERSION                    */
 #define CQI_MAJOR_VERSION 0x00
 #define CQI_MINOR_VERSION 0x01
@@ -0,0 +1,473 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+/**
+ * @file
+ *
+ * Load test for CQPserver: runs a number of CQi clients at the same time,
+ * each of which repeatedly runs a query, reads the size and the first
+ * matches of the result and drops it again. Reports throughput and latency.
+ *
+ * Each client also keeps a subcorpus of its own (under the same name in all
+ * clients) throughout the test and checks that it is not affected by the
+ * other clients, which tests the separation of sessions in multi-client
+ * mode (cqpserver -o).
+ *
+ * With option -x, the clients use the protocol extensions (CQI_CTRL_EXTENSIONS):
+ * they send the requests of each round in pairs without waiting for the
+ * responses, and receive the matches as packed lists.
+ *
+ * The clients are forked processes, so this program does not depend on a
+ * thread library; it is not supported on Windows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+#include "cqi.h"
+
+/** Number of matches read from each query result */
+#define LOADTEST_DUMP_ROWS 1000
+
+/** Connection to the server of a client */
+static FILE *in, *out;
+
+/** Name of the client (for error messages) */
+static int client_nr = 0;
+
+/** Use the protocol extensions (pipelined requests, packed lists)? */
+static int extensions = 0;
+
+/** With extensions: IDs of the next request, and of the next expected response */
+static int next_request = 1, next_response = 1;
+
+/** Number of bytes received from the server */
+static long received = 0;
+
+
+static void
+fail(const char *what)
+{
+  fprintf(stderr, "cqpserver-loadtest: client #%d: %s\n", client_nr, what);
+  exit(1);
+}
+
+static double
+now(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/*
+ * CQi primitives of the client
+ */
+
+static void
+send_word(int n)
+{
+  putc((n >> 8) & 0xff, out);
+  putc(n & 0xff, out);
+}
+
+static void
+send_int(int n)
+{
+  putc((n >> 24) & 0xff, out);
+  putc((n >> 16) & 0xff, out);
+  putc((n >> 8) & 0xff, out);
+  putc(n & 0xff, out);
+}
+
+static void
+send_string(const char *s)
+{
+  int len = strlen(s);
+  send_word(len);
+  fwrite(s, 1, len, out);
+}
+
+static int
+read_byte(void)
+{
+  int c = getc(in);
+  if (c == EOF)
+    fail("connection closed by server");
+  received++;
+  return c;
+}
+
+static int
+read_word(void)
+{
+  int n = read_byte();
+  return (n << 8) | read_byte();
+}
+
+static int
+read_int(void)
+{
+  unsigned int n = read_byte();
+  n = (n << 8) | read_byte();
+  n = (n << 8) | read_byte();
+  n = (n << 8) | read_byte();
+  return (int)n;
+}
+
+/** Starts a request (with extensions, the command is followed by the request ID). */
+static void
+send_command(int cmd)
+{
+  send_word(cmd);
+  if (extensions)
+    send_int(next_request++);
+}
+
+/** Flushes the requests and checks that the next response is of the expected type. */
+static void
+expect(int response)
+{
+  int r;
+
+  fflush(out);
+  if (extensions && read_int() != next_response++)
+    fail("response to the wrong request");
+  if ((r = read_word()) != response) {
+    char msg[64];
+    sprintf(msg, "expected response 0x%04X, got 0x%04X", response, r);
+    fail(msg);
+  }
+}
+
+/*
+ * Requests: send_* functions only send the request, so that several requests
+ * can be sent before the responses are read with expect().
+ */
+
+static void
+send_size_request(const char *subcorpus)
+{
+  send_command(CQI_CQP_SUBCORPUS_SIZE);
+  send_string(subcorpus);
+}
+
+static void
+send_query(const char *corpus, const char *name, const char *query)
+{
+  send_command(CQI_CQP_QUERY);
+  send_string(corpus);
+  send_string(name);
+  send_string(query);
+}
+
+static void
+send_drop(const char *subcorpus)
+{
+  send_command(CQI_CQP_DROP_SUBCORPUS);
+  send_string(subcorpus);
+}
+
+static void
+send_dump(const char *subcorpus, int first, int last)
+{
+  send_command(CQI_CQP_DUMP_SUBCORPUS);
+  send_string(subcorpus);
+  putc(CQI_CONST_FIELD_MATCH, out);
+  send_int(first);
+  send_int(last);
+}
+
+static int
+subcorpus_size(const char *subcorpus)
+{
+  send_size_request(subcorpus);
+  expect(CQI_DATA_INT);
+  return read_int();
+}
+
+/**
+ * Reads the matches returned for send_dump() and checks that there are n of them,
+ * in ascending order.
+ */
+static void
+read_matches(int n)
+{
+  int i, bytes, shift, previous = 0, count = 0;
+  unsigned int x, delta;
+
+  if (!extensions) {
+    expect(CQI_DATA_INT_LIST);
+    if (read_int() != n)
+      fail("wrong number of matches returned");
+    for (i = 0; i < n; i++) {
+      x = read_int();
+      if ((int)x < previous)
+        fail("matches are not in order");
+      previous = x;
+    }
+    return;
+  }
+
+  expect(CQI_DATA_PACKED_INT_LIST);
+  if (read_int() != n)
+    fail("wrong number of matches returned");
+  while (count < n) {
+    for (bytes = read_int(); bytes > 0; ) {
+      /* decode a varint, then undo zigzag and delta encoding */
+      for (delta = 0, shift = 0; ; shift += 7) {
+        x = read_byte();
+        bytes--;
+        delta |= (x & 0x7f) << shift;
+        if (!(x & 0x80))
+          break;
+      }
+      delta = (delta >> 1) ^ (0U - (delta & 1));
+      if ((int)delta < 0)
+        fail("matches are not in order");
+      previous += delta;
+      count++;
+    }
+  }
+  if (count != n)
+    fail("wrong number of matches returned");
+}
+
+/**
+ * Opens a connection to the server and logs on.
+ */
+static void
+connect_to_server(const char *host, int port, const char *user, const char *passwd)
+{
+  struct sockaddr_in addr;
+  struct hostent *h;
+  int fd, on = 1;
+
+  if (!(h = gethostbyname(host)))
+    fail("can't resolve host name");
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  memcpy(&addr.sin_addr, h->h_addr_list[0], sizeof(addr.sin_addr));
+
+  if (0 > (fd = socket(AF_INET, SOCK_STREAM, 0)) || 0 != connect(fd, (struct sockaddr *)&addr, sizeof(addr)))
+    fail("can't connect to server");
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const void *)&on, sizeof(int));
+  if (!(in = fdopen(fd, "r")) || !(out = fdopen(dup(fd), "w")))
+    fail("can't open connection streams");
+
+  send_word(CQI_CTRL_CONNECT);
+  send_string(user);
+  send_string(passwd);
+  fflush(out);
+  if (read_word() != CQI_STATUS_CONNECT_OK)
+    fail("connection refused");
+
+  if (extensions) {
+    send_word(CQI_CTRL_EXTENSIONS);
+    send_int(CQI_EXT_PIPELINE | CQI_EXT_PACKED);
+    fflush(out);
+    if (read_word() != CQI_DATA_INT || read_int() != (CQI_EXT_PIPELINE | CQI_EXT_PACKED))
+      fail("server does not support the protocol extensions");
+  }
+}
+
+/**
+ * Runs one client of the load test.
+ *
+ * Writes one line per round (the latency in seconds) to the result pipe,
+ * followed by "ok" if the private subcorpus of the client was unaffected.
+ */
+static void
+run_client(int result_fd, const char *host, int port, const char *user, const char *passwd,
+           const char *corpus, const char *query, int rounds)
+{
+  FILE *result = fdopen(result_fd, "w");
+  char mine[1024], last[1024], query_cut[2048];
+  int r, size, n, mine_size, expected = -1;
+  double t0;
+
+  connect_to_server(host, port, user, passwd);
+
+  /* the private subcorpus holds the first (client_nr) matches of the query */
+  snprintf(query_cut, sizeof(query_cut), "%s cut %d", query, client_nr);
+  snprintf(mine, sizeof(mine), "%s:Mine", corpus);
+  snprintf(last, sizeof(last), "%s:Result", corpus);
+  send_query(corpus, "Mine", query_cut);
+  expect(CQI_STATUS_OK);
+  mine_size = subcorpus_size(mine);
+
+  for (r = 0; r < rounds; r++) {
+    t0 = now();
+    send_query(corpus, "Result", query);
+    if (extensions)
+      send_size_request(last);  /* pipelined: don't wait for the query to finish */
+    expect(CQI_STATUS_OK);
+    if (!extensions)
+      send_size_request(last);
+    expect(CQI_DATA_INT);
+    size = read_int();
+    if (expected < 0)
+      expected = size;
+    else if (size != expected)
+      fail("query results differ between rounds");
+
+    n = (size < LOADTEST_DUMP_ROWS) ? size : LOADTEST_DUMP_ROWS;
+    if (n > 0) {
+      send_dump(last, 0, n - 1);
+      if (extensions)
+        send_drop(last);
+      read_matches(n);
+      if (!extensions)
+        send_drop(last);
+    }
+    else
+      send_drop(last);
+    expect(CQI_STATUS_OK);
+    fprintf(result, "%f\n", now() - t0);
+  }
+
+  /* check that the private subcorpus wasn't replaced by that of another client */
+  if (subcorpus_size(mine) != mine_size || (expected >= 0 && mine_size != (expected < client_nr ? expected : client_nr)))
+    fail("subcorpus was changed by another session");
+  send_drop(mine);
+  expect(CQI_STATUS_OK);
+
+  send_command(CQI_CTRL_BYE);
+  expect(CQI_STATUS_BYE_OK);
+  fprintf(result, "bytes %ld\n", received);
+  fprintf(result, "ok\n");
+  fclose(result);
+  exit(0);
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static void
+usage(void)
+{
+  fprintf(stderr,
+          "\n"
+          "Usage:  cqpserver-loadtest [options] <corpus> <query>\n\n"
+          "Runs several CQi clients at the same time against a CQPserver; each client\n"
+          "repeatedly runs <query> on <corpus> and reads the first %d matches.\n\n"
+          "Options:\n"
+          "  -H <host>    server host [localhost]\n"
+          "  -P <port>    server port [%d]\n"
+          "  -u <user>    user name [user]\n"
+          "  -p <passwd>  password [pass]\n"
+          "  -n <n>       number of concurrent clients [8]\n"
+          "  -r <n>       number of queries per client [20]\n"
+          "  -x           use protocol extensions (pipelining, packed lists)\n"
+          "  -h           show this help page\n\n",
+          LOADTEST_DUMP_ROWS, CQI_PORT);
+  exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+  char *host = "localhost", *user = "user", *passwd = "pass";
+  int port = CQI_PORT, n_clients = 8, rounds = 20;
+  int c, i, n, ok = 0, failed = 0, status;
+  long bytes = 0;
+  int (*pipes)[2];
+  double *latency, t0, elapsed, sum = 0.0;
+  char line[256];
+  FILE *f;
+
+  while (EOF != (c = getopt(argc, argv, "H:P:u:p:n:r:xh")))
+    switch (c) {
+    case 'H': host = optarg; break;
+    case 'P': port = atoi(optarg); break;
+    case 'u': user = optarg; break;
+    case 'p': passwd = optarg; break;
+    case 'n': n_clients = atoi(optarg); break;
+    case 'r': rounds = atoi(optarg); break;
+    case 'x': extensions = 1; break;
+    default: usage();
+    }
+  if (argc - optind != 2 || n_clients < 1 || rounds < 1)
+    usage();
+
+  pipes = malloc(n_clients * sizeof(*pipes));
+  latency = malloc(n_clients * rounds * sizeof(double));
+
+  t0 = now();
+  for (i = 0; i < n_clients; i++) {
+    if (0 != pipe(pipes[i])) {
+      perror("ERROR pipe() failed");
+      exit(1);
+    }
+    switch (fork()) {
+    case -1:
+      perror("ERROR fork() failed");
+      exit(1);
+    case 0:
+      close(pipes[i][0]);
+      client_nr = i + 1;
+      run_client(pipes[i][1], host, port, user, passwd, argv[optind], argv[optind + 1], rounds);
+    default:
+      close(pipes[i][1]);
+    }
+  }
+
+  for (n = 0, i = 0; i < n_clients; i++) {
+    f = fdopen(pipes[i][0], "r");
+    while (fgets(line, sizeof(line), f)) {
+      if (0 == strncmp(line, "ok", 2))
+        ok++;
+      else if (0 == strncmp(line, "bytes ", 6))
+        bytes += atol(line + 6);
+      else if (n < n_clients * rounds)
+        sum += (latency[n++] = atof(line));
+    }
+    fclose(f);
+  }
+  while (wait(&status) > 0)
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      failed++;
+  elapsed = now() - t0;
+
+  printf("clients:      %d (%d ok, %d failed)\n", n_clients, ok, failed);
+  printf("queries:      %d in %.3f s  (%.1f queries/s)\n", n, elapsed, n / elapsed);
+  printf("received:     %ld bytes\n", bytes);
+  if (n > 0) {
+    qsort(latency, n, sizeof(double), compare_doubles);
+    printf("latency (ms): mean %.2f  median %.2f  95%% %.2f  max %.2f\n",
+           1000 * sum / n, 1000 * latency[n / 2], 1000 * latency[(int)(0.95 * (n - 1))], 1000 * latency[n - 1]);
+  }
+
+  free(latency);
+  free(pipes);
+  return (failed || ok < n_clients) ? 1 : 0;
+}
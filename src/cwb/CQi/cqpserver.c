@@ -18,6 +18,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include <math.h>
 
 #include "server.h"
@@ -31,9 +32,13 @@
 #include "../cqp/options.h"
 #include "../cqp/corpmanag.h"
 #include "../cqp/groups.h"
+#include "../cqp/querycache.h"
 void Rprintf(const char *, ...);
 
 
+/** Bulk access commands decode and send data in blocks of this many values */
+#define CQI_BULK_BLOCK 4096
+
 /** String containing the username sent by the currently-connect CQi client */
 char *user = "";
 
@@ -57,6 +62,7 @@ void
 cqiserver_unknown_command_error(int cmd)
 {
   cqiserver_log(Error, "unknown CQi command 0x%04X.", cmd);
+  cqi_end_session();            /* in multi-client mode, only the session is closed */
   exit(1);
 }
 
@@ -69,6 +75,7 @@ void
 cqiserver_wrong_command_error(int cmd)
 {
   cqiserver_log(Error, "command 0x%04X not allowed in this context.", cmd);
+  cqi_end_session();            /* in multi-client mode, only the session is closed */
   exit(1);
 }
 
@@ -86,6 +93,7 @@ cqiserver_internal_error(char *function, char *reason)
 {
   cqiserver_log(Error, "internal error in %s()", function);
   cqiserver_log(Error, "''%s''n", reason);
+  cqi_end_session();            /* in multi-client mode, only the session is closed */
   exit(1);
 }
 
@@ -155,6 +163,21 @@ send_cl_error(void)
  *
  */
 
+/**
+ * Switches on the protocol extensions requested by the client (as far as
+ * they are supported); they apply from the next request on.
+ */
+static void
+do_cqi_ctrl_extensions(void)
+{
+  int requested = cqi_read_int();
+  int granted = requested & (CQI_EXT_PIPELINE | CQI_EXT_PACKED);
+
+  cqiserver_debug_msg("CQI_CTRL_EXTENSIONS(0x%02X) => 0x%02X", requested, granted);
+  cqi_data_int(granted);
+  cqi_extensions = granted;
+}
+
 static void
 do_cqi_corpus_list_corpora(void)
 {
@@ -435,16 +458,16 @@ do_cqi_cl_id2freq(void)
   if (!(attribute = cqi_lookup_attribute(att_name, ATT_POS)))
     cqi_command(cqi_errno);
   else {
-    /* we assemble the CQI_DATA_INT_LIST() return command by hand,
-       so we don't have to allocate a temporary list */
-    cqi_send_word(CQI_DATA_INT_LIST);
-    cqi_send_int(len);          /* list size */
+    /* overwrite the IDs with their frequencies and send them as a block */
     for (i=0; i<len; i++) {
       f = cl_id2freq(attribute, idlist[i]);
       if (f < 0)
         f = 0;                  /* return 0 if ID is out of range */
-      cqi_send_int(f);
+      idlist[i] = f;
     }
+    cqi_send_word(CQI_DATA_INT_LIST);
+    cqi_send_int(len);          /* list size */
+    cqi_send_int_array(idlist, len);
   }
   cqi_flush();
   cl_free(idlist);               /* don't forget to free allocated memory */
@@ -482,7 +505,7 @@ void
 do_cqi_cl_cpos2id(void)
 {
   int *cposlist;
-  int i, id;
+  int i;
   Attribute *attribute;
 
   char *att_name = cqi_read_string();
@@ -493,16 +516,16 @@ do_cqi_cl_cpos2id(void)
   if (!(attribute = cqi_lookup_attribute(att_name, ATT_POS)))
     cqi_command(cqi_errno);
   else {
-    /* we assemble the CQI_DATA_INT_LIST() return command by hand,
-       so we don't have to allocate a temporary list */
+    /* look up all positions at once, overwriting the list (fast for sorted cposlist) */
+    if (cl_cpos2id_list(attribute, cposlist, len, cposlist) < 0)
+      for (i=0; i<len; i++)
+        cposlist[i] = -1;
+    for (i=0; i<len; i++)
+      if (cposlist[i] < 0)
+        cposlist[i] = -1;               /* return -1 if cpos is out of range */
     cqi_send_word(CQI_DATA_INT_LIST);
     cqi_send_int(len);          /* list size */
-    for (i=0; i<len; i++) {
-      id = cl_cpos2id(attribute, cposlist[i]);
-      if (id < 0)
-        id = -1;                        /* return -1 if cpos is out of range */
-      cqi_send_int(id);
-    }
+    cqi_send_int_array(cposlist, len);
   }
   cqi_flush();
   cl_free(cposlist);                     /* don't forget to free allocated memory */
@@ -625,15 +648,18 @@ do_cqi_cl_cpos2alg(void)
   if (!(attribute = cqi_lookup_attribute(att_name, ATT_ALIGN)))
     cqi_command(cqi_errno);
   else {
-    /* we assemble the CQI_DATA_INT_LIST() return command by hand,
-       so we don't have to allocate a temporary list */
-    int i, alg;
+    /* look up all positions at once (fast for sorted cposlist) and
+       assemble the CQI_DATA_INT_LIST() return command by hand */
+    int i;
+    int *alglist = (int *)cl_malloc((len > 0 ? len : 1) * sizeof(int));
+    if (cl_cpos2alg_list(attribute, cposlist, len, alglist) < 0)
+      for (i=0; i<len; i++)
+        alglist[i] = -1;
     cqi_send_word(CQI_DATA_INT_LIST);
     cqi_send_int(len);          /* list size */
-    for (i=0; i<len; i++) {
-      alg = cl_cpos2alg(attribute, cposlist[i]);
-      cqi_send_int(alg < 0 ? -1 : alg); /* return -1 if cpos is out of range */
-    }
+    for (i=0; i<len; i++)
+      cqi_send_int(alglist[i] < 0 ? -1 : alglist[i]); /* return -1 if cpos is out of range */
+    cl_free(alglist);
   }
   cqi_flush();
   cl_free(cposlist);                     /* don't forget to free allocated memory */
@@ -789,6 +815,202 @@ do_cqi_cl_alg2cpos(void)
   cl_free(att_name);                      /* don't forget to free allocated space */
 }
 
+/**
+ * Counts the corpus positions in a list of ranges for the bulk access commands.
+ *
+ * @param start    List of start positions.
+ * @param n_start  Length of the list of start positions.
+ * @param end      List of end positions.
+ * @param n_end    Length of the list of end positions.
+ * @return         Total number of corpus positions in the ranges, or -1 if
+ *                 the two lists differ in length or the total does not fit
+ *                 into a CQi list.
+ */
+static int
+cqi_range_total(int *start, int n_start, int *end, int n_end)
+{
+  long long total = 0;
+  int i;
+
+  if (n_start != n_end)
+    return -1;
+  for (i = 0; i < n_start; i++)
+    if (end[i] >= start[i])
+      if ((total += (long long)end[i] - start[i] + 1) > INT_MAX)
+        return -1;
+  return (int)total;
+}
+
+/**
+ * Decodes the tokens in a list of ranges on a p-attribute, one block at a time.
+ *
+ * Each block of lexicon IDs is passed to the callback function, which
+ * sends it to the client.
+ *
+ * @param attribute  The p-attribute to decode.
+ * @param start      List of start positions.
+ * @param end        List of end positions.
+ * @param n          Number of ranges.
+ * @param send       Callback for each block of IDs (out-of-range positions are -1).
+ */
+static void
+cqi_decode_ranges(Attribute *attribute, int *start, int *end, int n, void (*send)(Attribute *, int *, int))
+{
+  int cposlist[CQI_BULK_BLOCK], idlist[CQI_BULK_BLOCK];
+  int i, j, k, len, size;
+
+  for (i = 0; i < n; i++) {
+    size = (end[i] >= start[i]) ? end[i] - start[i] + 1 : 0;
+    for (k = 0; k < size; k += len) {
+      len = (size - k < CQI_BULK_BLOCK) ? size - k : CQI_BULK_BLOCK;
+      for (j = 0; j < len; j++)
+        cposlist[j] = start[i] + k + j;
+      if (cl_cpos2id_list(attribute, cposlist, len, idlist) < 0)
+        for (j = 0; j < len; j++)
+          idlist[j] = -1;
+      for (j = 0; j < len; j++)
+        if (idlist[j] < 0)
+          idlist[j] = -1;
+      send(attribute, idlist, len);
+    }
+  }
+}
+
+static void
+send_id_block(Attribute *attribute, int *idlist, int len)
+{
+  cqi_send_int_array(idlist, len);
+}
+
+static void
+send_str_block(Attribute *attribute, int *idlist, int len)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+    cqi_send_string(idlist[i] < 0 ? NULL : cl_id2str(attribute, idlist[i]));  /* sends "" if cpos is out of range */
+}
+
+void
+do_cqi_cl_cpos_range2id(void)
+{
+  int *start, *end;
+  int total;
+  Attribute *attribute;
+
+  char *att_name = cqi_read_string();
+  int n_start = cqi_read_int_list(&start);
+  int n_end = cqi_read_int_list(&end);
+
+  cqiserver_debug_msg("CQI_CL_CPOS_RANGE2ID('%s', <%d ranges>)", att_name, n_start);
+
+  if (!(attribute = cqi_lookup_attribute(att_name, ATT_POS)))
+    cqi_command(cqi_errno);
+  else if (0 > (total = cqi_range_total(start, n_start, end, n_end)))
+    cqi_general_error("CQI_CL_CPOS_RANGE2ID: lists of start and end positions don't match.");
+  else {
+    cqi_send_word(CQI_DATA_INT_LIST);
+    cqi_send_int(total);        /* list size */
+    cqi_decode_ranges(attribute, start, end, n_start, send_id_block);
+  }
+  cqi_flush();
+  cl_free(start);
+  cl_free(end);
+  cl_free(att_name);
+}
+
+void
+do_cqi_cl_cpos_range2str(void)
+{
+  int *start, *end;
+  int total;
+  Attribute *attribute;
+
+  char *att_name = cqi_read_string();
+  int n_start = cqi_read_int_list(&start);
+  int n_end = cqi_read_int_list(&end);
+
+  cqiserver_debug_msg("CQI_CL_CPOS_RANGE2STR('%s', <%d ranges>)", att_name, n_start);
+
+  if (!(attribute = cqi_lookup_attribute(att_name, ATT_POS)))
+    cqi_command(cqi_errno);
+  else if (0 > (total = cqi_range_total(start, n_start, end, n_end)))
+    cqi_general_error("CQI_CL_CPOS_RANGE2STR: lists of start and end positions don't match.");
+  else {
+    cqi_send_word(CQI_DATA_STRING_LIST);
+    cqi_send_int(total);        /* list size */
+    cqi_decode_ranges(attribute, start, end, n_start, send_str_block);
+  }
+  cqi_flush();
+  cl_free(start);
+  cl_free(end);
+  cl_free(att_name);
+}
+
+void
+do_cqi_cl_struc_range2cpos(void)
+{
+  int buf[2 * CQI_BULK_BLOCK];
+  int i, n, rows;
+  Attribute *attribute;
+
+  char *att_name = cqi_read_string();
+  int first = cqi_read_int();
+  int last = cqi_read_int();
+
+  cqiserver_debug_msg("CQI_CL_STRUC_RANGE2CPOS('%s', %d, %d)", att_name, first, last);
+
+  if (!(attribute = cqi_lookup_attribute(att_name, ATT_STRUC)))
+    cqi_command(cqi_errno);
+  else if ((long long)last - first + 1 > INT_MAX)
+    cqi_general_error("CQI_CL_STRUC_RANGE2CPOS: too many regions requested.");
+  else {
+    rows = (last >= first) ? last - first + 1 : 0;
+    cqi_send_word(CQI_DATA_INT_TABLE);  /* return table with 2 columns & <rows> rows */
+    cqi_send_int(rows);
+    cqi_send_int(2);
+    for ( ; rows > 0; rows -= n, first += n) {
+      n = (rows < CQI_BULK_BLOCK) ? rows : CQI_BULK_BLOCK;
+      for (i = 0; i < n; i++)
+        if (!cl_struc2cpos(attribute, first + i, &buf[2*i], &buf[2*i+1]))
+          buf[2*i] = buf[2*i+1] = -1;   /* cannot return error within table, so send -1 */
+      cqi_send_int_array(buf, 2 * n);
+    }
+  }
+  cqi_flush();
+  cl_free(att_name);
+}
+
+void
+do_cqi_cl_lexicon_freqs(void)
+{
+  int freqs[CQI_BULK_BLOCK];
+  int id, i, n, size;
+  Attribute *attribute;
+
+  char *att_name = cqi_read_string();
+
+  cqiserver_debug_msg("CQI_CL_LEXICON_FREQS('%s')", att_name);
+
+  if (!(attribute = cqi_lookup_attribute(att_name, ATT_POS)))
+    cqi_command(cqi_errno);
+  else if (0 > (size = cl_max_id(attribute)))
+    send_cl_error();
+  else {
+    cqi_send_word(CQI_DATA_INT_LIST);
+    cqi_send_int(size);         /* list size */
+    for (id = 0; id < size; id += n) {
+      n = (size - id < CQI_BULK_BLOCK) ? size - id : CQI_BULK_BLOCK;
+      for (i = 0; i < n; i++)
+        if (0 > (freqs[i] = cl_id2freq(attribute, id + i)))
+          freqs[i] = 0;
+      cqi_send_int_array(freqs, n);
+    }
+  }
+  cqi_flush();
+  cl_free(att_name);
+}
+
 void
 do_cqi_cqp_list_subcorpora(void)
 {
@@ -868,25 +1090,35 @@ do_cqi_cqp_query(void)
     if (!check_subcorpus_name(child) || !cqi_activate_corpus(mother))
       cqi_command(cqi_errno);
     else {
+      CorpusList *mothercl = cqi_find_corpus(mother);
+      char *key = query_cache_key(mothercl, query);
+      CorpusList *childcl;
+
       query_lock = floor(1e9 * cl_random_fraction()) + 1; /* activate query lock mode with random key */
       cqiserver_log(Info, "query_lock = %d\n", query_lock);
 
       snprintf(cqp_query, len, "%s = %s;", child, query);
-      if (!cqp_parse_string(cqp_query))
+      if ((childcl = query_cache_lookup(mothercl, key, child))) {
+        cqiserver_log(Info, "'%s' ran the following query on %s\n\t%s\n\tand got %d matches (from the query cache).", user, mother, cqp_query, childcl->size);
+        cqi_command(CQI_STATUS_OK);
+      }
+      else if (!cqp_parse_string(cqp_query))
         cqi_command(CQI_CQP_ERROR_GENERAL); /* should be changed to detailed error messages */
       else {
         char *full_child = combine_subcorpus_spec(corpus_name, child); /* corpus_name is the 'physical' part of the mother corpus */;
-        CorpusList *childcl = cqi_find_corpus(full_child);
+        childcl = cqi_find_corpus(full_child);
 
         if (!childcl)
           cqi_command(CQI_CQP_ERROR_GENERAL);
         else {
+          query_cache_store(key, childcl);
           cqiserver_log(Info, "'%s' ran the following query on %s\n\t%s\n\tand got %d matches.", user, mother, cqp_query, childcl->size);
           cqi_command(CQI_STATUS_OK);
         }
         cl_free(full_child);
       }
       query_lock = 0;           /* deactivate query lock mode */
+      cl_free(key);
     }
     cl_free(cqp_query);
   }
@@ -984,22 +1216,64 @@ do_cqi_cqp_subcorpus_has_field(void)
 }
 
 /**
- * Sends n instances of integer -1 to the client.
- *
- * Utility function for do_cqi_cqp_dump_subcorpus().
- *
- * This is the error condition of the CQI_CQP_DUMP_SUBCORPUS command:
- * it returns a list of (-1) values if requested field is not set.
- *
- * It is assumed that the length of the lsit has already been sent.
+ * Sends a block of integers of a list or table, packed if the client has
+ * asked for CQI_EXT_PACKED.
+ */
+static void
+send_list_block(const int *block, int n)
+{
+  if (cqi_extensions & CQI_EXT_PACKED)
+    cqi_send_packed_ints(block, n);
+  else
+    cqi_send_int_array(block, n);
+}
+
+/**
+ * Sends the frequency table computed for CQI_CQP_FDIST_1 (columns: id, frequency)
+ * or CQI_CQP_FDIST_2 (columns: id1, id2, frequency).
  *
- * @param n  Length of list to send.
+ * As a CQI_DATA_INT_TABLE, the table is sent row by row; with CQI_EXT_PACKED, it
+ * is sent column by column, so the differences between successive ids and between
+ * (sorted) frequencies are small.
  */
-void
-do_cqi_send_minus_one_list(int n)
+static void
+send_group_table(Group *table, int columns)
 {
-  while (n--)
-    cqi_send_int(-1);
+  int block[CQI_BULK_BLOCK];
+  int rows = table->nr_cells;
+  int i, k, n, c;
+
+  if (cqi_extensions & CQI_EXT_PACKED) {
+    cqi_send_word(CQI_DATA_PACKED_INT_TABLE);
+    cqi_send_int(rows);
+    cqi_send_int(columns);
+    for (c = 3 - columns; c < 3; c++) {       /* columns: s (only for FDIST_2), t, freq */
+      for (i = 0; i < rows; i += n) {
+        n = (rows - i < CQI_BULK_BLOCK) ? rows - i : CQI_BULK_BLOCK;
+        for (k = 0; k < n; k++)
+          block[k] = (c == 0) ? table->count_cells[i + k].s : (c == 1) ? table->count_cells[i + k].t : table->count_cells[i + k].freq;
+        cqi_send_packed_ints(block, n);
+      }
+      cqi_send_packed_end();
+    }
+  }
+  else {
+    cqi_send_word(CQI_DATA_INT_TABLE);
+    cqi_send_int(rows);
+    cqi_send_int(columns);
+    for (i = 0; i < rows; i += n) {
+      n = (rows - i < CQI_BULK_BLOCK / 3) ? rows - i : CQI_BULK_BLOCK / 3;
+      for (k = 0; k < n; k++) {
+        int *row = block + columns * k;
+        if (columns == 3)
+          *row++ = table->count_cells[i + k].s;
+        row[0] = table->count_cells[i + k].t;
+        row[1] = table->count_cells[i + k].freq;
+      }
+      cqi_send_int_array(block, columns * n);
+    }
+  }
+  cqi_flush();
 }
 
 void
@@ -1028,36 +1302,33 @@ do_cqi_cqp_dump_subcorpus(void)
   else if (last < first || first < 0 || last >= cl->size)
     cqi_command(CQI_CQP_ERROR_OUT_OF_RANGE);
   else {
-    int i, size;
-    cqi_send_word(CQI_DATA_INT_LIST); /* assemble by hand, so we don't have to allocate a temporary list */
-    size = last - first + 1;
-    cqi_send_int(size);
-    switch (field) {
-    case CQI_CONST_FIELD_MATCH:
-      for (i=first; i<=last; i++)
-        cqi_send_int(cl->range[i].start);
-      break;
-    case CQI_CONST_FIELD_MATCHEND:
-      for (i=first; i<=last; i++)
-        cqi_send_int(cl->range[i].end);
-      break;
-    case CQI_CONST_FIELD_TARGET:
-      if (cl->targets == NULL)
-        do_cqi_send_minus_one_list(size);
-      else
-        for (i=first; i<=last; i++)
-          cqi_send_int(cl->targets[i]);
-      break;
-    case CQI_CONST_FIELD_KEYWORD:
-      if (cl->keywords == NULL)
-        do_cqi_send_minus_one_list(size);
-      else
-        for (i=first; i<=last; i++)
-          cqi_send_int(cl->keywords[i]);
-      break;
-    default:
+    int block[CQI_BULK_BLOCK];
+    int i, k, n, *values = NULL;
+
+    if (field == CQI_CONST_FIELD_TARGET)
+      values = cl->targets;
+    else if (field == CQI_CONST_FIELD_KEYWORD)
+      values = cl->keywords;
+    else if (field != CQI_CONST_FIELD_MATCH && field != CQI_CONST_FIELD_MATCHEND)
       cqiserver_internal_error("do_cqi_cqp_dump_subcorpus", "No handler for requested field.");
+
+    /* assemble by hand, so we don't have to allocate a temporary list */
+    cqi_send_word((cqi_extensions & CQI_EXT_PACKED) ? CQI_DATA_PACKED_INT_LIST : CQI_DATA_INT_LIST);
+    cqi_send_int(last - first + 1);
+    for (i = first; i <= last; i += n) {
+      n = (last - i + 1 < CQI_BULK_BLOCK) ? last - i + 1 : CQI_BULK_BLOCK;
+      for (k = 0; k < n; k++) {
+        if (field == CQI_CONST_FIELD_MATCH)
+          block[k] = cl->range[i + k].start;
+        else if (field == CQI_CONST_FIELD_MATCHEND)
+          block[k] = cl->range[i + k].end;
+        else
+          block[k] = values ? values[i + k] : -1;
+      }
+      send_list_block(block, n);
     }
+    if (cqi_extensions & CQI_EXT_PACKED)
+      cqi_send_packed_end();
     cqi_flush();
   }
 
@@ -1131,15 +1402,7 @@ do_cqi_cqp_fdist_1(void)
     if (table == NULL)
       cqi_command(CQI_CQP_ERROR_GENERAL);
     else {
-      int i, size = table->nr_cells;
-      cqi_send_word(CQI_DATA_INT_TABLE);        /* return table with 2 columns & <size> rows */
-      cqi_send_int(size);
-      cqi_send_int(2);
-      for (i=0; i < size; i++) {
-        cqi_send_int(table->count_cells[i].t);
-        cqi_send_int(table->count_cells[i].freq);
-      }
-      cqi_flush();
+      send_group_table(table, 2);       /* return table with 2 columns & <size> rows */
       free_group(&table);
     }
   }
@@ -1154,7 +1417,6 @@ do_cqi_cqp_fdist_2(void)
 {
   CorpusList *cl;
   Group *table;
-  int i, size;
   const char *field_name1, *field_name2;
   FieldType field_type1 = NoField, field_type2 = NoField;
   int fields_ok = 1;    /* (both) fields valid? */
@@ -1195,16 +1457,7 @@ do_cqi_cqp_fdist_2(void)
     if (!(table = compute_grouping(cl, field_type1, 0, att_name1, field_type2, 0, att_name2, cutoff, 0, NULL)))
       cqi_command(CQI_CQP_ERROR_GENERAL);
     else {
-      size = table->nr_cells;
-      cqi_send_word(CQI_DATA_INT_TABLE);        /* return table with 3 columns & <size> rows */
-      cqi_send_int(size);
-      cqi_send_int(3);
-      for (i=0; i < size; i++) {
-        cqi_send_int(table->count_cells[i].s);
-        cqi_send_int(table->count_cells[i].t);
-        cqi_send_int(table->count_cells[i].freq);
-      }
-      cqi_flush();
+      send_group_table(table, 3);       /* return table with 3 columns & <size> rows */
       free_group(&table);
     }
   }
@@ -1217,22 +1470,18 @@ do_cqi_cqp_fdist_2(void)
 
 /**
  *
- *  The CQP server's command interpreter loop.
+ *  The CQP server's command interpreter.
  *
- *  The loops starts running when this function is called, and when the
- *  exit command is reveived (CQI_CTRL_BYE)
- *  (returns on exit)
+ *  Processes a single command (whose arguments are then read from the connection).
+ *
+ *  @param cmd  The command received from the client.
+ *  @return     False if the client has disconnected (CQI_CTRL_BYE), true otherwise.
  *
  */
-static void
-interpreter(void)
+static int
+interpret_command(int cmd)
 {
-  int cmd;
-  int cmd_group;
-
-  while (42) {
-    cmd = cqi_read_command();
-    cmd_group = cmd >> 8;
+  int cmd_group = cmd >> 8;
 
     switch (cmd_group) {
 
@@ -1245,7 +1494,7 @@ interpreter(void)
       case CQI_CTRL_BYE:
         cqiserver_debug_msg("CQI_CTRL_BYE()");
         cqi_command(CQI_STATUS_BYE_OK);
-        return;                 /* exit CQi command interpreter */
+        return 0;               /* exit CQi command interpreter */
       case CQI_CTRL_USER_ABORT:
         cqiserver_debug_msg("CQI_CTRL_ABORT signal ... ignored");
         break;
@@ -1257,6 +1506,9 @@ interpreter(void)
         cqiserver_debug_msg("CQI_CTRL_LAST_GENERAL_ERROR() => '%s'", cqi_error_string);
         cqi_data_string(cqi_error_string);
         break;
+      case CQI_CTRL_EXTENSIONS:
+        do_cqi_ctrl_extensions();
+        break;
       default:
         cqiserver_unknown_command_error(cmd);
       }
@@ -1277,6 +1529,14 @@ interpreter(void)
         cqiserver_debug_msg("CQI_ASK_FEATURE_CQP_2_3 ... CQP v2.3 ok");
         cqi_data_bool(CQI_CONST_YES);
         break;
+      case CQI_ASK_FEATURE_CL_BULK:
+        cqiserver_debug_msg("CQI_ASK_FEATURE_CL_BULK ... bulk access ok");
+        cqi_data_bool(CQI_CONST_YES);
+        break;
+      case CQI_ASK_FEATURE_EXTENSIONS:
+        cqiserver_debug_msg("CQI_ASK_FEATURE_EXTENSIONS ... protocol extensions ok");
+        cqi_data_bool(CQI_CONST_YES);
+        break;
       default:
         cqiserver_debug_msg("CQI_ASK_FEATURE_* ... <unknown feature> not supported");
         cqi_data_bool(CQI_CONST_NO);
@@ -1372,6 +1632,18 @@ interpreter(void)
       case CQI_CL_ALG2CPOS:
         do_cqi_cl_alg2cpos();
         break;
+      case CQI_CL_CPOS_RANGE2ID:
+        do_cqi_cl_cpos_range2id();
+        break;
+      case CQI_CL_CPOS_RANGE2STR:
+        do_cqi_cl_cpos_range2str();
+        break;
+      case CQI_CL_STRUC_RANGE2CPOS:
+        do_cqi_cl_struc_range2cpos();
+        break;
+      case CQI_CL_LEXICON_FREQS:
+        do_cqi_cl_lexicon_freqs();
+        break;
       default:
         cqiserver_unknown_command_error(cmd);
       }
@@ -1414,10 +1686,70 @@ interpreter(void)
 
     } /* end outer switch */
 
-  } /* end while 42 */
+  return 1;
+}
 
+/**
+ *
+ *  The CQP server's command interpreter loop.
+ *
+ *  The loops starts running when this function is called, and when the
+ *  exit command is reveived (CQI_CTRL_BYE)
+ *  (returns on exit)
+ *
+ */
+static void
+interpreter(void)
+{
+  while (interpret_command(cqi_read_command()))
+    ;
 }
 
+/**
+ * Processes a request of a client in multi-client mode (see cqi_serve_sessions()).
+ *
+ * The first request of a session must be CQI_CTRL_CONNECT; all later ones are
+ * passed on to the command interpreter.
+ *
+ * @param session  The session (which is active).
+ * @return         False if the session has ended, true otherwise.
+ */
+static int
+session_handler(CqiSession *session)
+{
+  int cmd = cqi_read_command();
+
+  if (session->user) {
+    user = session->user;
+    return interpret_command(cmd);
+  }
+
+  /* establish CQi connection: the first request must be CONNECT */
+  if (cmd != CQI_CTRL_CONNECT) {
+    cqiserver_log(Info, "Invalid command received. Connection refused.");
+    return 0;
+  }
+  user = cqi_read_string();
+  passwd = cqi_read_string();
+  cqiserver_log(Info, "CONNECT  user = '%s'  session = #%d", user, session->id);
+
+  /* check password here (always required !!) */
+  if (!authenticate_user(user, passwd)) {
+    cqiserver_log(Error, "Wrong username or password. Connection refused.\n");
+    cqi_command(CQI_ERROR_CONNECT_REFUSED);
+    cl_free(user);
+    cl_free(passwd);
+    user = "";
+    return 0;
+  }
+  cqi_command(CQI_STATUS_CONNECT_OK);
+  session->user = user;
+  cl_free(passwd);
+  passwd = "";
+  return 1;
+}
+
+
 
 
 /**
@@ -1455,6 +1787,13 @@ main(int argc, char *argv[])
   if (localhost)
     add_host_to_list("127.0.0.1"); /* in -L mode, connections from localhost are automatically accepted  */
 
+  if (shared_server) {
+    /* serve all clients from this process; returns only if the server can't be started */
+    cl_randomize();
+    cqi_serve_sessions(server_port, session_handler);
+    exit(cqiserver_log(Error, "ERROR Connection failed.") || cqp_error_status);
+  }
+
   if (0 < accept_connection(server_port))
     cqiserver_log(Info, "Connected. Waiting for CONNECT request.");
   else
@@ -19,9 +19,12 @@
 #define socklen_t int
 #endif
 #include <signal.h>
+#include <setjmp.h>
+#include <errno.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 
 #include <sys/types.h>
@@ -30,8 +33,10 @@
 #ifndef __MINGW__
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
 #endif
 
 
@@ -51,8 +56,21 @@
 
 void Rprintf(const char *, ...);
 
-/** Error strings are limited to this many bytes. @see cqi_error_string */
-#define GENERAL_ERROR_SIZE 1024
+
+/** Size of the stream buffer for the outgoing connection (in bytes) */
+#define CQI_OUTPUT_BUFFER_SIZE 65536
+
+/** Size of the buffer for the incoming connection (in bytes) */
+#define CQI_INPUT_BUFFER_SIZE 65536
+
+/** In multi-client mode, a session is closed if sending or receiving data stalls for this many seconds */
+#define CQI_SESSION_TIMEOUT 10
+
+/** Integer lists are converted to network byte order in blocks of this many values */
+#define CQI_SEND_BLOCK 1024
+
+/** Packed integer lists are sent in chunks of about this many bytes */
+#define CQI_PACK_CHUNK 16384
 
 #ifndef MSG_WAITALL
 /* Linux doesn't define the MSG_WAITALL flag (ditto MinGW), but under normal conditions
@@ -80,6 +98,24 @@ int cqi_errno = CQI_STATUS_OK;    /**< CQi last error */
 /** String describing the last CQi error. This can be queried by the client. */
 char cqi_error_string[GENERAL_ERROR_SIZE] = "No error.";
 
+/** Buffer for incoming data, so that requests are not read from the socket one byte at a time */
+static cqi_byte default_input_buffer[CQI_INPUT_BUFFER_SIZE];
+static cqi_byte *input_buffer = default_input_buffer; /**< the buffer of the current session in multi-client mode */
+static int input_pos = 0;         /**< next unread byte in input_buffer */
+static int input_len = 0;         /**< number of bytes in input_buffer */
+
+/** Protocol extensions the client has asked for (CQI_EXT_* flags, see CQI_CTRL_EXTENSIONS) */
+int cqi_extensions = 0;
+
+static int request_id = 0;        /**< with CQI_EXT_PIPELINE: ID of the request being processed */
+static int response_pending = 0;  /**< with CQI_EXT_PIPELINE: true until the request ID has been sent back */
+static int output_pending = 0;    /**< with CQI_EXT_PIPELINE: true if a flush has been put off */
+
+/** Chunk of a packed integer list that is being sent (CQI_EXT_PACKED) */
+static unsigned char pack_buffer[CQI_PACK_CHUNK + 5];
+static int pack_used = 0;                 /**< number of bytes in pack_buffer */
+static unsigned int pack_previous = 0;    /**< the last integer that was packed (deltas are relative to it) */
+
 
 
 /*
@@ -100,6 +136,7 @@ cqi_send_error(char *function)
 {
 #ifndef R_PACKAGE
   cqiserver_log(Error, "ERROR CQi data send failure in function\n\t%s() <server.c>", function);
+  cqi_end_session();            /* in multi-client mode, only the session is closed */
   exit(1);
 #else
   Rf_error("ERROR CQi data send failure in function\n\t%s() <server.c>", function);
@@ -118,6 +155,7 @@ cqi_recv_error(char *function)
 {
 #ifndef R_PACKAGE
   cqiserver_log(Error, "ERROR CQi data recv failure in function\n\t%s() <server.c>\n", function);
+  cqi_end_session();            /* in multi-client mode, only the session is closed */
   exit(1);
 #else
   Rf_error("ERROR CQi data recv failure in function\n\t%s() <server.c>\n", function);
@@ -137,6 +175,7 @@ cqi_internal_error(char *function, char *cause)
 {
 #ifndef R_PACKAGE
   cqiserver_log(Error, "ERROR Internal error in function\n\t%s() <server.c>\n\t''%s''", function, cause);
+  cqi_end_session();            /* in multi-client mode, only the session is closed */
   exit(1);
 #else
   Rf_error("ERROR Internal error in function\n\t%s() <server.c>\n\t''%s''", function, cause);
@@ -173,43 +212,18 @@ cqi_general_error(char *errstring)
  */
 
 /**
- * Wait for, and then process, an attempt by a client to initiate a connection
- * to cqpserver via TCP/IP.
- *
- * Note that this function may or may not fork the cqpserver process.
- *
- * If forking happens, then the child handles the connection,
- * whereas the parent carries on waiting for further connections.
- *
- * On Windows, forking never happens (since Windows doesn't support it).
+ * Opens the listening socket of the server (global variable sockfd).
  *
- * On *nix, forking happens UNLESS the global private_server is true.
- * (Actually, if private_server is true, then forking still happens,
- * but the parent process immeidately exits.)
+ * If the global server_quit is true, the process forks, and the parent
+ * exits before any connections are accepted.
  *
  * @param port  The integer identifier of the port to listen on.
- * @return      A > 0 value ( the socket ID of the incoming connection)
- *              if all is OK; otherwise -1.
+ * @return      Boolean: true if everything OK, otherwise false.
  */
-int
-accept_connection(int port)
+static int
+open_server_socket(int port)
 {
   const int on = 1;
-  socklen_t sin_size = sizeof(struct sockaddr_in);
-#ifndef __MINGW__
-  pid_t child_pid;
-#endif
-
-#ifndef __MINGW__
-  if (SIG_ERR == signal(SIGCHLD, SIG_IGN)) {
-#ifndef R_PACKAGE
-    perror("ERROR Can't ignore SIGCHLD");
-    exit(1);
-#else
-    Rf_error("ERROR Can't ignore SIGCHLD");
-#endif
-  }
-#endif
 
   if (port <= 0)
     port = CQI_PORT;
@@ -228,7 +242,7 @@ accept_connection(int port)
     char buffer[50];
     snprintf(buffer, 50, "ERROR WSAStartup failed with error: %d\n",err);
     perror(buffer);
-    return -1;
+    return 0;
   }
 #endif
 
@@ -240,7 +254,7 @@ accept_connection(int port)
   if (sockfd == INVALID_SOCKET) {
 #endif
     perror("ERROR Can't create socket");
-    return -1;
+    return 0;
   }
   if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, (const void *)&on, sizeof(int)) < 0)
     perror("WARNING Can't set address reuse option"); /* can be ignored... */
@@ -254,13 +268,14 @@ accept_connection(int port)
   memset(&(my_addr.sin_zero), '\0', 8);
   if (0 != bind(sockfd, (struct sockaddr *)&my_addr, sizeof(struct sockaddr))) {
     perror("ERROR Can't bind socket to port");
-    return -1;
+    return 0;
   }
 
   cqiserver_log(Info, "Waiting for client on port #%d.\n", port);
-  if (0 != listen(sockfd, 5)) {
+  /* in multi-client mode, many clients may connect at the same time: a short queue would drop connection attempts */
+  if (0 != listen(sockfd, shared_server ? SOMAXCONN : 5)) {
     perror("ERROR listen() failed");
-    return -1;
+    return 0;
   }
 
 #ifndef __MINGW__
@@ -281,6 +296,78 @@ accept_connection(int port)
   /* no forking in Windows! */
 #endif
 
+  return 1;
+}
+
+/**
+ * Sets up the outgoing stream (global variable conn_out) of a new connection.
+ *
+ * @param fd  The file descriptor of the connection.
+ * @return    Boolean: true if everything OK, otherwise false.
+ */
+static int
+open_connection_stream(int fd)
+{
+#ifndef __MINGW__
+  const int on = 1;
+
+  /* each reply is flushed as a whole, so don't let Nagle's algorithm hold back its last packet */
+  if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const void *)&on, sizeof(int)) < 0)
+    perror("WARNING Can't disable Nagle's algorithm on CQi connection"); /* can be ignored... */
+
+  /* create a buffered stream to the outgoing connection */
+  if (!(conn_out = fdopen(fd, "w"))) {
+    perror("ERROR Can't switch CQi connection to buffered output");
+    close(fd);
+    return 0;
+  }
+  /* a large buffer lets bulk replies go out in a few big writes */
+  setvbuf(conn_out, NULL, _IOFBF, CQI_OUTPUT_BUFFER_SIZE);
+#endif
+  return 1;
+}
+
+/**
+ * Wait for, and then process, an attempt by a client to initiate a connection
+ * to cqpserver via TCP/IP.
+ *
+ * Note that this function may or may not fork the cqpserver process.
+ *
+ * If forking happens, then the child handles the connection,
+ * whereas the parent carries on waiting for further connections.
+ *
+ * On Windows, forking never happens (since Windows doesn't support it).
+ *
+ * On *nix, forking happens UNLESS the global private_server is true.
+ * (Actually, if private_server is true, then forking still happens,
+ * but the parent process immeidately exits.)
+ *
+ * @param port  The integer identifier of the port to listen on.
+ * @return      A > 0 value ( the socket ID of the incoming connection)
+ *              if all is OK; otherwise -1.
+ */
+int
+accept_connection(int port)
+{
+  socklen_t sin_size = sizeof(struct sockaddr_in);
+#ifndef __MINGW__
+  pid_t child_pid;
+#endif
+
+#ifndef __MINGW__
+  if (SIG_ERR == signal(SIGCHLD, SIG_IGN)) {
+#ifndef R_PACKAGE
+    perror("ERROR Can't ignore SIGCHLD");
+    exit(1);
+#else
+    Rf_error("ERROR Can't ignore SIGCHLD");
+#endif
+  }
+#endif
+
+  if (!open_server_socket(port))
+    return -1;
+
   while (42) {
     /* when run as a private server, we'll only wait for up to 10 seconds */
     if (private_server) {
@@ -370,14 +457,9 @@ accept_connection(int port)
 #endif
   }
 
-#ifndef __MINGW__
-  /* create a buffered stream to the outgoing connection */
-  if (!(conn_out = fdopen(connfd, "w"))) {
-    perror("ERROR Can't switch CQi connection to buffered output");
-    close(connfd);
+  if (!open_connection_stream(connfd))
     return -1;
-  }
-#endif
+
   cqiserver_debug_msg("creating attribute hash (size = %d)", ATTHASHSIZE);
   make_attribute_hash(ATTHASHSIZE);
 
@@ -386,6 +468,315 @@ accept_connection(int port)
 
 
 
+/*
+ *
+ *  Multi-client mode
+ *
+ */
+
+/** Sessions of the connected clients in multi-client mode */
+static CqiSession *sessions = NULL;
+
+/** While a session is processed: where to jump if the session has to be ended */
+static jmp_buf *session_abort = NULL;
+
+/** Corpora on the list before the current session was activated (sorted by address) */
+static CorpusList **shared_corpora = NULL;
+static int n_shared_corpora = 0;
+
+static int
+compare_corpus_pointers(const void *a, const void *b)
+{
+  const CorpusList *x = *(CorpusList * const *)a, *y = *(CorpusList * const *)b;
+  return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+/** Predicate for detach_corpora(): corpora that were created in the current session */
+static Boolean
+session_owns_corpus(CorpusList *cl, void *data)
+{
+  return bsearch(&cl, shared_corpora, n_shared_corpora, sizeof(CorpusList *), compare_corpus_pointers) ? False : True;
+}
+
+/** Predicate for detach_corpora(): system corpora the user (data) may not access */
+static Boolean
+corpus_not_granted(CorpusList *cl, void *data)
+{
+  return (cl->type == SYSTEM && !check_grant((char *)data, cl->name)) ? True : False;
+}
+
+/**
+ * Makes a session the current one: switches the connection and error state
+ * of the CQi server, and the list of corpora, to the session.
+ */
+static void
+activate_session(CqiSession *session)
+{
+  CorpusList *cl;
+  int n = 0;
+
+  connfd = session->fd;
+  conn_out = session->out;
+  input_buffer = session->input;
+  input_pos = session->input_pos;
+  input_len = session->input_len;
+  cqi_errno = session->saved_errno;
+  strcpy(cqi_error_string, session->error_string);
+  cqi_extensions = session->extensions;
+  response_pending = output_pending = 0;
+  pack_used = 0;
+  pack_previous = 0;
+
+  /* remember which corpora are shared by all sessions */
+  for (cl = FirstCorpusFromList(); cl; cl = NextCorpusFromList(cl))
+    n++;
+  shared_corpora = (CorpusList **)cl_realloc(shared_corpora, (n > 0 ? n : 1) * sizeof(CorpusList *));
+  for (n = 0, cl = FirstCorpusFromList(); cl; cl = NextCorpusFromList(cl))
+    shared_corpora[n++] = cl;
+  n_shared_corpora = n;
+  qsort(shared_corpora, n, sizeof(CorpusList *), compare_corpus_pointers);
+
+  attach_corpora(session->corpora);
+  session->corpora = NULL;
+  if (session->user)
+    session->hidden = detach_corpora(corpus_not_granted, session->user);
+
+  /* restore the current corpus, unless it has been dropped in the meantime */
+  for (cl = FirstCorpusFromList(); cl && cl != session->current; cl = NextCorpusFromList(cl))
+    ;
+  set_current_corpus(cl, 0);
+}
+
+/**
+ * Saves the state of the current session and takes its subcorpora
+ * off the list of corpora.
+ */
+static void
+deactivate_session(CqiSession *session)
+{
+  session->input_pos = input_pos;
+  session->input_len = input_len;
+  session->saved_errno = cqi_errno;
+  strcpy(session->error_string, cqi_error_string);
+  session->extensions = cqi_extensions;
+  cqi_extensions = 0;
+
+  session->current = current_corpus;
+  set_current_corpus(NULL, 0);
+
+  attach_corpora(session->hidden);
+  session->hidden = NULL;
+  session->corpora = detach_corpora(session_owns_corpus, NULL);
+
+  input_buffer = default_input_buffer;
+  input_pos = input_len = 0;
+}
+
+/**
+ * Ends the session that is being processed, if the server is in multi-client
+ * mode (called by the error functions instead of exiting the server).
+ *
+ * Returns (and does nothing) if no session is being processed.
+ */
+void
+cqi_end_session(void)
+{
+  if (session_abort)
+    longjmp(*session_abort, 1);
+}
+
+/**
+ * Processes the requests of a session that have arrived.
+ *
+ * @return  Boolean: true if the session continues, false if it has ended.
+ */
+static int
+run_session(CqiSession *session, int (*handler)(CqiSession *session))
+{
+  jmp_buf abort_session;
+  volatile int open = 1;
+
+  activate_session(session);
+  session_abort = &abort_session;
+  if (setjmp(abort_session)) {
+    open = 0;
+    query_lock = 0;             /* in case the session was ended in the middle of a query */
+    pack_used = 0;              /* ... or of a packed integer list */
+    pack_previous = 0;
+  }
+  else {
+    do {
+      open = handler(session);
+      if (open && session->user && !session->hidden)
+        session->hidden = detach_corpora(corpus_not_granted, session->user);
+    } while (open && input_pos < input_len);  /* requests that have already arrived */
+  }
+  session_abort = NULL;
+  deactivate_session(session);
+
+  return open;
+}
+
+/**
+ * Creates a session for a new connection.
+ */
+static CqiSession *
+new_session(int fd)
+{
+  static int id = 0;
+  CqiSession *session;
+  struct timeval tv;
+
+  /* a client that stops in the middle of a request must not block the other sessions for long */
+  tv.tv_sec = CQI_SESSION_TIMEOUT;
+  tv.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const void *)&tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, (const void *)&tv, sizeof(tv));
+
+  if (!open_connection_stream(fd))
+    return NULL;
+
+  session = (CqiSession *)cl_malloc(sizeof(CqiSession));
+  session->fd = fd;
+  session->out = conn_out;
+  session->id = ++id;
+  session->user = NULL;
+  session->input = (cqi_byte *)cl_malloc(CQI_INPUT_BUFFER_SIZE);
+  session->input_pos = session->input_len = 0;
+  session->saved_errno = CQI_STATUS_OK;
+  session->error_string = (char *)cl_malloc(GENERAL_ERROR_SIZE);
+  strcpy(session->error_string, "No error.");
+  session->extensions = 0;
+  session->current = NULL;
+  session->corpora = NULL;
+  session->hidden = NULL;
+  session->next = sessions;
+  sessions = session;
+  return session;
+}
+
+/**
+ * Closes the connection of a session and frees its subcorpora.
+ */
+static void
+close_session(CqiSession *session)
+{
+  CqiSession **prev;
+
+  for (prev = &sessions; *prev != session; prev = &(*prev)->next)
+    ;
+  *prev = session->next;
+
+  cqiserver_log(Info, "Session #%d closed (%d session(s) left).", session->id, cqi_count_sessions());
+  fclose(session->out);         /* also closes session->fd */
+  free_corpora(session->corpora);
+  cl_free(session->user);
+  cl_free(session->input);
+  cl_free(session->error_string);
+  cl_free(session);
+}
+
+/**
+ * Counts the sessions of connected clients in multi-client mode.
+ */
+int
+cqi_count_sessions(void)
+{
+  CqiSession *session;
+  int n = 0;
+
+  for (session = sessions; session; session = session->next)
+    n++;
+  return n;
+}
+
+/**
+ * Serves all clients from this process (multi-client mode).
+ *
+ * Instead of forking a server for each connection (as accept_connection()
+ * does), the server waits for requests on all connections with poll() and
+ * processes them one at a time. All sessions therefore share the loaded
+ * corpora, the memory-mapped data and the query cache, while each session
+ * keeps its own subcorpora and sees only the corpora the user has been
+ * granted access to.
+ *
+ * The handler is called with the session activated whenever a request has
+ * arrived; it should read and process one command. Errors that would end the
+ * server in single-client mode only close the connection of the session.
+ *
+ * @param port     The port to listen on (CQI_PORT if 0).
+ * @param handler  Processes a request of a session; returns false if the
+ *                 session has ended (e.g. after CQI_CTRL_BYE).
+ * @return         -1 if the server could not be started (otherwise, this
+ *                 function does not return).
+ */
+int
+cqi_serve_sessions(int port, int (*handler)(CqiSession *session))
+{
+#ifdef __MINGW__
+  cqiserver_log(Error, "ERROR Multi-client mode is not supported on Windows.");
+  return -1;
+#else
+  struct pollfd *fds = NULL;
+  CqiSession *session, *next;
+  int i, n, fd;
+  socklen_t sin_size;
+
+  if (!open_server_socket(port))
+    return -1;
+
+  /* writing to a client that has gone away must not kill the server */
+  signal(SIGPIPE, SIG_IGN);
+
+  cqiserver_debug_msg("creating attribute hash (size = %d)", ATTHASHSIZE);
+  make_attribute_hash(ATTHASHSIZE);
+
+  while (42) {
+    n = cqi_count_sessions() + 1;
+    fds = (struct pollfd *)cl_realloc(fds, n * sizeof(struct pollfd));
+    fds[0].fd = sockfd;
+    fds[0].events = POLLIN;
+    for (i = 1, session = sessions; session; session = session->next, i++) {
+      fds[i].fd = session->fd;
+      fds[i].events = POLLIN;
+    }
+
+    if (poll(fds, n, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("ERROR poll() failed");
+      return -1;
+    }
+
+    /* the list of sessions is in the same order as fds[] until new sessions are added below */
+    for (i = 1, session = sessions; session; session = next, i++) {
+      next = session->next;
+      if (fds[i].revents)
+        if (!run_session(session, handler))
+          close_session(session);
+    }
+
+    if (fds[0].revents & POLLIN) {
+      sin_size = sizeof(struct sockaddr_in);
+      if (0 > (fd = accept(sockfd, (struct sockaddr *)&client_addr, &sin_size))) {
+        perror("ERROR Can't establish connection");
+        continue;
+      }
+      remote_address = inet_ntoa(client_addr.sin_addr);
+      if (!check_host(client_addr.sin_addr)) {
+        cqiserver_log(Info, "WARNING %s not in list, connection refused!\n", remote_address);
+        close(fd);
+      }
+      else if ((session = new_session(fd)))
+        cqiserver_log(Info, "Connection established with %s (session #%d, %d session(s) open)",
+                      remote_address, session->id, cqi_count_sessions());
+    }
+  }
+#endif
+}
+
+
+
 
 /*
  *
@@ -410,6 +801,12 @@ cqi_flush(void)
 #ifdef __MINGW__
   return 1;
 #else
+  /* with pipelining, responses are held back while further requests are waiting to be processed */
+  if ((cqi_extensions & CQI_EXT_PIPELINE) && input_pos < input_len) {
+    output_pending = 1;
+    return 1;
+  }
+  output_pending = 0;
   cqiserver_snoop("FLUSH");
   if (EOF == fflush(conn_out)) {
     perror("ERROR cqi_flush()");
@@ -471,6 +868,12 @@ cqi_send_byte(int n, int nosnoop)
 int
 cqi_send_word(int n)
 {
+  /* with pipelining, the first word of a response (the response code) is preceded by the request ID */
+  if (response_pending) {
+    response_pending = 0;
+    if (!cqi_send_int(request_id))
+      return 0;
+  }
   cqiserver_snoop("SEND WORD   %04X      [= %d]", n, n);
   if (
       /* exploit the fact that cqi_send_byte() only uses the lowest 8 bytes of its argument */
@@ -510,6 +913,146 @@ cqi_send_int(int n)
   return 1;
 }
 
+/**
+ * Sends a block of raw bytes to the client.
+ *
+ * This function should be called via one of the cqi_data_* functions
+ * and not on its own.
+ *
+ * @param buf    pointer to the bytes to send.
+ * @param bytes  the number of bytes to send.
+ *
+ * @return  Boolean: true if everything OK, otherwise false.
+ */
+int
+cqi_send_bytes(const cqi_byte *buf, int bytes)
+{
+#ifndef __MINGW__
+  if (bytes > 0 && bytes != fwrite(buf, 1, bytes, conn_out)) {
+    perror("ERROR cqi_send_bytes()");
+    return 0;
+  }
+#else
+  int sent;
+
+  while (bytes > 0) {
+    if (0 >= (sent = send(connfd, buf, bytes, 0))) {
+      perror("ERROR cqi_send_bytes()");
+      return 0;
+    }
+    buf += sent;
+    bytes -= sent;
+  }
+#endif
+  return 1;
+}
+
+/**
+ * Sends a sequence of INTs to the client, without a length prefix.
+ *
+ * The integers are converted to network order in blocks, and each block
+ * is passed to the outgoing stream in one go; this is much faster than
+ * sending the integers one byte at a time for long lists.
+ *
+ * This function should be called via one of the cqi_data_* functions
+ * and not on its own.
+ *
+ * @param list  pointer to a block of integers to send.
+ * @param l     the number of integers to send.
+ *
+ * @return  Boolean: true if everything OK, otherwise false.
+ */
+int
+cqi_send_int_array(const int *list, int l)
+{
+  unsigned char buf[4 * CQI_SEND_BLOCK];
+  int i, n;
+  unsigned int x;
+
+  cqiserver_snoop("SEND INT[%d]", l);
+  while (l > 0) {
+    n = (l < CQI_SEND_BLOCK) ? l : CQI_SEND_BLOCK;
+    for (i = 0; i < n; i++) {
+      x = (unsigned int)list[i];
+      buf[4*i]   = x >> 24;
+      buf[4*i+1] = x >> 16;
+      buf[4*i+2] = x >> 8;
+      buf[4*i+3] = x;
+    }
+    if (!cqi_send_bytes((cqi_byte *)buf, 4 * n)) {
+      perror("ERROR cqi_send_int_array()");
+      return 0;
+    }
+    list += n;
+    l -= n;
+  }
+  return 1;
+}
+
+/** Sends the chunk of packed integers collected so far. */
+static int
+cqi_send_packed_chunk(void)
+{
+  if (!cqi_send_int(pack_used) || !cqi_send_bytes((cqi_byte *)pack_buffer, pack_used)) {
+    perror("ERROR cqi_send_packed_chunk()");
+    return 0;
+  }
+  pack_used = 0;
+  return 1;
+}
+
+/**
+ * Sends a sequence of INTs to the client in packed form (CQI_EXT_PACKED).
+ *
+ * Each integer is stored as the difference to the previous one, zigzag-encoded
+ * and written as a varint, so that sorted corpus positions and frequencies
+ * mostly take one or two bytes. The bytes are sent in chunks with a length
+ * prefix; the sequence may be continued with further calls and has to be
+ * finished with cqi_send_packed_end().
+ *
+ * This function should be called via one of the cqi_data_* functions
+ * and not on its own.
+ *
+ * @param list  pointer to a block of integers to send.
+ * @param l     the number of integers to send.
+ *
+ * @return  Boolean: true if everything OK, otherwise false.
+ */
+int
+cqi_send_packed_ints(const int *list, int l)
+{
+  unsigned int delta, x;
+  int i;
+
+  cqiserver_snoop("SEND PACKED INT[%d]", l);
+  for (i = 0; i < l; i++) {
+    delta = (unsigned int)list[i] - pack_previous;
+    pack_previous = (unsigned int)list[i];
+    x = (delta << 1) ^ (0U - (delta >> 31)); /* zigzag: small negative differences become small numbers, too */
+    while (x >= 0x80) {
+      pack_buffer[pack_used++] = (x & 0x7f) | 0x80;
+      x >>= 7;
+    }
+    pack_buffer[pack_used++] = x;
+    if (pack_used >= CQI_PACK_CHUNK && !cqi_send_packed_chunk())
+      return 0;
+  }
+  return 1;
+}
+
+/**
+ * Finishes a sequence of packed INTs: sends the last chunk and starts
+ * the differences of the next sequence from 0 again.
+ *
+ * @return  Boolean: true if everything OK, otherwise false.
+ */
+int
+cqi_send_packed_end(void)
+{
+  pack_previous = 0;
+  return (pack_used > 0) ? cqi_send_packed_chunk() : 1;
+}
+
 
 /**
  * Sends a STRING to the client.
@@ -543,12 +1086,10 @@ cqi_send_string(const char *str)
   }
   cqiserver_snoop("SEND CHAR[] '%s'", str);
 
-  /* we can afford to mangle len and str because we're at the end of the function */
-  while (--len >= 0)
-    if (!cqi_send_byte(*str++, 1)) {
-      perror("ERROR cqi_send_string()");
-      return 0;
-    }
+  if (!cqi_send_bytes(str, len)) {
+    perror("ERROR cqi_send_string()");
+    return 0;
+  }
 
   return 1;
 }
@@ -597,16 +1138,10 @@ cqi_send_byte_list(cqi_byte *list, int l, int as_boolean)
 int
 cqi_send_int_list(int *list, int l)
 {
-  if (!cqi_send_int(l)) {
+  if (!cqi_send_int(l) || !cqi_send_int_array(list, l)) {
     perror("ERROR cqi_send_int_list()");
     return 0;
   }
-  while (--l >= 0) {
-    if (!cqi_send_int(*list++)) {
-      perror("ERROR cqi_send_int_list()");
-      return 0;
-    }
-  }
   return 1;
 }
 
@@ -787,15 +1322,49 @@ cqi_data_int_int_int_int(int n1, int n2, int n3, int n4)
  *
  */
 
+/**
+ * Refills the buffer for incoming data.
+ *
+ * Blocks until at least one byte has arrived, then reads as much data
+ * as is available (up to the size of the buffer).
+ *
+ * @return  Boolean: true if everything OK, otherwise false.
+ */
+static int
+cqi_fill_input_buffer(void)
+{
+  int n;
+
+  /* responses held back for pipelining must go out before we wait for the client */
+  if (output_pending && !cqi_flush())
+    return 0;
+  n = recv(connfd, input_buffer, CQI_INPUT_BUFFER_SIZE, 0);
+
+  if (n <= 0)
+    return 0;
+  input_pos = 0;
+  input_len = n;
+  return 1;
+}
+
 int
 cqi_recv_bytes(cqi_byte *buf, int bytes)
 {
+  int n;
+
   if (bytes <= 0)
     return 1;
   cqiserver_snoop("RECV BYTE[%d]", bytes);
-  if (bytes != recv(connfd, buf, bytes, MSG_WAITALL)) {
-    perror("ERROR cqi_recv_bytes()");
-    return 0;
+  while (bytes > 0) {
+    if (input_pos >= input_len && !cqi_fill_input_buffer()) {
+      perror("ERROR cqi_recv_bytes()");
+      return 0;
+    }
+    n = (bytes < input_len - input_pos) ? bytes : input_len - input_pos;
+    memcpy(buf, input_buffer + input_pos, n);
+    input_pos += n;
+    buf += n;
+    bytes -= n;
   }
   return 1;
 }
@@ -803,11 +1372,12 @@ cqi_recv_bytes(cqi_byte *buf, int bytes)
 int
 cqi_recv_byte(void)
 {
-  cqi_byte b;
-  if (1 != recv(connfd, &b, 1, MSG_WAITALL)) {
+  unsigned char b;              /* cqi_byte is signed, but bytes >= 0x80 must not be sign-extended */
+  if (input_pos >= input_len && !cqi_fill_input_buffer()) {
     perror("ERROR cqi_recv_byte()");
     return EOF;
   }
+  b = input_buffer[input_pos++];
   cqiserver_snoop("RECV BYTE 0x%02X", b);
   return b;
 }
@@ -877,6 +1447,10 @@ cqi_read_command(void)
   while (command == CQI_PAD)
     command = cqi_read_byte();
   command = (command << 8) | cqi_read_byte();
+  if (cqi_extensions & CQI_EXT_PIPELINE) {
+    request_id = cqi_read_int();
+    response_pending = 1;
+  }
   return command;
 }
 
@@ -33,9 +33,16 @@ extern int cqi_errno;
    cqi_general_error(s) sends a CQI_ERROR_GENERAL_ERROR command and sets
    copies <s> into <cqi_error_string>. The CQI_CTRL_LAST_GENERAL_ERROR()
    function will then return <cqi_error_string> as a STRING */
+/** Error strings are limited to this many bytes. @see cqi_error_string */
+#define GENERAL_ERROR_SIZE 1024
 extern char cqi_error_string[];
 void cqi_general_error(char *errstring);
 
+/* protocol extensions (CQI_EXT_* flags) negotiated with CQI_CTRL_EXTENSIONS;
+   with CQI_EXT_PIPELINE, cqi_read_command() also reads the request ID, which is
+   then sent back in front of the response */
+extern int cqi_extensions;
+
 /* server-side console debug / snooping (on stderr) */
 void cqiserver_snoop(const char *format, ...);
 void cqiserver_debug_msg(const char *format, ...);
@@ -45,12 +52,47 @@ void cqiserver_debug_msg(const char *format, ...);
    port  ...  bind to this port; uses CQI_PORT if port==0 */
 int accept_connection(int port);
 
+/**
+ * A client connection in multi-client mode (see cqi_serve_sessions()).
+ *
+ * While a request of the session is processed, the connection, the error
+ * state and the list of corpora are those of the session; in between,
+ * its subcorpora are kept off the list of corpora.
+ */
+typedef struct _CqiSession {
+  int fd;                       /**< connection file descriptor */
+  FILE *out;                    /**< buffered stream for outgoing data */
+  int id;                       /**< session number (for log messages) */
+  char *user;                   /**< user name; set by the handler when the client has connected */
+  cqi_byte *input;              /**< buffer for incoming data */
+  int input_pos;                /**< next unread byte in the input buffer */
+  int input_len;                /**< number of bytes in the input buffer */
+  int saved_errno;              /**< cqi_errno of the session */
+  char *error_string;           /**< cqi_error_string of the session */
+  int extensions;               /**< protocol extensions of the session */
+  CorpusList *current;          /**< current corpus of the session */
+  CorpusList *corpora;          /**< subcorpora of the session (while it is not active) */
+  CorpusList *hidden;           /**< corpora the user may not access (while the session is active) */
+  struct _CqiSession *next;
+} CqiSession;
+
+/* cqi_serve_sessions serves all clients from the current process; the handler
+   processes one request of the active session and returns false when the session
+   has ended; returns -1 if the server can't be started (otherwise it doesn't return) */
+int cqi_serve_sessions(int port, int (*handler)(CqiSession *session));
+int cqi_count_sessions(void);
+void cqi_end_session(void);   /* called on fatal errors; closes the session in multi-client mode */
+
 /* CQi network primitives (no auto-flush) */
 int cqi_flush(void);
 int cqi_send_byte(int n, int nosnoop);
 int cqi_send_word(int n);
 int cqi_send_int(int n);
 int cqi_send_string(const char *str);	/* NULL pointer sends "" */
+int cqi_send_bytes(const cqi_byte *buf, int bytes);
+int cqi_send_int_array(const int *list, int length); /* without length prefix */
+int cqi_send_packed_ints(const int *list, int length); /* delta/varint chunks (CQI_EXT_PACKED) */
+int cqi_send_packed_end(void);
 int cqi_send_byte_list(cqi_byte *list, int length, int as_boolean);
 int cqi_send_int_list(int *list, int length);
 int cqi_send_string_list(char **list, int length);
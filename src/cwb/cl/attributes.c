@@ -19,6 +19,9 @@ void Rprintf(const char *, ...);
 
 #include <ctype.h>
 #include <sys/types.h>
+#ifndef __MINGW__
+#include <dlfcn.h>
+#endif
 
 #include "globals.h"
 
@@ -373,6 +376,13 @@ setup_attribute(Corpus *corpus, char *attribute_name, int type, char *data)
     attr->struc.has_attribute_values = -1; /* not yet known */
     break;
 
+  case ATT_DYN:
+    attr->dyn.func = NULL;
+    attr->dyn.func_data = NULL;
+    attr->dyn.plugin_handle = NULL;
+    attr->dyn.plugin_failed = 0;
+    break;
+
   default:
     break;
   }
@@ -470,6 +480,10 @@ cl_delete_attribute(Attribute *attribute)
     cl_free(attribute->pos.hc);
     break;
   case ATT_DYN:
+#ifndef __MINGW__
+    if (attribute->dyn.plugin_handle)
+      dlclose(attribute->dyn.plugin_handle);
+#endif
     cl_free(attribute->dyn.call);
     while (attribute->dyn.arglist != NULL) {
       arg = attribute->dyn.arglist;
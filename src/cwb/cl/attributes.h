@@ -37,6 +37,8 @@ typedef struct _dyn_arg {
 
 DynArg *makearg(char *type_id);
 
+ClDynamicFunction dynamic_load_plugin(Attribute *attribute);
+
 /* ================================================== Huffman compressed item seq */
 
 /** The number of integers in the p-attribute Huffmann code decompression block. */
@@ -194,6 +196,10 @@ typedef struct {
   char *call;
   int res_type;
   DynArg *arglist;
+  ClDynamicFunction func;           /**< in-process implementation; if NULL, call is run by popen() */
+  void *func_data;                  /**< data passed to func */
+  void *plugin_handle;              /**< handle of the shared library func was loaded from (or NULL) */
+  int plugin_failed;                /**< boolean: loading the plugin named by call has failed */
 } Dynamic_Attribute;
 
 
@@ -24,15 +24,65 @@
 /**
  * Size of the actual field of a Bitfield (in bytes).
  */
-static int BaseTypeSize = sizeof(BFBaseType);
+#define BaseTypeSize ((int)sizeof(BFBaseType))
 
 /**
  * Size of the actual field of a Bitfield (in bits).
  */
-static int BaseTypeBits = sizeof(BFBaseType) * CHAR_BIT;
+#define BaseTypeBits ((int)(sizeof(BFBaseType) * CHAR_BIT))
+
+/** Mask for a single bit within a word of the Bitfield. */
+#define BF_BIT(element) (((BFBaseType)1) << ((element) % BaseTypeBits))
+
 void Rprintf(const char *, ...);
 
 
+/**
+ * Counts the bits set in a word of a Bitfield (using the CPU's popcount instruction if available).
+ */
+static int
+bf_word_popcount(BFBaseType word)
+{
+#if defined(__GNUC__)
+  return __builtin_popcountll(word);
+#else
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/**
+ * Gets the offset of the lowest bit set in a word of a Bitfield (which must not be 0).
+ */
+static int
+bf_word_lowest_bit(BFBaseType word)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  int n = 0;
+  while (!(word & 1)) {
+    word >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * Gets the mask of the used bits in the last word of a Bitfield
+ * (all bits set if the last word is fully used).
+ */
+static BFBaseType
+bf_last_word_mask(Bitfield bitfield)
+{
+  int used = bitfield->elements % BaseTypeBits;
+  return (used == 0) ? ~((BFBaseType)0) : (BF_BIT(used) - 1);
+}
+
+
 /**
  * Create a new Bitfield object.
  *
@@ -114,7 +164,7 @@ set_bit(Bitfield bitfield, int element)
 {
   if (bitfield && element < bitfield->elements) {
     BFBaseType v1 = bitfield->field[element/BaseTypeBits];
-    bitfield->field[element/BaseTypeBits] |= (1<<(element % BaseTypeBits));
+    bitfield->field[element/BaseTypeBits] |= BF_BIT(element);
 
     if (bitfield->field[element/BaseTypeBits] != v1)
       bitfield->nr_bits_set++;
@@ -144,7 +194,7 @@ clear_bit(Bitfield bitfield, int element)
 {
   if (bitfield && element < bitfield->elements) {
     BFBaseType v1 = bitfield->field[element/BaseTypeBits];
-    bitfield->field[element/BaseTypeBits] &= ~(1<<(element % BaseTypeBits));
+    bitfield->field[element/BaseTypeBits] &= ~BF_BIT(element);
 
     if (bitfield->field[element/BaseTypeBits] != v1)
       bitfield->nr_bits_set--;
@@ -171,7 +221,7 @@ clear_all_bits(Bitfield bitfield)
 }
 
 /**
- * Sets an entire Bitfield (ie sets all bits to 1, all bytes to 0xff).
+ * Sets an entire Bitfield (ie sets all bits to 1).
  *
  * @return  False if passed a NULL pointer; otherwise true.
  */
@@ -180,6 +230,8 @@ set_all_bits(Bitfield bitfield)
 {
   if (bitfield) {
     memset((char *)bitfield->field, 0xff, bitfield->bytes);
+    if (bitfield->bytes > 0)
+      bitfield->field[bitfield->bytes / BaseTypeSize - 1] &= bf_last_word_mask(bitfield); /* keep unused bits at 0 */
     bitfield->nr_bits_set = bitfield->elements;
     return 1;
   }
@@ -199,7 +251,7 @@ int
 get_bit(Bitfield bitfield, int element)
 {
   if (bitfield && element < bitfield->elements)
-    return ( 0 == (bitfield->field[element/BaseTypeBits] & (1<<(element % BaseTypeBits))) ) ? 0 : 1;
+    return ( 0 == (bitfield->field[element/BaseTypeBits] & BF_BIT(element)) ) ? 0 : 1;
   Rprintf("Illegal offset %d in get_bit\n", element);
   return -1;
 }
@@ -222,12 +274,11 @@ int
 toggle_bit(Bitfield bitfield, int element)
 {
   if (bitfield && element < bitfield->elements) {
-    if ((bitfield->field[element/BaseTypeBits]
-         & (1<<(element % BaseTypeBits))) == 0)
+    if ((bitfield->field[element/BaseTypeBits] & BF_BIT(element)) == 0)
       bitfield->nr_bits_set++;
     else
       bitfield->nr_bits_set--;
-    bitfield->field[element/BaseTypeBits] ^= (1<<(element % BaseTypeBits));
+    bitfield->field[element/BaseTypeBits] ^= BF_BIT(element);
     return 1;
   }
   Rprintf("Illegal offset %d in toggle_bit\n", element);
@@ -245,7 +296,8 @@ toggle_bit(Bitfield bitfield, int element)
 int
 bf_equal(Bitfield bf1, Bitfield bf2)
 {
-  int i, items, last_item_bits_used, mask;
+  int i, items, last_item_bits_used;
+  BFBaseType mask;
 
   assert(bf1->elements == bf2->elements);
   assert(bf1->bytes == bf2->bytes);
@@ -255,7 +307,7 @@ bf_equal(Bitfield bf1, Bitfield bf2)
 
   if (0 != last_item_bits_used) {
     items--; /* check last, partially used item (i.e. field[items-1]) separately */
-    mask = (1 << last_item_bits_used) - 1; /* should set first <last_item_bits_used> bits in mask */
+    mask = BF_BIT(last_item_bits_used) - 1; /* should set first <last_item_bits_used> bits in mask */
     if (((bf1->field[items] ^ bf2->field[items]) & mask) != 0)
       return 0;
   }
@@ -278,8 +330,8 @@ bf_equal(Bitfield bf1, Bitfield bf2)
 int
 bf_compare(Bitfield bf1, Bitfield bf2)
 {
-  int i, items, last_item_bits_used, mask;
-  signed long diff;
+  int i, items, last_item_bits_used;
+  BFBaseType mask, v1, v2;
 
   assert(bf1->elements == bf2->elements);
   assert(bf1->bytes == bf2->bytes);
@@ -287,23 +339,18 @@ bf_compare(Bitfield bf1, Bitfield bf2)
   items = bf1->bytes / BaseTypeSize;
   last_item_bits_used = bf1->elements % BaseTypeBits;
 
-  if (last_item_bits_used != 0)
-    items--; /* check last, partially used item (i.e. field[items-1]) separately (below) */
-
   for (i = 0; i < items; i++) {
-    diff = ((signed long) bf1->field[i]) - ((signed long) bf2->field[i]);
-    if (0 > diff)
-      return -1;
-    else if (diff > 0)
-      return 1;
-  }
-
-  if (0 != last_item_bits_used) {
-    mask = (1 << last_item_bits_used) - 1; /* should set first <last_item_bits_used> bits in mask */
-    diff = ((signed long) (bf1->field[i] & mask)) - ((signed long) (bf2->field[i] & mask));
-    if (diff < 0)
+    v1 = bf1->field[i];
+    v2 = bf2->field[i];
+    if (i == items - 1 && last_item_bits_used != 0) {
+      /* last, partially used item */
+      mask = BF_BIT(last_item_bits_used) - 1; /* should set first <last_item_bits_used> bits in mask */
+      v1 &= mask;
+      v2 &= mask;
+    }
+    if (v1 < v2)
       return -1;
-    else if (diff > 0)
+    else if (v1 > v2)
       return 1;
   }
 
@@ -320,3 +367,257 @@ nr_bits_set(Bitfield bitfield)
   return bitfield->nr_bits_set;
 }
 
+/**
+ * Sets all bits in a range of a Bitfield to 1.
+ *
+ * Whole words of the Bitfield are set at once; the number of bits set is
+ * updated accordingly.
+ *
+ * @param bitfield  The Bitfield to work with.
+ * @param first     Offset of the first bit to set.
+ * @param last      Offset of the last bit to set (the range is empty if last < first).
+ * @return          Boolean: false if the range is not within the Bitfield.
+ */
+int
+set_bit_range(Bitfield bitfield, int first, int last)
+{
+  int w, first_word, last_word;
+  BFBaseType mask;
+
+  if (!bitfield || first < 0 || last >= bitfield->elements) {
+    Rprintf("Illegal range %d..%d in set_bit_range\n", first, last);
+    return 0;
+  }
+
+  first_word = first / BaseTypeBits;
+  last_word = last / BaseTypeBits;
+  for (w = first_word; w <= last_word && first <= last; w++) {
+    mask = ~((BFBaseType)0);
+    if (w == first_word)
+      mask &= ~(BF_BIT(first) - 1);
+    if (w == last_word && (last + 1) % BaseTypeBits != 0)
+      mask &= BF_BIT(last + 1) - 1;
+    bitfield->nr_bits_set += bf_word_popcount(mask & ~bitfield->field[w]);
+    bitfield->field[w] |= mask;
+  }
+  return 1;
+}
+
+/**
+ * Sets all bits in a range of a Bitfield to 0.
+ *
+ * Whole words of the Bitfield are cleared at once; the number of bits set is
+ * updated accordingly.
+ *
+ * @param bitfield  The Bitfield to work with.
+ * @param first     Offset of the first bit to clear.
+ * @param last      Offset of the last bit to clear (the range is empty if last < first).
+ * @return          Boolean: false if the range is not within the Bitfield.
+ */
+int
+clear_bit_range(Bitfield bitfield, int first, int last)
+{
+  int w, first_word, last_word;
+  BFBaseType mask;
+
+  if (!bitfield || first < 0 || last >= bitfield->elements) {
+    Rprintf("Illegal range %d..%d in clear_bit_range\n", first, last);
+    return 0;
+  }
+
+  first_word = first / BaseTypeBits;
+  last_word = last / BaseTypeBits;
+  for (w = first_word; w <= last_word && first <= last; w++) {
+    mask = ~((BFBaseType)0);
+    if (w == first_word)
+      mask &= ~(BF_BIT(first) - 1);
+    if (w == last_word && (last + 1) % BaseTypeBits != 0)
+      mask &= BF_BIT(last + 1) - 1;
+    bitfield->nr_bits_set -= bf_word_popcount(mask & bitfield->field[w]);
+    bitfield->field[w] &= ~mask;
+  }
+  return 1;
+}
+
+/**
+ * Finds the next bit set to 1 in a Bitfield.
+ *
+ * This skips over words without any bits set, so iterating over the set bits of a
+ * sparse Bitfield with this function is much faster than testing all bits with get_bit():
+ *
+ * for (i = bf_next_set_bit(bf, 0); i >= 0; i = bf_next_set_bit(bf, i + 1)) ...
+ *
+ * @param bitfield  The Bitfield to search.
+ * @param element   Offset where the search starts.
+ * @return          Offset of the first bit set at or after element, or -1 if there is none.
+ */
+int
+bf_next_set_bit(Bitfield bitfield, int element)
+{
+  int w, words;
+  BFBaseType word;
+
+  if (!bitfield || element >= bitfield->elements)
+    return -1;
+  if (element < 0)
+    element = 0;
+
+  words = bitfield->bytes / BaseTypeSize;
+  w = element / BaseTypeBits;
+  word = bitfield->field[w] & ~(BF_BIT(element) - 1);
+  while (word == 0) {
+    if (++w >= words)
+      return -1;
+    word = bitfield->field[w];
+  }
+  return w * BaseTypeBits + bf_word_lowest_bit(word); /* unused bits are 0, so this is < elements */
+}
+
+/**
+ * Finds the next bit set to 0 in a Bitfield.
+ *
+ * @see             bf_next_set_bit
+ * @param bitfield  The Bitfield to search.
+ * @param element   Offset where the search starts.
+ * @return          Offset of the first bit cleared at or after element, or -1 if there is none.
+ */
+int
+bf_next_clear_bit(Bitfield bitfield, int element)
+{
+  int w, words;
+  BFBaseType word;
+
+  if (!bitfield || element >= bitfield->elements)
+    return -1;
+  if (element < 0)
+    element = 0;
+
+  words = bitfield->bytes / BaseTypeSize;
+  w = element / BaseTypeBits;
+  word = ~bitfield->field[w] & ~(BF_BIT(element) - 1);
+  while (word == 0) {
+    if (++w >= words)
+      return -1;
+    word = ~bitfield->field[w];
+  }
+  element = w * BaseTypeBits + bf_word_lowest_bit(word);
+  return (element < bitfield->elements) ? element : -1;
+}
+
+/**
+ * Counts the bits set to 1 in a Bitfield.
+ *
+ * Unlike nr_bits_set(), which returns the count maintained by the functions
+ * modifying the Bitfield, this function counts the bits (a word at a time)
+ * and updates the stored count.
+ *
+ * @return  The number of bits set, or -1 if passed a NULL pointer.
+ */
+int
+bf_popcount(Bitfield bitfield)
+{
+  int w, words, n = 0;
+
+  if (!bitfield)
+    return -1;
+  words = bitfield->bytes / BaseTypeSize;
+  for (w = 0; w < words; w++)
+    n += bf_word_popcount(bitfield->field[w]);
+  bitfield->nr_bits_set = n;
+  return n;
+}
+
+/** The word-level operations of bf_combine(). */
+typedef enum { BfAnd, BfOr, BfXor, BfAndNot } BfOperation;
+
+/**
+ * Combines two Bitfield objects word by word, storing the result in the first one.
+ *
+ * The Bitfields combined must have the same number of elements!
+ */
+static int
+bf_combine(Bitfield target, Bitfield source, BfOperation op)
+{
+  int w, words, n = 0;
+  BFBaseType *t, *s;
+
+  if (!target || !source)
+    return 0;
+  assert(target->elements == source->elements);
+
+  t = target->field;
+  s = source->field;
+  words = target->bytes / BaseTypeSize;
+  switch (op) {
+  case BfAnd:
+    for (w = 0; w < words; w++)
+      n += bf_word_popcount(t[w] &= s[w]);
+    break;
+  case BfOr:
+    for (w = 0; w < words; w++)
+      n += bf_word_popcount(t[w] |= s[w]);
+    break;
+  case BfXor:
+    for (w = 0; w < words; w++)
+      n += bf_word_popcount(t[w] ^= s[w]);
+    break;
+  case BfAndNot:
+    for (w = 0; w < words; w++)
+      n += bf_word_popcount(t[w] &= ~s[w]);
+    break;
+  }
+  target->nr_bits_set = n;
+  return 1;
+}
+
+/**
+ * Computes the intersection of two Bitfields (target = target AND source).
+ *
+ * The Bitfields must have the same number of elements.
+ *
+ * @return  False if passed a NULL pointer; otherwise true.
+ */
+int
+bf_and(Bitfield target, Bitfield source)
+{
+  return bf_combine(target, source, BfAnd);
+}
+
+/**
+ * Computes the union of two Bitfields (target = target OR source).
+ *
+ * The Bitfields must have the same number of elements.
+ *
+ * @return  False if passed a NULL pointer; otherwise true.
+ */
+int
+bf_or(Bitfield target, Bitfield source)
+{
+  return bf_combine(target, source, BfOr);
+}
+
+/**
+ * Computes the symmetric difference of two Bitfields (target = target XOR source).
+ *
+ * The Bitfields must have the same number of elements.
+ *
+ * @return  False if passed a NULL pointer; otherwise true.
+ */
+int
+bf_xor(Bitfield target, Bitfield source)
+{
+  return bf_combine(target, source, BfXor);
+}
+
+/**
+ * Computes the difference of two Bitfields (target = target AND NOT source).
+ *
+ * The Bitfields must have the same number of elements.
+ *
+ * @return  False if passed a NULL pointer; otherwise true.
+ */
+int
+bf_andnot(Bitfield target, Bitfield source)
+{
+  return bf_combine(target, source, BfAndNot);
+}
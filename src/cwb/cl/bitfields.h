@@ -22,17 +22,24 @@
 #include "globals.h"
 
 #include <limits.h>
+#include <stdint.h>
 
-typedef unsigned char BFBaseType;
+/**
+ * The unit of storage of a Bitfield: bits are processed a whole word at a time
+ * by the bulk operations (bf_and() etc.), by the range operations and by
+ * the functions that search for set bits.
+ */
+typedef uint64_t BFBaseType;
 
 /**
  * Underlying storage of Bitfield object.
  */
 typedef struct BFBuf {
   int elements;         /**< The number of bits in the bitfield */
-  int bytes;            /**< The number of bytes the bitfield occupies */
+  int bytes;            /**< The number of bytes the bitfield occupies (a multiple of sizeof(BFBaseType)) */
   int nr_bits_set;      /**< The number of bits whose value has been assigned. Initialised to 0. */
-  BFBaseType *field;    /**< the bitfield data itself. All elements initialised to 0. */
+  BFBaseType *field;    /**< the bitfield data itself. All elements initialised to 0; unused bits
+                             in the last word are always 0. */
 } BFBuf;
 
 
@@ -61,6 +68,24 @@ int toggle_bit(Bitfield bitfield, int element);
 
 int nr_bits_set(Bitfield bitfield);
 
+int set_bit_range(Bitfield bitfield, int first, int last);
+
+int clear_bit_range(Bitfield bitfield, int first, int last);
+
+int bf_next_set_bit(Bitfield bitfield, int element);
+
+int bf_next_clear_bit(Bitfield bitfield, int element);
+
+int bf_popcount(Bitfield bitfield);
+
+int bf_and(Bitfield target, Bitfield source);
+
+int bf_or(Bitfield target, Bitfield source);
+
+int bf_xor(Bitfield target, Bitfield source);
+
+int bf_andnot(Bitfield target, Bitfield source);
+
 int bf_equal(Bitfield bf1, Bitfield bf2);
 
 int bf_compare(Bitfield bf1, Bitfield bf2);
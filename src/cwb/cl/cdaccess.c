@@ -20,6 +20,9 @@
 #include <ctype.h>
 #include <sys/types.h>
 #include <errno.h>
+#ifndef __MINGW__
+#include <dlfcn.h>
+#endif
 
 #include "globals.h"
 
@@ -39,8 +42,23 @@ void Rprintf(const char *, ...);
 
 /**
  * Error number for CL: is set after access to any of various corpus-data-access functions.
+ *
+ * Each thread has its own error number.
+ */
+CL_THREAD_LOCAL int cl_errno = CDA_OK;
+
+/** Number of decompression buffers of each thread started by cl_parallel() */
+#define WORKER_BLOCKS 4
+
+/**
+ * Decompression buffers of a thread started by cl_parallel(), used by cl_cpos2id()
+ * instead of the buffer of the attribute (one per attribute, as far as possible).
  */
-int cl_errno = CDA_OK;
+static CL_THREAD_LOCAL struct {
+  Attribute *attribute;
+  int block_nr;
+  int block[SYNCHRONIZATION];
+} worker_block[WORKER_BLOCKS];
 
 /**
  * Macro to test for one of the two component state values that boil down to
@@ -1002,6 +1020,75 @@ cl_read_stream(PositionStream ps, int *buffer, int buffer_size)
 
 
 
+/**
+ * Decompresses one block of the compressed item sequence of a p-attribute.
+ *
+ * The components of the compressed item sequence must have been loaded
+ * already. The function does not modify the attribute, so it can be called
+ * by different threads at the same time.
+ *
+ * @param attribute  The P-attribute.
+ * @param block      The number of the block (corpus position / SYNCHRONIZATION).
+ * @param dest       Buffer of SYNCHRONIZATION integers for the lexicon IDs.
+ * @return           CDA_OK, or CDA_ENODATA if the data cannot be read.
+ */
+static int
+decompress_block(Attribute *attribute, unsigned int block, int *dest)
+{
+  Component *cis      = attribute->any.components[CompHuffSeq];
+  Component *cis_sync = attribute->any.components[CompHuffSync];
+  BStream bs;
+
+  unsigned char bit;
+  unsigned int offset, max, v, l, i;
+
+  /* is the block we read the last block of the corpus? Then, we
+   * cannot read SYNC items, but only as much as there are left.
+   * */
+
+  max = attribute->pos.hc->length - block * SYNCHRONIZATION;
+  if (max > SYNCHRONIZATION)
+    max = SYNCHRONIZATION;
+
+  offset = ntohl(cis_sync->data.data[block]);
+
+  if (COMPRESS_DEBUG > 1)
+    Rprintf("-> Block %d, offset %d\n", block, offset);
+
+  BSopen((unsigned char *)cis->data.data, "r", &bs);
+  BSseek(&bs, offset);
+
+  for (i = 0; i < max; i++) {
+    if (!BSread(&bit, 1, &bs)) {
+      if (!cl_worker_thread)     /* threads started by cl_parallel() must not call R: the caller reports the error */
+        Rprintf("cdaccess:decompressed read: Read error/1\n");
+      return CDA_ENODATA;
+    }
+
+    v = (bit ? 1 : 0);
+    l = 1;
+
+    while (v < attribute->pos.hc->min_code[l]) {
+      if (!BSread(&bit, 1, &bs)) {
+        if (!cl_worker_thread)
+          Rprintf("cdaccess:decompressed read: Read error/2\n");
+        return CDA_ENODATA;
+      }
+
+      v <<= 1;
+      if (bit)
+        v++;
+      l++;
+    }
+
+    /* we now have the item - store it in the decompression block */
+    dest[i] = ntohl(attribute->pos.hc->symbols[attribute->pos.hc->symindex[l] + v - attribute->pos.hc->min_code[l]]);
+  }
+
+  BSclose(&bs);
+  return CDA_OK;
+}
+
 /**
  * Gets the integer ID of the item at the specified
  * position on the given p-attribute.
@@ -1027,11 +1114,9 @@ cl_cpos2id(Attribute *attribute, int position)
     Component *cis;
     Component *cis_sync;
     Component *cis_map;
-    BStream bs;
 
-    unsigned char bit;
-    int item;
-    unsigned int block, rest, offset, max, v, l, i;
+    unsigned int block, rest;
+    int *buffer, *buffer_nr;
 
     if (COMPRESS_DEBUG > 1)
       Rprintf("Accessing position %d of %s via compressed item sequence\n", position, attribute->any.name);
@@ -1050,61 +1135,34 @@ cl_cpos2id(Attribute *attribute, int position)
       block = position / SYNCHRONIZATION;
       rest  = position % SYNCHRONIZATION;
 
-      if (attribute->pos.this_block_nr != block) {
+      if (cl_worker_thread) {
+        /* threads started by cl_parallel() must not touch the buffer of the attribute */
+        int slot = ((size_t)attribute / sizeof(Attribute)) % WORKER_BLOCKS;
+        if (worker_block[slot].attribute != attribute) {
+          worker_block[slot].attribute = attribute;
+          worker_block[slot].block_nr = -1;
+        }
+        buffer = worker_block[slot].block;
+        buffer_nr = &(worker_block[slot].block_nr);
+      }
+      else {
+        buffer = attribute->pos.this_block;
+        buffer_nr = &(attribute->pos.this_block_nr);
+      }
+
+      if (*buffer_nr != block) {
 
         /* the current block in the decompression buffer is not the
          * block we need. So we read the proper block into the buffer
          * and hope that we'll get a cache hit next time. */
 
         if (COMPRESS_DEBUG > 0)
-          Rprintf("Block miss: have %d, want %d\n", attribute->pos.this_block_nr, block);
+          Rprintf("Block miss: have %d, want %d\n", *buffer_nr, block);
 
-        /* is the block we read the last block of the corpus? Then, we
-         * cannot read SYNC items, but only as much as there are left.
-         * */
-
-        max = attribute->pos.hc->length - block * SYNCHRONIZATION;
-        if (max > SYNCHRONIZATION)
-          max = SYNCHRONIZATION;
-
-        attribute->pos.this_block_nr = block;
-
-        offset = ntohl(cis_sync->data.data[block]);
-
-        if (COMPRESS_DEBUG > 1)
-          Rprintf("-> Block %d, rest %d, offset %d\n", block, rest, offset);
-
-        BSopen((unsigned char *)cis->data.data, "r", &bs);
-        BSseek(&bs, offset);
-
-        for (i = 0; i < max; i++) {
-          if (!BSread(&bit, 1, &bs)) {
-            Rprintf("cdaccess:decompressed read: Read error/1\n");
-            return cl_errno = CDA_ENODATA;
-          }
-
-          v = (bit ? 1 : 0);
-          l = 1;
-
-          while (v < attribute->pos.hc->min_code[l]) {
-            if (!BSread(&bit, 1, &bs)) {
-              Rprintf("cdaccess:decompressed read: Read error/2\n");
-              return cl_errno = CDA_ENODATA;
-            }
-
-            v <<= 1;
-            if (bit)
-              v++;
-            l++;
-          }
-
-          /* we now have the item - store it in the decompression block */
-          item = ntohl(attribute->pos.hc->symbols[attribute->pos.hc->symindex[l] + v - attribute->pos.hc->min_code[l]]);
-          attribute->pos.this_block[i] = item;
-        }
-
-        BSclose(&bs);
+        *buffer_nr = block;
 
+        if (CDA_OK != decompress_block(attribute, block, buffer))
+          return cl_errno = CDA_ENODATA;
       }
       else if (COMPRESS_DEBUG > 0)
         Rprintf("Block hit: block[%d,%d]\n", block, rest);
@@ -1112,7 +1170,7 @@ cl_cpos2id(Attribute *attribute, int position)
       assert(rest < SYNCHRONIZATION);
 
       cl_errno = CDA_OK;         /* hi 'Oli' ! */
-      return attribute->pos.this_block[rest];
+      return buffer[rest];
     }
     else
       return cl_errno = CDA_EPOSORNG;
@@ -1132,6 +1190,79 @@ cl_cpos2id(Attribute *attribute, int position)
   }
 }
 
+/**
+ * Gets the integer IDs of the items at a list of corpus
+ * positions on the given p-attribute.
+ *
+ * This is a vectorised version of cl_cpos2id(). Compressed data are
+ * decoded into a buffer of its own rather than the decompression buffer
+ * of the attribute, and cl_errno (which is thread-local) is only set if
+ * the data cannot be read. So different threads can call this function
+ * for the same attribute at the same time, provided that the attribute
+ * has been accessed before (e.g. with cl_cpos2id()), so that its data are
+ * loaded. In threads started by cl_parallel(), read errors are not
+ * printed; the caller has to report them after the threads are done.
+ * Lookups are fastest if the corpus positions are sorted in ascending
+ * order.
+ *
+ * @see cl_cpos2id
+ *
+ * @param attribute  The P-attribute to look on.
+ * @param cposlist   The corpus positions to look up.
+ * @param len        The number of corpus positions in cposlist.
+ * @param idlist     Location to put the IDs (an array of at least len
+ *                   integers). For corpus positions out of range,
+ *                   CDA_EPOSORNG is stored.
+ * @return           The number of valid corpus positions,
+ *                   or a negative int error code.
+ */
+int
+cl_cpos2id_list(Attribute *attribute, int *cposlist, int len, int *idlist)
+{
+  Component *corpus;
+  int i, n_valid = 0;
+
+  check_arg(attribute, ATT_POS, cl_errno);
+
+  if (cl_sequence_compressed(attribute) == 1) {
+    int block_ids[SYNCHRONIZATION];
+    int block_nr = -1, size;
+
+    if (!ensure_component(attribute, CompHuffSeq, 0) || !ensure_component(attribute, CompHuffCodes, 0)
+        || !ensure_component(attribute, CompHuffSync, 0))
+      return cl_errno = CDA_ENODATA;
+
+    size = attribute->pos.hc->length;
+    for (i = 0; i < len; i++) {
+      if (cposlist[i] < 0 || cposlist[i] >= size)
+        idlist[i] = CDA_EPOSORNG;
+      else {
+        if (cposlist[i] / SYNCHRONIZATION != block_nr) {
+          block_nr = cposlist[i] / SYNCHRONIZATION;
+          if (CDA_OK != decompress_block(attribute, block_nr, block_ids))
+            return cl_errno = CDA_ENODATA;
+        }
+        idlist[i] = block_ids[cposlist[i] % SYNCHRONIZATION];
+        n_valid++;
+      }
+    }
+  }
+  else {
+    if (!(corpus = ensure_component(attribute, CompCorpus, 0)))
+      return cl_errno = CDA_ENODATA;
+
+    for (i = 0; i < len; i++) {
+      if (cposlist[i] < 0 || cposlist[i] >= corpus->size)
+        idlist[i] = CDA_EPOSORNG;
+      else {
+        idlist[i] = ntohl(corpus->data.data[cposlist[i]]);
+        n_valid++;
+      }
+    }
+  }
+  return n_valid;
+}
+
 
 /**
  * Gets the string of the item at the specified
@@ -1234,6 +1365,7 @@ cl_regex2id(Attribute *attribute, char *pattern, int flags, int *number_of_match
   CL_Regex rx;
   int /*regex_result,*/ idx/*, len*/; // only need one index now.
   int optimised/*, grain_match*/;     // we don't track grain matching now.
+  int regopt_avoided;           /* reading of the regopt success counter before the lexicon scan */
 
   /* results are stored as a a bitmap: one bit per lexicon item; this reduce memory footprint and avoids frequent realloc();
    * it would also be possible to use a Bitfield, see <bitfield.h>, but this custom implementation is somewhat more efficient */
@@ -1298,7 +1430,9 @@ cl_regex2id(Attribute *attribute, char *pattern, int flags, int *number_of_match
   bitmap_offset = 0;
   bitmap_mask = 0x80;           /* start with MSB of first byte */
 
-  cl_regopt_count_reset();      /* report how often we have a grain match when using optimised search */
+  /* report how often we have a grain match when using optimised search; the counters are
+   * not reset here so that callers can accumulate them over a complete query */
+  regopt_avoided = cl_regopt_count_get();
 
   /* for each index in the lexicon... */
   for (idx = 0; idx < lexsize; idx++) {
@@ -1318,7 +1452,7 @@ cl_regex2id(Attribute *attribute, char *pattern, int flags, int *number_of_match
   if (cl_debug && optimised)
     Rprintf("CL: regexp optimiser avoided calling regex engine for %d candidates out of %d strings\n"
                     "    (%d matching strings in total) \n",
-                    cl_regopt_count_get(), lexsize, match_count);
+                    cl_regopt_count_get() - regopt_avoided, lexsize, match_count);
 
   /* table was initialised to NULL, and will stay NULL till returned if there were zero matches;
      but if there WERE matches, we put into it a list of matching IDs from the bitmap. */
@@ -2336,14 +2470,368 @@ cl_alg2cpos(Attribute *attribute,
 }
 
 
+/**
+ * Gets the start of the source region of an alignment bead.
+ *
+ * Works for both extended (XALIGN) and old-style (ALIGN) alignment data.
+ *
+ * @param data      The data member of the CompXAlignData or CompAlignData component.
+ * @param bead      The number of the alignment bead.
+ * @param extended  Boolean: whether data is an XALIGN component.
+ * @return          The first corpus position of the source region.
+ */
+static int
+get_alignment_bead_start(int *data, int bead, int extended)
+{
+  return (extended) ? ntohl(data[bead * 4]) : ntohl(data[bead * 2]);
+}
+
+/**
+ * Gets the end of the source region of an alignment bead.
+ *
+ * Old-style alignments have no gaps, so the region ends right before
+ * the next alignment boundary.
+ *
+ * @see get_alignment_bead_start
+ * @return          The last corpus position of the source region.
+ */
+static int
+get_alignment_bead_end(int *data, int bead, int extended)
+{
+  return (extended) ? ntohl(data[bead * 4 + 1]) : ntohl(data[(bead + 1) * 2]) - 1;
+}
+
+/**
+ * Finds the alignment bead containing a corpus position, starting from a cursor.
+ *
+ * Alignment beads are sorted by source corpus position. If the position is not
+ * smaller than the start of the bead at the cursor, the search gallops forward
+ * from the cursor (with exponentially growing steps) before doing a binary search
+ * in the remaining interval, so a sequence of increasing corpus positions that are
+ * close to each other costs only a few comparisons per position. For large jumps
+ * (or if the cursor is -1), a binary search over all beads is carried out.
+ *
+ * @param data      The data member of the CompXAlignData or CompAlignData component.
+ * @param n_beads   The number of alignment beads.
+ * @param extended  Boolean: whether data is an XALIGN component.
+ * @param cpos      The corpus position to look up.
+ * @param cursor    Bead to start the search from; updated to the bead
+ *                  where the search ended.
+ * @return          The number of the bead containing cpos, or -1 if there
+ *                  is none (out of range or in a gap between beads).
+ */
+static int
+get_alignment_from_cursor(int *data, int n_beads, int extended, int cpos, int *cursor)
+{
+  int low, high, mid, step, start;
+
+  low = *cursor;
+  high = n_beads - 1;
+  if (low >= 0 && low < n_beads && cpos >= get_alignment_bead_start(data, low, extended)) {
+    if (cpos <= get_alignment_bead_end(data, low, extended))
+      return low;               /* still in the same bead */
+    /* gallop: find a small interval [low, high] in which the bead containing cpos must lie;
+     * give up after a few steps, because the first probes of a full binary search are usually cached */
+    for (step = 1; step <= 16 && low + step < n_beads; step *= 2) {
+      if (cpos <= get_alignment_bead_end(data, low + step, extended)) {
+        high = low + step;
+        break;
+      }
+      low += step;
+    }
+    low++;                      /* the bead at low ends before cpos */
+    if (step > 16)
+      low = 0;
+  }
+  else
+    low = 0;
+
+  /* binary search in [low, high] */
+  while (low <= high) {
+    mid = (low + high) / 2;
+    start = get_alignment_bead_start(data, mid, extended);
+    if (start <= cpos) {
+      if (cpos <= get_alignment_bead_end(data, mid, extended)) {
+        *cursor = mid;
+        return mid;
+      }
+      else
+        low = mid + 1;
+    }
+    else
+      high = mid - 1;
+  }
+
+  *cursor = high;               /* last bead starting before cpos (or -1) */
+  return -1;                    /* in a gap between beads (or out of range) */
+}
+
+/**
+ * Gets the id numbers of the alignments at a list of corpus positions.
+ *
+ * This is a vectorised version of cl_cpos2alg(). Lookups are fastest if the corpus
+ * positions are sorted in ascending order, because each search then starts from the
+ * alignment bead found for the previous position (see get_alignment_from_cursor).
+ * Unsorted input is handled correctly, though (with one binary search per position).
+ *
+ * @see cl_cpos2alg
+ *
+ * @param attribute  The align-attribute to look on.
+ * @param cposlist   The corpus positions to look up.
+ * @param len        The number of corpus positions in cposlist.
+ * @param alglist    Location to put the id numbers of the alignments (an
+ *                   array of at least len integers). For corpus positions
+ *                   that are not aligned, the same negative error code as
+ *                   from cl_cpos2alg() is stored.
+ * @return           The number of aligned corpus positions,
+ *                   or a negative int error code.
+ */
+int
+cl_cpos2alg_list(Attribute *attribute, int *cposlist, int len, int *alglist)
+{
+  int i, alg, n_beads, extended, cursor, sorted, found;
+  Component *align_data;
+
+  /* call to cl_has_extended_alignment subsumes check_arg() */
+  extended = cl_has_extended_alignment(attribute);
+  align_data = ensure_component(attribute, (extended ? CompXAlignData : CompAlignData), 0);
+  if (align_data == NULL)
+    return cl_errno = CDA_ENODATA;
+
+  /* last alignment boundary of old-style alignment doesn't correspond to region */
+  n_beads = (extended) ? align_data->size / 4 : (align_data->size / 2) - 1;
+
+  /* the cursor only pays off for sorted input; otherwise, always do a full binary search */
+  for (i = 1; i < len; i++)
+    if (cposlist[i] < cposlist[i - 1])
+      break;
+  sorted = (i >= len);
+
+  cursor = -1;
+  found = 0;
+  for (i = 0; i < len; i++) {
+    if (!sorted)
+      cursor = -1;
+    alg = get_alignment_from_cursor(align_data->data.data, n_beads, extended, cposlist[i], &cursor);
+    if (alg >= 0) {
+      alglist[i] = alg;
+      found++;
+    }
+    else
+      alglist[i] = (extended) ? CDA_EALIGN : CDA_EPOSORNG; /* old alignment files don't allow gaps */
+  }
+
+  cl_errno = CDA_OK;
+  return found;
+}
+
+/**
+ * Gets the corpus positions of a list of alignments on the given align-attribute.
+ *
+ * This is a vectorised version of cl_alg2cpos(). The source and target regions of
+ * each alignment are written to the four arrays passed as parameters; for invalid
+ * alignment ids (including negative error codes returned by cl_cpos2alg_list), all
+ * four positions are set to -1.
+ *
+ * @see cl_alg2cpos
+ *
+ * @param attribute            The align-attribute to look on.
+ * @param alglist              The IDs of the alignments whose positions are wanted.
+ * @param len                  The number of IDs in alglist.
+ * @param source_region_start  Array to put source corpus start positions.
+ * @param source_region_end    Array to put source corpus end positions.
+ * @param target_region_start  Array to put target corpus start positions.
+ * @param target_region_end    Array to put target corpus end positions.
+ * @return                     The number of valid alignment IDs,
+ *                             or a negative int error code.
+ */
+int
+cl_alg2cpos_list(Attribute *attribute,
+                 int *alglist,
+                 int len,
+                 int *source_region_start,
+                 int *source_region_end,
+                 int *target_region_start,
+                 int *target_region_end)
+{
+  int i, alg, n_beads, extended, found;
+  int *val;
+  Component *align_data;
+
+  /* call to cl_has_extended_alignment subsumes check_arg() */
+  extended = cl_has_extended_alignment(attribute);
+  align_data = ensure_component(attribute, (extended ? CompXAlignData : CompAlignData), 0);
+  if (align_data == NULL)
+    return cl_errno = CDA_ENODATA;
+
+  n_beads = (extended) ? align_data->size / 4 : (align_data->size / 2) - 1;
+
+  found = 0;
+  for (i = 0; i < len; i++) {
+    alg = alglist[i];
+    if (alg < 0 || alg >= n_beads) {
+      source_region_start[i] = source_region_end[i] = -1;
+      target_region_start[i] = target_region_end[i] = -1;
+    }
+    else if (extended) {
+      val = align_data->data.data + (alg * 4);
+      source_region_start[i] = ntohl(val[0]);
+      source_region_end[i]   = ntohl(val[1]);
+      target_region_start[i] = ntohl(val[2]);
+      target_region_end[i]   = ntohl(val[3]);
+      found++;
+    }
+    else {
+      val = align_data->data.data + (alg * 2);
+      source_region_start[i] = ntohl(val[0]);
+      target_region_start[i] = ntohl(val[1]);
+      source_region_end[i]   = ntohl(val[2]) - 1;
+      target_region_end[i]   = ntohl(val[3]) - 1;
+      found++;
+    }
+  }
+
+  cl_errno = CDA_OK;
+  return found;
+}
+
+
 
 /* ================================================== DYNAMIC ATTRIBUTES */
 
+/** Prefix of the call string of a dynamic attribute that is implemented by a plugin. */
+#define DYN_PLUGIN_PREFIX "plugin:"
+
+/**
+ * Checks whether the arguments of a call match the argument list of a dynamic attribute.
+ *
+ * @param attribute  The (dynamic) attribute in question.
+ * @param args       The arguments of the call.
+ * @param nr_args    Number of arguments.
+ * @return           Boolean: true if the arguments are OK.
+ */
+static int
+dynamic_args_ok(Attribute *attribute, DynCallResult *args, int nr_args)
+{
+  DynArg *p = attribute->dyn.arglist;
+  int argnum = 0;
+
+  while (p && argnum < nr_args) {
+    if (p->type == args[argnum].type || (p->type == ATTAT_POS && args[argnum].type == ATTAT_INT)) {
+      p = p->next;
+      argnum++;
+    }
+    else if (p->type == ATTAT_VAR)
+      argnum++;
+    else
+      return 0;
+  }
+
+  return (p == NULL && argnum == nr_args) || (p != NULL && p->type == ATTAT_VAR);
+}
+
+/**
+ * Loads the plugin implementing a dynamic attribute.
+ *
+ * If the call string of the attribute names a plugin ("plugin:<library>:<symbol>"),
+ * the shared library is loaded and the function is stored in the attribute. This is
+ * done when the corpus is loaded (see registry_add_corpus()), i.e. in the main thread:
+ * the attribute is shared by all threads, which only read dyn.func when calling it.
+ * A library that cannot be loaded is not tried again.
+ *
+ * @param attribute  The (dynamic) attribute in question.
+ * @return           The function, or NULL if the call string is to be run by popen()
+ *                   or if the plugin cannot be loaded (check dyn.plugin_failed).
+ */
+ClDynamicFunction
+dynamic_load_plugin(Attribute *attribute)
+{
+  char *spec, *symbol;
+  void *handle;
+
+  if (attribute->dyn.func || attribute->dyn.plugin_failed || attribute->dyn.call == NULL)
+    return attribute->dyn.func;
+  if (strncmp(attribute->dyn.call, DYN_PLUGIN_PREFIX, strlen(DYN_PLUGIN_PREFIX)) != 0)
+    return NULL;
+
+  /* the library path may contain ':' (drive letters), so the symbol follows the last one */
+  spec = cl_strdup(attribute->dyn.call + strlen(DYN_PLUGIN_PREFIX));
+  symbol = strrchr(spec, ':');
+  if (symbol == NULL || symbol == spec || symbol[1] == '\0') {
+    Rprintf("CL: invalid plugin specification \"%s\" for dynamic attribute %s\n",
+            attribute->dyn.call, attribute->any.name);
+    attribute->dyn.plugin_failed = 1;
+    cl_free(spec);
+    return NULL;
+  }
+  *symbol++ = '\0';
+
+#ifndef __MINGW__
+  if (NULL == (handle = dlopen(spec, RTLD_NOW | RTLD_LOCAL)))
+    Rprintf("CL: can't load plugin for dynamic attribute %s: %s\n", attribute->any.name, dlerror());
+  else if (NULL == (*(void **)(&attribute->dyn.func) = dlsym(handle, symbol))) {
+    Rprintf("CL: can't find function %s in plugin %s\n", symbol, spec);
+    dlclose(handle);
+  }
+  else
+    attribute->dyn.plugin_handle = handle;
+#else
+  handle = NULL;
+  Rprintf("CL: plugins for dynamic attributes are not supported on this platform\n");
+#endif
+
+  if (attribute->dyn.func == NULL)
+    attribute->dyn.plugin_failed = 1;
+  else if (cl_debug)
+    Rprintf("Loaded function %s from plugin %s for dynamic attribute %s\n", symbol, spec, attribute->any.name);
+
+  cl_free(spec);
+  return attribute->dyn.func;
+}
+
+/**
+ * Sets the in-process implementation of a dynamic attribute.
+ *
+ * The function replaces the call string (or the plugin) declared in the registry;
+ * this is how applications embedding the CL provide dynamic attributes implemented
+ * in their own language.
+ *
+ * @see              ClDynamicFunction
+ * @param attribute  The (dynamic) attribute in question.
+ * @param func       The function, or NULL to revert to the call string (or plugin) from the registry.
+ * @param data       Pointer passed to func on each call.
+ * @return           Boolean: True for all OK, false for error.
+ */
+int
+cl_dynamic_register(Attribute *attribute, ClDynamicFunction func, void *data)
+{
+  check_arg(attribute, ATT_DYN, 0);
+
+#ifndef __MINGW__
+  if (attribute->dyn.plugin_handle)
+    dlclose(attribute->dyn.plugin_handle);
+#endif
+  attribute->dyn.plugin_handle = NULL;
+  attribute->dyn.plugin_failed = 0;
+  attribute->dyn.func = func;
+  attribute->dyn.func_data = data;
+  if (func == NULL)
+    dynamic_load_plugin(attribute);
+
+  cl_errno = CDA_OK;
+  return 1;
+}
+
 /**
  * Calls a dynamic attribute.
  *
  * This is the attribute access function for dynamic attributes.
  *
+ * Dynamic attributes with an in-process implementation (a plugin or a function
+ * set by cl_dynamic_register()) are evaluated directly. Otherwise, the call string
+ * from the registry is completed with the arguments and run by popen(), which
+ * spawns a process for each call.
+ *
  * @param attribute  The (dynamic) attribute in question.
  * @param dcr        Location for the result (*int or *char).
  * @param args       Location of the parameters (of *int or *char).
@@ -2362,89 +2850,59 @@ cl_dynamic_call(Attribute *attribute,
   int i, k, ap, ins;
 
   FILE *pipe;
-  int argnum, val;
+  int val;
   DynArg *p;
   char c;
+  ClDynamicFunction func;
 
   check_arg(attribute, ATT_DYN, cl_errno);
 
   if ((args == NULL) || (nr_args <= 0))
     goto error;
 
-  p = attribute->dyn.arglist;
-  argnum = 0;
+  if (!dynamic_args_ok(attribute, args, nr_args))
+    goto error;
 
-  while (p && argnum < nr_args) {
-    if (p->type == args[argnum].type || (p->type == ATTAT_POS && args[argnum].type == ATTAT_INT)) {
-      p = p->next;
-      argnum++;
-    }
-    else if (p->type == ATTAT_VAR)
-      argnum++;
-    else
+  if (NULL != (func = attribute->dyn.func)) {
+    dcr->type = attribute->dyn.res_type;
+    if (!func(dcr, args, nr_args, 1, attribute->dyn.func_data) || dcr->type == ATTAT_NONE)
       goto error;
+    cl_errno = CDA_OK;
+    return 1;
   }
+  else if (attribute->dyn.plugin_failed)
+    goto error;
 
-  if ( (p && argnum == nr_args) || (p && p->type == ATTAT_VAR) ) {
-    /* everything OK , so build the call string */
-    i = 0;
-    ins = 0;
-
-    while ('\0'!= (c = attribute->dyn.call[i])) {
-      if (c == '$' && isdigit(attribute->dyn.call[i+1])) {
-        /* reference */
-        i++;
-        val = 0;
-        while (isdigit(attribute->dyn.call[i]))
-          val = val * 10 + attribute->dyn.call[i++] - '0';
-
-        /* find the corresponding argument in the definition of args */
-        if (val > 0 && val <= nr_args) {
-          p = attribute->dyn.arglist;
-          k = val - 1;  /* 0 .. max. nr_args-1 */
-          ap = 0;
-          while (p && p->type != ATTAT_VAR && k > 0) {
-            p = p->next;
-            ap++;
-            k--;
-          }
+  /* no in-process implementation, so build the call string for popen() */
+  i = 0;
+  ins = 0;
+
+  while ('\0'!= (c = attribute->dyn.call[i])) {
+    if (c == '$' && isdigit(attribute->dyn.call[i+1])) {
+      /* reference */
+      i++;
+      val = 0;
+      while (isdigit(attribute->dyn.call[i]))
+        val = val * 10 + attribute->dyn.call[i++] - '0';
+
+      /* find the corresponding argument in the definition of args */
+      if (val > 0 && val <= nr_args) {
+        p = attribute->dyn.arglist;
+        k = val - 1;  /* 0 .. max. nr_args-1 */
+        ap = 0;
+        while (p && p->type != ATTAT_VAR && k > 0) {
+          p = p->next;
+          ap++;
+          k--;
+        }
 
-          if (p != NULL) {
-            assert(ap < nr_args);
-
-            if (p->type == ATTAT_VAR) {
-
-              /* put all args >= ap into the call string */
-              for (; ap < nr_args; ap++)
-                switch (args[ap].type) {
-                case ATTAT_STRING:
-                  for (k = 0; args[ap].value.charres[k]; k++)
-                    call[ins++] = args[ap].value.charres[k];
-                  break;
-
-                case ATTAT_INT:
-                case ATTAT_POS:
-                  snprintf(istr, 32, "%d", args[ap].value.intres);
-                  for (k = 0; istr[k]; k++)
-                    call[ins++] = istr[k];
-                  break;
-
-                case ATTAT_FLOAT:
-                  snprintf(istr, 32, "%f", args[ap].value.floatres);
-                  for (k = 0; istr[k]; k++)
-                    call[ins++] = istr[k];
-                  break;
-
-                case ATTAT_NONE:
-                case ATTAT_VAR:
-                case ATTAT_PAREF:
-                default:
-                  goto error;
-                  break;
-                }
-            }
-            else {
-              /* just put arg ap into the call string */
+        if (p != NULL) {
+          assert(ap < nr_args);
+
+          if (p->type == ATTAT_VAR) {
+
+            /* put all args >= ap into the call string */
+            for (; ap < nr_args; ap++)
               switch (args[ap].type) {
               case ATTAT_STRING:
                 for (k = 0; args[ap].value.charres[k]; k++)
@@ -2471,61 +2929,87 @@ cl_dynamic_call(Attribute *attribute,
                 goto error;
                 break;
               }
+          }
+          else {
+            /* just put arg ap into the call string */
+            switch (args[ap].type) {
+            case ATTAT_STRING:
+              for (k = 0; args[ap].value.charres[k]; k++)
+                call[ins++] = args[ap].value.charres[k];
+              break;
+
+            case ATTAT_INT:
+            case ATTAT_POS:
+              snprintf(istr, 32, "%d", args[ap].value.intres);
+              for (k = 0; istr[k]; k++)
+                call[ins++] = istr[k];
+              break;
+
+            case ATTAT_FLOAT:
+              snprintf(istr, 32, "%f", args[ap].value.floatres);
+              for (k = 0; istr[k]; k++)
+                call[ins++] = istr[k];
+              break;
+
+            case ATTAT_NONE:
+            case ATTAT_VAR:
+            case ATTAT_PAREF:
+            default:
+              goto error;
+              break;
             }
           }
-          else
-            goto error;
         }
         else
           goto error;
       }
-      else {
-        call[ins++] = c;
-        call[ins] = '\0';       /* for debugging */
-        i++;                    /* get next char */
-      }
+      else
+        goto error;
     }
-    call[ins++] = '\0';
-
-    if (cl_debug)
-      Rprintf("Composed dynamic call: \"%s\"\n", call);
+    else {
+      call[ins++] = c;
+      call[ins] = '\0';       /* for debugging */
+      i++;                    /* get next char */
+    }
+  }
+  call[ins++] = '\0';
 
-    if (NULL == (pipe = popen(call, "r")))
-      goto error;
+  if (cl_debug)
+    Rprintf("Composed dynamic call: \"%s\"\n", call);
 
-    dcr->type = attribute->dyn.res_type;
+  if (NULL == (pipe = popen(call, "r")))
+    goto error;
 
-    switch (attribute->dyn.res_type) {
-    case ATTAT_POS:             /* convert output to int */
-    case ATTAT_INT:
-      if (!fscanf(pipe, "%d", &(dcr->value.intres)))
-        dcr->value.intres = -1;
-      break;
+  dcr->type = attribute->dyn.res_type;
 
-    case ATTAT_STRING:          /* copy output */
-      if (fgets(call, CL_MAX_LINE_LENGTH, pipe) == NULL) Rprintf("fgets failure");
-      dcr->value.charres = (char *)cl_strdup(call);
-      break;
+  switch (attribute->dyn.res_type) {
+  case ATTAT_POS:             /* convert output to int */
+  case ATTAT_INT:
+    if (!fscanf(pipe, "%d", &(dcr->value.intres)))
+      dcr->value.intres = -1;
+    break;
 
-    case ATTAT_FLOAT:
-      if (!fscanf(pipe, "%lf", &(dcr->value.floatres)))
-        dcr->value.floatres = 0.0;
-      break;
+  case ATTAT_STRING:          /* copy output */
+    if (fgets(call, CL_MAX_LINE_LENGTH, pipe) == NULL) Rprintf("fgets failure");
+    dcr->value.charres = (char *)cl_strdup(call);
+    break;
 
-    case ATTAT_NONE:
-    case ATTAT_VAR:             /* not possible */
-    case ATTAT_PAREF:
-    default:
-      goto error;
-      break;
-    }
+  case ATTAT_FLOAT:
+    if (!fscanf(pipe, "%lf", &(dcr->value.floatres)))
+      dcr->value.floatres = 0.0;
+    break;
 
-    pclose(pipe);
-    cl_errno = CDA_OK;
-    return 1;
-  }
-  else
+  case ATTAT_NONE:
+  case ATTAT_VAR:             /* not possible */
+  case ATTAT_PAREF:
+  default:
     goto error;
+    break;
+  }
+
+  pclose(pipe);
+  cl_errno = CDA_OK;
+  return 1;
 
  error:
   cl_errno = CDA_EARGS;
@@ -2533,6 +3017,63 @@ cl_dynamic_call(Attribute *attribute,
   return 0;
 }
 
+/**
+ * Calls a dynamic attribute for a batch of argument lists.
+ *
+ * An in-process implementation of the dynamic attribute is called once for the
+ * whole batch; otherwise, cl_dynamic_call() is used for each argument list.
+ *
+ * @param attribute  The (dynamic) attribute in question.
+ * @param dcr        Location for the results (n_calls DynCallResult objects).
+ * @param args       The arguments: nr_args DynCallResult objects for each call,
+ *                   i.e. argument j of call i is args[i * nr_args + j].
+ * @param nr_args    Number of parameters of each call.
+ * @param n_calls    Number of calls.
+ * @return           The number of successful calls (results of failed calls have
+ *                   type ATTAT_NONE), or a negative error code.
+ */
+int
+cl_dynamic_call_list(Attribute *attribute,
+                     DynCallResult *dcr,
+                     DynCallResult *args,
+                     int nr_args,
+                     int n_calls)
+{
+  int i, ok;
+  ClDynamicFunction func;
+
+  check_arg(attribute, ATT_DYN, cl_errno);
+
+  if ((args == NULL) || (nr_args <= 0) || (n_calls < 0)) {
+    cl_errno = CDA_EARGS;
+    return cl_errno;
+  }
+
+  for (i = 0; i < n_calls; i++)
+    if (!dynamic_args_ok(attribute, args + (size_t)i * nr_args, nr_args)) {
+      cl_errno = CDA_EARGS;
+      return cl_errno;
+    }
+
+  ok = 0;
+  if (NULL != (func = attribute->dyn.func)) {
+    for (i = 0; i < n_calls; i++)
+      dcr[i].type = attribute->dyn.res_type;
+    if (n_calls > 0 && !func(dcr, args, nr_args, n_calls, attribute->dyn.func_data))
+      for (i = 0; i < n_calls; i++)
+        dcr[i].type = ATTAT_NONE;
+    for (i = 0; i < n_calls; i++)
+      if (dcr[i].type != ATTAT_NONE)
+        ok++;
+  }
+  else
+    for (i = 0; i < n_calls; i++)
+      ok += cl_dynamic_call(attribute, dcr + i, args + (size_t)i * nr_args, nr_args);
+
+  cl_errno = CDA_OK;
+  return ok;
+}
+
 /**
  * Count the number of arguments on a dynamic attribute's argument list.
  *
@@ -170,8 +170,16 @@ char* cl_get_p_attr_default();
 #define CDA_EPOSIX      -21       /**< Error code: POSIX-level error: check errno or perror() */
 #define CDA_CPOSUNDEF   INT_MIN   /**< Error code: undefined corpus position (use this code to avoid ambiguity with negative cpos) */
 
-/* a global variable which will always be set to one of the above constants! */
-extern int cl_errno;
+/**
+ * Storage class of the global variables of the CL that have a separate instance in each
+ * thread, so that CL functions can be called by the workers of cl_parallel().
+ */
+#ifndef CL_THREAD_LOCAL
+#define CL_THREAD_LOCAL __thread
+#endif
+
+/* a global variable which will always be set to one of the above constants! (one per thread) */
+extern CL_THREAD_LOCAL int cl_errno;
 
 /** A macro which collapses cl_errno's values to a bool: is everything OK or not? true/false respectively.  */
 #define cl_all_ok() (cl_errno == CDA_OK)
@@ -283,6 +291,15 @@ void cl_set_optimize(int state);          /* 0 = off, 1 = on */
 int cl_get_optimize(void);
 void cl_set_memory_limit(int megabytes);  /* 0 or less turns limit off */
 int cl_get_memory_limit(void);
+void cl_set_threads(int n);               /* 1 = no parallel processing */
+int cl_get_threads(void);
+
+/**
+ * A function run by cl_parallel(): thread is the number of the thread
+ * (0 .. n_threads - 1), data points to the data shared by all threads.
+ */
+typedef void (*ClWorker)(int thread, int n_threads, void *data);
+void cl_parallel(ClWorker worker, int n_threads, void *data);
 
 
 
@@ -630,6 +647,16 @@ int cl_delete_corpus(Corpus *corpus);
 char *cl_standard_registry();
 cl_string_list cl_corpus_list_attributes(Corpus *corpus, int attribute_type);
 
+/* registry cache: parsed registry entries, validated by modification time and size of the registry file */
+int cl_set_registry_cache(char *filename);  /* NULL turns the cache off */
+char *cl_get_registry_cache(void);
+int cl_registry_cache_write(void);
+int cl_registry_prefetch(char *registry_dir);
+/* log of registry entries loaded by cl_new_corpus(): source is 0 = parsed, 1 = cache, -1 = failed */
+int cl_registry_log_size(void);
+int cl_registry_log_entry(int i, char **registry_dir, char **registry_name, int *source, double *seconds);
+void cl_registry_log_reset(void);
+
 
 
 
@@ -740,6 +767,7 @@ int *cl_id2cpos_oldstyle(Attribute *attribute,
                          int *restrictor_list,
                          int restrictor_list_size);
 int cl_cpos2id(Attribute *attribute, int position);
+int cl_cpos2id_list(Attribute *attribute, int *cposlist, int len, int *idlist);
 char *cl_cpos2str(Attribute *attribute, int position);
 
 /* ========== some high-level constructs */
@@ -812,6 +840,11 @@ int cl_cpos2alg(Attribute *attribute, int cpos);
 int cl_alg2cpos(Attribute *attribute, int alg,
                 int *source_region_start, int *source_region_end,
                 int *target_region_start, int *target_region_end);
+/* vectorised versions of cl_cpos2alg() and cl_alg2cpos(); fastest with sorted corpus positions */
+int cl_cpos2alg_list(Attribute *attribute, int *cposlist, int len, int *alglist);
+int cl_alg2cpos_list(Attribute *attribute, int *alglist, int len,
+                     int *source_region_start, int *source_region_end,
+                     int *target_region_start, int *target_region_end);
 
 /* attribute access functions: alignment attributes (old style) -- DEPRACATED */
 int cl_cpos2alg2cpos_oldstyle(Attribute *attribute,
@@ -877,6 +910,25 @@ typedef struct _DCR {
 int cl_dynamic_call(Attribute *attribute, DynCallResult *dcr, DynCallResult *args, int nr_args);
 int cl_dynamic_numargs(Attribute *attribute);
 
+/**
+ * In-process implementation of a dynamic attribute ("plugin").
+ *
+ * The function is called with a batch of n_calls calls: args holds nr_args
+ * arguments for each call, i.e. args[i * nr_args + j] is argument j of call i,
+ * and the result of call i goes to dcr[i]. On entry, the type of each result
+ * is set to the result type of the dynamic attribute; string results must be
+ * copied to the dynamic_string_buffer of the result (and charres pointed to it).
+ * A call that fails sets the type of its result to ATTAT_NONE. data is the
+ * pointer passed to cl_dynamic_register() (NULL for plugins loaded from a
+ * shared library). The function returns false if the whole batch failed.
+ *
+ * Plugins are declared in the registry by a call string of the form
+ * "plugin:<path to shared library>:<symbol>" and are loaded with the corpus.
+ */
+typedef int (*ClDynamicFunction)(DynCallResult *dcr, DynCallResult *args, int nr_args, int n_calls, void *data);
+int cl_dynamic_register(Attribute *attribute, ClDynamicFunction func, void *data);
+int cl_dynamic_call_list(Attribute *attribute, DynCallResult *dcr, DynCallResult *args, int nr_args, int n_calls);
+
 
 
 
@@ -1068,9 +1120,10 @@ int cl_regex_match(CL_Regex rx, char *str, int normalize_utf8);
 void cl_delete_regex(CL_Regex rx);
 extern char cl_regex_error[];
 
-/* two functions interface the optimiser system's reporting capabilities */
+/* three functions interface the optimiser system's reporting capabilities */
 void cl_regopt_count_reset(void);
 int cl_regopt_count_get(void);
+int cl_regopt_count_trials(void);
 
 
 
@@ -17,7 +17,11 @@
 
 void Rprintf(const char *, ...);
 #include <ctype.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <dirent.h>
 #ifndef __MINGW__
 #include <sys/utsname.h>
 #include <pwd.h>
@@ -42,11 +46,6 @@ static int memberIDList(char *s, IDList l);
 
 /* ---------------------------------Interface to registry parser */
 
-/**
- * File pointer for loading corpus registry.
- * (External variable, defined in the output from parsing registry.y)
- */
-extern FILE *cregin;
 /**
  * Pointer to a corpus object that is used when loading from the registry.
  * (External variable, defined in the output from parsing registry.y)
@@ -54,10 +53,16 @@ extern FILE *cregin;
 extern Corpus *cregcorpus;
 
 /**
- * Restarts the registry file parse;
- * function created in output from parsing registry.y
+ * Scans a registry entry from memory (the scanner is switched to the new buffer);
+ * function created in output from parsing registry.l
+ */
+extern struct yy_buffer_state *creg_scan_bytes(const char *bytes, size_t len);
+
+/**
+ * Deletes a scanner buffer created by creg_scan_bytes();
+ * function created in output from parsing registry.l
  */
-extern void cregrestart(FILE *file);
+extern void creg_delete_buffer(struct yy_buffer_state *buffer);
 
 /**
  * Parse a corpus registry file.
@@ -341,6 +346,975 @@ check_access_conditions(Corpus *corpus, int verbose)
   return access_ok;
 }
 
+/* ---------------------------------------------------------------------- REGISTRY CACHE */
+
+/**
+ * Environment variable with the path of the registry cache file
+ * (used if cl_set_registry_cache() has not been called).
+ */
+#define REGISTRY_CACHE_ENVVAR "CORPUS_REGISTRY_CACHE"
+
+/** Magic string at the beginning of a registry cache file (incremented when the format changes). */
+#define REGISTRY_CACHE_MAGIC "CWB registry cache 2\n"
+
+/**
+ * An entry of the registry cache: a registry file and the serialised Corpus object parsed from it.
+ *
+ * The fields file_mtime, file_size, text and text_len are filled in by cl_registry_prefetch(),
+ * possibly in parallel threads.
+ */
+typedef struct _RegistryCacheEntry {
+  char *filename;           /**< full path of the registry file */
+  int64_t mtime;            /**< modification time (in nanoseconds) of the file the blob was parsed from */
+  int64_t size;             /**< size of the file the blob was parsed from */
+  char *blob;               /**< the serialised Corpus object (or NULL) */
+  int blob_len;             /**< length of blob in bytes */
+  int checked;              /**< boolean: file_mtime and file_size are up to date */
+  int64_t file_mtime;       /**< modification time (in nanoseconds) of the registry file */
+  int64_t file_size;        /**< size of the registry file, -1 if it does not exist */
+  char *text;               /**< contents of the registry file (or NULL if not read yet) */
+  int text_len;             /**< length of text in bytes */
+} RegistryCacheEntry;
+
+/** Path of the registry cache file (NULL = no cache). */
+static char *registry_cache_file = NULL;
+/** Boolean: whether the cache file has been set (or looked up in the environment). */
+static int registry_cache_initialised = 0;
+/** The entries of the registry cache, indexed by the full path of the registry file. */
+static cl_lexhash registry_cache = NULL;
+/** Boolean: whether the registry cache has changed since it was read from disk. */
+static int registry_cache_dirty = 0;
+
+/** An entry in the log of registry entries loaded by cl_new_corpus(). */
+typedef struct {
+  char *registry_dir;
+  char *registry_name;
+  int source;               /**< 0 = parsed, 1 = from the cache, -1 = failed */
+  double seconds;
+} RegistryLogEntry;
+
+/** Maximum number of entries in the log of registry entries (older entries are discarded). */
+#define REGISTRY_LOG_MAX 4096
+
+/** The log is a ring buffer: the oldest entry is registry_log[registry_log_first]. */
+static RegistryLogEntry *registry_log = NULL;
+static int registry_log_n = 0;
+static int registry_log_first = 0;
+static int registry_log_allocated = 0;
+
+/** A growing buffer for serialising Corpus objects. */
+typedef struct {
+  char *data;
+  int len;
+  int allocated;
+} RegistryBuffer;
+
+/** A cursor for reading serialised Corpus objects; ok is cleared when reading beyond the end. */
+typedef struct {
+  char *pos;
+  char *end;
+  int ok;
+} RegistryReader;
+
+static void
+rb_put(RegistryBuffer *b, const void *data, int len)
+{
+  if (b->len + len > b->allocated) {
+    b->allocated = 2 * (b->len + len) + 256;
+    b->data = (char *)cl_realloc(b->data, b->allocated);
+  }
+  memcpy(b->data + b->len, data, len);
+  b->len += len;
+}
+
+static void
+rb_put_int(RegistryBuffer *b, int value)
+{
+  rb_put(b, &value, sizeof(int));
+}
+
+static void
+rb_put_string(RegistryBuffer *b, const char *str)
+{
+  int len = str ? strlen(str) : -1;
+  rb_put_int(b, len);
+  if (len > 0)
+    rb_put(b, str, len);
+}
+
+static int
+rr_get_int(RegistryReader *r)
+{
+  int value = 0;
+  if (r->ok && r->end - r->pos >= (long)sizeof(int)) {
+    memcpy(&value, r->pos, sizeof(int));
+    r->pos += sizeof(int);
+  }
+  else
+    r->ok = 0;
+  return value;
+}
+
+/** Reads a string written by rb_put_string(): returns a newly allocated string or NULL. */
+static char *
+rr_get_string(RegistryReader *r)
+{
+  char *str;
+  int len = rr_get_int(r);
+
+  if (!r->ok || len < 0)
+    return NULL;
+  if (r->end - r->pos < len) {
+    r->ok = 0;
+    return NULL;
+  }
+  str = (char *)cl_malloc(len + 1);
+  memcpy(str, r->pos, len);
+  str[len] = '\0';
+  r->pos += len;
+  return str;
+}
+
+/**
+ * Serialises a Corpus object parsed from a registry file.
+ *
+ * @return  Boolean: false if the corpus cannot be cached (because of access
+ *          restrictions or component paths that depend on the environment).
+ */
+static int
+registry_serialise(Corpus *corpus, RegistryBuffer *b)
+{
+  CorpusProperty prop;
+  Attribute *attr;
+  DynArg *arg;
+  int n, cid;
+
+  if (corpus->userAccessList || corpus->groupAccessList || corpus->hostAccessList)
+    return 0;
+
+  rb_put_string(b, corpus->id);
+  rb_put_string(b, corpus->name);
+  rb_put_string(b, corpus->path);
+  rb_put_string(b, corpus->info_file);
+  rb_put_int(b, corpus->charset);
+
+  for (n = 0, prop = corpus->properties; prop; prop = prop->next)
+    n++;
+  rb_put_int(b, n);
+  for (prop = corpus->properties; prop; prop = prop->next) {
+    rb_put_string(b, prop->property);
+    rb_put_string(b, prop->value);
+  }
+
+  for (n = 0, attr = corpus->attributes; attr; attr = attr->any.next)
+    n++;
+  rb_put_int(b, n);
+  for (attr = corpus->attributes; attr; attr = attr->any.next) {
+    rb_put_int(b, attr->type);
+    rb_put_string(b, attr->any.name);
+    rb_put_string(b, attr->any.path);
+    for (cid = CompDirectory; cid < CompLast; cid++)
+      if (attr->any.components[cid] && attr->any.components[cid]->path) {
+        /* declare_component() would expand references in the path */
+        if (strchr(attr->any.components[cid]->path, '$'))
+          return 0;
+        rb_put_int(b, cid);
+        rb_put_string(b, attr->any.components[cid]->path);
+      }
+    rb_put_int(b, -1);
+    if (attr->type == ATT_DYN) {
+      rb_put_string(b, attr->dyn.call);
+      rb_put_int(b, attr->dyn.res_type);
+      for (n = 0, arg = attr->dyn.arglist; arg; arg = arg->next)
+        n++;
+      rb_put_int(b, n);
+      for (arg = attr->dyn.arglist; arg; arg = arg->next)
+        rb_put_int(b, arg->type);
+    }
+  }
+  return 1;
+}
+
+/**
+ * Creates a Corpus object from its serialised form (the equivalent of parsing the registry file).
+ *
+ * @return  The Corpus object or NULL if the data is corrupt.
+ */
+static Corpus *
+registry_deserialise(char *blob, int blob_len)
+{
+  RegistryReader r;
+  Corpus *corpus;
+  CorpusProperty prop, last_prop = NULL;
+  Attribute *attr;
+  DynArg *arg, *last_arg;
+  int i, j, n, n_args, type, cid;
+  char *name, *path;
+
+  r.pos = blob;
+  r.end = blob + blob_len;
+  r.ok = 1;
+
+  corpus = (Corpus *)cl_malloc(sizeof(Corpus));
+  corpus->attributes = NULL;
+  corpus->properties = NULL;
+  corpus->groupAccessList = NULL;
+  corpus->hostAccessList = NULL;
+  corpus->userAccessList = NULL;
+  corpus->registry_dir = NULL;
+  corpus->registry_name = NULL;
+  corpus->nr_of_loads = 1;
+  corpus->next = NULL;
+
+  corpus->id = rr_get_string(&r);
+  corpus->name = rr_get_string(&r);
+  corpus->path = rr_get_string(&r);
+  corpus->info_file = rr_get_string(&r);
+  corpus->charset = (CorpusCharset)rr_get_int(&r);
+
+  n = rr_get_int(&r);
+  for (i = 0; i < n && r.ok; i++) {
+    prop = (CorpusProperty)cl_malloc(sizeof(struct TCorpusProperty));
+    prop->property = rr_get_string(&r);
+    prop->value = rr_get_string(&r);
+    prop->next = NULL;
+    if (last_prop)
+      last_prop->next = prop;
+    else
+      corpus->properties = prop;
+    last_prop = prop;
+  }
+
+  n = rr_get_int(&r);
+  for (i = 0; i < n && r.ok; i++) {
+    type = rr_get_int(&r);
+    name = rr_get_string(&r);
+    path = rr_get_string(&r);
+    if (!r.ok || name == NULL || NULL == (attr = setup_attribute(corpus, name, type, NULL))) {
+      cl_free(name);
+      cl_free(path);
+      r.ok = 0;
+      break;
+    }
+    attr->any.path = path;
+    while (r.ok && (cid = rr_get_int(&r)) >= 0) {
+      path = rr_get_string(&r);
+      if (cid >= CompLast || path == NULL)
+        r.ok = 0;
+      else
+        declare_component(attr, cid, path);
+      cl_free(path);
+    }
+    if (type == ATT_DYN) {
+      attr->dyn.call = rr_get_string(&r);
+      attr->dyn.res_type = rr_get_int(&r);
+      attr->dyn.arglist = last_arg = NULL;
+      n_args = rr_get_int(&r);
+      for (j = 0; j < n_args && r.ok; j++) {
+        arg = (DynArg *)cl_malloc(sizeof(DynArg));
+        arg->type = rr_get_int(&r);
+        arg->next = NULL;
+        if (last_arg)
+          last_arg->next = arg;
+        else
+          attr->dyn.arglist = arg;
+        last_arg = arg;
+      }
+    }
+  }
+
+  if (!r.ok || corpus->attributes == NULL) {
+    cl_delete_corpus(corpus);
+    return NULL;
+  }
+  return corpus;
+}
+
+/**
+ * Gets the modification time and size of a file.
+ *
+ * The modification time is in nanoseconds where the file system records it
+ * (otherwise in whole seconds), so that a registry file edited twice within a
+ * second is not taken for the cached version.
+ *
+ * @return  Boolean: true if the file exists.
+ */
+static int
+registry_file_stat(char *filename, int64_t *mtime, int64_t *size)
+{
+  struct stat st;
+
+  if (0 != stat(filename, &st) || S_ISDIR(st.st_mode)) {
+    *mtime = 0;
+    *size = -1;
+    return 0;
+  }
+#if defined(__MINGW__)
+  *mtime = (int64_t)st.st_mtime * 1000000000;
+#elif defined(__APPLE__)
+  *mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+  *mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+  *size = (int64_t)st.st_size;
+  return 1;
+}
+
+/**
+ * Reads a file into memory (without calling any R functions, so this can run in a thread).
+ *
+ * @return  The contents of the file (allocated with malloc()) or NULL.
+ */
+static char *
+registry_read_file(FILE *fd, int *len)
+{
+  char *text = NULL, *tmp;
+  size_t n = 0, allocated = 0, got;
+
+  do {
+    if (n + 4096 > allocated) {
+      allocated = 2 * allocated + 4096;
+      if (NULL == (tmp = (char *)realloc(text, allocated))) {
+        free(text);
+        return NULL;
+      }
+      text = tmp;
+    }
+    got = fread(text + n, 1, allocated - n, fd);
+    n += got;
+  } while (got > 0);
+
+  *len = (int)n;
+  return text;
+}
+
+/** Frees an entry of the registry cache (cleanup function of the lexhash). */
+static void
+registry_cache_free_entry(cl_lexhash_entry entry)
+{
+  RegistryCacheEntry *e = (RegistryCacheEntry *)entry->data.pointer;
+
+  if (e) {
+    cl_free(e->filename);
+    cl_free(e->blob);
+    cl_free(e->text);
+    cl_free(e);
+    entry->data.pointer = NULL;
+  }
+}
+
+/** Gets the cache entry of a registry file, creating it if necessary. */
+static RegistryCacheEntry *
+registry_cache_entry(char *filename, int create)
+{
+  cl_lexhash_entry entry;
+  RegistryCacheEntry *e;
+
+  if (NULL != (entry = cl_lexhash_find(registry_cache, filename)))
+    return (RegistryCacheEntry *)entry->data.pointer;
+  if (!create)
+    return NULL;
+
+  e = (RegistryCacheEntry *)cl_calloc(1, sizeof(RegistryCacheEntry));
+  e->filename = cl_strdup(filename);
+  e->file_size = -1;
+  entry = cl_lexhash_add(registry_cache, filename);
+  entry->data.pointer = e;
+  return e;
+}
+
+/**
+ * Reads the registry cache file into memory.
+ *
+ * A cache file that does not exist, or that has been written by a different
+ * version of the CL or on a different platform, is ignored.
+ *
+ * @return  The number of entries read.
+ */
+static int
+registry_cache_read(void)
+{
+  FILE *fd;
+  char *text;
+  int len, n = 0;
+  RegistryReader r;
+  RegistryCacheEntry *e;
+  char *filename;
+
+  if (!registry_cache_file || NULL == (fd = fopen(registry_cache_file, "rb")))
+    return 0;
+  text = registry_read_file(fd, &len);
+  fclose(fd);
+  if (!text)
+    return 0;
+
+  r.pos = text;
+  r.end = text + len;
+  r.ok = 1;
+  if (len < (int)strlen(REGISTRY_CACHE_MAGIC) || 0 != strncmp(text, REGISTRY_CACHE_MAGIC, strlen(REGISTRY_CACHE_MAGIC)))
+    r.ok = 0;
+  else
+    r.pos += strlen(REGISTRY_CACHE_MAGIC);
+  /* the binary format depends on the platform and on the components known to this version of the CL */
+  if (rr_get_int(&r) != (int)sizeof(int64_t) || rr_get_int(&r) != CompLast)
+    r.ok = 0;
+
+  while (r.ok && r.pos < r.end) {
+    filename = rr_get_string(&r);
+    if (!r.ok || !filename || r.end - r.pos < (long)(2 * sizeof(int64_t))) {
+      cl_free(filename);
+      break;
+    }
+    e = registry_cache_entry(filename, 1);
+    memcpy(&e->mtime, r.pos, sizeof(int64_t));
+    memcpy(&e->size, r.pos + sizeof(int64_t), sizeof(int64_t));
+    r.pos += 2 * sizeof(int64_t);
+    e->blob_len = rr_get_int(&r);
+    if (!r.ok || e->blob_len < 0 || r.end - r.pos < e->blob_len) {
+      e->blob_len = 0;
+      cl_free(filename);
+      break;
+    }
+    cl_free(e->blob);
+    e->blob = (char *)cl_malloc(e->blob_len);
+    memcpy(e->blob, r.pos, e->blob_len);
+    r.pos += e->blob_len;
+    cl_free(filename);
+    n++;
+  }
+
+  free(text);
+  return n;
+}
+
+/** Sets up the registry cache on first use (from the environment, unless a cache file has been set). */
+static void
+registry_cache_init(void)
+{
+  char *filename;
+
+  if (!registry_cache_initialised) {
+    registry_cache_initialised = 1;
+    if (NULL != (filename = getenv(REGISTRY_CACHE_ENVVAR)) && *filename)
+      cl_set_registry_cache(filename);
+  }
+}
+
+/**
+ * Sets the file used to cache parsed registry entries.
+ *
+ * Registry entries are stored in binary form, together with the modification time
+ * and size of the registry file; an entry is only used as long as these match. If
+ * no cache file is set, the environment variable CORPUS_REGISTRY_CACHE is used.
+ * Note that the cache is written to disk by cl_registry_cache_write().
+ *
+ * @param filename  Path of the cache file, which is created if necessary;
+ *                  NULL turns the cache off.
+ * @return          The number of entries read from the cache file.
+ */
+int
+cl_set_registry_cache(char *filename)
+{
+  registry_cache_initialised = 1;
+  cl_free(registry_cache_file);
+  if (registry_cache) {
+    cl_delete_lexhash(registry_cache);
+    registry_cache = NULL;
+  }
+  registry_cache_dirty = 0;
+
+  if (filename == NULL || *filename == '\0')
+    return 0;
+
+  registry_cache_file = cl_strdup(filename);
+  registry_cache = cl_new_lexhash(0);
+  cl_lexhash_set_cleanup_function(registry_cache, registry_cache_free_entry);
+  cl_lexhash_auto_grow(registry_cache, 1);
+  return registry_cache_read();
+}
+
+/**
+ * Gets the path of the registry cache file.
+ *
+ * @return  Pointer to an internal string (must not be freed) or NULL if there is no cache.
+ */
+char *
+cl_get_registry_cache(void)
+{
+  registry_cache_init();
+  return registry_cache_file;
+}
+
+/**
+ * Writes the registry cache to disk, if it has changed.
+ *
+ * The cache is written to a temporary file first, which then replaces the cache file.
+ *
+ * @return  Boolean: true if the cache is up to date on disk, false on error.
+ */
+int
+cl_registry_cache_write(void)
+{
+  RegistryBuffer b = { NULL, 0, 0 };
+  cl_lexhash_entry entry;
+  RegistryCacheEntry *e;
+  char *tmp_name;
+  FILE *fd;
+  int ok;
+
+  registry_cache_init();
+  if (!registry_cache_file || !registry_cache_dirty)
+    return 1;
+
+  rb_put(&b, REGISTRY_CACHE_MAGIC, strlen(REGISTRY_CACHE_MAGIC));
+  rb_put_int(&b, sizeof(int64_t));
+  rb_put_int(&b, CompLast);
+  cl_lexhash_iterator_reset(registry_cache);
+  while (NULL != (entry = cl_lexhash_iterator_next(registry_cache))) {
+    e = (RegistryCacheEntry *)entry->data.pointer;
+    if (!e->blob)
+      continue;
+    rb_put_string(&b, e->filename);
+    rb_put(&b, &e->mtime, sizeof(int64_t));
+    rb_put(&b, &e->size, sizeof(int64_t));
+    rb_put_int(&b, e->blob_len);
+    rb_put(&b, e->blob, e->blob_len);
+  }
+
+  tmp_name = (char *)cl_malloc(strlen(registry_cache_file) + 5);
+  sprintf(tmp_name, "%s.tmp", registry_cache_file);
+  ok = 0;
+  if (NULL != (fd = fopen(tmp_name, "wb"))) {
+    ok = (fwrite(b.data, 1, b.len, fd) == (size_t)b.len);
+    ok = (0 == fclose(fd)) && ok;
+#ifdef __MINGW__
+    if (ok)
+      remove(registry_cache_file);
+#endif
+    ok = ok && (0 == rename(tmp_name, registry_cache_file));
+    if (!ok)
+      remove(tmp_name);
+  }
+  if (!ok)
+    Rprintf("CL: can't write registry cache file %s\n", registry_cache_file);
+  else
+    registry_cache_dirty = 0;
+
+  cl_free(tmp_name);
+  cl_free(b.data);
+  return ok;
+}
+
+/**
+ * Gets the next directory from a list of registry directories.
+ *
+ * Unlike cl_path_get_component(), this does not keep any state between calls, so
+ * it can be used while callers iterate over the same list (as CQP does when it
+ * loads the corpus names).
+ *
+ * @param pos  Pointer to the current position in the list, which is advanced.
+ * @return     The directory (without the '?' marking optional directories) in a
+ *             newly allocated string, or NULL if there are no more directories.
+ */
+static char *
+registry_dir_next(char **pos)
+{
+  char *start, *dirname;
+
+  while (**pos == PATH_SEPARATOR)
+    (*pos)++;
+  if (**pos == '\0')
+    return NULL;
+  if (**pos == '?' && (*pos)[1] != '\0' && (*pos)[1] != PATH_SEPARATOR)
+    (*pos)++;
+  start = *pos;
+  while (**pos != PATH_SEPARATOR && **pos != '\0')
+    (*pos)++;
+  dirname = (char *)cl_malloc(*pos - start + 1);
+  memcpy(dirname, start, *pos - start);
+  dirname[*pos - start] = '\0';
+  return dirname;
+}
+
+/**
+ * Creates the full path of a registry file.
+ *
+ * @return  The path in a newly allocated string.
+ */
+static char *
+registry_file_path(char *dirname, char *name)
+{
+  char *filename = (char *)cl_malloc(strlen(dirname) + strlen(name) + 2);
+
+  if (dirname[0] && dirname[strlen(dirname) - 1] == SUBDIR_SEPARATOR)
+    sprintf(filename, "%s%s", dirname, name);
+  else
+    sprintf(filename, "%s%c%s", dirname, SUBDIR_SEPARATOR, name);
+  return filename;
+}
+
+/** Data shared by the threads of cl_registry_prefetch(). */
+typedef struct {
+  RegistryCacheEntry **entries;
+  int n;
+} RegistryPrefetch;
+
+/**
+ * Worker of cl_registry_prefetch(): checks the registry files of every n_threads-th entry and
+ * reads those that are not in the cache or have changed.
+ */
+static void
+registry_prefetch_worker(int thread, int n_threads, void *data)
+{
+  RegistryPrefetch *rp = (RegistryPrefetch *)data;
+  RegistryCacheEntry *e;
+  FILE *fd;
+  int i;
+
+  for (i = thread; i < rp->n; i += n_threads) {
+    e = rp->entries[i];
+    e->checked = 1;
+    if (!registry_file_stat(e->filename, &e->file_mtime, &e->file_size))
+      continue;
+    if (e->blob && e->mtime == e->file_mtime && e->size == e->file_size)
+      continue;
+    if (NULL != (fd = fopen(e->filename, "rb"))) {
+      e->text = registry_read_file(fd, &e->text_len);
+      fclose(fd);
+    }
+  }
+}
+
+/**
+ * Checks all registry files in the registry directories against the registry cache.
+ *
+ * Registry files are checked (and read, if their entry in the cache is missing or out
+ * of date) in parallel, using up to cl_threads threads. Subsequent calls of cl_new_corpus()
+ * for these corpora then do not need to access the registry files. The registry cache
+ * is created if it has not been set up (the cache is not written to disk without a
+ * cache file, though).
+ *
+ * @param registry_dir  The registry directory or directories (separated by
+ *                      PATH_SEPARATOR), may be NULL for the default registry.
+ * @return              The number of registry files found.
+ */
+int
+cl_registry_prefetch(char *registry_dir)
+{
+  char *pos, *dirname, *filename;
+  DIR *dp;
+  struct dirent *ep;
+  RegistryPrefetch rp;
+  RegistryCacheEntry *e;
+  int allocated = 0, n_threads;
+
+  registry_cache_init();
+  if (!registry_cache) {
+    registry_cache = cl_new_lexhash(0);
+    cl_lexhash_set_cleanup_function(registry_cache, registry_cache_free_entry);
+    cl_lexhash_auto_grow(registry_cache, 1);
+  }
+  if (registry_dir == NULL)
+    registry_dir = cl_standard_registry();
+
+  rp.entries = NULL;
+  rp.n = 0;
+
+  pos = registry_dir;
+  while (NULL != (dirname = registry_dir_next(&pos))) {
+    if (NULL == (dp = opendir(dirname))) {
+      cl_free(dirname);
+      continue;
+    }
+    while ((ep = readdir(dp))) {
+      /* same files as considered by CQP: no hidden files, no backup files */
+      if (strchr(ep->d_name, '.') || strchr(ep->d_name, '~'))
+        continue;
+      filename = registry_file_path(dirname, ep->d_name);
+      e = registry_cache_entry(filename, 1);
+      cl_free(filename);
+      cl_free(e->text);
+      e->checked = 0;
+      if (rp.n >= allocated) {
+        allocated = 2 * allocated + 64;
+        rp.entries = (RegistryCacheEntry **)cl_realloc(rp.entries, sizeof(RegistryCacheEntry *) * allocated);
+      }
+      rp.entries[rp.n++] = e;
+    }
+    closedir(dp);
+    cl_free(dirname);
+  }
+
+  n_threads = (rp.n < cl_threads) ? rp.n : cl_threads;
+  if (n_threads > 0)
+    cl_parallel(registry_prefetch_worker, n_threads, &rp);
+
+  cl_free(rp.entries);
+  return rp.n;
+}
+
+/**
+ * Adds an entry to the log of registry entries loaded by cl_new_corpus().
+ *
+ * Once the log holds REGISTRY_LOG_MAX entries, the oldest entry is replaced.
+ */
+static void
+registry_log_add(char *registry_dir, char *registry_name, int source, struct timeval *start)
+{
+  struct timeval now;
+  RegistryLogEntry *entry;
+
+  gettimeofday(&now, NULL);
+  if (registry_log_n >= REGISTRY_LOG_MAX) {
+    entry = &registry_log[registry_log_first];
+    registry_log_first = (registry_log_first + 1) % registry_log_allocated;
+    cl_free(entry->registry_dir);
+    cl_free(entry->registry_name);
+  }
+  else {
+    if (registry_log_n >= registry_log_allocated) {
+      /* the ring only wraps around once it is full, so the entries are still in order */
+      registry_log_allocated = MIN(2 * registry_log_allocated + 64, REGISTRY_LOG_MAX);
+      registry_log = (RegistryLogEntry *)cl_realloc(registry_log, sizeof(RegistryLogEntry) * registry_log_allocated);
+    }
+    entry = &registry_log[registry_log_n++];
+  }
+  entry->registry_dir = cl_strdup(registry_dir);
+  entry->registry_name = cl_strdup(registry_name);
+  entry->source = source;
+  entry->seconds = (now.tv_sec - start->tv_sec) + (now.tv_usec - start->tv_usec) / 1e6;
+}
+
+/**
+ * Gets the number of entries in the log of registry entries loaded by cl_new_corpus().
+ *
+ * The log keeps the last REGISTRY_LOG_MAX entries.
+ */
+int
+cl_registry_log_size(void)
+{
+  return registry_log_n;
+}
+
+/**
+ * Gets an entry from the log of registry entries loaded by cl_new_corpus().
+ *
+ * @param i              Number of the entry (0 .. cl_registry_log_size() - 1).
+ * @param registry_dir   Set to the registry directory (or directories) searched
+ *                       (pointer to an internal string).
+ * @param registry_name  Set to the name of the corpus (pointer to an internal string).
+ * @param source         Set to 0 if the registry file has been parsed, to 1 if the
+ *                       corpus has been set up from the registry cache, and to -1 if
+ *                       the corpus could not be loaded.
+ * @param seconds        Set to the time taken (in seconds).
+ * @return               Boolean: false if i is out of range.
+ */
+int
+cl_registry_log_entry(int i, char **registry_dir, char **registry_name, int *source, double *seconds)
+{
+  RegistryLogEntry *entry;
+
+  if (i < 0 || i >= registry_log_n)
+    return 0;
+  entry = &registry_log[(registry_log_first + i) % registry_log_allocated];
+  *registry_dir = entry->registry_dir;
+  *registry_name = entry->registry_name;
+  *source = entry->source;
+  *seconds = entry->seconds;
+  return 1;
+}
+
+/**
+ * Clears the log of registry entries loaded by cl_new_corpus().
+ */
+void
+cl_registry_log_reset(void)
+{
+  int i;
+
+  for (i = 0; i < registry_log_n; i++) {
+    cl_free(registry_log[(registry_log_first + i) % registry_log_allocated].registry_dir);
+    cl_free(registry_log[(registry_log_first + i) % registry_log_allocated].registry_name);
+  }
+  registry_log_n = 0;
+  registry_log_first = 0;
+}
+
+/**
+ * Inserts a newly set up Corpus object into the list of loaded corpora.
+ *
+ * The corpus gets a new serial number, so that objects that refer to a corpus
+ * (such as prepared queries) can tell whether it has been reloaded since.
+ */
+static void
+registry_add_corpus(Corpus *corpus, char *real_registry_name, char *canonical_name)
+{
+  static unsigned long serial = 0;
+  Attribute *attr;
+
+  corpus->serial = ++serial;
+  corpus->registry_dir = real_registry_name;
+  corpus->registry_name = cl_strdup(canonical_name);
+  corpus->next = loaded_corpora;
+  loaded_corpora = corpus;
+  /* load the plugins of dynamic attributes now, so that threads calling them don't modify the attributes */
+  for (attr = corpus->attributes; attr; attr = attr->any.next)
+    if (attr->type == ATT_DYN)
+      dynamic_load_plugin(attr);
+  /* check whether ID field corresponds to name of registry file */
+  if (corpus->id && (strcmp(corpus->id, canonical_name) != 0)) {
+#ifndef R_PACKAGE
+    fprintf(
+        stderr,
+        "CL warning: ID field '%s' does not match name of registry file %s/%s\n",
+        corpus->id, real_registry_name, canonical_name);
+#else
+    Rf_warning(
+      "CL warning: ID field '%s' does not match name of registry file %s/%s\n",
+      corpus->id, real_registry_name, canonical_name);
+    
+#endif
+  }
+}
+
+/**
+ * Parses a registry entry in memory and sets up the Corpus object.
+ *
+ * @param text                The contents of the registry file.
+ * @param text_len            The length of text.
+ * @param real_registry_name  The registry directory the file was found in (taken over by the Corpus object).
+ * @param canonical_name      The CWB name of the corpus.
+ * @return                    The Corpus object, or NULL if there was a parse error or
+ *                            access to the corpus is not permitted.
+ */
+static Corpus *
+registry_parse(char *text, int text_len, char *real_registry_name, char *canonical_name)
+{
+  Corpus *corpus = NULL;
+  struct yy_buffer_state *buffer;
+
+  buffer = creg_scan_bytes(text, text_len);
+  cregin_path = real_registry_name;
+  cregin_name = canonical_name;
+  if (cregparse() == 0) { /* OK */
+    if (check_access_conditions(cregcorpus, 0)) {
+      corpus = cregcorpus;
+      registry_add_corpus(corpus, real_registry_name, canonical_name);
+    }
+    else
+      cl_delete_corpus(cregcorpus);
+  }
+  cregin_path = "";
+  cregin_name = "";
+  cregcorpus = NULL;
+  creg_delete_buffer(buffer);
+
+  return corpus;
+}
+
+/**
+ * Stores a Corpus object that has just been parsed in the registry cache.
+ */
+static void
+registry_cache_store(RegistryCacheEntry *e, Corpus *corpus, int64_t mtime, int64_t size)
+{
+  RegistryBuffer b = { NULL, 0, 0 };
+
+  cl_free(e->blob);
+  e->blob_len = 0;
+  if (registry_serialise(corpus, &b)) {
+    e->blob = b.data;
+    e->blob_len = b.len;
+    e->mtime = mtime;
+    e->size = size;
+  }
+  else
+    cl_free(b.data);
+  registry_cache_dirty = 1;
+}
+
+/**
+ * Sets up a Corpus object using the registry cache.
+ *
+ * The registry directories are searched in order, as by find_corpus_registry();
+ * the corpus is set up from the cache if the cached entry is up to date, or parsed
+ * from the contents of the registry file read by cl_registry_prefetch(). Otherwise,
+ * the registry file is read and parsed, and the result is stored in the cache.
+ *
+ * @param registry_dir    The registry directory or directories.
+ * @param canonical_name  The CWB name of the corpus.
+ * @param source          Set to 1 if the corpus was set up from the cache, to 0 otherwise.
+ * @return                The Corpus object or NULL.
+ */
+static Corpus *
+registry_load(char *registry_dir, char *canonical_name, int *source)
+{
+  char *pos, *dirname, *filename;
+  RegistryCacheEntry *e = NULL;
+  Corpus *corpus = NULL;
+  FILE *fd;
+  char *text;
+  int text_len;
+  int64_t mtime = 0, size = -1;
+
+  *source = 0;
+
+  if (registry_cache) {
+    /* locate the registry file (the first directory containing it wins) */
+    pos = registry_dir;
+    while (NULL != (dirname = registry_dir_next(&pos))) {
+      filename = registry_file_path(dirname, canonical_name);
+      e = registry_cache_entry(filename, 0);
+      if (e && e->checked) {
+        mtime = e->file_mtime;
+        size = e->file_size;
+      }
+      else
+        registry_file_stat(filename, &mtime, &size);
+      if (size >= 0 && !e)
+        e = registry_cache_entry(filename, 1);
+      cl_free(filename);
+      if (size >= 0)
+        break;
+      e = NULL;
+      cl_free(dirname);
+    }
+
+    if (e) {
+      if (e->blob && e->mtime == mtime && e->size == size) {
+        if (NULL != (corpus = registry_deserialise(e->blob, e->blob_len))) {
+          registry_add_corpus(corpus, cl_strdup(dirname), canonical_name);
+          *source = 1;
+        }
+      }
+      if (!corpus && e->text) {
+        corpus = registry_parse(e->text, e->text_len, cl_strdup(dirname), canonical_name);
+        if (corpus)
+          registry_cache_store(e, corpus, mtime, size);
+      }
+      cl_free(e->text);
+      e->checked = 0;
+      cl_free(dirname);
+    }
+    if (corpus)
+      return corpus;
+  }
+
+  if (!(fd = find_corpus_registry(registry_dir, canonical_name, &dirname)))
+    Rprintf("cl_new_corpus: can't locate <%s> in %s\n", canonical_name, registry_dir);
+  else {
+    text = registry_read_file(fd, &text_len);
+    fclose(fd);
+    if (text) {
+      corpus = registry_parse(text, text_len, dirname, canonical_name);
+      free(text);
+      if (corpus && e)
+        registry_cache_store(e, corpus, mtime, size);
+    }
+  }
+  return corpus;
+}
+
 /**
  * Creates a Corpus object to represent a given indexed corpus, located in
  * a given directory accessible to the program.
@@ -353,7 +1327,6 @@ check_access_conditions(Corpus *corpus, int verbose)
 Corpus *
 cl_new_corpus(char *registry_dir, char *registry_name)
 {
-  char *real_registry_name;
   static char *canonical_name = NULL;
   Corpus *corpus;
 
@@ -375,45 +1348,16 @@ cl_new_corpus(char *registry_dir, char *registry_name)
   else {
     /* it's not yet in memory, so create and load it */
 
+    struct timeval start;
+    int source;
+
     if (registry_dir == NULL)
       registry_dir = cl_standard_registry();
 
-    if (!(cregin = find_corpus_registry(registry_dir, canonical_name, &real_registry_name)))
-      Rprintf("cl_new_corpus: can't locate <%s> in %s\n", registry_name, registry_dir);
-    else {
-      cregrestart(cregin);
-      cregin_path = real_registry_name;
-      cregin_name = canonical_name;
-      if (cregparse() == 0) { /* OK */
-        if (check_access_conditions(cregcorpus, 0)) {
-          corpus = cregcorpus;
-          corpus->registry_dir = real_registry_name;
-          corpus->registry_name = cl_strdup(canonical_name);
-          corpus->next = loaded_corpora;
-          loaded_corpora = corpus;
-          /* check whether ID field corresponds to name of registry file */
-          if (corpus->id && (strcmp(corpus->id, canonical_name) != 0)) {
-#ifndef R_PACKAGE
-            fprintf(
-                stderr,
-                "CL warning: ID field '%s' does not match name of registry file %s/%s\n",
-                corpus->id, real_registry_name, canonical_name);
-#else
-            Rf_warning(
-              "CL warning: ID field '%s' does not match name of registry file %s/%s\n",
-              corpus->id, real_registry_name, canonical_name);
-            
-#endif
-          }
-        }
-        else
-          cl_delete_corpus(cregcorpus);
-      }
-      cregin_path = "";
-      cregin_name = "";
-      cregcorpus = NULL;
-      fclose(cregin);
-    }
+    gettimeofday(&start, NULL);
+    registry_cache_init();
+    corpus = registry_load(registry_dir, canonical_name, &source);
+    registry_log_add(registry_dir, canonical_name, corpus ? source : -1, &start);
   }
 
   return corpus;
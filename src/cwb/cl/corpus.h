@@ -59,6 +59,7 @@ struct TCorpus {
   char *registry_name;             /**< the cwb-name of this corpus */
 
   int nr_of_loads;                 /**< the number of setup_corpus ops */
+  unsigned long serial;            /**< number of the load of this corpus (a reloaded corpus gets a new one) */
 
   union _Attribute *attributes;    /**< the list of attributes */
 
@@ -96,6 +96,9 @@
 #define CWB_SUBCORPMAGIC_NEW 36193929
 /* new format -- Mon Jul 31 17:19:27 1995 (oli) */
 
+/** magic number for subcorpus (incl. query) file format: versioned BINARY format that can be memory-mapped (== orig + 2) */
+#define CWB_SUBCORPMAGIC_BINARY 36193930
+
 
 
 
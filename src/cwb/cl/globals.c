@@ -31,6 +31,10 @@
 
 /* #include <locale.h> */
 
+#ifndef __MINGW__
+#include <pthread.h>
+#endif
+
 #include "globals.h"
 void Rprintf(const char *, ...);
 
@@ -77,6 +81,22 @@ int cl_optimize = 0;
  */
 size_t cl_memory_limit = 0;
 
+/**
+ *  Global configuration variable: number of threads.
+ *
+ *  Upper limit for the number of threads used by functions that can
+ *  work in parallel (1 = no parallel processing).
+ */
+int cl_threads = 2;
+
+/**
+ *  Set in the threads started by cl_parallel(), but not in the calling thread.
+ *
+ *  Functions that keep state in shared objects (such as the decompression
+ *  buffer of a p-attribute) use private buffers in these threads instead.
+ */
+CL_THREAD_LOCAL int cl_worker_thread = 0;
+
 
 /**
  * Startup function for the CL. All programs that use CL should call this before
@@ -171,6 +191,19 @@ cl_set_memory_limit(int megabytes)
     cl_memory_limit = (size_t)megabytes;
 }
 
+/**
+ * Sets the maximum number of threads used by CL and CQP functions.
+ *
+ * @param n  The number of threads; values less than 1 are treated as 1.
+ *
+ * @see cl_threads
+ */
+void
+cl_set_threads(int n)
+{
+  cl_threads = (n < 1) ? 1 : n;
+}
+
 
 int
 cl_get_debug_level(void)
@@ -189,3 +222,96 @@ cl_get_memory_limit(void)
 {
   return (int)cl_memory_limit;
 }
+
+int
+cl_get_threads(void)
+{
+  return cl_threads;
+}
+
+
+#ifndef __MINGW__
+/** Arguments of a thread started by cl_parallel(). */
+typedef struct {
+  ClWorker worker;
+  int thread;
+  int n_threads;
+  void *data;
+  int regopt_successes;         /**< counters of the regex optimiser in this thread */
+  int regopt_trials;
+} ClWorkerArgs;
+
+/** Start routine of the threads started by cl_parallel(). */
+static void *
+cl_parallel_start(void *args)
+{
+  ClWorkerArgs *a = (ClWorkerArgs *)args;
+  cl_worker_thread = 1;
+  a->worker(a->thread, a->n_threads, a->data);
+  cl_regex_worker_done();
+  a->regopt_successes = cl_regopt_successes;
+  a->regopt_trials = cl_regopt_trials;
+  return NULL;
+}
+#endif
+
+/**
+ * Runs a function in several threads and waits until all of them are done.
+ *
+ * The worker is called once for each thread (0 .. n_threads - 1); thread 0 runs
+ * in the calling thread. Workers must not call any R functions or print messages.
+ * Data used by the CL functions they call must have been loaded before (e.g. by
+ * accessing each attribute once in the calling thread).
+ * If threads are not available (or can't be created), the remaining workers are
+ * called one after the other in the calling thread, so workers must not depend
+ * on running concurrently.
+ *
+ * @param worker     The function to run.
+ * @param n_threads  The number of threads; if less than 1, cl_threads is used.
+ * @param data       Pointer passed to each call of the worker.
+ */
+void
+cl_parallel(ClWorker worker, int n_threads, void *data)
+{
+  int t;
+#ifndef __MINGW__
+  pthread_t *threads;
+  ClWorkerArgs *args;
+  int *started;
+#endif
+
+  if (n_threads < 1)
+    n_threads = cl_threads;
+
+#ifndef __MINGW__
+  if (n_threads > 1) {
+    threads = (pthread_t *)cl_malloc(sizeof(pthread_t) * n_threads);
+    args = (ClWorkerArgs *)cl_malloc(sizeof(ClWorkerArgs) * n_threads);
+    started = (int *)cl_calloc(n_threads, sizeof(int));
+    for (t = 1; t < n_threads; t++) {
+      args[t].worker = worker;
+      args[t].thread = t;
+      args[t].n_threads = n_threads;
+      args[t].data = data;
+      started[t] = (0 == pthread_create(&threads[t], NULL, cl_parallel_start, &args[t]));
+    }
+    worker(0, n_threads, data);
+    for (t = 1; t < n_threads; t++) {
+      if (started[t]) {
+        pthread_join(threads[t], NULL);
+        cl_regopt_successes += args[t].regopt_successes;
+        cl_regopt_trials += args[t].regopt_trials;
+      }
+      else
+        worker(t, n_threads, data);
+    }
+    cl_free(started);
+    cl_free(args);
+    cl_free(threads);
+    return;
+  }
+#endif
+
+  for (t = 0; t < n_threads; t++)
+    worker(t, n_threads, data);
+}
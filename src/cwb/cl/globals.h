@@ -41,6 +41,17 @@ void	Rf_warning(const char *, ...);
 extern int cl_debug;
 extern int cl_optimize;
 extern size_t cl_memory_limit;
+extern int cl_threads;
+
+/* set in the threads started by cl_parallel() (but not in the calling thread) */
+extern CL_THREAD_LOCAL int cl_worker_thread;
+
+/* counters of the regex optimiser (one per thread, see cl_parallel()) */
+extern CL_THREAD_LOCAL int cl_regopt_successes;
+extern CL_THREAD_LOCAL int cl_regopt_trials;
+
+/* frees the match data of cl_regex_match() when a thread started by cl_parallel() is done */
+void cl_regex_worker_done(void);
 
 
 #endif
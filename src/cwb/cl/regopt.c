@@ -72,7 +72,10 @@ struct _cl_regex {
   char *grain[MAX_GRAINS];           /**< @see cl_regopt_grain */
   int anchor_start;                  /**< @see cl_regopt_anchor_start */
   int anchor_end;                    /**< @see cl_regopt_anchor_end */
-  int jumptable[256];                /**< @see cl_regopt_jumptable @see make_jump_table */
+  int prefilter_len;                 /**< number of bytes of each grain packed into the prefilter @see make_prefilter */
+  uint64_t prefilter_mask[256];      /**< bit-parallel shift-and masks for all grains (one bit per grain byte) */
+  uint64_t prefilter_init;           /**< bits marking the first byte of each grain in the prefilter state */
+  uint64_t prefilter_final;          /**< bits marking the last byte of each grain in the prefilter state */
 };
 
 
@@ -140,9 +143,26 @@ char local_grain_data[CL_MAX_LINE_LENGTH];
  * A counter of how many times the "grain" system has allwoed us to avoid
  * calling the regex engine.
  *
+ * Threads started by cl_parallel() count separately; their counts are added
+ * to those of the calling thread when they are done.
+ *
  * @see cl_regopt_count_get
  */
-int cl_regopt_successes = 0;
+CL_THREAD_LOCAL int cl_regopt_successes = 0;
+
+/**
+ * A counter of how many strings have been scanned with the "grain" prefilter
+ * (whether or not the regex engine had to be called afterwards).
+ *
+ * @see cl_regopt_count_trials
+ */
+CL_THREAD_LOCAL int cl_regopt_trials = 0;
+
+/** Buffers used by cl_regex_match() in threads started by cl_parallel() (instead of those of the CL_Regex). */
+static CL_THREAD_LOCAL char worker_haystack_buf[CL_MAX_LINE_LENGTH];
+static CL_THREAD_LOCAL char worker_haystack_casefold[2 * CL_MAX_LINE_LENGTH];
+/** Match data used by cl_regex_match() in threads started by cl_parallel(); it only has room for the whole match. */
+static CL_THREAD_LOCAL pcre2_match_data *worker_mdata = NULL;
 
 
 /*
@@ -159,10 +179,10 @@ char cl_regex_error[CL_MAX_LINE_LENGTH];
 
 
 /*
- * static prototypes
+ * prototypes of optimiser functions (non-exported)
  */
-/* static void regopt_data_copy_to_regex_object(CL_Regex rx); */
-/* static int cl_regopt_analyse(char *regex); */
+void regopt_data_copy_to_regex_object(CL_Regex rx);
+int cl_regopt_analyse(char *regex);
 
 /**
  * Create a new CL_regex object (ie a regular expression buffer).
@@ -174,8 +194,8 @@ char cl_regex_error[CL_MAX_LINE_LENGTH];
  *
  * The regular expression engine used is PCRE. However, the regex is optimized by
  * scanning it for literal strings ("grains") that must be contained in any
- * match; the grains can be used as a fast pre-filter (using Boyer-Moore search
- * for the grains).
+ * match; the grains can be used as a fast pre-filter (a single-pass bit-parallel
+ * search for all grains at once, see make_prefilter()).
  *
  * The optimizer only understands a subset of PCRE syntax:
  *  - literal characters (alphanumeric, safe punctuation, escaped punctuation)
@@ -213,7 +233,7 @@ cl_new_regex(char *regex, int flags, CorpusCharset charset)
   PCRE2_SIZE length_regex;
 
   CL_Regex rx;
-  int /* optimised, */ l;
+  int optimised, l;
 
   uint32_t  options_for_pcre2 = 0; /* pcre2 patch (previously: int)*/
   /* const char *errstring_for_pcre2 = NULL; */
@@ -297,42 +317,42 @@ cl_new_regex(char *regex, int flags, CorpusCharset charset)
     /* Rprintf("CL: calling pcre_study produced useful information...\n"); */
 
   /* attempt to optimise regular expression */
-  /* cl_regopt_utf8 = (charset == utf8); */
-  /* if (CL_MAX_LINE_LENGTH <= (l+1)) */
-    /* optimised = cl_regopt_analyse(preprocessed_regex); */
-  /* else */
-    /* optimised = 0; */   /* IE: avoid optimisation if the regex is longer than the grain buffer. */
+  cl_regopt_utf8 = (charset == utf8);
+  if (strlen(preprocessed_regex) + 1 < CL_MAX_LINE_LENGTH)
+    optimised = cl_regopt_analyse(preprocessed_regex);
+  else
+    optimised = 0;   /* IE: avoid optimisation if the regex is longer than the grain buffer. */
 
   /* decide whether it makes sense to use the optimizer:
    *  - testing showed that it is usually faster to rely directly on PCRE's caseless matching than
-   *    casefold each input string for a Boyer-Moore search
+   *    casefold each input string for the grain prefilter
    *  - this is always the case if PCRE has JIT capability
    *  - without JIT, it is still usually better to avoid expensive UTF-8 case-folding
    * NB: accent-folding for %d cannot be avoided, so it makes no sense to disable the optimizer there
    * NB: cannot debug the optimizer with %c any more (because regopt_data_copy_to_regex_object will not be called)
    */
-  /* if (rx->icase && (charset == utf8 || is_pcre2_jit_available)) { */
-    /* if (optimised && cl_debug) { */
-    /*  int i; */
-    /*  Rprintf("CL: Found grain set with %d items(s)", cl_regopt_grains); */
-    /*  for (i = 0; i < cl_regopt_grains; i++) { */
-    /*    Rprintf(" [%s]", cl_regopt_grain[i]); */
-    /*  } */
-    /*  Rprintf("\nCL: but optimization disabled for case-insensitive search\n"); */
-    /* } */
-    /* optimised = 0; */
-  /* } */
+  if (rx->icase && (charset == utf8 || is_pcre2_jit_available)) {
+    if (optimised && cl_debug) {
+      int i;
+      Rprintf("CL: Found grain set with %d items(s)", cl_regopt_grains);
+      for (i = 0; i < cl_regopt_grains; i++) {
+        Rprintf(" [%s]", cl_regopt_grain[i]);
+      }
+      Rprintf("\nCL: but optimization disabled for case-insensitive search\n");
+    }
+    optimised = 0;
+  }
 
-  /* if (optimised) { */
-    /* copy optimiser data to CL_Regex object and construct jump table for Boyer-Moore search */
-    /* regopt_data_copy_to_regex_object(rx);  */ /* will also casefold grains if rx->icase is set */
-  /* } */
+  if (optimised) {
+    /* copy optimiser data to CL_Regex object and construct the bit-parallel prefilter */
+    regopt_data_copy_to_regex_object(rx); /* will also casefold grains if rx->icase is set */
+  }
 
   if (rx->idiac)
     /* allocate string buffer for accent folding in cl_regex_match() */
     rx->haystack_buf = (char *) cl_malloc(CL_MAX_LINE_LENGTH); /* this is for the string being matched, not the regex! */
   
-  if (rx->icase /* && optimised */)
+  if (rx->icase && optimised)
     /* allocate second buffer for case-folded version (only needed for optimizer) */
     rx->haystack_casefold = (char *) cl_malloc(2 * CL_MAX_LINE_LENGTH);
   
@@ -376,6 +396,8 @@ cl_regex_optimised(CL_Regex rx)
  * If the subject string is a UTF-8 string from an external sources, the caller can request
  * enforcement of the subject to canonical NFC form by setting the third argument to true.
  *
+ * The same CL_Regex can be matched by several workers of cl_parallel() at the same time.
+ *
  * @see   cl_new_regex
  * @param rx              The regular expression to match.
  * @param str             The subject (the string to compare the regex to).
@@ -391,15 +413,26 @@ cl_regex_match(CL_Regex rx, char *str, int normalize_utf8)
 {
   char *haystack_pcre2, *haystack; /* possibly case/accent folded versions of str for PCRE regexp and optimizer, respectively */
   int optimised = (rx->grains > 0);
-  int i, di, k, max_i, /* len, */ jump; /* pcre2 */
+  int i, max_i, hlen; /* pcre2 */
+  uint64_t state;
   PCRE2_SIZE len;
   PCRE2_SIZE startoffset = (PCRE2_SIZE)0;
   int grain_match, result;
   /* int ovector[30]; */ /* memory for pcre to use for back-references in pattern matches */
   int do_nfc = (normalize_utf8 && (rx->charset == utf8)) ? REQUIRE_NFC : 0; /* whether we need to normalize the input to NFC */
+  /* threads started by cl_parallel() must not use the buffers and match data of the regex */
+  char *haystack_buf = (cl_worker_thread) ? worker_haystack_buf : rx->haystack_buf;
+  char *haystack_casefold = (cl_worker_thread) ? worker_haystack_casefold : rx->haystack_casefold;
+  pcre2_match_data *mdata = rx->mdata;
+
+  if (cl_worker_thread) {
+    if (!worker_mdata)
+      worker_mdata = pcre2_match_data_create(1, NULL);
+    mdata = worker_mdata;
+  }
 
   if (rx->idiac || do_nfc) { /* perform accent folding on input string if necessary */
-    haystack_pcre2 = rx->haystack_buf;
+    haystack_pcre2 = haystack_buf;
     cl_strcpy(haystack_pcre2, str);
     cl_string_canonical(haystack_pcre2, rx->charset, rx->idiac | do_nfc, CL_MAX_LINE_LENGTH);
   }
@@ -416,40 +449,34 @@ cl_regex_match(CL_Regex rx, char *str, int normalize_utf8)
    */
   if (optimised && cl_optimize) {
     if (rx->icase) {
-      haystack = rx->haystack_casefold;
+      haystack = haystack_casefold;
       cl_strcpy(haystack, haystack_pcre2);
       cl_string_canonical(haystack, rx->charset, rx->icase, 2 * CL_MAX_LINE_LENGTH);
     }
     else
       haystack = haystack_pcre2;
-    /* this 'optimised' matcher may look fairly complicated, but it's still way ahead of POSIX regexen */
-    /* string offset where first character of each grain would be */
+    /* single pass over the haystack with the bit-parallel prefilter, which tracks all grains at once:
+     * bit j of each grain's block in <state> is set iff the last j+1 bytes read match the grain's first j+1 bytes */
+    cl_regopt_trials++;
     grain_match = 0;
-    max_i = len - rx->grain_len; /* stop trying to match when i > max_i */
-    if (rx->anchor_end)
-      i = (max_i >= 0) ? max_i : 0; /* if anchored at end, align grains with end of string */
-    else
-      i = 0;
-
-    while (i <= max_i) {
-      jump = rx->jumptable[(unsigned char) haystack[i + rx->grain_len - 1]];
-      if (jump > 0)
-        i += jump; /* Boyer-Moore search */
+    hlen = strlen(haystack); /* case-folding may have changed the length of the string */
+    if (hlen >= rx->prefilter_len) {
+      if (rx->anchor_start) {
+        i = 0; /* if anchored at start, only the first prefilter_len bytes can match */
+        max_i = rx->prefilter_len;
+      }
       else {
-        /* for each grain */
-        for (k = 0; k < rx->grains; k++) {
-          di = 0;
-          while ((di < rx->grain_len) && (rx->grain[k][di] == haystack[i + di]))
-            di++;
-          if (di >= rx->grain_len) {
-            grain_match = 1;
-            break; /* we have found a grain match and can quit the loop */
-          }
+        /* if anchored at end, align grains with end of string */
+        i = (rx->anchor_end) ? hlen - rx->prefilter_len : 0;
+        max_i = hlen;
+      }
+      for (state = 0; i < max_i; i++) {
+        state = ((state << 1) | rx->prefilter_init) & rx->prefilter_mask[(unsigned char) haystack[i]];
+        if (state & rx->prefilter_final) {
+          grain_match = 1;
+          break; /* we have found a grain match and can quit the loop */
         }
-        i++;
       }
-      if (rx->anchor_start)
-        break; /* if anchored at start, only the first iteration can match */
     }
   } /* endif optimised */
   else
@@ -472,8 +499,8 @@ cl_regex_match(CL_Regex rx, char *str, int normalize_utf8)
 #endif
     result = pcre2_match(rx->needle, /* rx->extra, */ (PCRE2_SPTR)haystack_pcre2,
                        len, startoffset, (uint32_t)0,
-                       rx->mdata, NULL);
-    if (result < PCRE2_ERROR_NOMATCH && cl_debug)
+                       mdata, NULL);
+    if (result < PCRE2_ERROR_NOMATCH && cl_debug && !cl_worker_thread)
       /* note, "no match" is a PCRE2 "error", but all actual errors are lower numbers */
       Rprintf("CL: Regex Execute Error no. %d (see `man pcreapi` for error codes)\n", result);
   }
@@ -482,11 +509,25 @@ cl_regex_match(CL_Regex rx, char *str, int normalize_utf8)
 #if 1
   /* debugging code used before version 2.2.b94, modified to pcre return values & re-enabled in 3.2.b3 */
   /* check for critical error: optimiser didn't accept candidate, but regex matched */
-  if ((result > 0) && !grain_match)
+  if ((result >= 0) && !grain_match && !cl_worker_thread) /* threads started by cl_parallel() must not call R */
     Rprintf("CL ERROR: regex optimiser did not accept '%s' although it should have!\n", str);
 #endif
 
-  return (result > 0); /* return true if regular expression matched */
+  /* 0 = matched, but the match data has no room for the captured substrings (in worker threads) */
+  return (result >= 0); /* return true if regular expression matched */
+}
+
+/**
+ * Frees the match data used by cl_regex_match() in a thread started by cl_parallel()
+ * (called when the worker of the thread is done).
+ */
+void
+cl_regex_worker_done(void)
+{
+  if (worker_mdata) {
+    pcre2_match_data_free(worker_mdata);
+    worker_mdata = NULL;
+  }
 }
 
 /**
@@ -1017,6 +1058,36 @@ read_grain(char *mark, char *grain, int *len)
     return mark;
 }
 
+/**
+ * Checks whether a grain read by read_grain() was followed by a quantifier - part of the CL Regex Optimiser.
+ *
+ * If the last symbol of a grain is repeated, the grain is still contained in any
+ * matching string, but it cannot be aligned with the end of the regex segment.
+ * The check is conservative: an escaped quantifier character at the end of the
+ * grain is also reported as a quantifier, which merely loses the alignment.
+ *
+ * This is a non-exported function.
+ *
+ * @param mark  Pointer to the start of the grain in the regex string.
+ * @param end   Pointer returned by read_grain().
+ * @return      Boolean: true if the grain may have ended in a quantifier.
+ */
+int
+grain_quantified(char *mark, char *end)
+{
+  if (end <= mark)
+    return 0;
+  switch (end[-1]) {
+  case '?':
+  case '*':
+  case '+':
+  case '}':
+    return 1;
+  default:
+    return 0;
+  }
+}
+
 /**
  * Finds grains in a simple disjunction group - part of the CL Regex Optimiser.
  *
@@ -1097,6 +1168,8 @@ read_disjunction(char *mark, int *align_start, int *align_end, int no_paren)
         return mark;      /* no grain found in this alternative -> unsuccessful */
       p2 = read_grain(point, buf, &(grain_buffer_len[grain]));
     }
+    if (grain_quantified(point, p2))
+      *align_end = 0;    /* repeated last symbol: grain can't be aligned at end */
     grain_buffer[grain] = buf; /* store grain in local grain buffer */
     buf += strlen(buf) + 1;
     grain++;
@@ -1131,68 +1204,246 @@ read_disjunction(char *mark, int *align_start, int *align_end, int no_paren)
 
 
 /**
- * Computes a jump table for Boyer-Moore searches -- part of the CL Regex Optimiser.
+ * Updates the public grain set with the grains in the local buffer - part of the CL Regex Optimiser.
+ *
+ * The grains found for a single segment of the regex (by read_grain or read_disjunction)
+ * are written to the local grain buffer. This function checks whether they are better than
+ * the current grain set and copies them to the public grain buffer if they are. A grain set
+ * is considered better if its shortest grain is longer, if it has fewer grains, or if it is
+ * anchored at the start or end of the regex (in this order of precedence).
+ *
+ * This is a non-exported function.
+ *
+ * @param at_start  Whether the grains are anchored at the start of the regex.
+ * @param at_end    Whether the grains are anchored at the end of the regex.
+ */
+void
+update_grain_buffer(int at_start, int at_end)
+{
+  char *buf = public_grain_data;
+  int i, len, N;
+
+  N = grain_buffer_grains;
+  if (N <= 0)
+    return;
+
+  len = CL_MAX_LINE_LENGTH;
+  for (i = 0; i < N; i++)
+    if (grain_buffer_len[i] < len)
+      len = grain_buffer_len[i];
+  if (len <= 0)
+    return; /* shouldn't happen, but an empty grain would match anything */
+
+  if ( (cl_regopt_grains == 0) ||                                  /* no grain set yet */
+       (len > cl_regopt_grain_len) ||                              /* or grains are longer */
+       (len == cl_regopt_grain_len && N < cl_regopt_grains) ||     /* or there are fewer grains */
+       (len == cl_regopt_grain_len && N == cl_regopt_grains &&     /* or grains are anchored */
+        (at_start || at_end) && !(cl_regopt_anchor_start || cl_regopt_anchor_end))
+     ) {
+    cl_regopt_grains = N;
+    cl_regopt_grain_len = len;
+    cl_regopt_anchor_start = at_start;
+    cl_regopt_anchor_end = at_end;
+    for (i = 0; i < N; i++) {
+      strcpy(buf, grain_buffer[i]);
+      cl_regopt_grain[i] = buf;
+      buf += strlen(buf) + 1;
+    }
+  }
+}
+
+/**
+ * Analyses a regular expression and tries to find the best set of grains - part of the CL Regex Optimiser.
+ *
+ * The regex is parsed as a sequence of segments, each of which is either a literal
+ * grain (read_grain), a simple disjunction group with a grain in each alternative
+ * (read_disjunction) or a wildcard segment (read_wildcard). A bare top-level disjunction
+ * is also accepted. The best grain set found in any segment is stored in the public
+ * cl_regopt_ variables. If any part of the regex cannot be parsed, no grains are
+ * reported (because we cannot be sure that the grains are required for a match).
+ *
+ * cl_regopt_utf8 must be set before calling this function.
+ *
+ * This is a non-exported function.
+ *
+ * @param regex  String containing the (preprocessed) regex to optimise.
+ * @return       Boolean: true if good grains have been found.
+ */
+int
+cl_regopt_analyse(char *regex)
+{
+  char *point, *q;
+  int len, at_start, at_end, align_start, align_end, one_or_more;
+
+  cl_regopt_grains = 0;
+  cl_regopt_grain_len = 0;
+  cl_regopt_anchor_start = cl_regopt_anchor_end = 0;
+
+  if (cl_debug)
+    Rprintf("CL: cl_regopt_analyse('%s')\n", regex);
+
+  /* a bare top-level disjunction (...|...|...) must be handled separately;
+   * a single "alternative" is better analysed segment by segment below */
+  q = read_disjunction(regex, &align_start, &align_end, 1);
+  if (q > regex && grain_buffer_grains > 1)
+    update_grain_buffer(align_start, align_end);
+  else {
+    point = regex;
+    while (*point) {
+      at_start = (point == regex);
+      if ((q = read_grain(point, local_grain_data, &len)) > point) {
+        /* literal grain */
+        grain_buffer[0] = local_grain_data;
+        grain_buffer_len[0] = len;
+        grain_buffer_grains = 1;
+        at_end = (*q == '\0' && !grain_quantified(point, q));
+        update_grain_buffer(at_start, at_end);
+        point = q;
+      }
+      else if ((q = read_disjunction(point, &align_start, &align_end, 0)) > point) {
+        /* disjunction group: optional quantifiers make the grains optional, too */
+        char *q2 = read_kleene(q, &one_or_more);
+        if (q2 == q || one_or_more) {
+          at_end = (q2 == q && *q == '\0');
+          update_grain_buffer(at_start && align_start, at_end && align_end);
+        }
+        point = q2;
+      }
+      else if ((q = read_wildcard(point)) > point)
+        point = q;
+      else {
+        /* unsupported syntax: we can't be sure that the grains are required */
+        if (cl_debug)
+          Rprintf("CL: cannot parse regex beyond '%s', no optimisation\n", point);
+        cl_regopt_grains = 0;
+        return 0;
+      }
+    }
+  }
+
+  /* a grain set anchored at both ends is only used for its start */
+  if (cl_regopt_anchor_start && cl_regopt_anchor_end)
+    cl_regopt_anchor_end = 0;
+
+  if (cl_debug && cl_regopt_grains > 0) {
+    int i;
+    Rprintf("CL: Regex optimised, %d grain(s) of length %d\n", cl_regopt_grains, cl_regopt_grain_len);
+    Rprintf("CL: grain set is");
+    for (i = 0; i < cl_regopt_grains; i++)
+      Rprintf(" [%s]", cl_regopt_grain[i]);
+    if (cl_regopt_anchor_start)
+      Rprintf(" (anchored at beginning of string)");
+    if (cl_regopt_anchor_end)
+      Rprintf(" (anchored at end of string)");
+    Rprintf("\n");
+  }
+
+  return (cl_regopt_grains > 0);
+}
+
+/**
+ * Computes the bit-parallel prefilter for all grains -- part of the CL Regex Optimiser.
  *
- * Unlike the textbook version, this jumptable includes the last character of each grain
- * (so we don't have to start the string comparison loops every time).
+ * The prefilter is a shift-and automaton for all grains simultaneously: the first
+ * prefilter_len bytes of each grain (or the last bytes if the grains are anchored at the
+ * end of the string) are packed into consecutive blocks of a single 64-bit state word,
+ * so a candidate string can be checked for all grains in a single pass with one shift,
+ * OR and AND per byte. The number of bytes per grain is limited by the length of the
+ * shortest grain and by the number of grains that must fit into 64 bits.
+ *
+ * The shift from the last bit of one block into the first bit of the next one is harmless,
+ * because the first bit of each block is set anyway before masking.
  *
  * A non-exported function.
  */
 void
-make_jump_table(CL_Regex rx)
+make_prefilter(CL_Regex rx)
 {
-  int j, k, jump;
+  int j, k, m, l, offset;
   unsigned int ch;
-  unsigned char *grain; /* want unsigned char to compare with unsigned int ch */
+  unsigned char *grain; /* want unsigned char as an index into the mask table */
 
-  /* clear the jump table */
+  /* clear the prefilter */
   for (ch = 0; ch < 256; ch++)
-    rx->jumptable[ch] = 0;
+    rx->prefilter_mask[ch] = 0;
+  rx->prefilter_init = rx->prefilter_final = 0;
+  rx->prefilter_len = 0;
 
   if (rx->grains > 0) {
-    /* compute smallest jump distance for each byte (0 -> matches last byte of one or more grains) */
-    for (ch = 0; ch < 256; ch++) {
-      jump = rx->grain_len; /* if character isn't contained in any of the grains, jump by grain length */
-
-      for (k = 0; k < rx->grains; k++) { /* for each grain... */
-        grain = (unsigned char *) rx->grain[k] + rx->grain_len - 1; /* pointer to last byte in grain */
-        for (j = 0; j < rx->grain_len; j++, grain--) {
-          if (*grain == ch) {
-            if (j < jump)
-              jump = j;
-            break; /* can't find shorter jump distance for this grain */
-          }
-        }
-      }
-
-      rx->jumptable[ch] = jump;
+    /* bytes per grain: shortest grain (in bytes), but all grains must fit into the 64-bit state */
+    m = 64 / rx->grains;
+    for (k = 0; k < rx->grains; k++) {
+      l = strlen(rx->grain[k]);
+      if (l < m)
+        m = l;
+    }
+    rx->prefilter_len = m;
+
+    for (k = 0; k < rx->grains; k++) {
+      l = strlen(rx->grain[k]);
+      offset = (rx->anchor_end) ? l - m : 0; /* use suffix of grain if anchored at end of string */
+      grain = (unsigned char *) rx->grain[k] + offset;
+      for (j = 0; j < m; j++)
+        rx->prefilter_mask[grain[j]] |= ((uint64_t) 1) << (k * m + j);
+      rx->prefilter_init |= ((uint64_t) 1) << (k * m);
+      rx->prefilter_final |= ((uint64_t) 1) << (k * m + m - 1);
     }
+
     if (cl_debug) {
-      /* in debug mode, print out the entire jumptable */
-      Rprintf("CL: cl_regopt_jumptable for Boyer-Moore search is\n");
-      for (k = 0; k < 256; k += 16) {
-        Rprintf("CL: ");
-        for (j = 0, ch = k ; j < 15 ; j++, ch++)
-          Rprintf((ch >= 32 && ch < 127) ? "|%2d %c  " : "|%2d %02X ", rx->jumptable[ch], ch);
-        Rprintf("\n");
-      }
+      /* in debug mode, print out the bytes that occur in the grains */
+      Rprintf("CL: prefilter uses %d byte(s) of each grain\n", m);
+      for (ch = 0; ch < 256; ch++)
+        if (rx->prefilter_mask[ch])
+          Rprintf((ch >= 32 && ch < 127) ? "CL:  %c  %016llX\n" : "CL: %02X  %016llX\n",
+                  ch, (unsigned long long) rx->prefilter_mask[ch]);
     }
   }
-  /* if no grains have been found, don't do anything (just clear the jump table) */
+  /* if no grains have been found, don't do anything (just clear the prefilter) */
 }
 
+/**
+ * Copies grains from the global variables to the CL_Regex object - part of the CL Regex Optimiser.
+ *
+ * Grains are case-folded if the IGNORE_CASE flag was set for the regex, and the
+ * bit-parallel prefilter is computed afterwards.
+ *
+ * A non-exported function.
+ *
+ * @param rx  The CL_Regex that was optimised.
+ */
+void
+regopt_data_copy_to_regex_object(CL_Regex rx)
+{
+  int i;
+
+  rx->grains = cl_regopt_grains;
+  rx->grain_len = cl_regopt_grain_len;
+  rx->anchor_start = cl_regopt_anchor_start;
+  rx->anchor_end = cl_regopt_anchor_end;
+
+  for (i = 0; i < rx->grains; i++) {
+    if (rx->icase)
+      rx->grain[i] = cl_string_canonical(cl_regopt_grain[i], rx->charset, rx->icase, CL_STRING_CANONICAL_STRDUP);
+    else
+      rx->grain[i] = cl_strdup(cl_regopt_grain[i]);
+  }
+
+  make_prefilter(rx);
+}
 
 
 
-/* two monitoring functions */
+
+/* three monitoring functions */
 
 /**
- * Reset the "success counter" for optimised regexes.
+ * Reset the "success counter" and the "trials counter" for optimised regexes.
  */
 void
 cl_regopt_count_reset(void)
 {
   cl_regopt_successes = 0;
+  cl_regopt_trials = 0;
 }
 
 /**
@@ -1225,3 +1476,22 @@ cl_regopt_count_get(void)
 {
   return cl_regopt_successes;
 }
+
+/**
+ * Get a reading from the "trials counter" for optimised regexes.
+ *
+ * The counter is incremented by 1 every time a string is scanned
+ * with the grain prefilter, i.e. whenever an optimised regex is
+ * matched while the optimiser is enabled (see cl_set_optimize).
+ * The difference to cl_regopt_count_get() is the number of times
+ * the regex engine had to be called nonetheless.
+ *
+ * @see cl_regopt_count_reset
+ * @return an integer indicating the number of strings tested with
+ *         the regopt prefilter.
+ */
+int
+cl_regopt_count_trials(void)
+{
+  return cl_regopt_trials;
+}
@@ -0,0 +1,656 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../cl/cl.h"
+#include "../cl/cwb-globals.h"
+
+#include "cqp.h"
+#include "options.h"
+#include "corpmanag.h"
+#include "ranges.h"
+#include "querycache.h"
+#include "parse_actions.h"
+#include "batch.h"
+
+/** Minimum number of lexicon entries times regular expressions for scanning a lexicon in parallel threads */
+#define BATCH_SCAN_PARALLEL_MIN 100000
+/** Minimum number of corpus positions for decoding the index in parallel threads */
+#define BATCH_DECODE_PARALLEL_MIN 100000
+/** Name of the query result of a query that is not for a single token; users can't give it to a subcorpus
+ *  (subcorpus names start with an uppercase letter, see check_subcorpus_name) */
+#define BATCH_RESULT "batch_result"
+
+/** A query of a batch that matches a single token, e.g. [lemma = "house"]. */
+typedef struct {
+  Attribute *attr;              /**< the p-attribute (NULL if the query is evaluated in the usual way) */
+  char *string;                 /**< the string the p-attribute is compared with */
+  int flags;                    /**< IGNORE_CASE, IGNORE_DIAC or IGNORE_REGEX */
+  CL_Regex rx;                  /**< the compiled regular expression (NULL for a literal string) */
+  int *ids;                     /**< matching lexicon IDs (in ascending order) */
+  int n_ids;                    /**< number of matching lexicon IDs */
+  int *postings;                /**< the entries of the matching IDs in the list of postings */
+  int *cpos;                    /**< the matches (if a subcorpus is created) */
+  int size;                     /**< number of matches */
+} BatchToken;
+
+/** The positions of a lexicon ID in the query corpus, which are decoded once for all queries of a batch. */
+typedef struct {
+  Attribute *attr;              /**< the p-attribute */
+  int id;                       /**< the lexicon ID */
+  int *cpos;                    /**< the corpus positions (NULL if only the frequency is needed) */
+  int *strucs;                  /**< region of each position (-1 = none), if matches are counted by region */
+  int size;                     /**< number of positions */
+} BatchPostings;
+
+/** Shared data of the threads of query_batch(). */
+typedef struct {
+  CorpusList *corpus;           /**< the query corpus with non-overlapping ranges (NULL = the whole corpus) */
+  Attribute *regions;           /**< s-attribute whose regions the matches are counted in (may be NULL) */
+  int n_queries;                /**< number of queries */
+  BatchToken *tokens;           /**< the queries (attr is NULL if a query is not for a single token) */
+  BatchPostings *postings;      /**< the lexicon IDs matched by the queries */
+  int n_postings;               /**< number of entries of postings */
+  int positions;                /**< boolean: corpus positions are needed for the matches */
+  int subcorpora;               /**< boolean: subcorpora are created for the matches */
+  int *counts;                  /**< number of matches of each query (in each region) */
+  Attribute *attr;              /**< the p-attribute whose lexicon is scanned */
+  BatchToken **scan;            /**< the queries with regular expressions on attr */
+  int n_scan;                   /**< number of entries of scan */
+  int **found;                  /**< IDs matched by each regular expression in each thread */
+  int *n_found;                 /**< number of entries of found */
+} QueryBatch;
+
+
+/** Skips whitespace in a query. */
+static char *
+batch_skip_space(char *p)
+{
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    p++;
+  return p;
+}
+
+/**
+ * Reads a string in quotes in the same way as the lexer: backslash escapes are kept,
+ * doubled quotes are replaced by a single one.
+ *
+ * @param p  Address of the position of the opening quote; set to the position after the string.
+ * @return   The string (to be freed by the caller), or NULL if there isn't a string at *p.
+ */
+static char *
+batch_read_string(char **p)
+{
+  char *q = *p, delim = **p, *s, *r;
+
+  if (delim != '"' && delim != '\'')
+    return NULL;
+
+  r = s = (char *)cl_malloc(strlen(q));
+  for (q++; *q && *q != '\r' && *q != '\n'; ) {
+    if (*q == '\\') {
+      if (!q[1] || q[1] == '\r' || q[1] == '\n')
+        break;
+      *r++ = *q++;
+      *r++ = *q++;
+    }
+    else if (*q == delim && q[1] == delim) {
+      *r++ = delim;
+      q += 2;
+    }
+    else if (*q == delim) {
+      *r = '\0';
+      *p = q + 1;
+      return s;
+    }
+    else
+      *r++ = *q++;
+  }
+
+  cl_free(s);
+  return NULL;
+}
+
+/**
+ * Checks whether a query matches a single token by comparing a p-attribute with a string,
+ * i.e. whether it has the form [att = "string" %flags] or "string" %flags.
+ *
+ * @param query   The query.
+ * @param attr    Set to the name of the p-attribute (to be freed by the caller).
+ * @param string  Set to the string (to be freed by the caller).
+ * @param flags   Set to the flags (IGNORE_CASE, IGNORE_DIAC or IGNORE_REGEX).
+ * @return        Boolean: true if the query has this form.
+ */
+static int
+batch_parse_token_query(char *query, char **attr, char **string, int *flags)
+{
+  char *p = batch_skip_space(query), *start;
+  int bracket = 0;
+
+  *attr = *string = NULL;
+  *flags = 0;
+
+  if (*p == '[') {
+    bracket = 1;
+    p = start = batch_skip_space(p + 1);
+    if (!(*p == '_' || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')))
+      return 0;
+    while (*p == '_' || *p == '-' || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9'))
+      p++;
+    *attr = (char *)cl_malloc(p - start + 1);
+    memcpy(*attr, start, p - start);
+    (*attr)[p - start] = '\0';
+    p = batch_skip_space(p);
+    if (*p != '=')
+      goto not_a_token;
+    p = batch_skip_space(p + 1);
+  }
+  else
+    *attr = cl_strdup(def_unbr_attr);
+
+  if (!(*string = batch_read_string(&p)))
+    goto not_a_token;
+  p = batch_skip_space(p);
+
+  /* the same flags as in the parser; warnings about other flags are left to the parser */
+  if (*p == '%') {
+    if (!(p[1] >= 'a' && p[1] <= 'z'))
+      goto not_a_token;
+    for (p++; *p >= 'a' && *p <= 'z'; p++) {
+      if (*p == 'c')
+        *flags |= IGNORE_CASE;
+      else if (*p == 'd')
+        *flags |= IGNORE_DIAC;
+      else if (*p == 'l')
+        *flags |= IGNORE_REGEX;
+      else
+        goto not_a_token;
+    }
+    if ((*flags & IGNORE_REGEX) && *flags != IGNORE_REGEX)
+      goto not_a_token;
+    p = batch_skip_space(p);
+  }
+
+  if (bracket) {
+    if (*p != ']')
+      goto not_a_token;
+    p = batch_skip_space(p + 1);
+  }
+  if (*p == ';')
+    p = batch_skip_space(p + 1);
+  if (*p == '\0')
+    return 1;
+
+not_a_token:
+  cl_free(*attr);
+  cl_free(*string);
+  return 0;
+}
+
+/**
+ * Prepares a query of a batch for a single token (in the same way as do_flagged_string()).
+ *
+ * @return  Boolean: true if the query is for a single token (otherwise, the query is evaluated in the usual way).
+ */
+static int
+batch_prepare_token(CorpusList *cl, char *query, BatchToken *token)
+{
+  char *attr_name, *s;
+  int flags;
+
+  if (!batch_parse_token_query(query, &attr_name, &s, &flags))
+    return 0;
+
+  token->attr = cl_new_attribute(cl->corpus, attr_name, ATT_POS);
+  cl_free(attr_name);
+  if (!token->attr || !cl_string_validate_encoding(s, cl->corpus->charset, 0)) {
+    token->attr = NULL;
+    cl_free(s);
+    return 0;
+  }
+
+  cl_string_latex2iso(s, s, strlen(s));
+  token->string = s;
+  token->flags = flags;
+  if (!(flags == IGNORE_REGEX || (flags == 0 && strcspn(s, "[](){}.*+|?\\") == strlen(s)))) {
+    /* the parser reports illegal regular expressions */
+    if (!(token->rx = cl_new_regex(s, flags, cl->corpus->charset))) {
+      token->attr = NULL;
+      cl_free(token->string);
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/**
+ * Worker of query_batch(): matches a contiguous chunk of the lexicon of qb->attr against the
+ * regular expressions of all queries on this attribute.
+ */
+static void
+batch_scan_worker(int thread, int n_threads, void *data)
+{
+  QueryBatch *qb = (QueryBatch *)data;
+  int lexsize = cl_max_id(qb->attr);
+  int from = (int)(((long long)lexsize * thread) / n_threads);
+  int to = (int)(((long long)lexsize * (thread + 1)) / n_threads);
+  int **found = qb->found + thread * qb->n_scan;
+  int *n_found = qb->n_found + thread * qb->n_scan;
+  int *allocated = (int *)cl_calloc(qb->n_scan, sizeof(int));
+  int id, k;
+  char *s;
+
+  for (id = from; id < to; id++) {
+    s = cl_id2str(qb->attr, id);
+    for (k = 0; k < qb->n_scan; k++)
+      if (cl_regex_match(qb->scan[k]->rx, s, 0)) {
+        if (n_found[k] >= allocated[k]) {
+          allocated[k] = allocated[k] ? 2 * allocated[k] : 16;
+          found[k] = (int *)cl_realloc(found[k], allocated[k] * sizeof(int));
+        }
+        found[k][n_found[k]++] = id;
+      }
+  }
+
+  cl_free(allocated);
+}
+
+/**
+ * Looks up the lexicon IDs matched by the queries of a batch on the p-attribute qb->attr.
+ *
+ * Literal strings are looked up in the lexicon hash; the lexicon is scanned once for all
+ * regular expressions (in parallel threads if it is large).
+ */
+static void
+batch_lookup_ids(QueryBatch *qb)
+{
+  BatchToken *token;
+  int i, t, k, n, n_threads;
+
+  qb->scan = (BatchToken **)cl_malloc(qb->n_queries * sizeof(BatchToken *));
+  qb->n_scan = 0;
+  for (i = 0; i < qb->n_queries; i++) {
+    token = &qb->tokens[i];
+    if (token->attr != qb->attr)
+      continue;
+    if (token->rx)
+      qb->scan[qb->n_scan++] = token;
+    else if ((k = cl_str2id(qb->attr, token->string)) >= 0) {
+      token->ids = (int *)cl_malloc(sizeof(int));
+      token->ids[0] = k;
+      token->n_ids = 1;
+    }
+  }
+
+  if (qb->n_scan > 0) {
+    /* make sure that the lexicon is loaded before threads access it */
+    cl_id2str(qb->attr, 0);
+    n_threads = ((double)cl_max_id(qb->attr) * qb->n_scan >= BATCH_SCAN_PARALLEL_MIN) ? cl_get_threads() : 1;
+    qb->found = (int **)cl_calloc(n_threads * qb->n_scan, sizeof(int *));
+    qb->n_found = (int *)cl_calloc(n_threads * qb->n_scan, sizeof(int));
+    cl_parallel(batch_scan_worker, n_threads, qb);
+
+    /* the threads have scanned the lexicon in order, so their IDs are appended */
+    for (k = 0; k < qb->n_scan; k++) {
+      token = qb->scan[k];
+      for (t = 0, n = 0; t < n_threads; t++)
+        n += qb->n_found[t * qb->n_scan + k];
+      token->ids = (int *)cl_malloc(n * sizeof(int) + sizeof(int));
+      for (t = 0; t < n_threads; t++) {
+        memcpy(token->ids + token->n_ids, qb->found[t * qb->n_scan + k], qb->n_found[t * qb->n_scan + k] * sizeof(int));
+        token->n_ids += qb->n_found[t * qb->n_scan + k];
+        cl_free(qb->found[t * qb->n_scan + k]);
+      }
+    }
+    cl_free(qb->found);
+    cl_free(qb->n_found);
+  }
+  cl_free(qb->scan);
+  qb->n_scan = 0;
+}
+
+/**
+ * Worker of query_batch(): decodes the positions of lexicon IDs in the index, keeping those in
+ * the ranges of the query corpus, and looks up their regions.
+ *
+ * The IDs are distributed in turn, since their frequencies differ widely.
+ */
+static void
+batch_decode_worker(int thread, int n_threads, void *data)
+{
+  QueryBatch *qb = (QueryBatch *)data;
+  BatchPostings *p;
+  Range *range;
+  int i, k, n, r, lo, hi, n_ranges;
+
+  for (i = thread; i < qb->n_postings; i += n_threads) {
+    p = &qb->postings[i];
+    p->cpos = cl_id2cpos(p->attr, p->id, &p->size);
+    if (!p->cpos)
+      p->size = 0;
+
+    if (qb->corpus && p->size > 0) {
+      range = qb->corpus->range;
+      n_ranges = qb->corpus->size;
+      /* find the first range that doesn't end before the first position */
+      lo = 0;
+      hi = n_ranges;
+      while (lo < hi) {
+        r = (lo + hi) / 2;
+        if (range[r].end < p->cpos[0])
+          lo = r + 1;
+        else
+          hi = r;
+      }
+      for (k = 0, n = 0, r = lo; k < p->size && r < n_ranges; k++) {
+        while (r < n_ranges && range[r].end < p->cpos[k])
+          r++;
+        if (r < n_ranges && range[r].start <= p->cpos[k])
+          p->cpos[n++] = p->cpos[k];
+      }
+      p->size = n;
+    }
+
+    if (qb->regions && p->size > 0) {
+      p->strucs = (int *)cl_malloc(p->size * sizeof(int));
+      for (k = 0; k < p->size; k++)
+        if ((p->strucs[k] = cl_cpos2struc(qb->regions, p->cpos[k])) < 0)
+          p->strucs[k] = -1;
+    }
+  }
+}
+
+/** Compares two corpus positions (for qsort()). */
+static int
+batch_cpos_cmp(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Worker of query_batch(): counts the matches of the queries for a single token (in each region),
+ * and collects them if subcorpora are created.
+ */
+static void
+batch_collect_worker(int thread, int n_threads, void *data)
+{
+  QueryBatch *qb = (QueryBatch *)data;
+  BatchToken *token;
+  BatchPostings *p;
+  int i, k, j, n;
+
+  for (i = thread; i < qb->n_queries; i += n_threads) {
+    token = &qb->tokens[i];
+    if (!token->attr)
+      continue;
+
+    for (k = 0, n = 0; k < token->n_ids; k++) {
+      p = &qb->postings[token->postings[k]];
+      if (qb->regions) {
+        for (j = 0; j < p->size; j++)
+          if (p->strucs[j] >= 0)
+            qb->counts[i + (size_t)qb->n_queries * p->strucs[j]]++;
+      }
+      n += p->size;
+    }
+    token->size = n;
+    if (!qb->regions)
+      qb->counts[i] = n;
+
+    if (qb->subcorpora && n > 0) {
+      token->cpos = (int *)cl_malloc(n * sizeof(int));
+      for (k = 0, n = 0; k < token->n_ids; k++) {
+        p = &qb->postings[token->postings[k]];
+        memcpy(token->cpos + n, p->cpos, p->size * sizeof(int));
+        n += p->size;
+      }
+      /* the positions of different IDs are disjoint */
+      if (token->n_ids > 1)
+        qsort(token->cpos, n, sizeof(int), batch_cpos_cmp);
+    }
+  }
+}
+
+/**
+ * Evaluates a query of a batch that is not for a single token in the usual way (using the query cache).
+ *
+ * @param cl         The corpus (or subcorpus) to query.
+ * @param query      The query.
+ * @param subcorpus  Name of the subcorpus for the query result (BATCH_RESULT if the matches are only counted).
+ * @return           The query result, or NULL for error.
+ */
+static CorpusList *
+batch_evaluate(CorpusList *cl, char *query, char *subcorpus)
+{
+  CorpusList *result, *old;
+  char *key, *text;
+  int len;
+
+  set_current_corpus(cl, 0);
+  key = query_cache_key(cl, query);
+  if ((result = query_cache_lookup(cl, key, subcorpus))) {
+    cl_free(key);
+    return result;
+  }
+
+  /* a query that fails leaves an existing subcorpus of the same name alone, which must not be taken for its result;
+     so the query is assigned to the reserved name, which is only in use if the query has created it */
+  if ((old = LoadedCorpus(BATCH_RESULT, NULL, SUB)))
+    dropcorpus(old, NULL);
+  /* the subcorpus is replaced by the result (or dropped if there is none), unless it is the corpus queried */
+  if ((old = LoadedCorpus(subcorpus, NULL, SUB)) && old != cl)
+    dropcorpus(old, NULL);
+
+  len = strlen(BATCH_RESULT) + strlen(query) + 10;
+  text = (char *)cl_malloc(len);
+  snprintf(text, len, "%s = %s", BATCH_RESULT, query);
+  if (cqp_parse_string(text) && generate_code && (result = LoadedCorpus(BATCH_RESULT, NULL, SUB)) && !cl_streq(subcorpus, BATCH_RESULT)) {
+    old = result;
+    result = duplicate_corpus(old, subcorpus, True);
+    dropcorpus(old, NULL);
+  }
+  cl_free(text);
+
+  query_cache_store(key, result);
+  cl_free(key);
+  return result;
+}
+
+/**
+ * Runs a batch of queries on a corpus.
+ *
+ * Queries for a single token are evaluated together (see batch.h), all other queries one
+ * after the other. The results are the same as those of the individual queries.
+ *
+ * @param cl          The corpus (or subcorpus) to query.
+ * @param queries     The queries.
+ * @param n_queries   Number of queries.
+ * @param subcorpora  Names of the subcorpora for the query results, or NULL if the matches are
+ *                    only counted.
+ * @param regions     An s-attribute: the matches are counted in each of its regions (by start
+ *                    position); if NULL, all matches are counted.
+ * @param n_columns   Set to the number of columns of the counts (regions or 1).
+ * @return            The number of matches of each query (in each region), by column; all counts
+ *                    of a query that cannot be evaluated are -1. NULL if the corpus can't be
+ *                    accessed. To be freed by the caller.
+ */
+int *
+query_batch(CorpusList *cl, char **queries, int n_queries, char **subcorpora, Attribute *regions, int *n_columns)
+{
+  QueryBatch qb;
+  CorpusList matches, *result;
+  BatchToken *token;
+  int *slot_of, *cpos;
+  int i, j, k, n, n_threads, n_columns_;
+  double n_positions;
+
+  if (!cl || !access_corpus(cl)) {
+    cqpmessage(Error, "Corpus can't be accessed");
+    return NULL;
+  }
+  if (regions && cl_max_struc(regions) <= 0)
+    regions = NULL;
+  n_columns_ = (regions) ? cl_max_struc(regions) : 1;
+  *n_columns = n_columns_;
+
+  memset(&qb, 0, sizeof(QueryBatch));
+  qb.regions = regions;
+  qb.n_queries = n_queries;
+  qb.subcorpora = (subcorpora != NULL);
+  qb.tokens = (BatchToken *)cl_calloc(n_queries, sizeof(BatchToken));
+  qb.counts = (int *)cl_calloc((size_t)n_queries * n_columns_ + 1, sizeof(int));
+
+  set_current_corpus(cl, 0);
+
+  /* matches in a subcorpus must lie in its ranges (overlapping ranges are deleted as for subqueries) */
+  if (cl->type != SYSTEM) {
+    qb.corpus = make_temp_corpus(cl, "RHS");
+    apply_range_set_operation(qb.corpus, RNonOverlapping, NULL, NULL);
+  }
+  qb.positions = (qb.subcorpora || qb.regions || qb.corpus);
+
+  for (i = 0; i < n_queries; i++)
+    batch_prepare_token(cl, queries[i], &qb.tokens[i]);
+
+  /* look up the lexicon IDs for each p-attribute, and list each ID once */
+  for (i = 0; i < n_queries; i++) {
+    if (!qb.tokens[i].attr)
+      continue;
+    for (j = 0; j < i; j++)
+      if (qb.tokens[j].attr == qb.tokens[i].attr)
+        break;
+    if (j < i)
+      continue;
+
+    qb.attr = qb.tokens[i].attr;
+    batch_lookup_ids(&qb);
+
+    slot_of = (int *)cl_malloc(cl_max_id(qb.attr) * sizeof(int) + sizeof(int));
+    for (k = 0; k < cl_max_id(qb.attr); k++)
+      slot_of[k] = -1;
+    for (j = i; j < n_queries; j++) {
+      token = &qb.tokens[j];
+      if (token->attr != qb.attr)
+        continue;
+      token->postings = (int *)cl_malloc(token->n_ids * sizeof(int) + sizeof(int));
+      for (k = 0; k < token->n_ids; k++) {
+        if (slot_of[token->ids[k]] < 0) {
+          qb.postings = (BatchPostings *)cl_realloc(qb.postings, (qb.n_postings + 1) * sizeof(BatchPostings));
+          memset(&qb.postings[qb.n_postings], 0, sizeof(BatchPostings));
+          qb.postings[qb.n_postings].attr = qb.attr;
+          qb.postings[qb.n_postings].id = token->ids[k];
+          slot_of[token->ids[k]] = qb.n_postings++;
+        }
+        token->postings[k] = slot_of[token->ids[k]];
+      }
+    }
+    cl_free(slot_of);
+  }
+
+  /* decode the positions of each ID once; without subcorpora and regions, the frequencies are sufficient */
+  n_positions = 0;
+  if (qb.n_postings > 0) {
+    if (qb.positions) {
+      for (k = 0; k < qb.n_postings; k++)
+        n_positions += cl_id2freq(qb.postings[k].attr, qb.postings[k].id);
+      /* make sure that the index and the regions are loaded before threads access them */
+      for (k = 0; k < qb.n_postings; k++)
+        if (k == 0 || qb.postings[k].attr != qb.postings[k - 1].attr) {
+          cpos = cl_id2cpos(qb.postings[k].attr, qb.postings[k].id, &n);
+          cl_free(cpos);
+        }
+      if (regions)
+        cl_cpos2struc(regions, 0);
+      n_threads = (n_positions >= BATCH_DECODE_PARALLEL_MIN) ? cl_get_threads() : 1;
+      cl_parallel(batch_decode_worker, n_threads, &qb);
+    }
+    else
+      for (k = 0; k < qb.n_postings; k++)
+        qb.postings[k].size = cl_id2freq(qb.postings[k].attr, qb.postings[k].id);
+  }
+
+  n_threads = (n_positions >= BATCH_DECODE_PARALLEL_MIN) ? cl_get_threads() : 1;
+  cl_parallel(batch_collect_worker, n_threads, &qb);
+
+  /* the matches of queries for a single token become subcorpora */
+  if (qb.subcorpora)
+    for (i = 0; i < n_queries; i++) {
+      token = &qb.tokens[i];
+      if (!token->attr)
+        continue;
+      memset(&matches, 0, sizeof(CorpusList));
+      matches.mother_name = cl->mother_name;
+      matches.mother_size = cl->mother_size;
+      matches.registry = cl->registry;
+      matches.type = SUB;
+      matches.query_corpus = cl->name;
+      matches.query_text = queries[i];
+      matches.loaded = True;
+      matches.corpus = cl->corpus;
+      matches.size = token->size;
+      if (token->size > 0) {
+        matches.range = (Range *)cl_malloc(token->size * sizeof(Range));
+        for (k = 0; k < token->size; k++)
+          matches.range[k].start = matches.range[k].end = token->cpos[k];
+      }
+      duplicate_corpus(&matches, subcorpora[i], True);
+      cl_free(matches.range);
+    }
+  drop_temp_corpora();
+
+  /* all other queries are evaluated one after the other */
+  for (i = 0; i < n_queries; i++) {
+    if (qb.tokens[i].attr)
+      continue;
+    result = batch_evaluate(cl, queries[i], (subcorpora) ? subcorpora[i] : BATCH_RESULT);
+    if (!result)
+      for (j = 0; j < n_columns_; j++)
+        qb.counts[i + (size_t)n_queries * j] = -1;
+    else if (regions) {
+      for (k = 0; k < result->size; k++)
+        if ((j = cl_cpos2struc(regions, result->range[k].start)) >= 0)
+          qb.counts[i + (size_t)n_queries * j]++;
+    }
+    else
+      qb.counts[i] = result->size;
+    if (result && !subcorpora)
+      dropcorpus(result, NULL);
+  }
+
+  for (i = 0; i < n_queries; i++) {
+    token = &qb.tokens[i];
+    cl_free(token->string);
+    if (token->rx)
+      cl_delete_regex(token->rx);
+    cl_free(token->ids);
+    cl_free(token->postings);
+    cl_free(token->cpos);
+  }
+  for (k = 0; k < qb.n_postings; k++) {
+    cl_free(qb.postings[k].cpos);
+    cl_free(qb.postings[k].strucs);
+  }
+  cl_free(qb.postings);
+  cl_free(qb.tokens);
+
+  return qb.counts;
+}
@@ -0,0 +1,38 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#ifndef _cqp_batch_h_
+#define _cqp_batch_h_
+
+#include "corpmanag.h"
+
+
+/*
+ * QUERY BATCHES
+ *
+ * A batch runs many queries on the same corpus. Queries for a single token,
+ * such as [lemma = "house"] or "hous.*" %c, are not compiled: the lexicons are
+ * scanned once for all regular expressions on the same p-attribute, the index
+ * of each lexicon ID is decoded once for all queries that match it, and both
+ * steps run in parallel threads (see cl_parallel()). All other queries are
+ * evaluated one after the other in the usual way.
+ */
+
+int *query_batch(CorpusList *cl, char **queries, int n_queries, char **subcorpora, Attribute *regions, int *n_columns);
+
+
+#endif
@@ -376,6 +376,7 @@ cleanup_kwic_line_memory(void)
   cl_autostring_delete(line);
   cl_autostring_delete(token);
   cl_autostring_delete(scratch);
+  free_kwic_batch(NULL);
 }
 
 /**
@@ -824,3 +825,298 @@ compose_kwic_line(Corpus *corpus,
 # undef add_sep_to_line_if_not_empty
 }
 
+
+
+
+/*
+ * BATCH KWIC RENDERING
+ *
+ * compose_kwic_batch() renders the concordance lines for all matches of a query
+ * result at once, as three columns (left co-text, match, right co-text) of plain
+ * text. Instead of looking up every token separately, the corpus positions of
+ * many lines are decoded with a single call of cl_cpos2id_list() per attribute,
+ * and the strings are copied into an arena, which free_kwic_batch() releases
+ * once the caller has copied the lines.
+ */
+
+/** Number of corpus positions decoded at once by compose_kwic_batch(). */
+#define KWIC_BATCH_POSITIONS 65536
+
+/** Arena holding the text of the batch KWIC lines (until free_kwic_batch() is called). */
+static char *kwic_arena = NULL;
+/** Size of the arena (bytes). */
+static size_t kwic_arena_size = 0;
+/** Field boundaries in the arena (3 fields per line, plus the end of the last field). */
+static size_t *kwic_offsets = NULL;
+
+/**
+ * Remembers the region of an s-attribute found by the last lookup, so that
+ * adjacent concordance lines (which are usually in the same or in the next
+ * region) do not need to search the s-attribute again.
+ */
+typedef struct _KwicRegionCache {
+  Attribute *attribute;
+  int nr_regions;
+  int struc;                    /**< number of the region, -1 if no region has been found yet */
+  int start;
+  int end;
+} KwicRegionCache;
+
+/**
+ * Finds the region of the s-attribute containing a corpus position.
+ *
+ * @param rc     The region cache.
+ * @param cpos   The corpus position.
+ * @param start  Start of the region is put here.
+ * @param end    End of the region is put here.
+ * @return       Boolean: true if cpos is in a region of the s-attribute.
+ */
+static int
+kwic_region_lookup(KwicRegionCache *rc, int cpos, int *start, int *end)
+{
+  int struc;
+
+  if (rc->struc < 0 || cpos < rc->start || cpos > rc->end) {
+    struc = -1;
+    /* matches are sorted, so try the next region first */
+    if (rc->struc >= 0 && cpos > rc->end && rc->struc + 1 < rc->nr_regions
+        && cl_struc2cpos(rc->attribute, rc->struc + 1, start, end) && cpos >= *start && cpos <= *end)
+      struc = rc->struc + 1;
+    else if ((struc = cl_cpos2struc(rc->attribute, cpos)) >= 0 && !cl_struc2cpos(rc->attribute, struc, start, end))
+      struc = -1;
+    if (struc < 0)
+      return 0;
+    rc->struc = struc;
+    rc->start = *start;
+    rc->end = *end;
+  }
+  *start = rc->start;
+  *end = rc->end;
+  return 1;
+}
+
+/**
+ * Copies a token (the values of the attributes, separated by att_sep) to the arena.
+ *
+ * @param used           Number of bytes of the arena used so far.
+ * @param add_space      Boolean: whether to insert a blank before the token.
+ * @param nr_attributes  Number of p-attributes.
+ * @param values         The value of the token on the first attribute; the values on
+ *                       the following attributes are stride pointers apart.
+ * @param lengths        The lengths of the values (same layout as values).
+ * @param stride         Distance between the values of the attributes.
+ * @param att_sep        String inserted between the attribute values.
+ * @return               Number of bytes of the arena used after the token has been added.
+ */
+static size_t
+kwic_append_token(size_t used, int add_space, int nr_attributes,
+                  char **values, int *lengths, int stride, char *att_sep)
+{
+  size_t sep_len = strlen(att_sep), len;
+  int a;
+
+  len = (add_space ? 1 : 0) + (nr_attributes - 1) * sep_len;
+  for (a = 0; a < nr_attributes; a++)
+    len += lengths[a * stride];
+
+  if (used + len > kwic_arena_size) {
+    kwic_arena_size = MAX(2 * kwic_arena_size, used + len);
+    kwic_arena = (char *)cl_realloc(kwic_arena, kwic_arena_size);
+  }
+
+  if (add_space)
+    kwic_arena[used++] = ' ';
+  for (a = 0; a < nr_attributes; a++) {
+    if (a > 0) {
+      memcpy(kwic_arena + used, att_sep, sep_len);
+      used += sep_len;
+    }
+    memcpy(kwic_arena + used, values[a * stride], lengths[a * stride]);
+    used += lengths[a * stride];
+  }
+  return used;
+}
+
+/**
+ * Renders the concordance lines of a query result as columns of plain text.
+ *
+ * For each match, three fields are produced: the left co-text (left_width tokens),
+ * the match itself and the right co-text (right_width tokens). Tokens are separated
+ * by blanks; if several p-attributes are given, their values are separated by att_sep.
+ * If a boundary s-attribute is given, the co-text does not extend beyond the region
+ * containing the start (left) or end (right) of the match, and matches outside of the
+ * regions of the s-attribute have no co-text.
+ *
+ * The text of the lines is not terminated by NUL bytes: field i of the result spans
+ * the bytes from batch->offsets[i] to batch->offsets[i+1] of batch->data, and the
+ * fields of line n are 3*n (left), 3*n + 1 (match) and 3*n + 2 (right). The memory
+ * belongs to this module and is overwritten by the next call.
+ *
+ * @param cl             The query result (the matches).
+ * @param attributes     The p-attributes to print.
+ * @param nr_attributes  Number of p-attributes (at least 1).
+ * @param boundary       An s-attribute limiting the co-text, or NULL.
+ * @param left_width     Size of the left co-text (in tokens; at most the size of the corpus is used).
+ * @param right_width    Size of the right co-text (in tokens; at most the size of the corpus is used).
+ * @param att_sep        String inserted between the values of the p-attributes.
+ * @param batch          The result is put here.
+ * @return               Boolean: true for success, false if the attributes cannot be decoded.
+ */
+int
+compose_kwic_batch(CorpusList *cl,
+                   Attribute **attributes,
+                   int nr_attributes,
+                   Attribute *boundary,
+                   int left_width,
+                   int right_width,
+                   char *att_sep,
+                   KwicBatch *batch)
+{
+  KwicRegionCache rc;
+  int *spans, *line_pos, *cposlist, *ids, *lengths;
+  char **values;
+  int text_size, line, first, last, n_pos, p, cpos, a, rs, re, len, buf_size;
+  size_t used = 0;
+
+  batch->nr_lines = 0;
+  batch->data = NULL;
+  batch->offsets = NULL;
+
+  if (!cl || cl->size < 0 || nr_attributes < 1)
+    return 0;
+  if ((text_size = cl_max_cpos(attributes[0])) <= 0)
+    return 0;
+
+  rc.attribute = boundary;
+  rc.nr_regions = boundary ? cl_max_struc(boundary) : 0;
+  rc.struc = -1;
+
+  /* the co-text can't be wider than the corpus (which keeps the spans below from overflowing) */
+  left_width = MIN(MAX(left_width, 0), text_size);
+  right_width = MIN(MAX(right_width, 0), text_size);
+
+  /* determine the stretch of corpus positions covered by each line */
+  spans = (int *)cl_malloc(2 * MAX(cl->size, 1) * sizeof(int));
+  for (line = 0; line < cl->size; line++) {
+    spans[2*line] = (int)MAX(0, (long)cl->range[line].start - left_width);
+    spans[2*line+1] = (int)MIN(text_size - 1, (long)cl->range[line].end + right_width);
+    if (boundary) {
+      if (kwic_region_lookup(&rc, cl->range[line].start, &rs, &re))
+        spans[2*line] = MAX(spans[2*line], rs);
+      else
+        spans[2*line] = cl->range[line].start;
+      if (kwic_region_lookup(&rc, cl->range[line].end, &rs, &re))
+        spans[2*line+1] = MIN(spans[2*line+1], re);
+      else
+        spans[2*line+1] = cl->range[line].end;
+    }
+    used += spans[2*line+1] - spans[2*line] + 1;
+  }
+
+  buf_size = (int)MIN(used, KWIC_BATCH_POSITIONS);
+
+  /* the arena grows with the text (see kwic_append_token()) */
+  kwic_offsets = (size_t *)cl_realloc(kwic_offsets, (3 * cl->size + 1) * sizeof(size_t));
+  used = 0;
+
+  line_pos = (int *)cl_malloc(MAX(cl->size, 1) * sizeof(int));
+  cposlist = (int *)cl_malloc(MAX(buf_size, 1) * sizeof(int));
+  ids = (int *)cl_malloc(MAX(buf_size, 1) * nr_attributes * sizeof(int));
+  lengths = (int *)cl_malloc(MAX(buf_size, 1) * nr_attributes * sizeof(int));
+  values = (char **)cl_malloc(MAX(buf_size, 1) * nr_attributes * sizeof(char *));
+
+  for (first = 0; first < cl->size; first = last) {
+
+    /* collect the corpus positions of as many lines as fit into the buffer (but at least one line);
+     * the co-texts of adjacent matches usually overlap, and positions already collected are shared */
+    n_pos = 0;
+    for (last = first; last < cl->size; last++) {
+      if (last > first && spans[2*last] >= spans[2*last-2] && spans[2*last] <= cposlist[n_pos-1]) {
+        line_pos[last] = n_pos - 1 - (cposlist[n_pos-1] - spans[2*last]);
+        cpos = cposlist[n_pos-1] + 1;
+      }
+      else {
+        line_pos[last] = n_pos;
+        cpos = spans[2*last];
+      }
+      len = MAX(0, spans[2*last+1] - cpos + 1);
+      if (n_pos + len > buf_size) {
+        if (last > first)
+          break;
+        buf_size = len;
+        cposlist = (int *)cl_realloc(cposlist, len * sizeof(int));
+        ids = (int *)cl_realloc(ids, len * nr_attributes * sizeof(int));
+        lengths = (int *)cl_realloc(lengths, len * nr_attributes * sizeof(int));
+        values = (char **)cl_realloc(values, len * nr_attributes * sizeof(char *));
+      }
+      for ( ; cpos <= spans[2*last+1]; cpos++)
+        cposlist[n_pos++] = cpos;
+    }
+
+    /* decode each attribute for all of these positions at once */
+    for (a = 0; a < nr_attributes; a++) {
+      if (cl_cpos2id_list(attributes[a], cposlist, n_pos, ids + a * n_pos) < 0)
+        break;
+      for (p = a * n_pos; p < (a + 1) * n_pos; p++) {
+        if (NULL == (values[p] = cl_id2str(attributes[a], ids[p])))
+          values[p] = "";
+        lengths[p] = strlen(values[p]);
+      }
+    }
+    if (a < nr_attributes)
+      break;
+
+    for (line = first; line < last; line++) {
+      kwic_offsets[3*line] = used;
+      p = line_pos[line];
+      for (cpos = spans[2*line]; cpos <= spans[2*line+1]; cpos++, p++) {
+        if (cpos == cl->range[line].start)
+          kwic_offsets[3*line+1] = used;
+        else if (cpos == cl->range[line].end + 1)
+          kwic_offsets[3*line+2] = used;
+        used = kwic_append_token(used,
+                                 cpos != spans[2*line] && cpos != cl->range[line].start && cpos != cl->range[line].end + 1,
+                                 nr_attributes, values + p, lengths + p, n_pos, att_sep);
+      }
+      if (cl->range[line].end == spans[2*line+1])
+        kwic_offsets[3*line+2] = used;
+    }
+  }
+  kwic_offsets[3 * cl->size] = used;
+
+  cl_free(spans);
+  cl_free(line_pos);
+  cl_free(cposlist);
+  cl_free(ids);
+  cl_free(lengths);
+  cl_free(values);
+
+  if (first < cl->size)
+    return 0;
+
+  batch->nr_lines = cl->size;
+  batch->data = kwic_arena;
+  batch->offsets = kwic_offsets;
+  return 1;
+}
+
+/**
+ * Frees the memory of the concordance lines rendered by compose_kwic_batch().
+ *
+ * Should be called as soon as the lines have been copied (also if compose_kwic_batch()
+ * has failed), so that the arena of a large batch is not kept for the rest of the session.
+ *
+ * @param batch  The batch (may be NULL); its fields are reset.
+ */
+void
+free_kwic_batch(KwicBatch *batch)
+{
+  cl_free(kwic_arena);
+  cl_free(kwic_offsets);
+  kwic_arena_size = 0;
+  if (batch) {
+    batch->nr_lines = 0;
+    batch->data = NULL;
+    batch->offsets = NULL;
+  }
+}
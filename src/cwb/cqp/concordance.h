@@ -51,4 +51,26 @@ char *compose_kwic_line(Corpus *corpus,
 
 void cleanup_kwic_line_memory(void);
 
+
+/**
+ * KwicBatch : the concordance lines rendered by compose_kwic_batch(), as three
+ * text fields per line (left co-text, match, right co-text) held in one arena.
+ */
+typedef struct _KwicBatch {
+  int nr_lines;
+  char *data;                   /**< the text of all fields (not NUL-terminated) */
+  size_t *offsets;              /**< field i spans data[offsets[i]] to data[offsets[i+1]-1] */
+} KwicBatch;
+
+int compose_kwic_batch(CorpusList *cl,
+                       Attribute **attributes,
+                       int nr_attributes,
+                       Attribute *boundary,
+                       int left_width,
+                       int right_width,
+                       char *att_sep,
+                       KwicBatch *batch);
+
+void free_kwic_batch(KwicBatch *batch);
+
 #endif
@@ -24,9 +24,11 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include <stdint.h>
 
 #include "../cl/cl.h"
 #include "../cl/fileutils.h"       /* for file_length */
+#include "../cl/endian2.h"         /* for cl_bswap32 */
 #include "../cl/ui-helpers.h"
 
 #include "corpmanag.h"
@@ -42,7 +44,6 @@
 #define subcorpload_debug 0
 
 /* module-internal function prototypes */
-static Boolean attach_subcorpus(CorpusList *cl, char *advertised_directory, char *advertised_filename);
 static CorpusList *GetSystemCorpus(char *name, char *registry);
 
 
@@ -1038,6 +1039,11 @@ load_corpusnames(enum corpus_type ct)
       corpus->type = TEMP;
   drop_temp_corpora();
 
+  /* check all registry files against the registry cache in parallel (the loop below
+   * then sets up the corpora from the cache or from memory) */
+  if (SYSTEM == ct)
+    cl_registry_prefetch(dirlist);
+
   for (dirname = cl_path_get_component(dirlist) ; dirname ; dirname = cl_path_get_component(NULL)) {
     int optional_dir = 0;
     if (*dirname == '?') {
@@ -1121,6 +1127,9 @@ load_corpusnames(enum corpus_type ct)
       cqpmessage(Warning, "Couldn't open directory %s (continuing)", dirname);
   }
   /* end for (each directory) */
+
+  if (SYSTEM == ct)
+    cl_registry_cache_write();
 }
 
 
@@ -1231,6 +1240,26 @@ ensure_syscorpus(char *registry, char *name)
 }
 
 
+/**
+ * Reads the magic number of a saved subcorpus/NQR file.
+ *
+ * @param fullname  Filename.
+ * @return          The magic number, or 0 if the file can't be read.
+ */
+static int
+subcorpus_file_magic(char *fullname)
+{
+  FILE *fd;
+  int magic = 0;
+
+  if ((fd = fopen(fullname, "rb"))) {
+    if (1 != fread(&magic, sizeof(int), 1, fd))
+      magic = 0;
+    fclose(fd);
+  }
+  return magic;
+}
+
 /**
  * Reads in a sbcorpus/NQR that was previously saved to disk.
  *
@@ -1239,7 +1268,7 @@ ensure_syscorpus(char *registry, char *name)
  * @param advertised_filename
  * @return                      Boolean: whether the file was loaded correctly.
  */
-static Boolean
+Boolean
 attach_subcorpus(CorpusList *cl, char *advertised_directory, char *advertised_filename)
 {
   int         len, magic;
@@ -1276,6 +1305,14 @@ attach_subcorpus(CorpusList *cl, char *advertised_directory, char *advertised_fi
 
     if (!src)
       Rprintf("Subcorpus %s not accessible (can't open %s for reading)\n", cl->name, fullname);
+    else if (subcorpus_file_magic(fullname) == CWB_SUBCORPMAGIC_BINARY) {
+      /* binary format: the file is memory-mapped rather than read */
+      cl_close_stream(src);
+      if ((load_ok = load_binary_subcorpus(cl, fullname, NULL))) {
+        cl->abs_fn = fullname;
+        fullname = NULL;
+      }
+    }
     else {
       if (0 >= (len = file_length(fullname)))
         Rprintf("ERROR: File length of subcorpus is <= 0\n");
@@ -1458,6 +1495,9 @@ save_subcorpus(CorpusList *cl, char *fname)
       }
     }
 
+    if (subcorpus_format != SubcorpusLegacy)
+      return save_binary_subcorpus(cl, fname, subcorpus_format == SubcorpusCompressed);
+
     if (NULL != (dst = cl_open_stream(fname, CL_STREAM_WRITE_BIN, CL_STREAM_MAGIC))) {
       int zero = 0;
       magic = CWB_SUBCORPMAGIC_NEW;
@@ -1515,6 +1555,420 @@ save_subcorpus(CorpusList *cl, char *fname)
   }
 }
 
+
+/*
+ * BINARY SUBCORPUS FORMAT
+ *
+ * The file starts with a fixed-size header (SubcorpusFileHeader), followed by
+ * the registry directory and the name of the mother corpus (as '\0'-terminated
+ * strings) and the range, sortidx, target and keyword arrays (each aligned to
+ * 8 bytes). The offset and length of every array are recorded in the header;
+ * absent arrays have offset 0. All integers are stored in the byte order of
+ * the machine that wrote the file, so uncompressed arrays can be used directly
+ * from a memory-mapped file.
+ *
+ * In the compressed variant, arrays are stored as variable-length integers
+ * (7 bits per byte, least significant group first) of zigzag-encoded
+ * differences: the start of each range relative to the previous start and its
+ * end relative to its start; targets and keywords relative to the start of
+ * the range; the sort index relative to the previous entry.
+ */
+
+/** Version of the binary subcorpus format written by save_binary_subcorpus() */
+#define SUBCORPUS_FORMAT_VERSION 1
+
+/** Flag in SubcorpusFileHeader: arrays are compressed */
+#define SUBCORPUS_FLAG_COMPRESSED 1
+
+/** Alignment of arrays in the binary subcorpus format */
+#define SUBCORPUS_ALIGN 8
+
+/** Indices of the arrays in the header of the binary subcorpus format */
+enum _subcorpus_section {
+  SubcorpusRanges, SubcorpusSortidx, SubcorpusTargets, SubcorpusKeywords, SubcorpusNrSections
+};
+
+/**
+ * Header of a subcorpus file in the binary format.
+ */
+typedef struct _SubcorpusFileHeader {
+  int magic;                                /**< CWB_SUBCORPMAGIC_BINARY (also serves as byte-order mark) */
+  int version;                              /**< SUBCORPUS_FORMAT_VERSION */
+  int flags;                                /**< SUBCORPUS_FLAG_COMPRESSED */
+  int size;                                 /**< number of ranges */
+  int registry_len;                         /**< length of the registry directory (including the '\0') */
+  int mother_len;                           /**< length of the name of the mother corpus (including the '\0') */
+  uint64_t offset[SubcorpusNrSections];     /**< file offsets of the arrays (0 = array is not present) */
+  uint64_t length[SubcorpusNrSections];     /**< length of the arrays in bytes */
+} SubcorpusFileHeader;
+
+
+/** Zigzag-encodes a difference of two integers (so that small negative numbers have a short code). */
+static unsigned int
+zigzag_diff(int x, int y)
+{
+  int d = (int)((unsigned int)x - (unsigned int)y);
+  return ((unsigned int)d << 1) ^ (unsigned int)(d >> 31);
+}
+
+/** Inverse of zigzag_diff(): returns x given zigzag_diff(x, y) and y. */
+static int
+unzigzag_add(unsigned int z, int y)
+{
+  return (int)((unsigned int)y + ((z >> 1) ^ (0U - (z & 1))));
+}
+
+/** Appends a variable-length integer to a buffer; returns the position after the code. */
+static unsigned char *
+varint_put(unsigned char *p, unsigned int v)
+{
+  while (v >= 0x80) {
+    *p++ = (unsigned char)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (unsigned char)v;
+  return p;
+}
+
+/** Reads a variable-length integer from a buffer (not beyond end); returns NULL if the code is invalid. */
+static const unsigned char *
+varint_get(const unsigned char *p, const unsigned char *end, unsigned int *v)
+{
+  unsigned int x = 0;
+  int shift;
+
+  for (shift = 0; p < end && shift < 35; shift += 7) {
+    x |= (unsigned int)(*p & 0x7f) << shift;
+    if (!(*p++ & 0x80)) {
+      *v = x;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Compresses one of the arrays of a subcorpus (see "binary subcorpus format").
+ *
+ * @return  Newly allocated buffer (length in *len).
+ */
+static unsigned char *
+compress_subcorpus_section(CorpusList *cl, int section, size_t *len)
+{
+  unsigned char *buf, *p;
+  int i, prev = 0;
+
+  buf = p = (unsigned char *)cl_malloc((size_t)cl->size * (section == SubcorpusRanges ? 10 : 5) + 1);
+  for (i = 0; i < cl->size; i++) {
+    switch (section) {
+    case SubcorpusRanges:
+      p = varint_put(p, zigzag_diff(cl->range[i].start, prev));
+      p = varint_put(p, zigzag_diff(cl->range[i].end, cl->range[i].start));
+      prev = cl->range[i].start;
+      break;
+    case SubcorpusSortidx:
+      p = varint_put(p, zigzag_diff(cl->sortidx[i], prev));
+      prev = cl->sortidx[i];
+      break;
+    case SubcorpusTargets:
+      p = varint_put(p, zigzag_diff(cl->targets[i], cl->range[i].start));
+      break;
+    case SubcorpusKeywords:
+      p = varint_put(p, zigzag_diff(cl->keywords[i], cl->range[i].start));
+      break;
+    }
+  }
+  *len = p - buf;
+  return buf;
+}
+
+/**
+ * Decompresses one of the arrays of a subcorpus (the ranges must be decompressed first).
+ *
+ * @return  Newly allocated array or NULL if the data are corrupt.
+ */
+static void *
+decompress_subcorpus_section(CorpusList *cl, Range *range, int section, const unsigned char *p, size_t len)
+{
+  const unsigned char *end = p + len;
+  unsigned int z1, z2;
+  int i, prev = 0;
+  int *data;
+
+  data = (int *)cl_malloc(sizeof(int) * (section == SubcorpusRanges ? 2 : 1) * cl->size);
+  for (i = 0; i < cl->size && p; i++) {
+    if (!(p = varint_get(p, end, &z1)))
+      break;
+    switch (section) {
+    case SubcorpusRanges:
+      if ((p = varint_get(p, end, &z2))) {
+        data[2*i] = prev = unzigzag_add(z1, prev);
+        data[2*i+1] = unzigzag_add(z2, prev);
+      }
+      break;
+    case SubcorpusSortidx:
+      data[i] = prev = unzigzag_add(z1, prev);
+      break;
+    default:
+      data[i] = unzigzag_add(z1, range[i].start);
+      break;
+    }
+  }
+  if (i < cl->size || p != end)
+    cl_free(data);
+  return data;
+}
+
+
+/**
+ * Saves a subcorpus/NQR to disk in the binary format.
+ *
+ * The file is written under a temporary name and then renamed, so that other
+ * processes which have mapped an earlier version of the file into memory are
+ * not affected.
+ *
+ * @param cl        The subcorpus to save.
+ * @param fname     Filename.
+ * @param compress  Boolean: whether the arrays should be compressed.
+ * @return          Boolean: true if the file was written successfully.
+ */
+Boolean
+save_binary_subcorpus(CorpusList *cl, char *fname, Boolean compress)
+{
+  SubcorpusFileHeader header;
+  void *data[SubcorpusNrSections];
+  unsigned char *packed[SubcorpusNrSections];
+  char *tmp_name;
+  char zero[SUBCORPUS_ALIGN] = { 0 };
+  uint64_t pos;
+  size_t len;
+  int i, ok;
+  FILE *dst;
+
+  if (!cl || !cl->registry || !cl->mother_name)
+    return False;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = CWB_SUBCORPMAGIC_BINARY;
+  header.version = SUBCORPUS_FORMAT_VERSION;
+  header.flags = compress ? SUBCORPUS_FLAG_COMPRESSED : 0;
+  header.size = cl->size;
+  header.registry_len = strlen(cl->registry) + 1;
+  header.mother_len = strlen(cl->mother_name) + 1;
+
+  data[SubcorpusRanges]   = (cl->size > 0) ? cl->range : NULL;
+  data[SubcorpusSortidx]  = (cl->size > 0) ? cl->sortidx : NULL;
+  data[SubcorpusTargets]  = (cl->size > 0) ? cl->targets : NULL;
+  data[SubcorpusKeywords] = (cl->size > 0) ? cl->keywords : NULL;
+
+  pos = sizeof(header) + header.registry_len + header.mother_len;
+  for (i = 0; i < SubcorpusNrSections; i++) {
+    packed[i] = NULL;
+    if (!data[i])
+      continue;
+    if (compress)
+      packed[i] = compress_subcorpus_section(cl, i, &len);
+    else
+      len = (size_t)cl->size * (i == SubcorpusRanges ? sizeof(Range) : sizeof(int));
+    pos = (pos + SUBCORPUS_ALIGN - 1) / SUBCORPUS_ALIGN * SUBCORPUS_ALIGN;
+    header.offset[i] = pos;
+    header.length[i] = len;
+    pos += len;
+  }
+
+  len = strlen(fname) + 32;
+  tmp_name = (char *)cl_malloc(len);
+  snprintf(tmp_name, len, "%s.%d.tmp", fname, (int)getpid());
+
+  if (!(dst = fopen(tmp_name, "wb"))) {
+    Rprintf("cannot open output file %s\n", tmp_name);
+    ok = 0;
+  }
+  else {
+    ok = (1 == fwrite(&header, sizeof(header), 1, dst));
+    ok = ok && (1 == fwrite(cl->registry, header.registry_len, 1, dst));
+    ok = ok && (1 == fwrite(cl->mother_name, header.mother_len, 1, dst));
+    pos = sizeof(header) + header.registry_len + header.mother_len;
+    for (i = 0; ok && i < SubcorpusNrSections; i++) {
+      if (!header.offset[i])
+        continue;
+      ok = (header.offset[i] == pos || 1 == fwrite(zero, header.offset[i] - pos, 1, dst));
+      ok = ok && (1 == fwrite(packed[i] ? (void *)packed[i] : data[i], header.length[i], 1, dst));
+      pos = header.offset[i] + header.length[i];
+    }
+    ok = (0 == fclose(dst)) && ok;
+    if (ok && 0 != rename(tmp_name, fname)) {
+      /* rename() can't replace an existing file on some systems */
+      remove(fname);
+      ok = (0 == rename(tmp_name, fname));
+    }
+    if (!ok) {
+      Rprintf("cannot write output file %s\n", fname);
+      remove(tmp_name);
+    }
+  }
+
+  for (i = 0; i < SubcorpusNrSections; i++)
+    cl_free(packed[i]);
+  cl_free(tmp_name);
+
+  if (ok) {
+    cl->saved = True;
+    cl->needs_update = False;
+  }
+  return ok ? True : False;
+}
+
+
+/**
+ * Reads in a subcorpus/NQR that was saved in the binary format.
+ *
+ * The file is memory-mapped. If mapping is not NULL and the arrays are
+ * stored uncompressed, the range, sortidx, target and keyword arrays of the
+ * subcorpus point directly into the mapped file, which is returned in
+ * *mapping; the caller must not free these arrays, but has to release the
+ * mapping with free_mblob() after the subcorpus has been discarded.
+ * Otherwise, the arrays are copied (or decompressed) and the file is unmapped
+ * again (mapping->data is NULL).
+ *
+ * The name and the filename of the subcorpus are not changed. If the file
+ * is in the legacy format, False is returned without an error message.
+ *
+ * @param cl        The subcorpus to load into (must be empty).
+ * @param fullname  Filename.
+ * @param mapping   Where to keep the mapped file (or NULL to copy the arrays).
+ * @return          Boolean: whether the file was loaded correctly.
+ */
+Boolean
+load_binary_subcorpus(CorpusList *cl, char *fullname, MemBlob *mapping)
+{
+  MemBlob blob;
+  SubcorpusFileHeader header;
+  void *data[SubcorpusNrSections] = { NULL, NULL, NULL, NULL };
+  const char *p;
+  CorpusList *mother;
+  Boolean in_place, ok = True;
+  int i;
+
+  init_mblob(&blob);
+  if (mapping)
+    init_mblob(mapping);
+  if (!read_file_into_blob(fullname, CL_MEMBLOB_MMAPPED, sizeof(int), &blob))
+    return False;
+  p = (const char *)blob.data;
+
+  if (blob.size < sizeof(header)) {
+    Rprintf("File %s is not a subcorpus\n", fullname);
+    free_mblob(&blob);
+    return False;
+  }
+  memcpy(&header, p, sizeof(header));
+  if (header.magic == CWB_SUBCORPMAGIC_ORIG || header.magic == CWB_SUBCORPMAGIC_NEW) {
+    /* legacy format: leave it to attach_subcorpus() */
+    free_mblob(&blob);
+    return False;
+  }
+  if (header.magic == cl_bswap32(CWB_SUBCORPMAGIC_BINARY)) {
+    Rprintf("Subcorpus %s was saved on a machine with a different byte order\n", fullname);
+    free_mblob(&blob);
+    return False;
+  }
+  if (header.magic != CWB_SUBCORPMAGIC_BINARY || header.version < 1 || header.version > SUBCORPUS_FORMAT_VERSION) {
+    Rprintf("Magic number or version incorrect in %s\n", fullname);
+    free_mblob(&blob);
+    return False;
+  }
+
+  /* validate the layout of the file */
+  if (header.size < 0 || header.registry_len <= 0 || header.mother_len <= 0
+      || sizeof(header) + (uint64_t)header.registry_len + header.mother_len > blob.size
+      || p[sizeof(header) + header.registry_len - 1] != '\0'
+      || p[sizeof(header) + header.registry_len + header.mother_len - 1] != '\0'
+      || (header.size > 0 && !header.offset[SubcorpusRanges]))
+    ok = False;
+  for (i = 0; ok && i < SubcorpusNrSections; i++) {
+    if (!header.offset[i])
+      continue;
+    if (header.offset[i] > blob.size || header.length[i] > blob.size - header.offset[i])
+      ok = False;
+    else if (!(header.flags & SUBCORPUS_FLAG_COMPRESSED)
+             && (header.offset[i] % sizeof(int)
+                 || header.length[i] != (uint64_t)header.size * (i == SubcorpusRanges ? sizeof(Range) : sizeof(int))))
+      ok = False;
+  }
+  if (!ok) {
+    Rprintf("Subcorpus file %s is corrupt\n", fullname);
+    free_mblob(&blob);
+    return False;
+  }
+
+  cl_free(cl->registry);
+  cl_free(cl->mother_name);
+  cl->registry = cl_strdup(p + sizeof(header));
+  cl->mother_name = cl_strdup(p + sizeof(header) + header.registry_len);
+  mother = ensure_syscorpus(cl->registry, cl->mother_name);
+  if (!(mother && mother->corpus)) {
+    cqpmessage(Warning, "When trying to load subcorpus %s:\n\tCan't access mother corpus %s", cl->name, cl->mother_name);
+    cl_free(cl->registry);
+    cl_free(cl->mother_name);
+    free_mblob(&blob);
+    return False;
+  }
+  cl->corpus = mother->corpus;
+  cl->mother_size = mother->mother_size;
+  cl->size = header.size;
+
+  in_place = (mapping && !(header.flags & SUBCORPUS_FLAG_COMPRESSED));
+  for (i = 0; ok && i < SubcorpusNrSections; i++) {
+    if (!header.offset[i] || cl->size == 0)
+      continue;
+    if (in_place)
+      data[i] = (void *)(p + header.offset[i]);
+    else if (header.flags & SUBCORPUS_FLAG_COMPRESSED)
+      ok = (NULL != (data[i] = decompress_subcorpus_section(cl, (Range *)data[SubcorpusRanges], i,
+                                                            (const unsigned char *)p + header.offset[i], header.length[i])));
+    else {
+      data[i] = cl_malloc(header.length[i]);
+      memcpy(data[i], p + header.offset[i], header.length[i]);
+    }
+  }
+  /* the sort index holds positions in the range array */
+  if (ok && data[SubcorpusSortidx])
+    for (i = 0; ok && i < cl->size; i++)
+      if (((int *)data[SubcorpusSortidx])[i] < 0 || ((int *)data[SubcorpusSortidx])[i] >= cl->size)
+        ok = False;
+  if (!ok) {
+    Rprintf("Subcorpus file %s is corrupt\n", fullname);
+    if (!in_place)
+      for (i = 0; i < SubcorpusNrSections; i++)
+        cl_free(data[i]);
+    cl_free(cl->registry);
+    cl_free(cl->mother_name);
+    cl->corpus = NULL;
+    cl->mother_size = 0;
+    cl->size = 0;
+    free_mblob(&blob);
+    return False;
+  }
+
+  cl->range    = (Range *)data[SubcorpusRanges];
+  cl->sortidx  = (int *)data[SubcorpusSortidx];
+  cl->targets  = (int *)data[SubcorpusTargets];
+  cl->keywords = (int *)data[SubcorpusKeywords];
+  cl->type = SUB;
+  cl->saved = True;
+  cl->loaded = True;
+  cl->needs_update = False;
+
+  if (in_place)
+    *mapping = blob;
+  else
+    free_mblob(&blob);
+
+  return True;
+}
+
+
 void
 save_unsaved_subcorpora(void)
 {
@@ -1556,6 +2010,77 @@ NextCorpusFromList(CorpusList *cl)
   return (cl ? cl->next : NULL);
 }
 
+/**
+ * Removes corpora from the global list of corpora without freeing them.
+ *
+ * Detached corpora are invisible to CQP until they are put back with
+ * attach_corpora(). The CQi server uses this to keep the subcorpora of
+ * client sessions apart when it serves several clients from one process.
+ * The caller is responsible for the current corpus, which must not be
+ * left pointing to a detached corpus.
+ *
+ * @param detach  Predicate which returns true for the corpora to remove.
+ * @param data    Passed on to the predicate.
+ * @return        The detached corpora (in the same order, linked by their
+ *                next pointers), or NULL if no corpus was removed.
+ */
+CorpusList *
+detach_corpora(Boolean (*detach)(CorpusList *cl, void *data), void *data)
+{
+  CorpusList *cl, *next, *kept = NULL, *removed = NULL;
+  CorpusList **kept_tail = &kept, **removed_tail = &removed;
+
+  for (cl = corpuslist; cl; cl = next) {
+    next = cl->next;
+    cl->next = NULL;
+    if (detach(cl, data)) {
+      *removed_tail = cl;
+      removed_tail = &cl->next;
+    }
+    else {
+      *kept_tail = cl;
+      kept_tail = &cl->next;
+    }
+  }
+  corpuslist = kept;
+
+  return removed;
+}
+
+/**
+ * Puts corpora removed by detach_corpora() back on the global list of corpora.
+ *
+ * @param chain  The detached corpora (may be NULL).
+ */
+void
+attach_corpora(CorpusList *chain)
+{
+  CorpusList *last;
+
+  if (chain) {
+    for (last = chain; last->next; last = last->next)
+      ;
+    last->next = corpuslist;
+    corpuslist = chain;
+  }
+}
+
+/**
+ * Frees corpora removed by detach_corpora() (without putting them back).
+ *
+ * @param chain  The detached corpora (may be NULL).
+ */
+void
+free_corpora(CorpusList *chain)
+{
+  CorpusList *next;
+
+  for ( ; chain; chain = next) {
+    next = chain->next;
+    destruct_cl(chain);
+  }
+}
+
 
 /**
  * Assesses whether a specified corpus can be accessed.
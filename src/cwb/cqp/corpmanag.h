@@ -21,6 +21,7 @@
 
 #include "../cl/cl.h"
 #include "../cl/bitfields.h"
+#include "../cl/storage.h"
 
 #include "cqp.h"
 #include "context_descriptor.h"
@@ -161,14 +162,27 @@ Boolean subcorpus_name_is_qualified(const char *corpusname);
 
 char *split_subcorpus_name(const char *corpusname, char *mother_name);
 
+Boolean attach_subcorpus(CorpusList *cl, char *advertised_directory, char *advertised_filename);
+
 Boolean save_subcorpus(CorpusList *cl, char *fname);
 
+Boolean load_binary_subcorpus(CorpusList *cl, char *fullname, MemBlob *mapping);
+
+Boolean save_binary_subcorpus(CorpusList *cl, char *fname, Boolean compress);
+
 void save_unsaved_subcorpora();
 
 /* Iterate through list of corpora */
 CorpusList *FirstCorpusFromList();
 CorpusList *NextCorpusFromList(CorpusList *cl);
 
+/* Take corpora off the list and put them back (for CQPserver sessions) */
+CorpusList *detach_corpora(Boolean (*detach)(CorpusList *cl, void *data), void *data);
+
+void attach_corpora(CorpusList *chain);
+
+void free_corpora(CorpusList *chain);
+
 int set_current_corpus(CorpusList *cp, int force);
 
 int set_current_corpus_name(char *name, int force);
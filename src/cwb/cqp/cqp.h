@@ -56,6 +56,15 @@ typedef enum _matching_strategy {
   longest_match       /**< find longest possible token sequences */
 } MatchingStrategy;
 
+/**
+ * SubcorpusFormat type : the file format used for saving subcorpora/NQRs to disk.
+ */
+typedef enum _subcorpus_format {
+  SubcorpusLegacy,    /**< traditional CQP format (compatible with older versions of CQP) */
+  SubcorpusBinary,    /**< versioned binary format that can be memory-mapped */
+  SubcorpusCompressed /**< versioned binary format with delta and variable-length integer compression */
+} SubcorpusFormat;
+
 /**
  * The "corpus yielding command type" type.
  *
@@ -24,6 +24,7 @@
 
 #include "../cl/cl.h"
 #include "../cl/cwb-globals.h"
+#include "../cl/globals.h"
 #include "../cl/ui-helpers.h"
 
 #include "cqp.h"
@@ -73,6 +74,40 @@ EEP CurEnv;
 /** Global pointer, address of the cell in Environment that is being used for evaluation. Used largely in files other than parse_actions. @see Environment. */
 EEP evalenv;
 
+/**
+ * Restricts the start positions of query matches to the range from query_start_min to query_start_max
+ * (inclusive) if query_start_max >= 0, so that a query can be evaluated incrementally in chunks of the corpus.
+ */
+int query_start_min = 0;
+/** @see query_start_min */
+int query_start_max = -1;
+
+/**
+ * Matching strategy of the last standard query evaluated with a restricted range of start positions.
+ * The matches of such a query are not post-processed according to the matching strategy, because nested
+ * matches may start outside the range; this is left to the caller.
+ */
+MatchingStrategy query_start_strategy = traditional;
+
+/**
+ * If query_sample_size > 0, standard queries are evaluated for a uniform random sample of the candidate
+ * start positions only: either for query_sample_size start positions, or, if query_sample_matches is true,
+ * for as many start positions as are needed to find at least query_sample_size matches.
+ */
+int query_sample_size = 0;
+/** @see query_sample_size */
+int query_sample_matches = 0;
+
+/** Number of candidate start positions of the last query evaluated with sampling (-1 if the query could not be sampled) */
+int query_sample_candidates = -1;
+/** Number of start positions simulated for the last query evaluated with sampling */
+int query_sample_evaluated = 0;
+/**
+ * Boolean: matches of the last query evaluated with sampling can be nested or share an end point, and
+ * the matching strategy would remove some of them; they are not removed unless both were sampled.
+ */
+int query_sample_biased = 0;
+
 /* desc above of CurEnv and evalenv is still a bit vague */
 
 
@@ -1391,6 +1426,396 @@ mark_offrange_cells(Matchlist *matchlist, CorpusList *subcorpus)
   return n_deletions;
 }
 
+/**
+ * Alters a matchlist so that the start/end values of any match whose start point is outside
+ * the range set by query_start_min and query_start_max are changed to the dummy -1 value.
+ *
+ * @param  matchlist  Matchlist to modify (need not be sorted).
+ * @return            Count of matches that were overwritten as -1.
+ */
+static int
+mark_cells_outside_start_range(Matchlist *matchlist)
+{
+  int i, n_deletions = 0;
+
+  if (query_start_max < 0)
+    return 0;
+
+  for (i = 0; i < matchlist->tabsize; i++)
+    if (matchlist->start[i] >= 0 && (matchlist->start[i] < query_start_min || matchlist->start[i] > query_start_max)) {
+      matchlist->start[i] = -1;
+      if (matchlist->end)
+        matchlist->end[i] = -1;
+      n_deletions++;
+    }
+
+  return n_deletions;
+}
+
+
+
+/*
+ * QUERY PLANNER FOR THE INITIAL MATCHLIST
+ *
+ * The size of the matchlist of each subtree of a constraint in query-initial position, and the cost
+ * of computing it, are estimated from lexicon frequencies, so that the operands of a conjunction can be
+ * evaluated in the cheapest order. Costs are measured in corpus positions that have to be looked up.
+ */
+
+/** Cost of evaluating a comparison at a single corpus position (with eval_bool()) */
+#define PLAN_FILTER_COST 1.0
+
+/** Cost of matching a regular expression against a string */
+#define PLAN_REGEX_COST 4.0
+
+/** Cost of calling a builtin function or dynamic attribute */
+#define PLAN_FUNC_COST 20.0
+
+/** Number of lexicon entries matched against a regular expression to estimate its frequency */
+#define PLAN_REGEX_SAMPLE 200
+
+/** Evaluation order of a conjunction in query-initial position. */
+typedef enum _PlanOrder {
+  PlanLeft,                     /**< compute matchlist of left operand, evaluate right operand on its positions */
+  PlanRight,                    /**< compute matchlist of right operand, evaluate left operand on its positions */
+  PlanIntersect                 /**< compute matchlists of both operands and intersect them */
+} PlanOrder;
+
+/** Estimates for the matchlist of a constraint tree in query-initial position. */
+typedef struct _PlanCost {
+  double size;                  /**< estimated number of matching corpus positions */
+  double cost;                  /**< estimated cost of computing the matchlist */
+  double filter;                /**< estimated cost of evaluating the constraint at a single position */
+  int fixed;                    /**< the constraint must be evaluated in the order written in the query */
+  PlanOrder order;              /**< cheapest evaluation order (for conjunctions) */
+} PlanCost;
+
+/**
+ * Estimates the number of tokens matching a regular expression on a p-attribute.
+ *
+ * Lexicon IDs are assigned in order of first occurrence, so frequent types tend to have low IDs:
+ * the first half of the sample is therefore taken from the start of the lexicon, the other half
+ * at regular intervals from the rest. For small lexicons, the count is exact.
+ */
+static double
+plan_regex_freq(Attribute *attr, CL_Regex rx)
+{
+  int id, lexsize, head, step;
+  double freq = 0.0, tail = 0.0;
+  /* matching the sample is not part of evaluating the query, so it must not show up in cl_regopt_count() */
+  int regopt_successes = cl_regopt_successes, regopt_trials = cl_regopt_trials;
+
+  lexsize = cl_max_id(attr);
+  if (lexsize <= 0)
+    return 0.0;
+
+  head = MIN(lexsize, PLAN_REGEX_SAMPLE / 2);
+  for (id = 0; id < head; id++)
+    if (cl_regex_match(rx, cl_id2str(attr, id), 0))
+      freq += cl_id2freq(attr, id);
+
+  if (head < lexsize) {
+    step = MAX(1, (lexsize - head) / (PLAN_REGEX_SAMPLE / 2));
+    for (id = head; id < lexsize; id += step)
+      if (cl_regex_match(rx, cl_id2str(attr, id), 0))
+        tail += cl_id2freq(attr, id);
+    freq += tail * step;
+  }
+
+  cl_regopt_successes = regopt_successes;
+  cl_regopt_trials = regopt_trials;
+  return freq;
+}
+
+/**
+ * Estimates the size and cost of the initial matchlist of a constraint tree
+ * (as computed by calculate_initial_matchlist_1()) and chooses the evaluation
+ * order of conjunctions, which is stored in their nodes (plan_order).
+ *
+ * Subtrees that calculate_initial_matchlist_1() handles in special ways (label references
+ * and other constructs that are not allowed in query-initial position) are marked as fixed,
+ * so that conjunctions containing them are evaluated in the order given in the query.
+ *
+ * @param ctptr   The constraint tree.
+ * @param corpus  The corpus the query is run on.
+ * @param pc      Estimates are stored here.
+ */
+static void
+plan_initial_matchlist(Constrainttree ctptr, CorpusList *corpus, PlanCost *pc)
+{
+  PlanCost left, right;
+  double n = (double) corpus->mother_size;
+  double f, option;
+  Constrainttree lhs, rhs;
+  int id;
+
+  pc->size = n;
+  pc->cost = n;
+  pc->filter = PLAN_FILTER_COST;
+  pc->fixed = 0;
+  pc->order = PlanLeft;
+
+  if (!ctptr) {
+    pc->cost = pc->filter = 0.0;
+    return;
+  }
+
+  switch (ctptr->type) {
+  case cnode:
+    pc->filter = 0.0;
+    if (ctptr->constnode.val == 0)
+      pc->size = pc->cost = 0.0;
+    return;
+
+  case id_list:
+    if (ctptr->idlist.label) {
+      pc->fixed = 1;
+      return;
+    }
+    f = (ctptr->idlist.nr_items > 0) ? cl_idlist2freq(ctptr->idlist.attr, ctptr->idlist.items, ctptr->idlist.nr_items) : 0;
+    if (ctptr->idlist.negated) {
+      pc->size = n - f;
+      pc->cost = n + f;
+    }
+    else
+      pc->size = pc->cost = f;
+    return;
+
+  case bnode:
+    break;
+
+  default:
+    pc->fixed = 1;
+    return;
+  }
+
+  switch (ctptr->node.op_id) {
+  case b_and:
+    plan_initial_matchlist(ctptr->node.left, corpus, &left);
+    plan_initial_matchlist(ctptr->node.right, corpus, &right);
+    pc->fixed = left.fixed || right.fixed;
+    pc->size = (n > 0) ? left.size * right.size / n : 0.0;
+    pc->filter = left.filter + ((n > 0) ? left.size / n : 0.0) * right.filter;
+    pc->cost = left.cost + left.size * right.filter;
+    pc->order = PlanLeft;
+    if (!pc->fixed) {
+      option = right.cost + right.size * left.filter;
+      if (option < pc->cost) {
+        pc->cost = option;
+        pc->order = PlanRight;
+      }
+      option = left.cost + right.cost + left.size + right.size;
+      if (option < pc->cost) {
+        pc->cost = option;
+        pc->order = PlanIntersect;
+      }
+    }
+    ctptr->node.plan_order = pc->order;
+    return;
+
+  case b_or:
+    plan_initial_matchlist(ctptr->node.left, corpus, &left);
+    plan_initial_matchlist(ctptr->node.right, corpus, &right);
+    pc->fixed = left.fixed || right.fixed;
+    pc->size = MIN(n, left.size + right.size);
+    pc->cost = left.cost + right.cost + left.size + right.size;
+    pc->filter = left.filter + right.filter;
+    return;
+
+  case b_not:
+    plan_initial_matchlist(ctptr->node.left, corpus, &left);
+    pc->fixed = left.fixed;
+    pc->size = n - left.size;
+    pc->cost = left.cost + n;
+    pc->filter = left.filter;
+    return;
+
+  case b_implies:
+    plan_initial_matchlist(ctptr->node.left, corpus, &left);
+    plan_initial_matchlist(ctptr->node.right, corpus, &right);
+    pc->filter = left.filter + right.filter;
+    pc->cost = n * (1.0 + pc->filter);
+    return;
+
+  default:
+    break;
+  }
+
+  /* comparisons */
+  lhs = ctptr->node.left;
+  rhs = ctptr->node.right;
+
+  switch (lhs->type) {
+  case func:
+    /* evaluated for every corpus position */
+    pc->filter = PLAN_FUNC_COST;
+    pc->size = n / 2;
+    pc->cost = n * (1.0 + pc->filter);
+    return;
+
+  case sa_ref:
+    /* evaluated for every corpus position; a comparison with a region boundary or a region value
+       is assumed to select the tokens of a single region */
+    if (rhs && rhs->type == string_leaf && rhs->leaf.pat_type == REGEXP)
+      pc->filter = PLAN_REGEX_COST;
+    pc->size = (ctptr->node.op_id == cmp_eq && cl_max_struc(lhs->sa_ref.attr) > 0) ? n / cl_max_struc(lhs->sa_ref.attr) : n / 2;
+    pc->cost = n * (1.0 + pc->filter);
+    return;
+
+  case pa_ref:
+    break;
+
+  default:
+    pc->fixed = 1;
+    return;
+  }
+
+  if (lhs->pa_ref.label) {
+    /* [ _ = <cpos> ] locates a single position, other label references are errors */
+    if (cl_str_is(lhs->pa_ref.label->name, "_") && rhs && rhs->type == int_leaf && ctptr->node.op_id == cmp_eq)
+      pc->size = pc->cost = 1.0;
+    else
+      pc->fixed = 1;
+    return;
+  }
+
+  if (!rhs || rhs->type != string_leaf) {
+    /* evaluated for every corpus position */
+    pc->size = n / 2;
+    pc->cost = n * (1.0 + pc->filter);
+    return;
+  }
+
+  if (ctptr->node.op_id != cmp_eq && ctptr->node.op_id != cmp_neq) {
+    pc->fixed = 1;
+    return;
+  }
+
+  switch (rhs->leaf.pat_type) {
+  case REGEXP:
+    if (cl_str_is(rhs->leaf.ctype.sconst, ".*")) {
+      pc->filter = 0.0;
+      f = n;
+    }
+    else {
+      pc->filter = PLAN_REGEX_COST;
+      f = rhs->leaf.rx ? MIN(n, plan_regex_freq(lhs->pa_ref.attr, rhs->leaf.rx)) : n / 2;
+      /* the whole lexicon is matched against the regular expression */
+      pc->cost = PLAN_REGEX_COST * cl_max_id(lhs->pa_ref.attr);
+    }
+    break;
+
+  case NORMAL:
+    id = cl_str2id(lhs->pa_ref.attr, rhs->leaf.ctype.sconst);
+    f = (id >= 0) ? cl_id2freq(lhs->pa_ref.attr, id) : 0;
+    pc->cost = 0.0;
+    break;
+
+  case CID:
+    f = cl_id2freq(lhs->pa_ref.attr, rhs->leaf.ctype.cidconst);
+    f = (f >= 0) ? f : 0;
+    pc->cost = 0.0;
+    break;
+
+  default:
+    pc->fixed = 1;
+    return;
+  }
+
+  if (ctptr->node.op_id == cmp_eq) {
+    pc->size = f;
+    pc->cost += f;
+  }
+  else {
+    pc->size = n - f;
+    pc->cost += n + f;
+  }
+}
+
+/**
+ * Prints the estimates of the query planner for a constraint tree in query-initial position
+ * (for option ExplainQuery).
+ *
+ * @param ctptr   The constraint tree.
+ * @param corpus  The corpus the query is run on.
+ * @param indent  Indentation level (two spaces each).
+ */
+static void
+explain_initial_matchlist(Constrainttree ctptr, CorpusList *corpus, int indent)
+{
+  PlanCost pc;
+  static const char *order[] = { "left operand first", "right operand first", "intersect operands" };
+
+  plan_initial_matchlist(ctptr, corpus, &pc);
+
+  Rprintf("%*s", 2 * indent, "");
+  if (!ctptr)
+    Rprintf("(no constraint)");
+  else if (ctptr->type == bnode) {
+    switch (ctptr->node.op_id) {
+    case b_and:
+      Rprintf("AND [%s]", pc.fixed ? "as written" : order[pc.order]);
+      break;
+    case b_or:
+      Rprintf("OR");
+      break;
+    case b_not:
+      Rprintf("NOT");
+      break;
+    case b_implies:
+      Rprintf("IMPLIES [scan corpus]");
+      break;
+    default:
+      switch (ctptr->node.left->type) {
+      case pa_ref:
+        Rprintf("%s%s%s %s",
+                ctptr->node.left->pa_ref.label ? ctptr->node.left->pa_ref.label->name : "",
+                ctptr->node.left->pa_ref.label && ctptr->node.left->pa_ref.attr ? "." : "",
+                ctptr->node.left->pa_ref.attr ? ctptr->node.left->pa_ref.attr->any.name : "",
+                get_b_operator_name(ctptr->node.op_id));
+        if (ctptr->node.right && ctptr->node.right->type == string_leaf) {
+          if (ctptr->node.right->leaf.pat_type == CID)
+            Rprintf(" \"%s\"", cl_id2str(ctptr->node.left->pa_ref.attr, ctptr->node.right->leaf.ctype.cidconst));
+          else
+            Rprintf(ctptr->node.right->leaf.pat_type == REGEXP ? " /%s/" : " \"%s\"", ctptr->node.right->leaf.ctype.sconst);
+        }
+        break;
+      case sa_ref:
+        Rprintf("%s %s [scan corpus]", ctptr->node.left->sa_ref.attr->any.name, get_b_operator_name(ctptr->node.op_id));
+        break;
+      case func:
+        Rprintf("function call %s [scan corpus]", get_b_operator_name(ctptr->node.op_id));
+        break;
+      default:
+        Rprintf("comparison %s", get_b_operator_name(ctptr->node.op_id));
+        break;
+      }
+    }
+  }
+  else if (ctptr->type == id_list)
+    Rprintf("%s%s in list of %d IDs", ctptr->idlist.negated ? "NOT " : "", ctptr->idlist.attr->any.name, ctptr->idlist.nr_items);
+  else if (ctptr->type == cnode)
+    Rprintf("constant %d", ctptr->constnode.val);
+  else
+    Rprintf("node type %d", ctptr->type);
+  Rprintf("  (est. %.0f matches, cost %.0f)\n", pc.size, pc.cost);
+
+  if (ctptr && ctptr->type == bnode) {
+    switch (ctptr->node.op_id) {
+    case b_and:
+    case b_or:
+    case b_implies:
+      explain_initial_matchlist(ctptr->node.left, corpus, indent + 1);
+      explain_initial_matchlist(ctptr->node.right, corpus, indent + 1);
+      break;
+    case b_not:
+      explain_initial_matchlist(ctptr->node.left, corpus, indent + 1);
+      break;
+    default:
+      break;
+    }
+  }
+}
 
 
 /**
@@ -1405,6 +1830,7 @@ calculate_initial_matchlist_1(Constrainttree ctptr, Matchlist *matchlist, Corpus
 {
   int i;
   Matchlist left, right;
+  Constrainttree first, second;
 
   /* do NOT use free_matchlist here! */
 
@@ -1423,40 +1849,54 @@ calculate_initial_matchlist_1(Constrainttree ctptr, Matchlist *matchlist, Corpus
 
         assert(ctptr->node.left && ctptr->node.right);
 
-        /* just the beginnings of an implementation for the b_and operator (by oli);
-           never mind, the entire <eval.c> code will have to be rewritten at some point
-           TODO */
-#ifdef INITIAL_MATCH_BY_MU
+        /* evaluate the cheapest operand first (as planned by calculate_initial_matchlist()) */
+        if (ctptr->node.plan_order == PlanIntersect) {
+          if (calculate_initial_matchlist_1(ctptr->node.left, &left, corpus) && calculate_initial_matchlist_1(ctptr->node.right, &right, corpus)) {
+            if (left.is_inverted)
+              if (!apply_setop_to_matchlist(&left, Complement, NULL))
+                return False;
+            if (right.is_inverted)
+              if (!apply_setop_to_matchlist(&right, Complement, NULL))
+                return False;
 
-        if (calculate_initial_matchlist_1(ctptr->node.left, &left, corpus) && calculate_initial_matchlist_1(ctptr->node.right, &right, corpus)) {
-          apply_setop_to_matchlist(&left, Intersection, &right);
-          free_matchlist(&right);
+            if (!apply_setop_to_matchlist(&left, Intersection, &right))
+              return False;
+            free_matchlist(&right);
 
-          matchlist->start = left.start;
-          matchlist->end   = left.end;
-          matchlist->tabsize = left.tabsize;
-          matchlist->matches_whole_corpus = 0;
-          matchlist->is_inverted = 0;
+            matchlist->start = left.start;
+            matchlist->end   = left.end;
+            matchlist->tabsize = left.tabsize;
+            matchlist->matches_whole_corpus = 0;
+            matchlist->is_inverted = 0;
 
-          return True;
+            return True;
+          }
+          else {
+            free_matchlist(matchlist);
+            free_matchlist(&left);
+            free_matchlist(&right);
+            return False;
+          }
+        }
+
+        if (ctptr->node.plan_order == PlanRight) {
+          first = ctptr->node.right;
+          second = ctptr->node.left;
         }
         else {
-          free_matchlist(matchlist)
-          free_matchlist(&left);
-          free_matchlist(&right);
-          return False;
+          first = ctptr->node.left;
+          second = ctptr->node.right;
         }
-#else
-        /* this is the old code. */
-        if (calculate_initial_matchlist_1(ctptr->node.left, &left, corpus)) {
-          /* We have b_and. So try to eval the right tree for each
-           * position yielded by the left tree. */
+
+        if (calculate_initial_matchlist_1(first, &left, corpus)) {
+          /* We have b_and. So try to eval the other tree for each
+           * position yielded by the first one. */
 
           for (i = 0; i < left.tabsize; i++) {
             if (!EvaluationIsRunning)
               break;
             if (left.start[i] >= 0 &&
-                !eval_bool(ctptr->node.right, NULL, left.start[i]))
+                !eval_bool(second, NULL, left.start[i]))
               /* we're ignoring labels at the moment, so we pass NULL as reftab */
               left.start[i] = -1;
           }
@@ -1476,7 +1916,6 @@ calculate_initial_matchlist_1(Constrainttree ctptr, Matchlist *matchlist, Corpus
           free_matchlist(&right);
           return False;
         }
-#endif
         break;
 
       case b_or:                /* logical or */
@@ -1836,7 +2275,18 @@ calculate_initial_matchlist_1(Constrainttree ctptr, Matchlist *matchlist, Corpus
 static Boolean
 calculate_initial_matchlist(Constrainttree ctptr, Matchlist *matchlist, CorpusList *corpus)
 {
-  Boolean res = calculate_initial_matchlist_1(ctptr, matchlist, corpus);
+  Boolean res;
+  PlanCost plan;
+
+  /* plan the whole tree once: the evaluation order of each conjunction is stored in its node */
+  plan_initial_matchlist(ctptr, corpus, &plan);
+
+  if (explain_query) {
+    Rprintf("Query plan for initial matchlist (%d tokens):\n", corpus->mother_size);
+    explain_initial_matchlist(ctptr, corpus, 1);
+  }
+
+  res = calculate_initial_matchlist_1(ctptr, matchlist, corpus);
 
   /* i.e. if calling the main function worked, and a matchlist was created */
   if (res && matchlist) {
@@ -1851,6 +2301,67 @@ calculate_initial_matchlist(Constrainttree ctptr, Matchlist *matchlist, CorpusLi
   return res;
 }
 
+/**
+ * Looks up all corpus positions that satisfy a constraint in the index, using the initial matchlist
+ * machinery of queries, so that the constraint need not be evaluated at every position of a search
+ * space (as in the 'set target' command, see evaluate_target()).
+ *
+ * The positions are only looked up if this is estimated to be cheaper (see plan_initial_matchlist())
+ * than evaluating the constraint for a number of search spaces of the given size.
+ *
+ * @param constr     The constraint tree.
+ * @param corpus     The corpus (normally a system corpus); positions are restricted to its ranges.
+ * @param lines      Number of search spaces.
+ * @param window     Average number of corpus positions in a search space.
+ * @param n_found    The number of positions is stored here.
+ * @return           Sorted array of corpus positions (to be freed by the caller), or NULL if the
+ *                   constraint should rather be evaluated position by position.
+ */
+int *
+get_constraint_positions(Constrainttree constr, CorpusList *corpus, int lines, double window, int *n_found)
+{
+  EEP saved_evalenv = evalenv;
+  EvalEnvironment env;
+  Matchlist matchlist;
+  PlanCost pc;
+  double n, scan, lookup;
+  int *positions = NULL;
+
+  *n_found = 0;
+  if (!constr || !corpus || corpus->mother_size <= 0 || corpus->size <= 0)
+    return NULL;
+
+  plan_initial_matchlist(constr, corpus, &pc);
+  if (pc.fixed)
+    return NULL;
+
+  /* evaluation stops at the first hit, which is expected after n / pc.size positions;
+   * search spaces are mostly visited in corpus order, so a galloping search skips pc.size / lines positions */
+  n = (double) corpus->mother_size;
+  scan = lines * MIN(window, n / MAX(pc.size, 1.0)) * pc.filter;
+  lookup = pc.cost + lines * log2(pc.size / MAX(lines, 1) + 2.0);
+  if (lookup >= scan)
+    return NULL;
+
+  /* the complement of a matchlist is computed relative to the query corpus of the current environment */
+  memset(&env, 0, sizeof(EvalEnvironment));
+  env.query_corpus = corpus;
+  evalenv = &env;
+
+  init_matchlist(&matchlist);
+  if (calculate_initial_matchlist(constr, &matchlist, corpus)) {
+    positions = matchlist.start;
+    *n_found = matchlist.tabsize;
+    matchlist.start = NULL;
+    if (!positions)
+      positions = (int *)cl_malloc(sizeof(int));
+  }
+  free_matchlist(&matchlist);
+
+  evalenv = saved_evalenv;
+  return positions;
+}
+
 
 
 
@@ -1925,16 +2436,14 @@ match_first_pattern(AVS pattern, Matchlist *matchlist, CorpusList *corpus)
       matchlist->matches_whole_corpus = 0;
 
       k = 0;
-      for (i = 0; i < nr_strucs; i++) {
-        if (get_bit(bf, i)) {
-          if (!cl_struc2cpos(pattern->tag.attr, i, &start, &end)) {
-            destroy_bitfield(&bf);
-            cl_free(matchlist->start);
-            return False;
-          }
-          matchlist->start[k++] = (pattern->tag.is_closing) ? (end + 1) : start;
-          /* NB: it's (end+1) for a closing tag, since the tag refers to the token at cpos-1 */
+      for (i = bf_next_set_bit(bf, 0); i >= 0; i = bf_next_set_bit(bf, i + 1)) {
+        if (!cl_struc2cpos(pattern->tag.attr, i, &start, &end)) {
+          destroy_bitfield(&bf);
+          cl_free(matchlist->start);
+          return False;
         }
+        matchlist->start[k++] = (pattern->tag.is_closing) ? (end + 1) : start;
+        /* NB: it's (end+1) for a closing tag, since the tag refers to the token at cpos-1 */
       }
     }
     destroy_bitfield(&bf);
@@ -2046,7 +2555,20 @@ match_first_pattern(AVS pattern, Matchlist *matchlist, CorpusList *corpus)
     /* endcase Pattern */
 
   case MatchAll:
-    get_matched_corpus_positions(NULL, ".*", 0, matchlist, (int *)corpus->range, corpus->size);
+    if (query_start_max >= 0) {
+      /* only positions in the range of start positions (rather than a copy of the whole corpus) */
+      start = MAX(query_start_min, 0);
+      end = MIN(query_start_max, corpus->mother_size - 1);
+      matchlist->tabsize = MAX(end - start + 1, 0);
+      matchlist->start = (matchlist->tabsize > 0) ? (int *)cl_malloc(sizeof(int) * matchlist->tabsize) : NULL;
+      matchlist->end = NULL;
+      matchlist->matches_whole_corpus = 0;
+      matchlist->is_inverted = 0;
+      for (i = 0; i < matchlist->tabsize; i++)
+        matchlist->start[i] = start + i;
+    }
+    else
+      get_matched_corpus_positions(NULL, ".*", 0, matchlist, (int *)corpus->range, corpus->size);
     return True;
 
   case Region:
@@ -2104,21 +2626,27 @@ match_first_pattern(AVS pattern, Matchlist *matchlist, CorpusList *corpus)
 
 
 /**
- * Simulate the DFA in the global evalenv.
+ * Simulate the DFA in the global evalenv for the start positions from .. to-1 of the matchlist.
  *
  * ("Simulate", in technical Comp Sci terminology on finite state machines, basically means "run" -
  * since CQP is, technically, only *simulating* the abstract machine described by the DFA!)
  *
+ * If worker is true, the function runs in a thread started by simulate(): it neither updates
+ * the progress bar nor checks for interrupts, and does not set evalenv->rp.
+ *
  * Returns True if the matching ranges may be out-of-order and need to be sorted.
  */
 static int
-simulate(Matchlist *matchlist,
-         int *cut,
-         int *state_vector,
-         int *target_vector,
-         RefTab *reftab_vector,
-         RefTab *reftab_target_vector,
-         int start_transition)
+simulate_chunk(Matchlist *matchlist,
+               int from,
+               int to,
+               int *cut,
+               int *state_vector,
+               int *target_vector,
+               RefTab *reftab_vector,
+               RefTab *reftab_target_vector,
+               int start_transition,
+               int worker)
 {
   int p, cpos, effective_cpos;
   int strict_regions_ok, lookahead_constraint, zero_width_pattern;
@@ -2160,7 +2688,7 @@ simulate(Matchlist *matchlist,
     /* whole of rest of function */
 
     int r_ix = 0; /* index into the range array; indicates our current range */
-    int i = 0;  /* index into  array of match start cpos */
+    int i = from;  /* index into  array of match start cpos */
 
     assert(state_vector);
     assert(target_vector);
@@ -2169,8 +2697,8 @@ simulate(Matchlist *matchlist,
 
     percentage = -1;
 
-    while ((i < matchlist->tabsize) && ((*cut) != 0) && EvaluationIsRunning) {
-      if (progress_bar && !evalenv->aligned) {
+    while ((i < to) && ((*cut) != 0) && EvaluationIsRunning) {
+      if (progress_bar && !evalenv->aligned && !worker) {
         new_percentage = floor(0.5 + (100.0 * i) / matchlist->tabsize);
         if (new_percentage > percentage) {
           percentage = new_percentage;
@@ -2243,7 +2771,8 @@ simulate(Matchlist *matchlist,
           /*
            * set up some 'global' variables in evalenv (which subroutines may need to use)
            */
-          evalenv->rp = r_ix;        /* current range (in subquery); used to evaluate Anchor constraints */
+          if (!worker)
+            evalenv->rp = r_ix;      /* current range (in subquery); used to evaluate Anchor constraints */
 
           /*
            * all states are inactive / reset label references
@@ -2458,7 +2987,8 @@ simulate(Matchlist *matchlist,
                       if (transition_valid) {
                         nr_transitions++;
                         if (nr_transitions >= 20000) {
-                          CheckForInterrupts();
+                          if (!worker)
+                            CheckForInterrupts();
                           nr_transitions = 0;
                         }
 
@@ -2644,7 +3174,7 @@ simulate(Matchlist *matchlist,
     }   /* while ((i < matchlist->tabsize) && ... ) ...  [simulate automaton for current matchlist] */
 
     /* if we left the execution prematurely, i.e. because !EvaluationIsRunning (due to interrupt or eval error) */
-    while (i < matchlist->tabsize)
+    while (i < to)
       matchlist->start[i++] = -1;
 
   }     /* end of the big "else" (unless evalenv->query_corpus->size == 0) */
@@ -2653,6 +3183,243 @@ simulate(Matchlist *matchlist,
 }
 
 
+/** Minimum number of start positions for simulating the DFA in parallel threads */
+#define SIMULATE_PARALLEL_MIN 10000
+
+/** Shared data of the threads of simulate(). */
+typedef struct {
+  Matchlist *matchlist;
+  int cut;                      /**< maximal number of matches (-1 = no limit) */
+  int start_transition;
+  int *held;                    /**< number of messages held back by each thread */
+} SimulateChunks;
+
+/**
+ * Makes sure that the data of an attribute are loaded (so that threads can access it).
+ */
+static void
+load_attribute_data(Attribute *attr, int is_struc)
+{
+  if (!attr)
+    return;
+  if (is_struc) {
+    cl_cpos2struc(attr, 0);
+    if (cl_struc_values(attr))
+      cl_struc2str(attr, 0);
+  }
+  else {
+    cl_cpos2id(attr, 0);
+    cl_id2str(attr, 0);
+  }
+}
+
+/**
+ * Checks whether a constraint tree can be evaluated in parallel threads and
+ * loads the data of the attributes it refers to.
+ *
+ * Function calls are evaluated in the main thread only (builtin functions may
+ * abort the query, dynamic attributes may call back into R).
+ */
+static int
+constraint_is_parallel(Constrainttree ctptr)
+{
+  if (!ctptr)
+    return 1;
+
+  switch (ctptr->type) {
+  case bnode:
+    return constraint_is_parallel(ctptr->node.left) && constraint_is_parallel(ctptr->node.right);
+  case cnode:
+  case string_leaf:
+  case int_leaf:
+  case float_leaf:
+    return 1;
+  case id_list:
+    load_attribute_data(ctptr->idlist.attr, 0);
+    return 1;
+  case pa_ref:
+    load_attribute_data(ctptr->pa_ref.attr, 0);
+    return 1;
+  case sa_ref:
+    load_attribute_data(ctptr->sa_ref.attr, 1);
+    return 1;
+  case sbound:
+    load_attribute_data(ctptr->sbound.strucattr, 1);
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * Checks whether the DFA in the global evalenv can be simulated in parallel threads.
+ *
+ * Anchor points depend on evalenv->rp and Region elements on their (shared) wait queues,
+ * so queries containing them are simulated in a single thread.
+ */
+static int
+simulate_is_parallel(void)
+{
+  int i;
+
+  if (simulate_debug || eval_debug || symtab_debug || evalenv->aligned)
+    return 0;
+
+  for (i = 0; i <= evalenv->MaxPatIndex; i++) {
+    switch (evalenv->patternlist[i].type) {
+    case MatchAll:
+      break;
+    case Pattern:
+      if (!constraint_is_parallel(evalenv->patternlist[i].con.constraint))
+        return 0;
+      break;
+    case Tag:
+      load_attribute_data(evalenv->patternlist[i].tag.attr, 1);
+      break;
+    default:
+      return 0;
+    }
+  }
+  if (!constraint_is_parallel(evalenv->gconstraint))
+    return 0;
+  if (evalenv->search_context.space_type == structure)
+    load_attribute_data(evalenv->search_context.attrib, 1);
+
+  return 1;
+}
+
+/**
+ * Worker of simulate(): simulates the DFA for a contiguous chunk of the matchlist,
+ * with state vectors and reference tables of its own.
+ */
+static void
+simulate_worker(int thread, int n_threads, void *data)
+{
+  SimulateChunks *sc = (SimulateChunks *)data;
+  int from = (int)(((long long)sc->matchlist->tabsize * thread) / n_threads);
+  int to = (int)(((long long)sc->matchlist->tabsize * (thread + 1)) / n_threads);
+  int i, cut = sc->cut;
+  int *state_vector, *target_vector;
+  RefTab *reftab_vector, *reftab_target_vector;
+
+  state_vector = (int *)cl_malloc(sizeof(int) * evalenv->dfa.Max_States);
+  target_vector = (int *)cl_malloc(sizeof(int) * evalenv->dfa.Max_States);
+  reftab_vector = (RefTab *)cl_malloc(sizeof(RefTab) * evalenv->dfa.Max_States);
+  reftab_target_vector = (RefTab *)cl_malloc(sizeof(RefTab) * evalenv->dfa.Max_States);
+  for (i = 0; i < evalenv->dfa.Max_States; i++) {
+    reftab_vector[i] = new_reftab(evalenv->labels);
+    reftab_target_vector[i] = new_reftab(evalenv->labels);
+    reset_reftab(reftab_vector[i]);
+    reset_reftab(reftab_target_vector[i]);
+  }
+
+  /* error messages cannot be printed here; simulate() repeats the simulation if there were any */
+  cqpmessage_hold = 1;
+  cqpmessage_held = 0;
+  simulate_chunk(sc->matchlist, from, to, &cut,
+                 state_vector, target_vector, reftab_vector, reftab_target_vector,
+                 sc->start_transition, 1);
+  sc->held[thread] = cqpmessage_held;
+  cqpmessage_hold = 0;
+
+  cl_free(state_vector);
+  cl_free(target_vector);
+  for (i = 0; i < evalenv->dfa.Max_States; i++) {
+    delete_reftab(reftab_vector[i]);
+    delete_reftab(reftab_target_vector[i]);
+  }
+  cl_free(reftab_vector);
+  cl_free(reftab_target_vector);
+}
+
+/**
+ * Simulate the DFA in the global evalenv (see simulate_chunk()).
+ *
+ * Large matchlists are split into contiguous chunks, which are simulated in parallel
+ * threads if the query allows it (see simulate_is_parallel()). The matches of the
+ * chunks are then cut in order, so the result is identical to a single simulation run.
+ * If any thread came across an error, the simulation is repeated in the main thread,
+ * which prints the error messages and aborts the query as usual.
+ *
+ * Returns True if the matching ranges may be out-of-order and need to be sorted.
+ */
+static int
+simulate(Matchlist *matchlist,
+         int *cut,
+         int *state_vector,
+         int *target_vector,
+         RefTab *reftab_vector,
+         RefTab *reftab_target_vector,
+         int start_transition)
+{
+  SimulateChunks sc;
+  int *saved_start, *saved_end;
+  int i, t, n, n_threads, held, need_sort;
+  size_t size = matchlist->tabsize * sizeof(int);
+
+  n_threads = MIN(cl_get_threads(), matchlist->tabsize / SIMULATE_PARALLEL_MIN);
+  if (n_threads < 2 || !evalenv->query_corpus || evalenv->query_corpus->size <= 0 || !simulate_is_parallel())
+    return simulate_chunk(matchlist, 0, matchlist->tabsize, cut,
+                          state_vector, target_vector, reftab_vector, reftab_target_vector,
+                          start_transition, 0);
+
+  saved_start = (int *)cl_malloc(size);
+  saved_end = (int *)cl_malloc(size);
+  memcpy(saved_start, matchlist->start, size);
+  memcpy(saved_end, matchlist->end, size);
+
+  sc.matchlist = matchlist;
+  sc.cut = *cut;
+  sc.start_transition = start_transition;
+  sc.held = (int *)cl_calloc(n_threads, sizeof(int));
+  cl_parallel(simulate_worker, n_threads, &sc);
+
+  for (held = 0, t = 0; t < n_threads; t++)
+    held += sc.held[t];
+  cl_free(sc.held);
+
+  if (held > 0) {
+    /* start again in the main thread, so that the messages are printed */
+    memcpy(matchlist->start, saved_start, size);
+    memcpy(matchlist->end, saved_end, size);
+    for (i = 0; i < matchlist->tabsize; i++) {
+      if (matchlist->target_positions)
+        matchlist->target_positions[i] = -1;
+      if (matchlist->keyword_positions)
+        matchlist->keyword_positions[i] = -1;
+    }
+    EvaluationIsRunning = 1;
+    need_sort = simulate_chunk(matchlist, 0, matchlist->tabsize, cut,
+                               state_vector, target_vector, reftab_vector, reftab_target_vector,
+                               start_transition, 0);
+  }
+  else {
+    /* each chunk may have found up to <cut> matches: keep the first <cut> matches of the whole matchlist */
+    if (*cut > 0) {
+      for (n = 0, i = 0; i < matchlist->tabsize; i++) {
+        if (matchlist->start[i] < 0)
+          continue;
+        if (n < *cut)
+          n++;
+        else {
+          matchlist->start[i] = -1;
+          if (matchlist->target_positions)
+            matchlist->target_positions[i] = -1;
+          if (matchlist->keyword_positions)
+            matchlist->keyword_positions[i] = -1;
+        }
+      }
+      *cut -= n;
+    }
+    need_sort = evalenv->match_selector.begin || evalenv->match_selector.begin_offset ||
+      evalenv->match_selector.end || evalenv->match_selector.end_offset;
+  }
+
+  cl_free(saved_start);
+  cl_free(saved_end);
+  return need_sort;
+}
+
 static int
 check_alignment_constraints(Matchlist *ml)
 {
@@ -2757,6 +3524,479 @@ check_alignment_constraints(Matchlist *ml)
   return 0;
 }
 
+/** Minimal factor by which an anchor pattern must reduce the number of start positions of the FSA simulation */
+#define ANCHOR_MIN_GAIN 4.0
+
+/**
+ * A pattern that occurs at a bounded distance from the start of every match of a query
+ * (see find_query_anchor()). Start positions of the FSA simulation are restricted to
+ * the corpus positions at which the anchor pattern can occur.
+ */
+typedef struct _QueryAnchor {
+  int pattern;                  /**< index of the anchor in the pattern list (-1 = no anchor) */
+  int min_offset;               /**< minimal distance (in tokens) of the anchor from the start of a match */
+  int max_offset;               /**< maximal distance (in tokens) of the anchor from the start of a match */
+  double size;                  /**< estimated number of corpus positions matching the anchor */
+  Matchlist positions;          /**< corpus positions matching the anchor (computed when needed) */
+  int computed;                 /**< whether positions have been computed */
+} QueryAnchor;
+
+/**
+ * Looks for the most selective pattern that every match of the query in the global evalenv
+ * must contain at a bounded distance from its start (e.g. "serendipity" at distance 2 in
+ * [] [] "serendipity" or [pos="DT"] []{0,2} "serendipity").
+ *
+ * The analysis follows all paths through the DFA from the start state to a final state:
+ * a pattern is a candidate if no final state can be reached without it, and if the minimal
+ * and maximal number of tokens consumed before it are bounded (i.e. not preceded by a loop).
+ * Only patterns whose constraint can be computed as an initial matchlist are considered;
+ * queries containing Region elements (which skip over a variable number of tokens) have no anchor.
+ *
+ * @param anchor  The anchor pattern is stored here (anchor->pattern is -1 if there is none).
+ */
+static void
+find_query_anchor(QueryAnchor *anchor)
+{
+  DFA *dfa = &evalenv->dfa;
+  int n_states = dfa->Max_States;
+  int s, p, q, t, round, changed, final_reached, min_offset, max_offset, ok;
+  int *width, *live, *seen, *mindist, *maxdist;
+  AVS pattern;
+  PlanCost pc;
+
+  anchor->pattern = -1;
+  anchor->computed = 0;
+  init_matchlist(&anchor->positions);
+
+  if (n_states <= 0 || dfa->Max_Input > evalenv->MaxPatIndex + 1 || !evalenv->query_corpus)
+    return;
+
+  /* number of tokens consumed by each pattern */
+  width = (int *)cl_malloc(sizeof(int) * dfa->Max_Input);
+  for (p = 0; p < dfa->Max_Input; p++) {
+    pattern = &(evalenv->patternlist[p]);
+    switch (pattern->type) {
+    case MatchAll:
+      width[p] = pattern->matchall.lookahead ? 0 : 1;
+      break;
+    case Pattern:
+      width[p] = pattern->con.lookahead ? 0 : 1;
+      break;
+    case Tag:
+    case Anchor:
+      width[p] = 0;
+      break;
+    default:
+      cl_free(width);
+      return;
+    }
+  }
+
+  live = (int *)cl_calloc(n_states, sizeof(int));
+  seen = (int *)cl_calloc(n_states, sizeof(int));
+  mindist = (int *)cl_malloc(sizeof(int) * n_states);
+  maxdist = (int *)cl_malloc(sizeof(int) * n_states);
+
+  /* live states are reachable from the start state and lead to a final state */
+  seen[0] = 1;
+  do {
+    changed = 0;
+    for (s = 0; s < n_states; s++)
+      if (seen[s])
+        for (p = 0; p < dfa->Max_Input; p++)
+          if ((t = dfa->TransTable[s][p]) != dfa->E_State && !seen[t])
+            seen[t] = changed = 1;
+  } while (changed);
+  for (s = 0; s < n_states; s++)
+    live[s] = seen[s] && dfa->Final[s];
+  do {
+    changed = 0;
+    for (s = 0; s < n_states; s++)
+      if (seen[s] && !live[s])
+        for (p = 0; p < dfa->Max_Input; p++)
+          if ((t = dfa->TransTable[s][p]) != dfa->E_State && live[t]) {
+            live[s] = changed = 1;
+            break;
+          }
+  } while (changed);
+
+  /* minimal and maximal number of tokens consumed before reaching each live state (INT_MAX = unbounded) */
+  for (s = 0; s < n_states; s++) {
+    mindist[s] = INT_MAX;
+    maxdist[s] = -1;
+  }
+  mindist[0] = maxdist[0] = 0;
+  for (round = 0; round <= n_states; round++) {
+    changed = 0;
+    for (s = 0; s < n_states; s++)
+      if (live[s] && maxdist[s] >= 0)
+        for (p = 0; p < dfa->Max_Input; p++)
+          if ((t = dfa->TransTable[s][p]) != dfa->E_State && live[t]) {
+            if (mindist[s] + width[p] < mindist[t]) {
+              mindist[t] = mindist[s] + width[p];
+              changed = 1;
+            }
+            if (maxdist[t] != INT_MAX && (maxdist[s] == INT_MAX || maxdist[s] + width[p] > maxdist[t])) {
+              /* after n_states rounds, maximal distances only grow on loops */
+              maxdist[t] = (round == n_states || maxdist[s] == INT_MAX) ? INT_MAX : maxdist[s] + width[p];
+              changed = 1;
+            }
+          }
+    if (!changed)
+      break;
+  }
+  if (changed) {
+    /* states reached from a loop have unbounded maximal distance */
+    do {
+      changed = 0;
+      for (s = 0; s < n_states; s++)
+        if (live[s] && maxdist[s] == INT_MAX)
+          for (p = 0; p < dfa->Max_Input; p++)
+            if ((t = dfa->TransTable[s][p]) != dfa->E_State && live[t] && maxdist[t] != INT_MAX) {
+              maxdist[t] = INT_MAX;
+              changed = 1;
+            }
+    } while (changed);
+  }
+
+  for (q = 0; q < dfa->Max_Input; q++) {
+    pattern = &(evalenv->patternlist[q]);
+    if (pattern->type != Pattern || pattern->con.lookahead)
+      continue;
+
+    /* can a final state be reached without this pattern? */
+    for (s = 0; s < n_states; s++)
+      seen[s] = 0;
+    seen[0] = 1;
+    final_reached = dfa->Final[0];
+    do {
+      changed = 0;
+      for (s = 0; s < n_states && !final_reached; s++)
+        if (seen[s])
+          for (p = 0; p < dfa->Max_Input; p++)
+            if (p != q && (t = dfa->TransTable[s][p]) != dfa->E_State && live[t] && !seen[t]) {
+              seen[t] = changed = 1;
+              if (dfa->Final[t])
+                final_reached = 1;
+            }
+    } while (changed && !final_reached);
+    if (final_reached)
+      continue;
+
+    /* distance of the pattern from the start of the match */
+    min_offset = INT_MAX;
+    max_offset = -1;
+    ok = 1;
+    for (s = 0; s < n_states; s++)
+      if (live[s] && (t = dfa->TransTable[s][q]) != dfa->E_State && live[t]) {
+        if (maxdist[s] == INT_MAX)
+          ok = 0;
+        min_offset = MIN(min_offset, mindist[s]);
+        max_offset = MAX(max_offset, maxdist[s]);
+      }
+    if (!ok || max_offset < 0)
+      continue;
+
+    plan_initial_matchlist(pattern->con.constraint, evalenv->query_corpus, &pc);
+    if (pc.fixed)
+      continue;
+    pc.size *= (max_offset - min_offset + 1);
+    if (anchor->pattern < 0 || pc.size < anchor->size) {
+      anchor->pattern = q;
+      anchor->min_offset = min_offset;
+      anchor->max_offset = max_offset;
+      anchor->size = pc.size;
+    }
+  }
+
+  if (explain_query) {
+    if (anchor->pattern >= 0)
+      Rprintf("Anchor pattern: #%d at distance %d..%d from start of match (est. %.0f start positions)\n",
+              anchor->pattern, anchor->min_offset, anchor->max_offset, anchor->size);
+    else
+      Rprintf("Anchor pattern: none\n");
+  }
+
+  cl_free(width);
+  cl_free(live);
+  cl_free(seen);
+  cl_free(mindist);
+  cl_free(maxdist);
+}
+
+/**
+ * Computes the corpus positions matching the anchor pattern (once per query).
+ *
+ * @return  False iff something has gone wrong.
+ */
+static Boolean
+compute_anchor_positions(QueryAnchor *anchor, CorpusList *corpus)
+{
+  if (!anchor->computed) {
+    anchor->computed = 1;
+    if (!calculate_initial_matchlist(evalenv->patternlist[anchor->pattern].con.constraint, &anchor->positions, corpus))
+      return False;
+  }
+  return True;
+}
+
+/**
+ * Computes the start positions of the FSA simulation for an initial transition from the
+ * positions of the anchor pattern, if the anchor is much more selective than the initial pattern.
+ *
+ * Start positions are those at the possible distances before an occurrence of the anchor;
+ * an initial Pattern is then checked at each of them (MatchAll is true anyway).
+ *
+ * @param anchor     The query anchor (see find_query_anchor()).
+ * @param pattern    The pattern of the initial transition.
+ * @param matchlist  The initial matchlist is stored here.
+ * @param corpus     The query corpus.
+ * @return           False if the anchor isn't used for this pattern (matchlist is unchanged)
+ *                   or if something has gone wrong (EvaluationIsRunning is cleared).
+ */
+static Boolean
+match_first_pattern_by_anchor(QueryAnchor *anchor, AVS pattern, Matchlist *matchlist, CorpusList *corpus)
+{
+  PlanCost pc;
+  int i, k, d, cpos, size;
+
+  if (anchor->pattern < 0)
+    return False;
+
+  if (pattern->type == MatchAll)
+    pc.size = corpus->mother_size;
+  else if (pattern->type == Pattern) {
+    plan_initial_matchlist(pattern->con.constraint, corpus, &pc);
+    if (pc.fixed)
+      return False;
+  }
+  else
+    return False;
+  if (anchor->size * ANCHOR_MIN_GAIN >= pc.size)
+    return False;
+
+  if (!compute_anchor_positions(anchor, corpus)) {
+    EvaluationIsRunning = 0;
+    return False;
+  }
+
+  size = anchor->positions.tabsize * (anchor->max_offset - anchor->min_offset + 1);
+  matchlist->start = (size > 0) ? (int *)cl_malloc(sizeof(int) * size) : NULL;
+  matchlist->end = NULL;
+  matchlist->matches_whole_corpus = 0;
+  matchlist->is_inverted = 0;
+
+  for (k = 0, i = 0; i < anchor->positions.tabsize; i++)
+    for (d = anchor->min_offset; d <= anchor->max_offset; d++)
+      if ((cpos = anchor->positions.start[i] - d) >= 0
+          && (query_start_max < 0 || (cpos >= query_start_min && cpos <= query_start_max)))
+        matchlist->start[k++] = cpos;
+  if (anchor->max_offset > anchor->min_offset && k > 0) {
+    qsort(matchlist->start, k, sizeof(int), intcompare);
+    for (size = 1, i = 1; i < k; i++)
+      if (matchlist->start[i] != matchlist->start[size - 1])
+        matchlist->start[size++] = matchlist->start[i];
+    k = size;
+  }
+  matchlist->tabsize = k;
+
+  if (pattern->type == Pattern)
+    for (i = 0; i < matchlist->tabsize && EvaluationIsRunning; i++)
+      if (!eval_bool(pattern->con.constraint, NULL, matchlist->start[i]))
+        matchlist->start[i] = -1;
+
+  mark_offrange_cells(matchlist, corpus);
+  apply_setop_to_matchlist(matchlist, Reduce, NULL);
+
+  if (initial_matchlist_debug)
+    Rprintf("initial matchlist computed from anchor pattern #%d: %d start positions\n", anchor->pattern, matchlist->tabsize);
+
+  return True;
+}
+
+/**
+ * Removes start positions of the FSA simulation that are not at a possible distance before
+ * an occurrence of the anchor pattern (if the initial matchlist is much larger than the set
+ * of anchor positions).
+ *
+ * @return  False iff something has gone wrong.
+ */
+static Boolean
+filter_by_anchor(QueryAnchor *anchor, Matchlist *matchlist, CorpusList *corpus)
+{
+  int i, j, n;
+
+  if (anchor->pattern < 0 || matchlist->tabsize <= anchor->size * ANCHOR_MIN_GAIN)
+    return True;
+
+  /* start positions from a target or keyword anchor need not be sorted */
+  for (i = 1; i < matchlist->tabsize; i++)
+    if (matchlist->start[i] < matchlist->start[i - 1])
+      return True;
+
+  if (!compute_anchor_positions(anchor, corpus))
+    return False;
+
+  n = anchor->positions.tabsize;
+  for (i = 0, j = 0; i < matchlist->tabsize; i++) {
+    if (matchlist->start[i] < 0)
+      continue;
+    while (j < n && anchor->positions.start[j] < matchlist->start[i] + anchor->min_offset)
+      j++;
+    if (j >= n || anchor->positions.start[j] > matchlist->start[i] + anchor->max_offset)
+      matchlist->start[i] = -1;
+  }
+
+  return apply_setop_to_matchlist(matchlist, Reduce, NULL);
+}
+
+
+/*
+ * SAMPLING OF START POSITIONS
+ *
+ * For very frequent queries, the number of matches can be estimated (and a random sample of matches
+ * can be drawn) by simulating the DFA for a uniform random sample of the candidate start positions
+ * in the initial matchlist only. Since every start position yields at most one match, the proportion
+ * of matching start positions in the sample is an unbiased estimate of the proportion in the full
+ * matchlist. Matches that would be removed by the matching strategy because they overlap with a match
+ * from a start position that was not sampled are kept, though.
+ */
+
+/**
+ * Checks whether all matches of the DFA in the global evalenv have the same length, so that no two
+ * matches can be nested or share an end point (and the matching strategy doesn't remove any of them).
+ *
+ * The DFA is traversed breadth-first from the start state: the length is fixed if every state is
+ * reached with the same number of tokens, no transition leaves a final state, and all transitions
+ * consume exactly one token.
+ */
+static int
+dfa_has_fixed_length(void)
+{
+  DFA *dfa = &(evalenv->dfa);
+  int *depth, *queue;
+  int head = 0, tail = 0, fixed = 1, state, target, p;
+
+  depth = (int *)cl_malloc(sizeof(int) * dfa->Max_States);
+  queue = (int *)cl_malloc(sizeof(int) * dfa->Max_States);
+  for (state = 0; state < dfa->Max_States; state++)
+    depth[state] = -1;
+
+  depth[0] = 0;
+  queue[tail++] = 0;
+  while (fixed && head < tail) {
+    state = queue[head++];
+    for (p = 0; p < dfa->Max_Input && fixed; p++) {
+      if ((target = dfa->TransTable[state][p]) == dfa->E_State)
+        continue;
+      if (dfa->Final[state] || (evalenv->patternlist[p].type != Pattern && evalenv->patternlist[p].type != MatchAll))
+        fixed = 0;
+      else if (depth[target] < 0) {
+        depth[target] = depth[state] + 1;
+        queue[tail++] = target;
+      }
+      else if (depth[target] != depth[state] + 1)
+        fixed = 0;
+    }
+  }
+
+  cl_free(depth);
+  cl_free(queue);
+  return fixed;
+}
+
+/**
+ * Simulates the DFA for a uniform random sample of the start positions in a matchlist.
+ *
+ * If query_sample_matches is false, query_sample_size start positions are drawn; otherwise,
+ * start positions are drawn in batches until at least query_sample_size matches have been found
+ * (the size of each further batch is extrapolated from the proportion of matches found so far).
+ * The numbers of candidate and simulated start positions are stored in query_sample_candidates
+ * and query_sample_evaluated.
+ *
+ * @param matchlist  The initial matchlist (start positions only); replaced by the sorted
+ *                   matches of the sampled start positions.
+ */
+static void
+simulate_sample(Matchlist *matchlist,
+                int *state_vector,
+                int *target_vector,
+                RefTab *reftab_vector,
+                RefTab *reftab_target_vector,
+                int start_transition)
+{
+  Matchlist batch, sample;
+  int n_candidates = matchlist->tabsize, n_evaluated = 0, n_matches = 0;
+  int batch_size, maxresult, i, j, tmp;
+  double extrapolated;
+
+  init_matchlist(&sample);
+  batch_size = MIN(query_sample_size, n_candidates);
+
+  while (batch_size > 0 && EvaluationIsRunning) {
+    /* draw the next batch by a partial Fisher-Yates shuffle of the remaining candidates */
+    for (i = n_evaluated; i < n_evaluated + batch_size; i++) {
+      j = i + (int)(cl_random_fraction() * (n_candidates - i));
+      if (j >= n_candidates)
+        j = n_candidates - 1;
+      tmp = matchlist->start[i];
+      matchlist->start[i] = matchlist->start[j];
+      matchlist->start[j] = tmp;
+    }
+
+    init_matchlist(&batch);
+    batch.tabsize = batch_size;
+    batch.start = (int *)cl_malloc(sizeof(int) * batch_size);
+    memcpy(batch.start, matchlist->start + n_evaluated, sizeof(int) * batch_size);
+    qsort(batch.start, batch_size, sizeof(int), intcompare);
+    batch.end = (int *)cl_malloc(sizeof(int) * batch_size);
+    memcpy(batch.end, batch.start, sizeof(int) * batch_size);
+    if (evalenv->has_target_indicator) {
+      batch.target_positions = (int *)cl_malloc(sizeof(int) * batch_size);
+      for (i = 0; i < batch_size; i++)
+        batch.target_positions[i] = -1;
+    }
+    if (evalenv->has_keyword_indicator) {
+      batch.keyword_positions = (int *)cl_malloc(sizeof(int) * batch_size);
+      for (i = 0; i < batch_size; i++)
+        batch.keyword_positions[i] = -1;
+    }
+
+    maxresult = -1;
+    if (simulate(&batch, &maxresult, state_vector, target_vector, reftab_vector, reftab_target_vector, start_transition)) {
+      apply_setop_to_matchlist(&batch, Reduce, NULL);
+      if (!sort_matchlist(&batch))
+        EvaluationIsRunning = 0;
+    }
+    else
+      apply_setop_to_matchlist(&batch, Reduce, NULL);
+
+    n_evaluated += batch_size;
+    n_matches += batch.tabsize;
+    apply_setop_to_matchlist(&sample, Union, &batch);
+    free_matchlist(&batch);
+
+    if (!query_sample_matches || n_matches >= query_sample_size)
+      break;
+
+    /* expected number of start positions needed for the missing matches, plus 10% */
+    if (n_matches > 0) {
+      extrapolated = 1.1 * (query_sample_size - n_matches) * n_evaluated / n_matches + 1;
+      batch_size = (extrapolated < n_candidates - n_evaluated) ? (int)extrapolated : n_candidates - n_evaluated;
+    }
+    else
+      batch_size = MIN(n_evaluated, n_candidates - n_evaluated);
+  }
+
+  free_matchlist(matchlist);
+  *matchlist = sample;
+
+  query_sample_candidates = n_candidates;
+  query_sample_evaluated = n_evaluated;
+  query_sample_biased = (evalenv->matching_strategy != traditional && !dfa_has_fixed_length());
+}
+
+
 /**
  * Run the DFA that performs a standard CQP query (i.e. based on token-level regular expression).
 
@@ -2785,6 +4025,9 @@ run_standard_query_dfa(int envidx, int cut, int keep_old_ranges)
   int FirstTransitionIsDeterministic;
   int trans_count = 0, current_transition = 0;
 
+  /* a rare pattern at a bounded distance from the start of the match restricts the start positions */
+  QueryAnchor anchor;
+
   assert(envidx <= ee_ix);        /* envidx == 0, actually ...  check_alignment_constraint EXPLICITLY assumes
                                    that everything else is an alignment constraint! */
   evalenv = &Environment[envidx];
@@ -2837,6 +4080,8 @@ run_standard_query_dfa(int envidx, int cut, int keep_old_ranges)
 
     EvaluationIsRunning = 1;
 
+    find_query_anchor(&anchor);
+
     /* first transition loop (loops over all possible initial patterns) */
     for (p = 0; p < evalenv->dfa.Max_Input && EvaluationIsRunning; p++)
       if ((state = evalenv->dfa.TransTable[0][p]) != evalenv->dfa.E_State) {
@@ -2853,15 +4098,28 @@ run_standard_query_dfa(int envidx, int cut, int keep_old_ranges)
           }
         }
 
-        /* match the initial pattern. */
-        if (match_first_pattern(&(evalenv->patternlist[p]), &matchlist, evalenv->query_corpus)) {
+        /* match the initial pattern (or find the start positions from the anchor pattern) */
+        if (match_first_pattern_by_anchor(&anchor, &(evalenv->patternlist[p]), &matchlist, evalenv->query_corpus)
+            || (EvaluationIsRunning
+                && match_first_pattern(&(evalenv->patternlist[p]), &matchlist, evalenv->query_corpus)
+                && filter_by_anchor(&anchor, &matchlist, evalenv->query_corpus))) {
+          if (mark_cells_outside_start_range(&matchlist) > 0)
+            apply_setop_to_matchlist(&matchlist, Reduce, NULL);
+
           if (initial_matchlist_debug) {
             Rprintf("After initial matching for transition %d: ", p);
             show_matchlist_firstelements(matchlist);
             print_symbol_table(evalenv->labels);
           }
 
-          if (matchlist.tabsize > 0) {
+          /* sampling is only possible if all start positions come from a single initial pattern */
+          if (matchlist.tabsize > 0 && query_sample_size > 0 && FirstTransitionIsDeterministic) {
+            simulate_sample(&matchlist,
+                            state_vector, target_vector,
+                            reftab_vector, reftab_target_vector,
+                            p);
+          }
+          else if (matchlist.tabsize > 0) {
             matchlist.end = (int *)cl_malloc(sizeof(int) * matchlist.tabsize);
             memcpy(matchlist.end, matchlist.start, sizeof(int) * matchlist.tabsize);
 
@@ -2966,6 +4224,7 @@ run_standard_query_dfa(int envidx, int cut, int keep_old_ranges)
     set_corpus_matchlists(evalenv->query_corpus, &total_matchlist, 1, keep_old_ranges);
     free_matchlist(&total_matchlist);
 
+    free_matchlist(&anchor.positions);
     cl_free(state_vector);
     cl_free(target_vector);
     for (i = 0; i < evalenv->dfa.Max_States; i++) {
@@ -2979,11 +4238,63 @@ run_standard_query_dfa(int envidx, int cut, int keep_old_ranges)
 
 
 
+/**
+ * Finds the first item of a sorted list of corpus positions that is not smaller than a given value.
+ *
+ * Galloping (exponential) search followed by binary search, so that skipping over many items
+ * takes logarithmic time while advancing by a few items is as cheap as a linear scan.
+ *
+ * @param list   Sorted vector of corpus positions.
+ * @param size   Number of items in list.
+ * @param from   Index at which to start the search.
+ * @param value  The value to look for.
+ * @return       Index of the first item >= value at or after from (size if there is none).
+ */
+static int
+gallop_cpos_list(int *list, int size, int from, int value)
+{
+  int lo, hi, mid, step;
+
+  if (from >= size || list[from] >= value)
+    return from;
+
+  /* invariant: list[lo] < value */
+  lo = from;
+  step = 1;
+  while (step < size - lo && list[lo + step] < value) {
+    lo += step;
+    step *= 2;
+  }
+  hi = (step < size - lo) ? lo + step : size;
+
+  /* invariant: list[lo] < value and (hi == size or list[hi] >= value) */
+  while (hi - lo > 1) {
+    mid = lo + (hi - lo) / 2;
+    if (list[mid] < value)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return hi;
+}
+
+/** Subtracts an offset from a corpus position, clamping the result to the range of integers. */
+static int
+meet_offset_bound(int cpos, int offset)
+{
+  long long bound = (long long)cpos - offset;
+  return (int)MAX(MIN(bound, INT_MAX), INT_MIN);
+}
+
 /**
  * Does a "meet" operation within MU queries.
  *
  * NB: list1 will be modified in place, list2 remains unchanged and should be deallocated by the caller
-
+ *
+ * Without "not", the two lists are joined by galloping alternately through list1 and list2,
+ * so that the time taken is proportional to the size of the smaller list (and the number of
+ * results) rather than to the sum of both sizes.
+ *
  * @param  negated   Boolean, true iff the "meet" operation contains the negation operator "not".
  */
 static int
@@ -2991,14 +4302,19 @@ meet_mu(Matchlist *list1, Matchlist *list2, int lw, int rw, Attribute *struc, in
 {
   int start, end, found_match;
   int corpus_size = evalenv->query_corpus->mother_size; /* corpus size needed for boundary checks below */
+  int region_start = -1, region_end = -1; /* last region of struc looked up for list1 */
 
-  if (list1->tabsize == 0 || list2->tabsize == 0) {
+  if (list1->tabsize == 0 || (list2->tabsize == 0 && !negated)) {
     /* If one of the two lists is empty, so is their intersection and we're done. */
     cl_free(list1->start);
     cl_free(list1->end);
     list1->tabsize = 0;
     list1->matches_whole_corpus = 0;
   }
+  else if (list2->tabsize == 0) {
+    /* negated constraint with empty B: all items of A pass the filter */
+    list1->matches_whole_corpus = 0;
+  }
   else {
     /* Implementation modified to give consistent "filtering" semantics (SE, 2017-07-01)
      *  - result of (meet A B <win>) are those items of A for which at least one item of B occurs within <win>
@@ -3011,18 +4327,73 @@ meet_mu(Matchlist *list1, Matchlist *list2, int lw, int rw, Attribute *struc, in
     int i = 0;                /* index in list1 */
     int j = 0;                /* index in list2 */
     int k = 0;                /* insertion point in list1 as result list */
+    int lo, hi;               /* range of items of A that an item of B can be matched against */
+
+    if (!negated) {
+      /* merge join: for the current item b of B, find the items of A whose context window contains b
+       * (i.e. positions from b - rw to b - lw, or the region of struc containing b);
+       * if there are none, skip to the first item of B that can be matched against the next item of A */
+      while ((i < list1->tabsize) && (j < list2->tabsize)) {
+        if (struc) {
+          if (!cl_cpos2struc2cpos(struc, list2->start[j], &lo, &hi) || !cl_all_ok()) {
+            j++; /* no region here, so b cannot be matched against any item of A */
+            continue;
+          }
+        }
+        else {
+          lo = meet_offset_bound(list2->start[j], rw);
+          hi = meet_offset_bound(list2->start[j], lw);
+        }
 
-    while ((i < list1->tabsize) && (j < list2->tabsize)) {
+        i = gallop_cpos_list(list1->start, list1->tabsize, i, lo);
+        if (i >= list1->tabsize)
+          break;
+
+        if (list1->start[i] > hi) {
+          /* skip items of B that cannot be matched against the current item of A */
+          if (struc)
+            j = gallop_cpos_list(list2->start, list2->tabsize, j + 1, hi + 1);
+          else
+            j = gallop_cpos_list(list2->start, list2->tabsize, j + 1, meet_offset_bound(list1->start[i], -lw));
+          continue;
+        }
+
+        for ( ; i < list1->tabsize && list1->start[i] <= hi; i++) {
+          if (!struc) {
+            /* same boundary checks as below (an item of A is discarded if a minimum distance is outside the corpus) */
+            start = cl_cpos_offset(list1->start[i], lw, corpus_size, lw <= 0);
+            end   = cl_cpos_offset(list1->start[i], rw, corpus_size, rw >= 0);
+            if (start < 0 || end < 0)
+              continue;
+          }
+          list1->start[k++] = list1->start[i];
+        }
+
+        /* all items of B in the same region have been dealt with */
+        if (struc)
+          j = gallop_cpos_list(list2->start, list2->tabsize, j + 1, hi + 1);
+        else
+          j++;
+      }
+    }
+
+    else while ((i < list1->tabsize) && (j < list2->tabsize)) {
       /* check whether this item from A can be matched against an item from B in the window [start, end] */
       if (struc) {
         /* s-attribute context: find region containing current point in A, otherwise there can be no match here */
-        if (!cl_cpos2struc2cpos(struc, list1->start[i], &start, &end) || !cl_all_ok()) {
-          if (negated)
-            list1->start[k++] = list1->start[i++]; /* negated constraint: upcopy match to insertion point within A */
-          else
-            i++; /* discard current point in A */
+        if (list1->start[i] >= region_start && list1->start[i] <= region_end) {
+          /* same region as for the previous item of A */
+          start = region_start;
+          end = region_end;
+        }
+        else if (!cl_cpos2struc2cpos(struc, list1->start[i], &start, &end) || !cl_all_ok()) {
+          list1->start[k++] = list1->start[i++]; /* negated constraint: upcopy match to insertion point within A */
           continue;
         }
+        else {
+          region_start = start;
+          region_end = end;
+        }
       }
       else {
         /* numeric context: compute start and end as offsets from current corpus position in A
@@ -3040,34 +4411,21 @@ meet_mu(Matchlist *list1, Matchlist *list2, int lw, int rw, Attribute *struc, in
 
         /* if a minimum distance is outside the corpus, there can be no match here */
         if (start < 0 || end < 0) { /* i.e. error code CDA_EPOSORNG has been returned */
-          if (negated)
-            list1->start[k++] = list1->start[i++]; /* negated constraint: upcopy match to insertion point within A */
-          else
-            i++; /* discard current point in A */
+          list1->start[k++] = list1->start[i++]; /* negated constraint: upcopy match to insertion point within A */
           continue;
         }
       }
 
       /* [start, end] is now a valid cpos range (which may be empty for end < start) and we try to find an item from B in this window */
       /* skip items of B before start of current context window */
-      while (j < list2->tabsize && list2->start[j] < start)
-        j++;
+      j = gallop_cpos_list(list2->start, list2->tabsize, j, start);
       /* note that we never have to move backwards in list2 because the context windows will be strictly increasing */
 
       /* now check for a match within the context window unless we have already reached the end of B */
+      found_match = (j < list2->tabsize && list2->start[j] <= end);
 
-      if (j < list2->tabsize && list2->start[j] <= end) {
-        /* verify that this is a valid match, as it should be */
-        assert((start <= list2->start[j]) && (list2->start[j] <= end));
-        found_match = 1;
-      }
-      else
-        found_match = 0;
-
-      /* if we found a match... or, in negated mode, if we DIDN'T find one ... */
-//      if ( (found_match && !negated) || (!found_match && negated) ) {
-      if ( found_match == (negated ? 0 : 1) )
-        /* ... upcopy match to insertion point within A */
+      /* in negated mode, upcopy the item of A to the insertion point iff we DIDN'T find a match */
+      if (!found_match)
         list1->start[k++] = list1->start[i++];
       else
         /* discard current point in A */
@@ -3077,6 +4435,11 @@ meet_mu(Matchlist *list1, Matchlist *list2, int lw, int rw, Attribute *struc, in
     }
     /* end of loop filtering A against B */
 
+    /* in negated mode, the items of A after the end of B pass the filter */
+    if (negated)
+      while (i < list1->tabsize)
+        list1->start[k++] = list1->start[i++];
+
     if (k == 0)
       /* the result is empty, so free list1 */
       cl_free(list1->start);
@@ -3114,6 +4477,8 @@ eval_mu_tree(Evaltree et, Matchlist* ml)
       init_matchlist(&arg2);
       if (! eval_mu_tree(et->cooc.left, ml))
         return 0;
+      if (ml->tabsize == 0)
+        return 1; /* result is empty, no need to evaluate the right-hand side */
       if (! eval_mu_tree(et->cooc.right, &arg2)) {
         free_matchlist(&arg2);
         return 0;
@@ -3175,6 +4540,34 @@ cqp_run_query(int cut, int keep_old_ranges)
   }
 }
 
+/**
+ * Merges the result of a query evaluated for a range of start positions (see query_start_min) into
+ * a list of pending matches, which is then post-processed according to the matching strategy.
+ *
+ * Since spurious matches are deleted only if they overlap with other matches, pending matches that
+ * end before the next range of start positions cannot be affected by the rest of the query result.
+ *
+ * @param pending    The pending matches (a subcorpus), which are updated.
+ * @param chunk      The query result for a range of start positions (all after those of pending, may be NULL).
+ * @param next_cpos  Start of the next range of start positions (-1 if the query has been evaluated completely).
+ * @return           Number of matches at the start of pending that are final.
+ */
+int
+merge_query_chunk(CorpusList *pending, CorpusList *chunk, int next_cpos)
+{
+  int i;
+
+  if (chunk)
+    apply_range_set_operation(pending, RUnion, chunk, NULL);
+  apply_matching_strategy(pending, query_start_strategy);
+
+  if (next_cpos < 0)
+    return pending->size;
+  for (i = 0; i < pending->size && pending->range[i].end < next_cpos; i++)
+    ;
+  return i;
+}
+
 
 
 /**
@@ -3200,6 +4593,7 @@ cqp_run_mu_query(int keep_old_ranges, int cut_value)
 
   if (matchlist.tabsize > 0) {
     mark_offrange_cells(&matchlist, evalenv->query_corpus);
+    mark_cells_outside_start_range(&matchlist);
     apply_setop_to_matchlist(&matchlist, Reduce, NULL);
 
     if (cut_value > 0 && matchlist.tabsize > cut_value) {
@@ -3380,8 +4774,8 @@ cqp_run_tab_query()
       }
       result.tabsize = n_res;
 
-      /* delete offrange cells if we are in a subcorpus */
-      if (mark_offrange_cells(&result, evalenv->query_corpus) > 0)
+      /* delete offrange cells if we are in a subcorpus (or outside the range of start positions) */
+      if (mark_offrange_cells(&result, evalenv->query_corpus) + mark_cells_outside_start_range(&result) > 0)
         apply_setop_to_matchlist(&result, Reduce, NULL);
     }
     else {
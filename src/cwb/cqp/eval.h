@@ -112,6 +112,9 @@ typedef union c_tree {
     union c_tree  *left,                  /**< points to the first operand       */
                   *right;                 /**< points to the second operand,
                                                if if there is one                */
+    int            plan_order;            /**< evaluation order of a conjunction in
+                                               query-initial position (set by the
+                                               query planner in eval.c)          */
   }                node;
 
   /** "constant" node in the evaluation tree */
@@ -184,6 +187,9 @@ typedef union c_tree {
     int            nr_items;              /**< size of the "items" array         */
     int           *items;                 /**< array of item IDs                 */
     int            del;                /**< delete label after using it?      */
+    int            param;                 /**< placeholder for this parameter of a
+                                               prepared query (0 = none)         */
+    int            flags;                 /**< IGNORE_CASE etc. for the parameter */
   }                idlist;
 
   /** leaf: a constant (string, int, float, ...) */
@@ -514,14 +520,30 @@ extern int ee_ix;
 extern EEP CurEnv;
 extern EEP evalenv;
 
+/* Range of start positions of query matches (for incremental evaluation) */
+extern int query_start_min;
+extern int query_start_max;
+extern MatchingStrategy query_start_strategy;
+
+/* Evaluation of standard queries for a random sample of start positions */
+extern int query_sample_size;
+extern int query_sample_matches;
+extern int query_sample_candidates;
+extern int query_sample_evaluated;
+extern int query_sample_biased;
+
 /* ---------------------------------------------------------------------- */
 
 Boolean eval_bool(Constrainttree ctptr, RefTab rt, int corppos);
 
+int *get_constraint_positions(Constrainttree constr, CorpusList *corpus, int lines, double window, int *n_found);
+
 /* ==================== the three query types */
 
 void cqp_run_query(int cut, int keep_old_ranges);
 
+int merge_query_chunk(CorpusList *pending, CorpusList *chunk, int next_cpos);
+
 void cqp_run_mu_query(int keep_old_ranges, int cut_value);
 
 void cqp_run_tab_query();
@@ -0,0 +1,469 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../cl/cl.h"
+
+#include "extsort.h"
+#include "output.h"
+
+/** Maximum number of runs that are merged at the same time (more runs are merged in several passes) */
+#define EXTSORT_FANIN 64
+/** Minimum number of records in memory for sorting them in parallel threads */
+#define EXTSORT_PARALLEL_MIN 10000
+/** Smallest memory budget (in bytes); smaller values are silently increased */
+#define EXTSORT_MIN_MEMORY (1 << 20)
+
+
+/**
+ * A sorted run of records in a temporary file.
+ *
+ * In the merge phase, the run holds its current record, i.e. the
+ * smallest record that has not been passed on yet.
+ */
+typedef struct _ExtSortRun {
+  char name[TEMP_FILENAME_BUFSIZE];     /**< filename of the temporary file */
+  FILE *fd;                             /**< stream for writing or reading the run (NULL if closed) */
+  int *rec;                             /**< current record (merge phase) */
+  int len;                              /**< length of the current record */
+  int size;                             /**< allocated size of rec */
+} ExtSortRun;
+
+/**
+ * The ExtSort object.
+ *
+ * Records are stored in a buffer, each preceded by its length.
+ */
+struct _ExtSort {
+  ExtSortCompare compare;               /**< comparison function for records */
+  size_t memory;                        /**< memory budget for records in memory (in bytes) */
+  int *buf;                             /**< buffer of records in memory */
+  size_t buf_used;                      /**< number of integers used in buf */
+  size_t buf_size;                      /**< allocated size of buf */
+  size_t *recs;                         /**< offsets of the records in buf */
+  size_t n_recs;                        /**< number of records in memory */
+  size_t recs_size;                     /**< allocated size of recs */
+  size_t next;                          /**< next record to be returned (if all records fit into memory) */
+  ExtSortRun **runs;                    /**< the runs written to disk */
+  int n_runs;                           /**< number of runs */
+  int *heap;                            /**< heap of the runs being merged (ordered by their current records) */
+  int heap_size;                        /**< number of runs in the heap */
+  int pending;                          /**< boolean: the current record of the top run has been passed on */
+  int merging;                          /**< boolean: records are returned from the runs on disk */
+};
+
+
+/** Ranges of records up to this length are sorted by insertion sort before merging them. */
+#define EXTSORT_INSERTION_MAX 16
+
+/**
+ * Sorts records of es by their offsets in es->buf (stable merge sort).
+ *
+ * Unlike qsort(), this passes es to the comparisons, so sorts of different
+ * ExtSort objects (or of slices in parallel threads) don't share any state.
+ *
+ * @param es    The ExtSort object.
+ * @param recs  Offsets of the records to be sorted (sorted in place).
+ * @param tmp   Scratch space for n offsets.
+ * @param n     Number of records.
+ */
+static void
+extsort_sort_recs(ExtSort es, size_t *recs, size_t *tmp, size_t n)
+{
+  size_t *src = recs, *dst = tmp, *swap;
+  size_t width, from, i, j, k, mid, to;
+
+  /* insertion sort of short ranges */
+  for (from = 0; from < n; from += EXTSORT_INSERTION_MAX) {
+    to = MIN(from + EXTSORT_INSERTION_MAX, n);
+    for (i = from + 1; i < to; i++) {
+      size_t rec = recs[i];
+      for (j = i; j > from && es->compare(es->buf + recs[j-1] + 1, es->buf + rec + 1) > 0; j--)
+        recs[j] = recs[j-1];
+      recs[j] = rec;
+    }
+  }
+
+  /* bottom-up merges of adjacent ranges (taking from the left range on ties keeps the sort stable) */
+  for (width = EXTSORT_INSERTION_MAX; width < n; width *= 2) {
+    for (from = 0; from < n; from += 2 * width) {
+      mid = MIN(from + width, n);
+      to = MIN(from + 2 * width, n);
+      for (i = from, j = mid, k = from; k < to; k++)
+        if (j >= to || (i < mid && es->compare(es->buf + src[i] + 1, es->buf + src[j] + 1) <= 0))
+          dst[k] = src[i++];
+        else
+          dst[k] = src[j++];
+    }
+    swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if (src != recs)
+    memcpy(recs, src, n * sizeof(size_t));
+}
+
+
+/**
+ * Creates a new, empty external-memory sort.
+ *
+ * @param compare  Comparison function for records.
+ * @param memory   Memory budget (in bytes) for the records kept in memory.
+ * @return         The new ExtSort object.
+ */
+ExtSort
+extsort_new(ExtSortCompare compare, size_t memory)
+{
+  ExtSort es = (ExtSort)cl_calloc(1, sizeof(struct _ExtSort));
+  es->compare = compare;
+  es->memory = (memory < EXTSORT_MIN_MEMORY) ? EXTSORT_MIN_MEMORY : memory;
+  return es;
+}
+
+/** Creates a temporary file for a new run and appends it to the runs of es; returns NULL on failure. */
+static ExtSortRun *
+extsort_new_run(ExtSort es)
+{
+  ExtSortRun *run = (ExtSortRun *)cl_calloc(1, sizeof(ExtSortRun));
+
+  if (NULL == (run->fd = open_temporary_file(run->name))) {
+    cqpmessage(Error, "Can't create temporary file for sorting on disk.");
+    cl_free(run);
+    return NULL;
+  }
+  es->runs = (ExtSortRun **)cl_realloc(es->runs, (es->n_runs + 1) * sizeof(ExtSortRun *));
+  es->runs[es->n_runs++] = run;
+  return run;
+}
+
+/** Deletes the first n runs of es (closing and removing their temporary files). */
+static void
+extsort_remove_runs(ExtSort es, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    ExtSortRun *run = es->runs[i];
+    if (run->fd)
+      fclose(run->fd);
+    if (unlink(run->name))
+      perror(run->name);
+    cl_free(run->rec);
+    cl_free(run);
+  }
+  memmove(es->runs, es->runs + n, (es->n_runs - n) * sizeof(ExtSortRun *));
+  es->n_runs -= n;
+}
+
+
+/** Shared data of the threads of extsort_spill(). */
+typedef struct {
+  ExtSort es;
+  size_t *tmp;                          /**< scratch space for sorting (a slice for each thread) */
+  int first_run;                        /**< run written by thread 0 */
+  int *failed;                          /**< error flag of each thread */
+} ExtSortSpill;
+
+/** Worker of extsort_spill(): sorts a contiguous slice of the records in memory and writes it to a run. */
+static void
+extsort_spill_worker(int thread, int n_threads, void *data)
+{
+  ExtSortSpill *sp = (ExtSortSpill *)data;
+  ExtSort es = sp->es;
+  ExtSortRun *run = es->runs[sp->first_run + thread];
+  size_t from = (es->n_recs * thread) / n_threads;
+  size_t to = (es->n_recs * (thread + 1)) / n_threads;
+  size_t i;
+
+  extsort_sort_recs(es, es->recs + from, sp->tmp + from, to - from);
+  for (i = from; i < to; i++) {
+    int *rec = es->buf + es->recs[i];
+    if (fwrite(rec, sizeof(int), rec[0] + 1, run->fd) != (size_t)rec[0] + 1) {
+      sp->failed[thread] = 1;
+      break;
+    }
+  }
+  if (fclose(run->fd))
+    sp->failed[thread] = 1;
+  run->fd = NULL;
+}
+
+/**
+ * Sorts the records in memory and writes them to disk.
+ *
+ * Large buffers are split into slices, which are sorted by separate threads
+ * and written to separate runs.
+ *
+ * @return  Boolean: true if successful.
+ */
+static int
+extsort_spill(ExtSort es)
+{
+  ExtSortSpill sp;
+  int n_threads, t, ok;
+
+  n_threads = (es->n_recs >= EXTSORT_PARALLEL_MIN) ? cl_get_threads() : 1;
+  sp.es = es;
+  sp.first_run = es->n_runs;
+  for (t = 0; t < n_threads; t++)
+    if (!extsort_new_run(es))
+      return 0;
+  sp.failed = (int *)cl_calloc(n_threads, sizeof(int));
+  sp.tmp = (size_t *)cl_malloc(es->n_recs * sizeof(size_t));
+
+  cl_parallel(extsort_spill_worker, n_threads, &sp);
+  cl_free(sp.tmp);
+
+  ok = 1;
+  for (t = 0; t < n_threads; t++)
+    if (sp.failed[t]) {
+      cqpmessage(Error, "Can't write temporary file %s for sorting on disk.", es->runs[sp.first_run + t]->name);
+      ok = 0;
+    }
+  cl_free(sp.failed);
+
+  es->buf_used = 0;
+  es->n_recs = 0;
+  return ok;
+}
+
+/**
+ * Adds a record to an external-memory sort.
+ *
+ * If the memory budget is exhausted, the records collected so far are
+ * sorted and written to disk first.
+ *
+ * @param es   The ExtSort object.
+ * @param rec  The record (which is copied).
+ * @param len  Number of integers in the record.
+ * @return     Boolean: true if successful, false if a temporary file could not be written.
+ */
+int
+extsort_add(ExtSort es, const int *rec, int len)
+{
+  size_t needed = es->buf_used + len + 1;
+
+  if (es->n_recs > 0 && needed * sizeof(int) + (es->n_recs + 1) * sizeof(size_t) > es->memory) {
+    if (!extsort_spill(es))
+      return 0;
+    needed = len + 1;
+  }
+
+  /* grow the buffers, but not (much) beyond the memory budget */
+  if (needed > es->buf_size) {
+    es->buf_size = MIN(2 * es->buf_size + 1024, es->memory / sizeof(int));
+    if (es->buf_size < needed)
+      es->buf_size = needed;
+    es->buf = (int *)cl_realloc(es->buf, es->buf_size * sizeof(int));
+  }
+  if (es->n_recs >= es->recs_size) {
+    es->recs_size = 2 * es->recs_size + 1024;
+    es->recs = (size_t *)cl_realloc(es->recs, es->recs_size * sizeof(size_t));
+  }
+
+  es->recs[es->n_recs++] = es->buf_used;
+  es->buf[es->buf_used] = len;
+  memcpy(es->buf + es->buf_used + 1, rec, len * sizeof(int));
+  es->buf_used += len + 1;
+  return 1;
+}
+
+
+/** Reads the next record of a run; returns false at the end of the run (or if the file is truncated). */
+static int
+extsort_read(ExtSortRun *run)
+{
+  int len;
+
+  if (1 != fread(&len, sizeof(int), 1, run->fd) || len < 0)
+    return 0;
+  if (len > run->size) {
+    run->size = len;
+    run->rec = (int *)cl_realloc(run->rec, len * sizeof(int));
+  }
+  if ((size_t)len != fread(run->rec, sizeof(int), len, run->fd))
+    return 0;
+  run->len = len;
+  return 1;
+}
+
+/** Moves run heap[i] down to its place in the heap of runs being merged. */
+static void
+extsort_sift_down(ExtSort es, int i)
+{
+  int child, temp, comp;
+
+  while ((child = 2 * i + 1) < es->heap_size) {
+    if (child + 1 < es->heap_size) {
+      comp = es->compare(es->runs[es->heap[child + 1]]->rec, es->runs[es->heap[child]]->rec);
+      if (comp < 0 || (comp == 0 && es->heap[child + 1] < es->heap[child]))
+        child++;
+    }
+    comp = es->compare(es->runs[es->heap[child]]->rec, es->runs[es->heap[i]]->rec);
+    if (comp > 0 || (comp == 0 && es->heap[child] > es->heap[i]))
+      break;
+    temp = es->heap[i];
+    es->heap[i] = es->heap[child];
+    es->heap[child] = temp;
+    i = child;
+  }
+}
+
+/** Starts merging the first n runs of es; returns false if a run cannot be opened. */
+static int
+extsort_merge_start(ExtSort es, int n)
+{
+  int i;
+
+  es->heap = (int *)cl_realloc(es->heap, n * sizeof(int));
+  es->heap_size = 0;
+  es->pending = 0;
+  for (i = 0; i < n; i++) {
+    ExtSortRun *run = es->runs[i];
+    if (NULL == (run->fd = fopen(run->name, "rb"))) {
+      perror(run->name);
+      cqpmessage(Error, "Can't read temporary file %s for sorting on disk.", run->name);
+      return 0;
+    }
+    if (extsort_read(run))
+      es->heap[es->heap_size++] = i;
+  }
+  for (i = es->heap_size / 2 - 1; i >= 0; i--)
+    extsort_sift_down(es, i);
+  return 1;
+}
+
+/** Returns the run with the next record in the merge (NULL if all runs are exhausted). */
+static ExtSortRun *
+extsort_merge_next(ExtSort es)
+{
+  if (es->pending) {
+    /* advance the run whose record has been passed on */
+    if (!extsort_read(es->runs[es->heap[0]]))
+      es->heap[0] = es->heap[--es->heap_size];
+    extsort_sift_down(es, 0);
+    es->pending = 0;
+  }
+  if (es->heap_size <= 0)
+    return NULL;
+  es->pending = 1;
+  return es->runs[es->heap[0]];
+}
+
+/**
+ * Finishes adding records to an external-memory sort and prepares for reading the sorted records.
+ *
+ * If all records fit into memory, they are just sorted in memory. Otherwise, the
+ * remaining records are written to disk and the runs are merged until at most
+ * EXTSORT_FANIN runs are left, which are merged on the fly by extsort_next().
+ *
+ * @return  Boolean: true if successful.
+ */
+int
+extsort_finish(ExtSort es)
+{
+  ExtSortRun *run, *out;
+
+  if (es->n_runs == 0) {
+    if (es->n_recs > 1) {
+      size_t *tmp = (size_t *)cl_malloc(es->n_recs * sizeof(size_t));
+      extsort_sort_recs(es, es->recs, tmp, es->n_recs);
+      cl_free(tmp);
+    }
+    es->next = 0;
+    return 1;
+  }
+
+  if (es->n_recs > 0 && !extsort_spill(es))
+    return 0;
+  cl_free(es->buf);
+  cl_free(es->recs);
+  es->buf_size = es->recs_size = 0;
+
+  /* intermediate merge passes (new runs are appended after the ones being merged) */
+  while (es->n_runs > EXTSORT_FANIN) {
+    if (!(out = extsort_new_run(es)) || !extsort_merge_start(es, EXTSORT_FANIN))
+      return 0;
+    while (NULL != (run = extsort_merge_next(es))) {
+      if (1 != fwrite(&run->len, sizeof(int), 1, out->fd) || (size_t)run->len != fwrite(run->rec, sizeof(int), run->len, out->fd)) {
+        cqpmessage(Error, "Can't write temporary file %s for sorting on disk.", out->name);
+        return 0;
+      }
+    }
+    if (fclose(out->fd)) {
+      out->fd = NULL;
+      cqpmessage(Error, "Can't write temporary file %s for sorting on disk.", out->name);
+      return 0;
+    }
+    out->fd = NULL;
+    extsort_remove_runs(es, EXTSORT_FANIN);
+  }
+
+  es->merging = 1;
+  return extsort_merge_start(es, es->n_runs);
+}
+
+/**
+ * Gets the next record in sort order (after extsort_finish()).
+ *
+ * @param es   The ExtSort object.
+ * @param len  Receives the number of integers in the record.
+ * @return     Pointer to the record, which is valid until the next call; NULL if there are no more records.
+ */
+const int *
+extsort_next(ExtSort es, int *len)
+{
+  ExtSortRun *run;
+  int *rec;
+
+  if (!es->merging) {
+    if (es->next >= es->n_recs)
+      return NULL;
+    rec = es->buf + es->recs[es->next++];
+    *len = rec[0];
+    return rec + 1;
+  }
+  if (NULL == (run = extsort_merge_next(es)))
+    return NULL;
+  *len = run->len;
+  return run->rec;
+}
+
+/** Returns the number of runs written to disk so far (0 if all records have been sorted in memory). */
+int
+extsort_nr_runs(ExtSort es)
+{
+  return es->n_runs;
+}
+
+/** Deletes an ExtSort object, removing all its temporary files. */
+void
+extsort_delete(ExtSort es)
+{
+  if (es) {
+    extsort_remove_runs(es, es->n_runs);
+    cl_free(es->runs);
+    cl_free(es->heap);
+    cl_free(es->buf);
+    cl_free(es->recs);
+    cl_free(es);
+  }
+}
@@ -0,0 +1,53 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#ifndef _cqp_extsort_h_
+#define _cqp_extsort_h_
+
+#include <stddef.h>
+
+
+/*
+ * EXTERNAL-MEMORY SORTING OF INTEGER RECORDS
+ *
+ * Records (sequences of integers of variable length) are collected in memory
+ * up to a given memory budget. When the budget is exhausted, the records are
+ * sorted (in parallel threads) and written to temporary files ("runs"), which
+ * are finally merged. This replaces the external sort commands formerly used
+ * for sorting and grouping query results.
+ */
+
+/** Compares two records (qsort-style return value); records are passed without their length. */
+typedef int (*ExtSortCompare)(const int *rec1, const int *rec2);
+
+/** An external-memory sort (opaque object). */
+typedef struct _ExtSort *ExtSort;
+
+ExtSort extsort_new(ExtSortCompare compare, size_t memory);
+
+int extsort_add(ExtSort es, const int *rec, int len);
+
+int extsort_finish(ExtSort es);
+
+const int *extsort_next(ExtSort es, int *len);
+
+int extsort_nr_runs(ExtSort es);
+
+void extsort_delete(ExtSort es);
+
+
+#endif
@@ -29,9 +29,7 @@
 #include "corpmanag.h"
 #include "groups.h"
 #include "output.h"
-
-/** define this as 1 to prevent temporary file deletion & print additional messages */
-#define GROUP_DEBUG 0
+#include "extsort.h"
 
 /** integer identfier special value: = anything */
 #define ANY_ID -2
@@ -97,6 +95,47 @@ compare_cells(const void *p1, const void *p2)
 }
 
 
+/**
+ * Get the effective corpus position of grouping element `target` (1 = target, 0 = source) for item `i`
+ * in query result set, i.e. the position of its anchor point plus offset (see get_group_id() for the
+ * special cases: ANY_ID if the grouping element is unused or its anchor point is undefined, -1 for
+ * all negative positions).
+ */
+static int
+get_group_cpos(Group *group, int i, int target)
+{
+  CorpusList *cl  = group->my_corpus;
+  int field_type  = (target ? group->target_field     : group->source_field);
+  int offset      = (target ? group->target_offset    : group->source_offset);
+  int pos = -1;
+
+  switch (field_type) {
+  case KeywordField:
+    pos = cl->keywords[i];
+    break;
+  case TargetField:
+    pos = cl->targets[i];
+    break;
+  case MatchField:
+    pos = cl->range[i].start;
+    break;
+  case MatchEndField:
+    pos = cl->range[i].end;
+    break;
+  case NoField:
+    return ANY_ID;
+    break;
+  default:
+    assert(0 && "get_group_cpos: reached unreachable code");
+    break;
+  }
+  if (pos < 0)
+    return ANY_ID;
+
+  pos += offset; /* compute effective cpos (which may be beyond end of corpus) */
+  return (pos < 0) ? -1 : pos;
+}
+
 /**
  * Get lexicon ID of grouping element `target` (1 = target, 0 = source) for item `i` in query result set.
  *
@@ -131,63 +170,32 @@ compare_cells(const void *p1, const void *p2)
 static int
 get_group_id(Group *group, int i, int target, int *cpos)
 {
-  CorpusList *cl  = group->my_corpus;
   int field_type  = (target ? group->target_field     : group->source_field);
-  int offset      = (target ? group->target_offset    : group->source_offset);
   Attribute *attr = (target ? group->target_attribute : group->source_attribute);
   int is_struc    = (target ? group->target_is_struc  : group->source_is_struc);
   char *base      = (target ? group->target_base      : group->source_base);
   int pos, id;
-  pos = -1;
 
-  switch (field_type) {
-  case KeywordField:
-    pos = cl->keywords[i];
-    break;
-  case TargetField:
-    pos = cl->targets[i];
-    break;
-  case MatchField:
-    pos = cl->range[i].start;
-    break;
-  case MatchEndField:
-    pos = cl->range[i].end;
-    break;
-  case NoField:
+  pos = get_group_cpos(group, i, target);
+  if (cpos) *cpos = pos;
+
+  if (field_type == NoField)
     /* special case A (there is no source field): ID=ANY_ID, *cpos=ANY_ID */
-    if (cpos) *cpos = ANY_ID;
     return ANY_ID;
-    break;
-  default:
-    assert(0 && "get_group_id: reached unreachable code");
-    break;
-  }
-  if (pos < 0) {
-    /* special case B (anchor point is undefined): ID=-1, *cpos=ANY_ID */
-    if (cpos) *cpos = ANY_ID;
+  if (pos < 0)
+    /* special cases B (anchor point is undefined, *cpos=ANY_ID) and C1 (effective cpos negative, *cpos=-1): ID=-1 */
     return -1;
-  }
 
-  pos += offset; /* compute effective cpos */
-  if (pos < 0) {
-    /* special case C1 (effective cpos negative): ID=-1, *cpos=-1 */
-    if (cpos) *cpos = -1;
-    id = -1;
+  /* special cases C2 and D are handled implicitly below: if CL function returns an error, set ID=-1 */
+  if (is_struc) {
+    char *str = cl_cpos2struc2str(attr, pos);
+    id = ( str ? (str - base) : -1 );
   }
   else {
-    /* in all other cases, we return the effective cpos (which may be beyond end of corpus) */
-    if (cpos) *cpos = pos;
-    /* special cases C2 and D are handled implicitly below: if CL function returns an error, set ID=-1 */
-    if (is_struc) {
-      char *str = cl_cpos2struc2str(attr, pos);
-      id = ( str ? (str - base) : -1 );
-    }
-    else {
-      /* includes special case C2, for which cl_cpos2id returns -1 */
-      id = cl_cpos2id(attr, pos);
-      if (id < 0)
-        id = -1;
-    }
+    /* includes special case C2, for which cl_cpos2id returns -1 */
+    id = cl_cpos2id(attr, pos);
+    if (id < 0)
+      id = -1;
   }
   return id;
 }
@@ -207,31 +215,174 @@ Group_id2str(Group *group, int id, int target) {
     return (const char *)cl_id2str(attr, id);
 }
 
+/**
+ * Gets the pair of source and target IDs to be counted for item `i` in query result set.
+ *
+ * For document frequencies (group ... within), the effective corpus positions of source
+ * and target must be in the same region of the <within> s-attribute; otherwise the pair
+ * is not counted. If there is no source element or its anchor is undefined, the region
+ * is determined by the target element (and vice versa).
+ *
+ * @param group    Pointer to a data structure describing the group operation.
+ * @param i        The row of the query result to be accessed.
+ * @param ids_s_t  Receives the source and target IDs.
+ * @param struc    Receives the number of the <within> region, or -1 for token frequencies.
+ * @return         Boolean: true if the pair is counted, false if it is discarded.
+ */
+static int
+get_group_pair(Group *group, int i, int *ids_s_t, int *struc)
+{
+  Attribute *within = group->within_attribute;
+  int cpos0, cpos1, struc0, struc1; /* effective cpos of grouping element, and corresponding s-attribute region */
+
+  ids_s_t[0] = get_group_id(group, i, 0, &cpos0);   /* source ID */
+  ids_s_t[1] = get_group_id(group, i, 1, &cpos1);   /* target ID */
+  *struc = -1;
+  if (!within)
+    return 1;
+
+  if (cpos0 == ANY_ID)
+    cpos0 = cpos1; /* if there is no source element or its anchor is undefined -> focus on target element */
+  else if (cpos1 == ANY_ID)
+    cpos1 = cpos0; /* if target element anchor is undefined -> focus on source element */
+  if (cpos0 < 0 || cpos1 < 0)
+    return 0; /* both anchors undefined or effective cpos of one of them is out of bounds */
+  struc0 = cl_cpos2struc(within, cpos0);
+  struc1 = cl_cpos2struc(within, cpos1);
+  if (struc0 < 0 || struc1 < 0 || struc0 != struc1)
+    return 0; /* not in a <within> region, or in different <within> regions */
+  *struc = struc0;
+  return 1;
+}
+
+/** Minimum number of (source, target) pairs for counting them in parallel threads */
+#define GROUP_PARALLEL_MIN 100000
+/** Number of matches whose IDs are looked up at a time by each thread */
+#define GROUP_LOOKUP_BATCH 4096
+
+/** Shared data of the threads of ComputeGroupInternally(). */
+typedef struct {
+  Group *group;                 /**< the group operation */
+  int lookup;                   /**< boolean: whether the threads look up the IDs of p-attributes themselves */
+  int *ids;                     /**< source and target IDs of the pairs to be counted */
+  int *strucs;                  /**< <within> region of each pair (NULL for token frequencies) */
+  int n_pairs;                  /**< number of pairs */
+  cl_ngram_hash *counts;        /**< frequency counts of each thread */
+  int *out_of_order;            /**< error flag of each thread */
+  int *read_error;              /**< flag of each thread: the data of an attribute could not be read */
+} GroupCount;
+
+/**
+ * Worker of ComputeGroupInternally(): counts the (source, target) pairs in a contiguous
+ * chunk of the query result in a hash of its own.
+ *
+ * If gc->lookup is set, the lexicon IDs of the chunk are looked up first (with
+ * cl_cpos2id_list(), which can be used by parallel threads).
+ *
+ * For document frequencies, the payload of each pair holds the first and the last <within>
+ * region counted in this chunk, so that the counts of the threads can be merged.
+ */
+static void
+group_count_worker(int thread, int n_threads, void *data)
+{
+  GroupCount *gc = (GroupCount *)data;
+  int from = (int)(((long long)gc->n_pairs * thread) / n_threads);
+  int to = (int)(((long long)gc->n_pairs * (thread + 1)) / n_threads);
+  cl_ngram_hash pairs = gc->counts[thread];
+  cl_ngram_hash_entry item;
+  int i, k, n, target, *payload;
+
+  if (gc->lookup) {
+    int cpos[GROUP_LOOKUP_BATCH], ids[GROUP_LOOKUP_BATCH];
+    for (i = from; i < to; i += n) {
+      n = MIN(GROUP_LOOKUP_BATCH, to - i);
+      for (target = 0; target <= 1; target++) {
+        int field_type = (target ? gc->group->target_field : gc->group->source_field);
+        Attribute *attr = (target ? gc->group->target_attribute : gc->group->source_attribute);
+        if (field_type == NoField) {
+          /* special case A, see get_group_id() */
+          for (k = 0; k < n; k++)
+            gc->ids[2*(i+k) + target] = ANY_ID;
+          continue;
+        }
+        for (k = 0; k < n; k++)
+          cpos[k] = get_group_cpos(gc->group, i + k, target);
+        /* special cases B, C1 and C2: the CL function sets an error code < 0, which becomes ID=-1 */
+        if (cl_cpos2id_list(attr, cpos, n, ids) < 0) {
+          gc->read_error[thread] = 1;   /* reported by ComputeGroupInternally() */
+          for (k = 0; k < n; k++)
+            ids[k] = -1;
+        }
+        for (k = 0; k < n; k++)
+          gc->ids[2*(i+k) + target] = (ids[k] < 0) ? -1 : ids[k];
+      }
+    }
+  }
+
+  for (i = from; i < to; i++) {
+    if (!gc->strucs)
+      cl_ngram_hash_add(pairs, gc->ids + 2*i, 1);   /* count frequency of (source, target) pair */
+    else {
+      item = cl_ngram_hash_add(pairs, gc->ids + 2*i, 0); /* find (possibly new) entry for this ID pair */
+      payload = cl_ngram_hash_payload(pairs, item, NULL); /* initialised to -1 for new entry */
+      if (gc->strucs[i] > payload[1]) {
+        item->freq++;                                /* first occurrence in this <within> region -> count */
+        if (payload[0] < 0)
+          payload[0] = gc->strucs[i];
+        payload[1] = gc->strucs[i];
+      }
+      else if (gc->strucs[i] < payload[1]) {
+        gc->out_of_order[thread] = 1;
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * Computes a grouping in memory, using hashes of frequency counts.
+ *
+ * The IDs of the grouping elements are looked up for all matches first. The pairs are then
+ * counted in parallel threads (for large query results), each of which processes a contiguous
+ * chunk of the query result, and the counts of the threads are merged in order.
+ *
+ * The Group object is modified in situ. The return is that Group again (or NULL on failure).
+ */
 static Group *
 ComputeGroupInternally(Group *group)
 {
   cl_ngram_hash pairs, groups; /* frequency counts for (source, target) pairs and groups (= source ID) */
-  cl_ngram_hash_entry item;
+  cl_ngram_hash_entry item, local;
   Attribute *within = group->within_attribute; /* NULL = token frequencies / s-attribute handle = document frequencies */
+  GroupCount gc;
 
-  int i, *payload;
-  int ids_s_t[2]; /* pair of source and target IDs */
+  int i, t, n_threads, f, struc, *payload, *local_payload;
+  int read_error = 0;
   size_t nr_nodes;
   int percentage, new_percentage; /* for ProgressBar */
   int size = group->my_corpus->size;
-  int cpos0, cpos1, struc0, struc1; /* effective cpos of grouping element, and corresponding s-attribute region for df counts */
-  int do_within = (within) ? 1 : 0; /* = extra payload size needed for pairs */
+  int do_within = (within) ? 1 : 0;
 
   if (progress_bar)
     progress_bar_clear_line();
   percentage = -1;
 
-  pairs  = cl_new_ngram_hash(2, 0, do_within);
-  groups = cl_new_ngram_hash(1, 0, 0);
-
   EvaluationIsRunning = 1;
 
-  for (i = 0; i < size; i++) {
+  /* the threads can look up IDs of p-attributes themselves; s-attributes have to be read here */
+  gc.group = group;
+  gc.lookup = !(do_within || group->source_is_struc || group->target_is_struc);
+  gc.ids = (int *)cl_malloc(2 * (size_t)size * sizeof(int) + sizeof(int));
+  gc.strucs = (do_within) ? (int *)cl_malloc((size_t)size * sizeof(int) + sizeof(int)) : NULL;
+  gc.n_pairs = (gc.lookup) ? size : 0;
+  if (gc.lookup) {
+    /* make sure that the data of the attributes are loaded before threads access them */
+    if (group->source_field != NoField)
+      cl_cpos2id(group->source_attribute, 0);
+    if (group->target_field != NoField)
+      cl_cpos2id(group->target_attribute, 0);
+  }
+  for (i = 0; i < size && !gc.lookup; i++) {
     if (!EvaluationIsRunning)
       break;
       /* user abort (Ctrl-C) is the only way that var can change in this loop. */
@@ -242,44 +393,73 @@ ComputeGroupInternally(Group *group)
         progress_bar_percentage(1, 2, (percentage = new_percentage) );
     }
 
-    ids_s_t[0] = get_group_id(group, i, 0, &cpos0);   /* source ID */
-    ids_s_t[1] = get_group_id(group, i, 1, &cpos1);   /* target ID */
-    if (!do_within) {
-      cl_ngram_hash_add(pairs,  ids_s_t, 1);        /* count frequency of (source, target) pair */
-      cl_ngram_hash_add(groups, ids_s_t, 1);        /* frequency counts for groups (source) */
+    /* if the pair cannot be assigned to a <within> region, it is silently discarded */
+    if (get_group_pair(group, i, gc.ids + 2*gc.n_pairs, &struc)) {
+      if (do_within)
+        gc.strucs[gc.n_pairs] = struc;
+      gc.n_pairs++;
     }
-    else {
-      /* compute document frequencies based on <within> regions */
-      if (cpos0 == ANY_ID)
-        cpos0 = cpos1; /* if there is no source element or its anchor is undefined -> focus on target element */
-      else if (cpos1 == ANY_ID)
-        cpos1 = cpos0; /* if target element anchor is undefined -> focus on source element */
-      if (cpos0 >= 0 && cpos1 >= 0) {
-        /* if both anchors are undefined or if the effective cpos of one of them is out of bounds,
-         * the pair cannot be assigned to a <within> region and is silently discarded */
-        struc0 = cl_cpos2struc(within, cpos0);
-        struc1 = cl_cpos2struc(within, cpos1);
-        if (struc0 >= 0 && struc1 >= 0 && struc0 == struc1) {
-          /* if either effective cpos is out of bounds or not in a <within> region, the pair is silently discarded;
-           * the same happens if they are in different <within> regions */
-          item = cl_ngram_hash_add(pairs, ids_s_t, 0); /* find (possibly new) entry for this ID pair */
-          payload = cl_ngram_hash_payload(pairs, item, NULL); /* initialised to -1 for new entry */
-          if (struc0 > *payload) {
-            item->freq++;                              /* first occurrence in this <within> region -> count and update payload */
-            *payload = struc0;
-            cl_ngram_hash_add(groups, ids_s_t, 1);     /* increase total count for the group = sum over all pairs */
-          }
-          else if (struc0 < *payload) {
-            /* anchor points are out of order in query result (can happen for target and keyword);
-             * our approach cannot deal with this situation (would substantially increase time and/or memory complexity),
-             * so abort the grouping operation with an error message */
-            cqpmessage(Error, "Anchor points are out of order for group ... within (aborted).");
-            EvaluationIsRunning = 0;
-          }
-        }
+  }
+
+  /* count pairs in parallel threads */
+  n_threads = (gc.n_pairs >= GROUP_PARALLEL_MIN) ? cl_get_threads() : 1;
+  gc.counts = (cl_ngram_hash *)cl_malloc(n_threads * sizeof(cl_ngram_hash));
+  gc.out_of_order = (int *)cl_calloc(n_threads, sizeof(int));
+  gc.read_error = (int *)cl_calloc(n_threads, sizeof(int));
+  for (t = 0; t < n_threads; t++)
+    gc.counts[t] = cl_new_ngram_hash(2, 0, 2 * do_within);
+  if (EvaluationIsRunning)
+    cl_parallel(group_count_worker, n_threads, &gc);
+
+  /* merge the counts of the threads (in order, so that <within> regions spanning two chunks are counted once) */
+  pairs = gc.counts[0];
+  for (t = 1; t < n_threads && EvaluationIsRunning; t++) {
+    cl_ngram_hash_iterator_reset(gc.counts[t]);
+    while (NULL != (local = cl_ngram_hash_iterator_next(gc.counts[t]))) {
+      f = local->freq;
+      item = cl_ngram_hash_add(pairs, local->ngram, 0);
+      if (do_within) {
+        payload = cl_ngram_hash_payload(pairs, item, NULL);
+        local_payload = cl_ngram_hash_payload(gc.counts[t], local, NULL);
+        if (local_payload[0] < payload[1])
+          gc.out_of_order[t] = 1;
+        else if (local_payload[0] == payload[1])
+          f--;                          /* region has already been counted by the previous chunk */
+        if (payload[0] < 0)
+          payload[0] = local_payload[0];
+        payload[1] = local_payload[1];
       }
+      item->freq += f;
+    }
+  }
+  for (t = 0; t < n_threads; t++) {
+    if (gc.out_of_order[t] && EvaluationIsRunning) {
+      /* anchor points are out of order in query result (can happen for target and keyword);
+       * our approach cannot deal with this situation (would substantially increase time and/or memory complexity),
+       * so abort the grouping operation with an error message */
+      cqpmessage(Error, "Anchor points are out of order for group ... within (aborted; try 'set ExternalGroup on;').");
+      EvaluationIsRunning = 0;
     }
+    if (gc.read_error[t])
+      read_error = 1;
+    if (t > 0)
+      cl_delete_ngram_hash(gc.counts[t]);
   }
+  cl_free(gc.counts);
+  cl_free(gc.out_of_order);
+  cl_free(gc.read_error);
+  /* the threads must not print, so errors of the CL are reported here */
+  if (read_error)
+    cqpmessage(Warning, "Can't read the data of the grouping attributes for named query %s (IDs undefined)",
+               group->my_corpus->name);
+  cl_free(gc.ids);
+  cl_free(gc.strucs);
+
+  /* frequency counts for groups (source) = sum over all pairs */
+  groups = cl_new_ngram_hash(1, 0, 0);
+  cl_ngram_hash_iterator_reset(pairs);
+  while (EvaluationIsRunning && NULL != (item = cl_ngram_hash_iterator_next(pairs)))
+    cl_ngram_hash_add(groups, item->ngram, item->freq);
 
   if (EvaluationIsRunning) {
     if (progress_bar)
@@ -331,74 +511,106 @@ ComputeGroupInternally(Group *group)
   return group;
 }
 
+/** Compares two records of ComputeGroupExternally(): (source ID, target ID, <within> region). */
+static int
+compare_group_records(const int *rec1, const int *rec2)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    if (rec1[i] != rec2[i])
+      return (rec1[i] > rec2[i]) ? 1 : -1;
+  return 0;
+}
+
 /**
- * This function is used for passing Groups to external tools for grouping.
- * The Group object is modified in situ. The return is that Group again.
+ * Computes a grouping on disk, bounded by the memory budget set with the SortMemory option.
+ *
+ * This is used for very large query results, or if the ExternalGroup option is set.
+ * Instead of counting pairs in hashes, the (source, target) pairs of all matches (with their
+ * <within> regions for document frequencies) are sorted by the external-memory sort (see
+ * extsort.h), so that identical pairs can be counted in a single pass over the sorted records.
+ * The result is the same as that of ComputeGroupInternally(); anchor points need not be
+ * in order for group ... within, though.
+ *
+ * The Group object is modified in situ. The return is that Group again (or NULL on failure).
  */
 static Group *
 ComputeGroupExternally(Group *group)
 {
-  int i;
+  ExtSort es;
+  const int *rec;
+  int i, len, ok, s_freq, last_struc;
+  int pair[3]; /* source ID, target ID, <within> region */
   int size = group->my_corpus->size;
-  int cutoff_freq = group->cutoff_frequency;
-
-  char temporary_name[TEMP_FILENAME_BUFSIZE];
-  FILE *pipe;
-  char sort_call[CL_MAX_LINE_LENGTH];
-
-  if (group->within_attribute) {
-    cqpmessage(Error, "group ... within; not supported for external grouping.");
-    return group;
-  }
+  int do_within = (group->within_attribute) ? 1 : 0;
+  size_t nr_nodes, nr_alloc, first, k;
+  ID_Count_Mapping *cells;
 
-  for (i = 0; i < size; i++)
-    Rprintf("%d %d\n", get_group_id(group, i, 0, NULL), get_group_id(group, i, 1, NULL)); /* (source ID, target ID) */
-
-  /* construct sort call */
-  snprintf(sort_call, CL_MAX_LINE_LENGTH, ExternalGroupCommand, temporary_name);
-#if GROUP_DEBUG
-  Rprintf("Running grouping sort: \n\t%s\n", sort_call);
-#endif
-  if (!(pipe = popen(sort_call, "r"))) {
-    perror("Failure opening grouping pipe");
-    cqpmessage(Warning, "Can't open grouping pipe:\n%s\nDisable external grouping with 'set ExternalGroup off;'", sort_call);
-  }
-  else {
-    int freq, p1, p2, tokens;
-#define GROUP_REALLOC 1024
-
-    while (3 == (tokens = fscanf(pipe, "%d%d%d", &freq, &p1, &p2))) {
-      if (freq > cutoff_freq) {
-        if (0 == (group->nr_cells % GROUP_REALLOC)) {
-          if (!group->count_cells)
-            group->count_cells = (ID_Count_Mapping *)cl_malloc(GROUP_REALLOC * sizeof(ID_Count_Mapping));
-          else
-            group->count_cells = (ID_Count_Mapping *)cl_realloc(group->count_cells, (GROUP_REALLOC + group->nr_cells) * sizeof(ID_Count_Mapping));
-          assert(group->count_cells);
+  es = extsort_new(compare_group_records, (size_t)MAX(SortMemory, 0) * 1024 * 1024);
+  EvaluationIsRunning = 1;
+  ok = 1;
+  for (i = 0; i < size && ok && EvaluationIsRunning; i++)
+    if (get_group_pair(group, i, pair, &pair[2]))
+      ok = extsort_add(es, pair, 3);
+  if (ok && EvaluationIsRunning)
+    ok = extsort_finish(es);
+
+  if (ok && EvaluationIsRunning) {
+    /* count identical pairs in the sorted records (for document frequencies, once per <within> region) */
+    cells = NULL;
+    nr_nodes = nr_alloc = 0;
+    last_struc = -1;
+    while (EvaluationIsRunning && NULL != (rec = extsort_next(es, &len))) {
+      if (nr_nodes == 0 || rec[0] != cells[nr_nodes-1].s || rec[1] != cells[nr_nodes-1].t) {
+        if (nr_nodes >= nr_alloc) {
+          nr_alloc = 2 * nr_alloc + 1024;
+          cells = (ID_Count_Mapping *)cl_realloc(cells, nr_alloc * sizeof(ID_Count_Mapping));
         }
-
-        group->count_cells[group->nr_cells].s = p1;
-        group->count_cells[group->nr_cells].t = p2;
-        group->count_cells[group->nr_cells].freq = freq;
-        group->count_cells[group->nr_cells].s_freq = 0;
-
-        group->nr_cells = group->nr_cells + 1;
+        cells[nr_nodes].s = rec[0];
+        cells[nr_nodes].t = rec[1];
+        cells[nr_nodes].freq = 0;
+        cells[nr_nodes].s_freq = 0;
+        nr_nodes++;
       }
+      else if (do_within && rec[2] == last_struc)
+        continue;
+      cells[nr_nodes-1].freq++;
+      last_struc = rec[2];
+    }
+
+    /* frequency of each group (source) = sum over all pairs, computed before applying the frequency threshold */
+    for (first = 0; first < nr_nodes; first = k) {
+      s_freq = 0;
+      for (k = first; k < nr_nodes && cells[k].s == cells[first].s; k++)
+        s_freq += cells[k].freq;
+      for (k = first; k < nr_nodes && cells[k].s == cells[first].s; k++)
+        cells[k].s_freq = s_freq;
     }
 
-    if (tokens != EOF)
-      Rprintf("Warning: could not reach EOF of temporary file!\n");
-    pclose(pipe);
+    /* keep pairs above the specified frequency threshold */
+    group->nr_cells = 0;
+    for (k = 0; k < nr_nodes; k++)
+      if (cells[k].freq >= group->cutoff_frequency)
+        cells[group->nr_cells++] = cells[k];
+    group->count_cells = (ID_Count_Mapping *)cl_realloc(cells, (group->nr_cells + 1) * sizeof(ID_Count_Mapping));
+
+    /* now sort entries by decreasing frequency, breaking ties in cl_strcmp() order */
+    compare_cells_group = group;
+    qsort(group->count_cells, group->nr_cells, sizeof(ID_Count_Mapping), compare_cells);
   }
+  extsort_delete(es);
 
-#if GROUP_DEBUG
-  Rprintf("Keeping temporary file %s -- delete manually\n", temporary_name);
-#else
-  if (0 != unlink(temporary_name)) {
-    perror(temporary_name);
-    Rprintf("Can't remove temporary file %s -- \n\tI will continue, but you should remove that file.\n", temporary_name);
+  if (!EvaluationIsRunning) {
+    cqpmessage(Warning, "Group operation aborted.");
+    if (which_app == cqp) install_signal_handler();
+    free_group(&group);
+  }
+  else if (!ok) {
+    cqpmessage(Error, "Group operation on disk failed.");
+    free_group(&group);
   }
-#endif
+  EvaluationIsRunning = 0;
 
   return group;
 }
@@ -554,9 +766,8 @@ Group *compute_grouping(CorpusList *cl,
   group->is_grouped = is_grouped;
   group->within_attribute = within_attr;
 
-  /* External grouping shouldn't exist; backwards compatibility demands it be preserved */
-  if (UseExternalGroup && !insecure && !(source_is_struc || target_is_struc || is_grouped))
-    /* external grouping doesn't support s-attributes and grouped counts */
+  /* very large query results are grouped on disk within the memory budget */
+  if (UseExternalGroup || (size_t)cl->size * 4 * sizeof(int) > (size_t)MAX(SortMemory, 0) * 1024 * 1024)
     return ComputeGroupExternally(group); /* modifies Group object in place and returns pointer */
   else
     return ComputeGroupInternally(group);
@@ -34,6 +34,7 @@
 #include "output.h"
 #include "corpmanag.h"
 #include "concordance.h"
+#include "querycache.h"
 
 
 #define DEFAULT_EXTERNAL_SORTING_COMMAND \
@@ -80,6 +81,7 @@ int tree_debug;                   /**< if true, extra messages are embedded when
 int eval_debug;                   /**< if true, assorted debug messages related to query evaluation are printed */
 int search_debug;                 /**< if true, the evaltree of a pattern is pretty-printed before the DFA is created. */
 int initial_matchlist_debug;      /**< if true, debug messages relating to the initial set of candidate matches are printed. */
+int explain_query;                /**< if true, the query planner prints its estimates and the evaluation order chosen for the initial matchlist. */
 int simulate_debug;               /**< if true, debug messages are printed when simulating an NFA. @see simulate */
 int activate_cl_debug;            /**< if true, the CL's debug message setting is set to On. */
 
@@ -91,6 +93,7 @@ int private_server;               /**< cqpserver option: makes CQPserver accept
 int server_port;                  /**< cqpserver option: CQPserver's listening port (if 0, listens on CQI_PORT) */
 int localhost;                    /**< cqpserver option: accept local connections (loopback) only */
 int server_quit;                  /**< cqpserver option: spawn server and return to caller (for CQI::Server.pm) */
+int shared_server;                /**< cqpserver option: serve all connections from a single process, sharing corpora and caches */
 
 int query_lock;                   /**< cqpserver option: safe mode for network/HTTP servers (allow query execution only) */
 int query_lock_violation;         /**< cqpserver option: set for CQPserver's sake to detect attempted query lock violation */
@@ -144,6 +147,8 @@ char *registry;                   /**< registry directory */
 char *data_directory;            /**< directory where subcorpora are stored (saved & loaded) */
 int auto_save;                    /**< automatically save subcorpora */
 int save_on_exit;                 /**< save unsaved subcorpora upon exit */
+SubcorpusFormat subcorpus_format; /**< file format for saved subcorpora */
+char *subcorpus_format_name;      /**< The subcorpus format option is implemented as this string option with side-effect of setting the actual SubcorpusFormat */
 char *cqp_init_file;              /**< changed from 'init_file' because of clash with a # define in {term.h} */
 char *macro_init_file;            /**< secondary init file for loading macro definitions (not read if macros are disabled) */
 char *cqp_history_file;           /**< filename where CQP command history will be saved */
@@ -156,11 +161,18 @@ int silent;                       /**< Disables some messages & warnings (used r
 char *default_corpus;             /**< corpus specified with -D {corpus} */
 char *query_string;               /**< query specified on command line (-E {string}, cqpcl only) */
 
+/* sorting and grouping */
+int SortMemory;                   /**< memory budget (in MB) for sorting and grouping query results; larger results are sorted on disk */
+int UseExternalSort;              /**< always sort query results on disk (bounded by SortMemory) */
+int UseExternalGroup;             /**< always group query results on disk (bounded by SortMemory) */
+
+/* cache of query results */
+int QueryCacheMemory;             /**< memory budget (in MB) for the cache of query results (0 = no caching) */
+char *QueryCacheDir;              /**< directory where cached query results are saved (NULL = keep them in memory only) */
+
 /* options which just shouldn't exist */
-int UseExternalSort;              /**< (option which should not exist) use external sorting algorithm */
-char *ExternalSortCommand;        /**< (option which should not exist) external sort command to use */
-int UseExternalGroup;             /**< (option which should not exist) use external grouping algorithm */
-char *ExternalGroupCommand;       /**< (option which should not exist) external group command to use */
+char *ExternalSortCommand;        /**< (option which should not exist) external sort command: no longer used, but can still be set (for backwards compatibility) */
+char *ExternalGroupCommand;       /**< (option which should not exist) external group command: no longer used, but can still be set (for backwards compatibility) */
 int user_level;                   /**< user level: no longer has any effect on anything, but can still be set (for backwards compatibility) */
 int output_binary_ranges;         /**< (option which should not exist) print binary cpos pairs instead of concordance. */
 
@@ -187,6 +199,7 @@ CQPOption cqpoptions[] = {
   { NULL, "TreeDebug",            OptBoolean, &tree_debug,             NULL,         0,   NULL,   0,     0 },
   { NULL, "EvalDebug",            OptBoolean, &eval_debug,             NULL,         0,   NULL,   0,     0 },
   { NULL, "InitialMatchlistDebug",OptBoolean, &initial_matchlist_debug,NULL,         0,   NULL,   0,     0 },
+  { NULL, "ExplainQuery",         OptBoolean, &explain_query,          NULL,         0,   NULL,   0,     0 },
   { NULL, "DebugSimulation",      OptBoolean, &simulate_debug,         NULL,         0,   NULL,   0,     0 },
   { NULL, "SearchDebug",          OptBoolean, &search_debug,           NULL,         0,   NULL,   0,     0 },
   { NULL, "ServerLog",            OptBoolean, &server_log,             NULL,         1,   NULL,   0,     0 },
@@ -202,7 +215,7 @@ CQPOption cqpoptions[] = {
   /* "secret" internal options */
   { NULL, "PrintNrMatches",       OptInteger, &printNrMatches,         NULL,         0,   NULL,   0,     0 },
 
-  { "eg", "ExternalGroup",        OptBoolean, &UseExternalGroup,       NULL,         0,   NULL,   0,     0 }, /* should not exist! */
+  { "eg", "ExternalGroup",        OptBoolean, &UseExternalGroup,       NULL,         0,   NULL,   0,     0 },
   { "egc","ExternalGroupCommand", OptString,  &ExternalGroupCommand,   NULL,         0,   NULL,   0,     0 }, /* should not exist! */
   { "lcv","LessCharsetVariable",  OptString,  &less_charset_variable,  "LESSCHARSET",0,   NULL,   0,     0 },
 
@@ -265,13 +278,17 @@ CQPOption cqpoptions[] = {
   { "o",  "Optimize",             OptBoolean, &query_optimize,         NULL,         0,   NULL,   3,     OPTION_VISIBLE_IN_CQP },
   { "ant","AnchorNumberTarget",   OptInteger, &anchor_number_target,   NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
   { "ank","AnchorNumberKeyword",  OptInteger, &anchor_number_keyword,  NULL,         1,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
-  { "es", "ExternalSort",         OptBoolean, &UseExternalSort,        NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP }, /* should not exist! */
+  { "es", "ExternalSort",         OptBoolean, &UseExternalSort,        NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
   { "esc","ExternalSortCommand",  OptString,  &ExternalSortCommand,    NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP }, /* should not exist! */
+  { "sm", "SortMemory",           OptInteger, &SortMemory,             NULL,         1024,NULL,   0,     OPTION_VISIBLE_IN_CQP },
+  { "qcm","QueryCacheMemory",     OptInteger, &QueryCacheMemory,       NULL,         0,   NULL,   5,     OPTION_VISIBLE_IN_CQP },
+  { "qcd","QueryCacheDir",        OptString,  &QueryCacheDir,          NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
   { "da", "DefaultNonbrackAttr",  OptString,  &def_unbr_attr,          CWB_DEFAULT_ATT_NAME,
                                                                                      0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
   { "sub","AutoSubquery",         OptBoolean, &auto_subquery,          NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
   { NULL, "AutoSave",             OptBoolean, &auto_save,              NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
   { NULL, "SaveOnExit",           OptBoolean, &save_on_exit,           NULL,         0,   NULL,   0,     OPTION_VISIBLE_IN_CQP },
+  { "sf", "SubcorpusFormat",      OptString,  &subcorpus_format_name,  "legacy",     0,   NULL,   10,    OPTION_VISIBLE_IN_CQP },
 
   /* empty option to terminate array */
   { NULL, NULL,                   OptString,  NULL,                    NULL,         0,   NULL,   0,     0}
@@ -420,11 +437,12 @@ cqp_usage(void)
     Rprintf("    -P  port     listen on port #<port> [default=CQI_PORT]\n");
     Rprintf("    -L           accept connections from localhost only (loopback)\n");
     Rprintf("    -q           fork() and quit before accepting connections\n");
+    Rprintf("    -o           serve all clients from one process (shared corpora & caches)\n");
   }
   Rprintf("    -d mode      activate/deactivate debug mode, where <mode> is one of: \n");
   Rprintf("       [ ShowSymtab, ShowPatList, ShowEvaltree, ShowDFA, ShowCompDFA,   ]\n");
-  Rprintf("       [ ShowGConstraints, SymtabDebug, TreeDebug, CLDebug,             ]\n");
-  Rprintf("       [ EvalDebug, InitialMatchlistDebug, DebugSimulation,             ]\n");
+  Rprintf("       [ ShowGConstraints, SymtabDebug, TreeDebug, ExplainQuery,        ]\n");
+  Rprintf("       [ EvalDebug, InitialMatchlistDebug, DebugSimulation, CLDebug,    ]\n");
   Rprintf("       [ VerboseParser, ParserDebug, ParseOnly, SearchDebug, MacroDebug ]\n");
   if (which_app == cqpserver)
     Rprintf("       [ ServerLog [on], ServerDebug, Snoop (log all network traffic)   ]\n");
@@ -645,9 +663,11 @@ set_default_option_values(void)
   private_server = 0;
   server_port = 0;
   server_quit = 0;
+  shared_server = 0;
   localhost = 0;
 
   matching_strategy = standard_match;  /* unfortunately, this is not automatically derived from the defaults */
+  subcorpus_format = SubcorpusLegacy;  /* same here */
 
   tested_pager = NULL;                 /* this will be set to the PAGER command if that can be successfully run */
 
@@ -745,7 +765,9 @@ execute_side_effects(int opt)
     cl_set_debug_level(activate_cl_debug); /* enable / disable CL debugging */
     break;
 
-    /* slot 5 is free */
+  case 5:  /* set QueryCacheMemory <n>; */
+    query_cache_trim(); /* discard query results exceeding the new memory budget */
+    break;
 
   case 6:  /* set PrintMode (ascii | sgml | html | latex); */
     if (!printModeString || cl_streq_ci(printModeString, "ascii"))
@@ -786,6 +808,21 @@ execute_side_effects(int opt)
       matching_strategy = code;
     break;
 
+  case 10: /* set SubcorpusFormat ( legacy | binary | compressed ); */
+    if (!subcorpus_format_name || cl_streq_ci(subcorpus_format_name, "legacy"))
+      subcorpus_format = SubcorpusLegacy;
+    else if (cl_streq_ci(subcorpus_format_name, "binary"))
+      subcorpus_format = SubcorpusBinary;
+    else if (cl_streq_ci(subcorpus_format_name, "compressed"))
+      subcorpus_format = SubcorpusCompressed;
+    else {
+      cqpmessage(Error, "USAGE: set SubcorpusFormat (legacy | binary | compressed);\n(Invalid format given, defaulting to legacy)");
+      subcorpus_format = SubcorpusLegacy;
+      cl_free(subcorpus_format_name);
+      subcorpus_format_name = cl_strdup("legacy");
+    }
+    break;
+
   default:
 #ifndef R_PACKAGE
     Rprintf("Unknown side-effect #%d invoked by option %s.\n", cqpoptions[opt].side_effect, cqpoptions[opt].opt_name);
@@ -853,7 +890,8 @@ set_string_option_value(const char *opt_name, char *value)
 
   /* if it's a filesystem path, then store a canonical path instead of what we got passed;
    * everything else gets stored unmodified. */
-  if (cl_str_is(cqpoptions[opt].opt_name, "Registry") || cl_str_is(cqpoptions[opt].opt_name, "LocalCorpusDirectory") || cl_str_is(cqpoptions[opt].opt_name, "DataDirectory")) {
+  if (cl_str_is(cqpoptions[opt].opt_name, "Registry") || cl_str_is(cqpoptions[opt].opt_name, "LocalCorpusDirectory") || cl_str_is(cqpoptions[opt].opt_name, "DataDirectory")
+      || cl_str_is(cqpoptions[opt].opt_name, "QueryCacheDir")) {
     *((char **)cqpoptions[opt].address) = expand_filename(value);
     cl_free(value);
   }
@@ -991,7 +1029,7 @@ impose_silent_options(void)
     tree_debug              = eval_debug     = search_debug      =
     initial_matchlist_debug = simulate_debug = macro_debug       =
     activate_cl_debug       = server_debug   = server_log        =
-    snoop                   = False;
+    snoop                   = explain_query  = False;
   cl_set_debug_level(0);
 }
 
@@ -1046,7 +1084,7 @@ parse_options(int ac, char *av[])
     valid_options = "+b:cd:D:E:FhiI:l:L:mM:r:R:sSvW:x";
     break;
   case cqpserver:
-    valid_options = "+1b:d:D:FhI:l:LmM:P:qr:Svx";
+    valid_options = "+1b:d:D:FhI:l:LmM:oP:qr:Svx";
     break;
   default:
     cqp_usage();
@@ -1064,6 +1102,10 @@ parse_options(int ac, char *av[])
       server_quit = 1;
       break;
 
+    case 'o':
+      shared_server = 1;
+      break;
+
     case 'x':
       insecure = 1;
       break;
@@ -1136,7 +1178,7 @@ parse_options(int ac, char *av[])
           verbose_parser = show_symtab = show_gconstraints =
             show_evaltree = show_patlist = show_dfa = show_compdfa =
             symtab_debug = parser_debug = eval_debug =
-            initial_matchlist_debug = simulate_debug =
+            initial_matchlist_debug = explain_query = simulate_debug =
             search_debug = macro_debug = activate_cl_debug =
             server_debug = server_log = snoop = True;
           /* execute side effect for CLDebug option */
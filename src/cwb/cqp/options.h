@@ -58,6 +58,7 @@ extern int tree_debug;
 extern int eval_debug;
 extern int search_debug;
 extern int initial_matchlist_debug;
+extern int explain_query;
 extern int simulate_debug;
 extern int activate_cl_debug;
 
@@ -69,6 +70,7 @@ extern int private_server;
 extern int server_port;
 extern int localhost;
 extern int server_quit;
+extern int shared_server;
 
 extern int query_lock;
 extern int query_lock_violation;
@@ -121,6 +123,8 @@ extern char *registry;
 extern char *data_directory;
 extern int auto_save;
 extern int save_on_exit;
+extern SubcorpusFormat subcorpus_format;
+extern char *subcorpus_format_name;
 extern char *cqp_init_file;
 extern char *macro_init_file;
 extern char *cqp_history_file;
@@ -132,10 +136,17 @@ extern int silent;
 extern char *default_corpus;
 extern char *query_string;
 
-/* options which just shouldn't exist */
+/* sorting and grouping */
+extern int SortMemory;
 extern int UseExternalSort;
-extern char *ExternalSortCommand;
 extern int UseExternalGroup;
+
+/* cache of query results */
+extern int QueryCacheMemory;
+extern char *QueryCacheDir;
+
+/* options which just shouldn't exist */
+extern char *ExternalSortCommand;
 extern char *ExternalGroupCommand;
 extern int user_level;
 extern int output_binary_ranges;
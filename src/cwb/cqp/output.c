@@ -49,6 +49,11 @@
 /** Global list of tabulation items for use with the "tabulate" operator */
 TabulationItem TabulationList = NULL;
 
+/** If set (in a thread evaluating part of a query), cqpmessage() counts messages in cqpmessage_held instead of printing them */
+CL_THREAD_LOCAL int cqpmessage_hold = 0;
+/** Number of messages held back by cqpmessage() in this thread */
+CL_THREAD_LOCAL int cqpmessage_held = 0;
+
 
 /* stupid Solaris doesn't have setenv() function, so we need to emulate it with putenv() */
 #ifdef EMULATE_SETENV
@@ -547,6 +552,8 @@ cat_listed_corpus(CorpusList *cl,
 /**
  * Print a message to output (for instance a debug message).
  *
+ * In threads that set cqpmessage_hold, messages are only counted (in cqpmessage_held).
+ *
  * @see           MessageType
  * @param type    Specifies what type of message (messages of some types are not always printed)
  * @param format  Format string (and ...) are passed as arguments to vfprintf().
@@ -557,6 +564,11 @@ cqpmessage(MessageType type, const char *format, ...)
   char *msg;
   va_list ap;
 
+  if (cqpmessage_hold) {
+    cqpmessage_held++;
+    return;
+  }
+
   va_start(ap, format);
 
   /* do not print messages of level Message, unless the parser is in verbose mode */
@@ -922,3 +934,136 @@ print_tabulation(CorpusList *cl, int first, int last, struct Redir *dst)
   return 1;
 }
 
+
+
+/** Data shared by the workers of tabulate_columns(). */
+typedef struct {
+  CorpusList *cl;
+  TabulationItem *items;        /**< the tabulation items (one per column) */
+  int **columns;                /**< the columns to fill in */
+  int *read_error;              /**< flag of each column: the data of its attribute could not be read */
+  int nr_items;
+} TabulateColumnsData;
+
+/**
+ * Worker of tabulate_columns(): fills in every n_threads-th column, starting with column thread.
+ */
+static void
+tabulate_columns_worker(int thread, int n_threads, void *data)
+{
+  TabulateColumnsData *td = (TabulateColumnsData *)data;
+  CorpusList *cl = td->cl;
+  TabulationItem item;
+  int *column;
+  int i, n, cpos;
+
+  for (i = thread; i < td->nr_items; i += n_threads) {
+    item = td->items[i];
+    column = td->columns[i];
+
+    for (n = 0; n < cl->size; n++) {
+      cpos = pt_get_anchor_cpos(cl, n, item->anchor1, item->offset1);
+      column[n] = (cpos >= 0 && cpos < cl->mother_size) ? cpos : CDA_CPOSUNDEF;
+    }
+
+    if (item->attribute_type == ATT_POS) {
+      /* decode the whole column at once (in place: positions out of range yield an error code) */
+      if (cl_cpos2id_list(item->attribute, column, cl->size, column) < 0) {
+        td->read_error[i] = 1;  /* reported by tabulate_columns() */
+        for (n = 0; n < cl->size; n++)
+          column[n] = CDA_CPOSUNDEF;
+      }
+      for (n = 0; n < cl->size; n++)
+        if (column[n] < 0)
+          column[n] = CDA_CPOSUNDEF;
+    }
+    else if (item->attribute_type == ATT_STRUC) {
+      for (n = 0; n < cl->size; n++)
+        if (column[n] != CDA_CPOSUNDEF && (column[n] = cl_cpos2struc(item->attribute, column[n])) < 0)
+          column[n] = CDA_CPOSUNDEF;
+    }
+  }
+}
+
+/**
+ * Tabulates a query result as columns of integers, without formatting any text.
+ *
+ * Each tabulation item defines one column with one value per match (in the sort
+ * order of the query result): the corpus position given by anchor1 and offset1
+ * (attribute_name NULL), the ID of the token at that position (p-attribute) or
+ * the number of the region containing it (s-attribute). Where the anchor is not
+ * set, the position is outside the corpus or not in a region, the value is
+ * CDA_CPOSUNDEF. The anchor2 and offset2 fields of the items are ignored.
+ *
+ * The columns are filled in by several threads (one column per thread).
+ *
+ * @param cl        The query result to tabulate.
+ * @param items     Linked list of tabulation items (not the global TabulationList).
+ * @param columns   One array of cl->size integers per tabulation item, which is filled in.
+ * @return          Boolean: true if tabulation was successful (otherwise, generates error message).
+ */
+int
+tabulate_columns(CorpusList *cl, TabulationItem items, int **columns)
+{
+  TabulateColumnsData td;
+  TabulationItem item;
+  int i;
+
+  if (!cl)
+    return 0;
+
+  td.cl = cl;
+  td.columns = columns;
+  td.nr_items = 0;
+  for (item = items ; item ; item = item->next)
+    td.nr_items++;
+  if (td.nr_items == 0)
+    return 1;
+  td.items = (TabulationItem *)cl_malloc(td.nr_items * sizeof(TabulationItem));
+
+  /* obtain attribute handles and load their data before the workers are started */
+  for (item = items, i = 0 ; item ; item = item->next, i++) {
+    td.items[i] = item;
+    if (item->attribute_name) {
+      if (NULL != (item->attribute = cl_new_attribute(cl->corpus, item->attribute_name, ATT_POS))) {
+        item->attribute_type = ATT_POS;
+        cl_cpos2id(item->attribute, 0);
+      }
+      else if (NULL != (item->attribute = cl_new_attribute(cl->corpus, item->attribute_name, ATT_STRUC))) {
+        item->attribute_type = ATT_STRUC;
+        cl_cpos2struc(item->attribute, 0);
+      }
+      else {
+        cqpmessage(Error, "Can't find attribute ``%s'' for named query %s", item->attribute_name, cl->name);
+        cl_free(td.items);
+        return 0;
+      }
+      if (!cl_all_ok() && cl_errno != CDA_ESTRUC) {
+        cqpmessage(Error, "Can't access attribute ``%s'' for named query %s", item->attribute_name, cl->name);
+        cl_free(td.items);
+        return 0;
+      }
+    }
+    else
+      item->attribute_type = ATT_NONE;
+
+    if (cl->size > 0 && !pt_validate_anchor(cl, item->anchor1)) {
+      cl_free(td.items);
+      return 0;
+    }
+  }
+
+  td.read_error = (int *)cl_calloc(td.nr_items, sizeof(int));
+  if (cl->size > 0)
+    cl_parallel(tabulate_columns_worker, MIN(td.nr_items, cl_get_threads()), &td);
+
+  /* the threads must not print, so errors of the CL are reported here */
+  for (i = 0; i < td.nr_items; i++)
+    if (td.read_error[i])
+      cqpmessage(Warning, "Can't read the data of attribute ``%s'' for named query %s (values undefined)",
+                 td.items[i]->attribute_name, cl->name);
+
+  cl_free(td.read_error);
+  cl_free(td.items);
+  return 1;
+}
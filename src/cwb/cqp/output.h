@@ -112,6 +112,9 @@ typedef enum _msgtype {
 
 void cqpmessage(MessageType type, const char *format, ...);
 
+extern CL_THREAD_LOCAL int cqpmessage_hold;
+extern CL_THREAD_LOCAL int cqpmessage_held;
+
 void print_corpus_info_header(CorpusList *cl,
                               FILE *stream,
                               PrintMode mode,
@@ -127,4 +130,6 @@ void append_tabulation_item(TabulationItem item);
 
 int print_tabulation(CorpusList *cl, int first, int last, struct Redir *rd);
 
+int tabulate_columns(CorpusList *cl, TabulationItem items, int **columns);
+
 #endif
@@ -52,6 +52,7 @@
 #include "output.h"
 #include "print-modes.h"
 #include "variables.h"
+#include "prepared.h"
 
 /* ======================================== GLOBAL PARSER VARIABLES */
 
@@ -605,8 +606,8 @@ do_translate(CorpusList *source, char *target_name)
 {
   CorpusList *res, *target;
   Attribute *alignment;
-  int i, n, bead;
-  int s1, s2, t1, t2;
+  int i, n;
+  int *cpos, *beads, *s1, *s2, *t1, *t2;
 
   if (generate_code) {
     assert(source);
@@ -631,18 +632,35 @@ do_translate(CorpusList *source, char *target_name)
     cl_free(res->targets);   /* make sure there are no spurious target / keywords vectors */
     cl_free(res->keywords);
 
-    /* translate each matching range into target bead */
-    for (i = 0; i < n; i++) {
-      bead = cl_cpos2alg(alignment, source->range[i].start);
-      if (bead < 0 ||
-          !cl_alg2cpos(alignment, bead, &s1, &s2, &t1, &t2) ||
-          !cl_all_ok()) {
-        res->range[i].start = -1;
-      }
-      else {
-        res->range[i].start = t1;
-        res->range[i].end = t2;
+    /* translate each matching range into target bead (ranges are sorted, so bulk lookup is fast) */
+    if (n > 0) {
+      cpos = (int *)cl_malloc(n * sizeof(int));
+      beads = (int *)cl_malloc(n * sizeof(int));
+      s1 = (int *)cl_malloc(n * sizeof(int));
+      s2 = (int *)cl_malloc(n * sizeof(int));
+      t1 = (int *)cl_malloc(n * sizeof(int));
+      t2 = (int *)cl_malloc(n * sizeof(int));
+      for (i = 0; i < n; i++)
+        cpos[i] = source->range[i].start;
+      if (cl_cpos2alg_list(alignment, cpos, n, beads) < 0 ||
+          cl_alg2cpos_list(alignment, beads, n, s1, s2, t1, t2) < 0) {
+        for (i = 0; i < n; i++)
+          t1[i] = -1;
+      }
+      for (i = 0; i < n; i++) {
+        if (t1[i] < 0)
+          res->range[i].start = -1;
+        else {
+          res->range[i].start = t1[i];
+          res->range[i].end = t2[i];
+        }
       }
+      cl_free(cpos);
+      cl_free(beads);
+      cl_free(s1);
+      cl_free(s2);
+      cl_free(t1);
+      cl_free(t2);
     }
 
     /* remove unaligned items (but not duplicates) */
@@ -847,8 +865,10 @@ do_delete_lines_num(CorpusList *cl, int start, int end)
     Bitfield lines = create_bitfield(cl->size);
     assert(lines);
 
-    for ( ; start <= end && start < cl->size; start++)
-      set_bit(lines, start);
+    if (end >= cl->size)
+      end = cl->size - 1;
+    if (start <= end)
+      set_bit_range(lines, start, end);
     if (nr_bits_set(lines) > 0)
       delete_intervals(cl, lines, SELECTED_LINES);
 
@@ -1096,6 +1116,34 @@ do_StandardQuery(int cut_value, int keep_flag, char *modifier)
   if (parse_only || !generate_code)
     return NULL;
 
+  /* a prepared query keeps the compiled environment instead of running it */
+  if (preparing_query) {
+    prepared_query_capture(cut_value, keep_flag);
+    cl_free(searchstr);
+    return NULL;
+  }
+
+  result = run_StandardQuery(cut_value, keep_flag);
+
+  cl_free(searchstr);
+
+  return result;
+}
+
+/**
+ * Evaluates the standard query compiled into Environment[0].
+ *
+ * This is the second half of do_StandardQuery(), which is also used to run prepared queries.
+ *
+ * @param cut_value  Maximum number of matches (0 = all).
+ * @param keep_flag  Boolean: keep the ranges of the query corpus.
+ * @return           CorpusList object for the result (NULL if there is no query to run).
+ */
+CorpusList *
+run_StandardQuery(int cut_value, int keep_flag)
+{
+  CorpusList *result = NULL;
+
   if (Environment[0].evaltree) {
     debug_output();
     do_start_timer();
@@ -1109,35 +1157,19 @@ do_StandardQuery(int cut_value, int keep_flag, char *modifier)
 
     result = Environment[0].query_corpus;
 
-    /* the new matching strategies require post-processing of the query result */
-    switch (Environment[0].matching_strategy) {
-
-    case shortest_match:
-      apply_range_set_operation(result, RMinimalMatches, NULL, NULL);         /* select shortest from several nested matches */
-      break;
-
-    case standard_match:
-      apply_range_set_operation(result, RLeftMaximalMatches, NULL, NULL);     /* reduce multiple matches created by optional query prefix */
-      break;
-
-    case longest_match:
-      apply_range_set_operation(result, RMaximalMatches, NULL, NULL);         /* select longest from several nested matches */
-      break;
-
-    case traditional:
-    default:
-      /* nothing to do here */
-      break;
-    }
+    /* the new matching strategies require post-processing of the query result
+     * (which is left to the caller if the range of start positions is restricted, see query_start_strategy) */
+    if (query_start_max >= 0)
+      query_start_strategy = Environment[0].matching_strategy;
+    else
+      apply_matching_strategy(result, Environment[0].matching_strategy);
 
     /* if there's a cut_value, we may need to reduce the result to <cut_value> matches */
     if (0 < cut_value) {
       /* if there is more than 1 initial pattern in the query, it may have returned more than <cut_value> matches */
       if (result->size > cut_value) {
         Bitfield lines = create_bitfield(result->size);
-        int i;
-        for (i = 0; i < cut_value; i++)
-          set_bit(lines, i);
+        set_bit_range(lines, 0, cut_value - 1);
         if (!delete_intervals(result, lines, UNSELECTED_LINES))
           cqpmessage(Error, "Couldn't reduce query result to first %d matches.\n", cut_value);
         destroy_bitfield(&lines);
@@ -1146,8 +1178,6 @@ do_StandardQuery(int cut_value, int keep_flag, char *modifier)
 
   } /* end of "if Environment[0] has an evaltre"e. */
 
-  cl_free(searchstr);
-
   return result;
 }
 
@@ -1174,6 +1204,8 @@ do_MUQuery(Evaltree evalt, int keep_flag, int cut_value)
     assert(CurEnv == &Environment[0]);
     CurEnv->evaltree = evalt;
     assert(evalt->type == meet_union || evalt->type == leaf);
+    if (preparing_query)
+      return NULL; /* only standard queries can be prepared */
 
     debug_output();
     do_start_timer();
@@ -1739,6 +1771,31 @@ OptimizeStringConstraint(Constrainttree left, enum b_ops op, Constrainttree righ
 {
   Constrainttree c = NULL;
 
+  /* a parameter of a prepared query becomes a placeholder, which is compiled for the arguments when the query is executed */
+  if (preparing_query && right->type == string_leaf && right->leaf.ctype.sconst && right->leaf.ctype.sconst[0] == PREPARED_QUERY_MARK) {
+    long param;
+
+    NEW_BNODE(c);
+    c->type = id_list;
+    c->idlist.attr = left->pa_ref.attr;
+    c->idlist.label = left->pa_ref.label;
+    c->idlist.del = left->pa_ref.del;
+    c->idlist.negated = (op == cmp_eq ? 0 : 1);
+    c->idlist.nr_items = 0;
+    c->idlist.items = NULL;
+    param = strtol(right->leaf.ctype.sconst + 1, NULL, 10);
+    c->idlist.param = (param >= 1 && param <= PREPARED_QUERY_MAX_PARAMS) ? (int)param : 0;
+    c->idlist.flags = right->leaf.canon;
+    if (!prepared_query_use_param(c->idlist.param)) {
+      cqpmessage(Error, "Invalid parameter in prepared query");
+      generate_code = 0;
+    }
+
+    cl_free(left);
+    free_booltree(right);
+    return c;
+  }
+
   if (right->type == cnode) {
     cl_free(left);
     c = right;
@@ -1784,6 +1841,8 @@ OptimizeStringConstraint(Constrainttree left, enum b_ops op, Constrainttree righ
           c->idlist.attr = left->pa_ref.attr;
           c->idlist.label = left->pa_ref.label;
           c->idlist.del = left->pa_ref.del;
+          c->idlist.param = 0;
+          c->idlist.flags = 0;
 
           c->idlist.nr_items = nr_items;
           c->idlist.items = items;
@@ -1958,6 +2017,8 @@ Varref2IDList(Attribute *attr, enum b_ops op, char *var_name)
       node->idlist.attr = attr;
       node->idlist.label = NULL;
       node->idlist.del = 0;
+      node->idlist.param = 0;
+      node->idlist.flags = 0;
       node->idlist.negated = (op == cmp_eq ? 0 : 1);
       node->idlist.items = GetVariableItems(v, query_corpus->corpus, attr, &(node->idlist.nr_items));
 
@@ -2843,6 +2904,8 @@ do_TABQuery(Evaltree patterns)
   assert(CurEnv == &Environment[0]);
   CurEnv->evaltree = patterns;
   assert(patterns->type == tabular);
+  if (preparing_query)
+    return NULL; /* only standard queries can be prepared */
   debug_output();
 
   do_start_timer();
@@ -139,6 +139,8 @@ void do_group_nosource(CorpusList *cl,
 
 CorpusList *do_StandardQuery(int cut_value, int keep_flag, char *modifier);
 
+CorpusList *run_StandardQuery(int cut_value, int keep_flag);
+
 CorpusList *do_MUQuery(Evaltree evalt, int keep_flag, int cut_value);
 
 void do_SearchPattern(Evaltree expr, Constrainttree constraint);
@@ -191,6 +193,8 @@ Constrainttree do_flagged_re_variable(char *varname, int flags);
 
 Constrainttree do_flagged_string(char *s, int flags);
 
+Constrainttree OptimizeStringConstraint(Constrainttree left, enum b_ops op, Constrainttree right);
+
 Constrainttree do_feature_set_string(char *s, int op, int flags);
 
 Constrainttree do_FunctionCall(char *f_name, ActualParamList *apl);
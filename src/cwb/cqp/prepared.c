@@ -0,0 +1,510 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "../cl/cl.h"
+#include "../cl/cwb-globals.h"
+
+#include "cqp.h"
+#include "options.h"
+#include "corpmanag.h"
+#include "ranges.h"
+#include "eval.h"
+#include "tree.h"
+#include "treemacros.h"
+#include "regex2dfa.h"
+#include "parse_actions.h"
+#include "querycache.h"
+#include "prepared.h"
+
+/** Offset of the pattern list in an EvalEnvironment */
+#define ENV_PATTERNS offsetof(EvalEnvironment, patternlist)
+/** Offset of the first member after the pattern list in an EvalEnvironment */
+#define ENV_TAIL (offsetof(EvalEnvironment, patternlist) + sizeof(Patternlist))
+
+/** The query being prepared while the template is parsed (NULL otherwise) */
+PreparedQuery *preparing_query = NULL;
+
+/** Which parameters of the query being prepared have been found in a comparison */
+static char *params_used = NULL;
+
+/** Set if the query being prepared cannot be compiled into a template */
+static int prepare_failed = 0;
+
+
+/**
+ * Substitutes the parameters ?1, ?2, ... in a query template.
+ *
+ * Without arguments, each parameter is replaced by a string that holds PREPARED_QUERY_MARK
+ * and the number of the parameter, so that the parser can recognise it. With arguments, the
+ * parameters are replaced by the quoted arguments; this text is used for the query cache and
+ * as the query text of the result.
+ *
+ * @param query     The query template.
+ * @param args      The arguments, or NULL.
+ * @param n_params  Number of arguments; without arguments, set to the highest parameter number.
+ * @return          The new query text (to be freed by the caller), or NULL if the template contains
+ *                  an invalid parameter (or a parameter number above PREPARED_QUERY_MAX_PARAMS or
+ *                  n_params) or an argument cannot be quoted.
+ */
+static char *
+prepared_query_substitute(char *query, char **args, int *n_params)
+{
+  char *text, *p, *q, *end, quote = 0;
+  size_t len, arg_len = 2;
+  long number;
+  int i, n, max = 0;
+
+  if (args)
+    for (i = 0; i < *n_params; i++) {
+      /* the lexer would unescape doubled quotes and could not handle a trailing backslash */
+      n = strlen(args[i]);
+      if (strpbrk(args[i], "\"\r\n"))
+        return NULL;
+      for (end = args[i] + n; end > args[i] && end[-1] == '\\'; end--)
+        ;
+      if ((args[i] + n - end) % 2)
+        return NULL;
+      if (n + 2 > arg_len)
+        arg_len = n + 2;
+    }
+
+  len = strlen(query);
+  p = text = (char *)cl_malloc(len + (len / 2 + 1) * (arg_len + 2) + 1);
+
+  for (q = query; *q; q++) {
+    if (*q == PREPARED_QUERY_MARK) {
+      cl_free(text);
+      return NULL;
+    }
+    else if (quote) {
+      *p++ = *q;
+      if (*q == '\\' && q[1])
+        *p++ = *++q;
+      else if (*q == quote)
+        quote = 0;
+    }
+    else if (*q == '"' || *q == '\'') {
+      quote = *q;
+      *p++ = *q;
+    }
+    else if (*q == '?' && q[1] >= '1' && q[1] <= '9') {
+      number = strtol(q + 1, &end, 10);
+      if (number < 1 || number > PREPARED_QUERY_MAX_PARAMS || (args && number > *n_params)) {
+        cl_free(text);
+        return NULL;
+      }
+      n = (int)number;
+      if (args)
+        p += sprintf(p, "\"%s\"", args[n - 1]);
+      else
+        p += sprintf(p, "\"%c%d\"", PREPARED_QUERY_MARK, n);
+      if (n > max)
+        max = n;
+      q = end - 1;
+    }
+    else
+      *p++ = *q;
+  }
+  *p = '\0';
+
+  if (!args)
+    *n_params = max;
+  return text;
+}
+
+/** Adds the parameter slots in a constraint tree to the query being prepared. */
+static void
+prepared_query_collect_slots(Constrainttree ctptr)
+{
+  PreparedQuery *pq = preparing_query;
+  PreparedSlot *slot;
+  ActualParamList *arg;
+
+  if (!ctptr)
+    return;
+
+  switch (ctptr->type) {
+  case bnode:
+    prepared_query_collect_slots(ctptr->node.left);
+    prepared_query_collect_slots(ctptr->node.right);
+    break;
+
+  case func:
+    for (arg = ctptr->func.args; arg; arg = arg->next)
+      prepared_query_collect_slots(arg->param);
+    break;
+
+  case id_list:
+    if (ctptr->idlist.param) {
+      pq->slots = (PreparedSlot *)cl_realloc(pq->slots, (pq->n_slots + 1) * sizeof(PreparedSlot));
+      slot = &pq->slots[pq->n_slots++];
+      slot->node = ctptr;
+      slot->attr = ctptr->idlist.attr;
+      slot->label = ctptr->idlist.label;
+      slot->del = ctptr->idlist.del;
+      slot->param = ctptr->idlist.param;
+      slot->flags = ctptr->idlist.flags;
+      slot->negated = ctptr->idlist.negated;
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**
+ * Copies an evaluation environment into a prepared query.
+ *
+ * The pattern list makes up most of an EvalEnvironment, so only the entries in use are kept.
+ */
+static void
+prepared_query_save_env(PreparedQuery *pq, EvalEnvironment *env)
+{
+  size_t patterns = pq->n_patterns * sizeof(AVStructure);
+
+  if (!pq->env)
+    pq->env = (char *)cl_malloc(ENV_PATTERNS + patterns + sizeof(EvalEnvironment) - ENV_TAIL);
+  memcpy(pq->env, env, ENV_PATTERNS + patterns);
+  memcpy(pq->env + ENV_PATTERNS + patterns, (char *)env + ENV_TAIL, sizeof(EvalEnvironment) - ENV_TAIL);
+}
+
+/** Copies the evaluation environment of a prepared query back into env. */
+static void
+prepared_query_restore_env(PreparedQuery *pq, EvalEnvironment *env)
+{
+  size_t patterns = pq->n_patterns * sizeof(AVStructure);
+
+  memcpy(env, pq->env, ENV_PATTERNS + patterns);
+  memcpy((char *)env + ENV_TAIL, pq->env + ENV_PATTERNS + patterns, sizeof(EvalEnvironment) - ENV_TAIL);
+}
+
+/** Detaches the compiled query from env, which can then be freed without affecting the prepared query. */
+static void
+prepared_query_clear_env(EvalEnvironment *env)
+{
+  env->labels = NULL;
+  env->MaxPatIndex = -1;
+  env->gconstraint = NULL;
+  env->evaltree = NULL;
+  init_dfa(&env->dfa);
+}
+
+/**
+ * Marks a parameter as used in the query being prepared (called by the parser).
+ *
+ * @param param  Number of the parameter.
+ * @return       Boolean: true if the parameter is valid (1 ... n_params); otherwise, the
+ *               query cannot be prepared.
+ */
+int
+prepared_query_use_param(int param)
+{
+  if (!preparing_query || param < 1 || param > preparing_query->n_params) {
+    prepare_failed = 1;
+    return 0;
+  }
+  params_used[param] = 1;
+  return 1;
+}
+
+/**
+ * Takes over the compiled query from Environment[0] (called by do_StandardQuery()).
+ *
+ * @param cut   The cut value of the query.
+ * @param keep  Boolean: keep ranges of the query corpus.
+ */
+void
+prepared_query_capture(int cut, int keep)
+{
+  PreparedQuery *pq = preparing_query;
+  EvalEnvironment *env = &Environment[0];
+  int i;
+
+  if (!pq || pq->env || ee_ix != 0 || !env->evaltree) {
+    prepare_failed = 1;
+    return;
+  }
+
+  for (i = 0; i <= env->MaxPatIndex; i++) {
+    if (env->patternlist[i].type == Region && env->patternlist[i].region.nqr) {
+      cqpmessage(Error, "Named query results (<<%s>>) can't be used in prepared queries.", env->patternlist[i].region.name);
+      prepare_failed = 1;
+      return;
+    }
+    if (env->patternlist[i].type == Pattern)
+      prepared_query_collect_slots(env->patternlist[i].con.constraint);
+  }
+  prepared_query_collect_slots(env->gconstraint);
+
+  pq->cut = cut;
+  pq->keep = keep;
+  pq->n_patterns = env->MaxPatIndex + 1;
+  query_corpus = env->query_corpus;
+  env->query_corpus = NULL;
+  prepared_query_save_env(pq, env);
+  prepared_query_clear_env(env);
+  env->query_corpus = query_corpus; /* still needed by the parser (expand to ...) */
+}
+
+/**
+ * Compiles a query template.
+ *
+ * @param cl     The corpus (or subcorpus) the query will be run on.
+ * @param query  The query template, a standard query with parameters ?1, ?2, ...
+ * @return       The prepared query, or NULL if the template cannot be compiled.
+ */
+PreparedQuery *
+prepare_query(CorpusList *cl, char *query)
+{
+  PreparedQuery *pq;
+  char *text;
+  int i, n_params, ok;
+
+  if (preparing_query)
+    return NULL;
+  if (!cl || !access_corpus(cl)) {
+    cqpmessage(Error, "Corpus can't be accessed");
+    return NULL;
+  }
+  /* the parser runs every command of the template, so these must not include others */
+  if (!query_cache_single_command(query)) {
+    cqpmessage(Error, "Query template must be a single query");
+    return NULL;
+  }
+  if (!(text = prepared_query_substitute(query, NULL, &n_params))) {
+    cqpmessage(Error, "Query template contains an invalid character or parameter");
+    return NULL;
+  }
+
+  pq = (PreparedQuery *)cl_calloc(1, sizeof(PreparedQuery));
+  pq->query = cl_strdup(query);
+  pq->corpus_name = cl_strdup(cl->corpus->registry_name);
+  pq->registry = cl_strdup(cl->corpus->registry_dir);
+  pq->corpus_serial = cl->corpus->serial;
+  pq->n_params = n_params;
+
+  params_used = (char *)cl_calloc(n_params + 1, 1);
+  prepare_failed = 0;
+
+  set_current_corpus(cl, 0);
+  preparing_query = pq;
+  ok = cqp_parse_string(text);
+  preparing_query = NULL;
+  pq->expansion = expansion;
+  free_all_environments();
+  drop_temp_corpora();
+  query_corpus = NULL;
+  cl_free(text);
+
+  if (!ok || prepare_failed || !pq->env) {
+    if (ok && !prepare_failed)
+      cqpmessage(Error, "Only standard queries can be prepared");
+    ok = 0;
+  }
+  else {
+    for (i = 1; i <= n_params; i++)
+      if (!params_used[i]) {
+        cqpmessage(Error, "Parameter ?%d must be compared with a positional attribute, e.g. [word = ?%d]", i, i);
+        ok = 0;
+        break;
+      }
+  }
+  cl_free(params_used);
+
+  if (!ok)
+    free_prepared_query(&pq);
+  return pq;
+}
+
+/**
+ * Compiles the comparisons with parameters of a prepared query for the given arguments.
+ *
+ * Each comparison is optimised in the same way as in a query where the argument is given as a
+ * string (into a lexicon ID, an ID list or a regular expression).
+ */
+static int
+prepared_query_bind(PreparedQuery *pq, char **args)
+{
+  PreparedSlot *slot;
+  Constrainttree left, right, c;
+  int i;
+
+  generate_code = 1;
+
+  for (i = 0; i < pq->n_slots; i++) {
+    slot = &pq->slots[i];
+    if (slot->param < 1 || slot->param > pq->n_params)
+      return 0;
+
+    /* discard the comparison compiled for the previous arguments */
+    NEW_BNODE(c);
+    *c = *slot->node;
+    free_booltree(c);
+    slot->node->type = cnode;
+    slot->node->constnode.val = 0;
+
+    if (!(right = do_flagged_string(cl_strdup(args[slot->param - 1]), slot->flags)))
+      return 0;
+
+    NEW_BNODE(left);
+    left->type = pa_ref;
+    left->pa_ref.attr = slot->attr;
+    left->pa_ref.label = slot->label;
+    left->pa_ref.del = slot->del;
+
+    c = OptimizeStringConstraint(left, slot->negated ? cmp_neq : cmp_eq, right);
+    *slot->node = *c;
+    cl_free(c);
+  }
+
+  return generate_code;
+}
+
+/**
+ * Runs a prepared query.
+ *
+ * @param pq         The prepared query.
+ * @param cl         The corpus (or subcorpus) to query; must belong to the corpus the query was prepared for
+ *                   (which must not have been reloaded since).
+ * @param args       The arguments for the parameters ?1, ?2, ...
+ * @param n_args     Number of arguments.
+ * @param subcorpus  Name of the subcorpus for the query result.
+ * @return           The query result, or NULL for error.
+ */
+CorpusList *
+execute_prepared_query(PreparedQuery *pq, CorpusList *cl, char **args, int n_args, char *subcorpus)
+{
+  CorpusList *result = NULL;
+  char *text, *key;
+  int i, size_before;
+
+  if (!pq || !pq->env)
+    return NULL;
+  if (n_args != pq->n_params) {
+    cqpmessage(Error, "Prepared query needs %d argument(s), %d given", pq->n_params, n_args);
+    return NULL;
+  }
+  /* the compiled query refers to the attributes of the corpus, which are freed if the corpus is unloaded */
+  if (!cl || !access_corpus(cl) || strcmp(cl->corpus->registry_name, pq->corpus_name)
+      || strcmp(cl->corpus->registry_dir, pq->registry)) {
+    cqpmessage(Error, "Prepared query can only be run on the corpus it was prepared for");
+    return NULL;
+  }
+  if (cl->corpus->serial != pq->corpus_serial) {
+    cqpmessage(Error, "Corpus %s has been reloaded since the query was prepared (prepare it again)", cl->name);
+    return NULL;
+  }
+  for (i = 0; i < n_args; i++)
+    if (!cl_string_validate_encoding(args[i], cl->corpus->charset, 0)) {
+      cqpmessage(Error, "Argument %d includes a character or character sequence that is invalid\n"
+                        "in the encoding specified for this corpus", i + 1);
+      return NULL;
+    }
+
+  set_current_corpus(cl, 0);
+
+  /* identical queries are answered from the query cache (if enabled) */
+  text = prepared_query_substitute(pq->query, args, &n_args);
+  key = text ? query_cache_key(cl, text) : NULL;
+  if ((result = query_cache_lookup(cl, key, subcorpus))) {
+    cl_free(key);
+    cl_free(text);
+    return result;
+  }
+
+  free_all_environments();
+  prepared_query_restore_env(pq, &Environment[0]);
+  ee_ix = 0;
+  CurEnv = &Environment[0];
+
+  for (i = 0; i <= CurEnv->MaxPatIndex; i++)
+    if (CurEnv->patternlist[i].type == Anchor
+        && ((CurEnv->patternlist[i].anchor.field == TargetField && !cl->targets)
+            || (CurEnv->patternlist[i].anchor.field == KeywordField && !cl->keywords))) {
+      cqpmessage(Error, "<%s> anchor not defined in %s", field_type_to_name(CurEnv->patternlist[i].anchor.field), cl->name);
+      break;
+    }
+
+  if (i > CurEnv->MaxPatIndex) {
+    CurEnv->query_corpus = query_corpus = make_temp_corpus(cl, "RHS");
+
+    /* subqueries don't work properly if the mother corpus has overlapping regions (see prepare_Query) */
+    size_before = query_corpus->size;
+    apply_range_set_operation(query_corpus, RNonOverlapping, NULL, NULL);
+    if (query_corpus->size < size_before)
+      cqpmessage(Warning, "Overlapping matches in %s:%s deleted for subquery execution.",
+                 query_corpus->mother_name, query_corpus->name);
+
+    if (prepared_query_bind(pq, args))
+      result = run_StandardQuery(pq->cut, pq->keep);
+  }
+
+  CurEnv->query_corpus = NULL;
+  prepared_query_save_env(pq, CurEnv);
+  prepared_query_clear_env(CurEnv);
+  ee_ix = -1;
+  query_corpus = NULL;
+
+  if (result) {
+    cl_free(result->query_corpus);
+    cl_free(result->query_text);
+    result->query_corpus = cl_strdup(cl->name);
+    result->query_text = cl_strdup(text ? text : pq->query);
+    expansion = pq->expansion;
+    expand_dataspace(result);
+    result = assign_temp_to_sub(result, subcorpus);
+  }
+  drop_temp_corpora();
+
+  query_cache_store(key, result);
+  cl_free(key);
+  cl_free(text);
+
+  return result;
+}
+
+/**
+ * Frees a prepared query, including its compiled environment.
+ *
+ * @param pq  Address of the prepared query; set to NULL.
+ */
+void
+free_prepared_query(PreparedQuery **pq)
+{
+  if (!*pq)
+    return;
+
+  if ((*pq)->env) {
+    free_all_environments();
+    prepared_query_restore_env(*pq, &Environment[0]);
+    ee_ix = 0;
+    free_all_environments();
+    cl_free((*pq)->env);
+  }
+  cl_free((*pq)->query);
+  cl_free((*pq)->corpus_name);
+  cl_free((*pq)->registry);
+  cl_free((*pq)->slots);
+  cl_free(*pq);
+}
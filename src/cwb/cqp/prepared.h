@@ -0,0 +1,88 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#ifndef _cqp_prepared_h_
+#define _cqp_prepared_h_
+
+#include "corpmanag.h"
+#include "eval.h"
+
+
+/*
+ * PREPARED QUERIES
+ *
+ * A prepared query is a standard query with parameters ?1, ?2, ... in place
+ * of the strings that a p-attribute is compared with, e.g.
+ *
+ *     [pos = ?1] [lemma = ?2 %c]
+ *
+ * The template is parsed once: macros are expanded, the token-level regular
+ * expression is compiled into a DFA and the constraint trees are built, with
+ * a placeholder node for each comparison with a parameter. Executing the
+ * query only compiles these comparisons for the arguments (in the same way as
+ * strings in a query) and runs the DFA.
+ */
+
+/** Marks a parameter in the query text given to the parser (followed by its number). */
+#define PREPARED_QUERY_MARK '\001'
+
+/** Highest parameter number allowed in a query template. */
+#define PREPARED_QUERY_MAX_PARAMS 1000
+
+/** A comparison of a p-attribute with a parameter in a prepared query. */
+typedef struct _PreparedSlot {
+  Constrainttree node;              /**< node of a constraint tree in the compiled query (replaced for each execution) */
+  Attribute *attr;                  /**< the p-attribute */
+  LabelEntry label;                 /**< label reference of the attribute (may be NULL) */
+  int del;                          /**< delete label after using it? */
+  int param;                        /**< number of the parameter */
+  int flags;                        /**< IGNORE_CASE, IGNORE_DIAC or IGNORE_REGEX */
+  int negated;                      /**< Boolean: comparison with != */
+} PreparedSlot;
+
+/** A compiled query template. */
+typedef struct _PreparedQuery {
+  char *query;                      /**< the query template */
+  char *corpus_name;                /**< the corpus the template was compiled for ... */
+  char *registry;                   /**< ... its registry directory ... */
+  unsigned long corpus_serial;      /**< ... and the serial number of its Corpus object (a reloaded corpus invalidates the query) */
+  int n_params;                     /**< number of parameters (?1 ... ?n) */
+  int cut;                          /**< cut value of the query (0 = none) */
+  int keep;                         /**< Boolean: keep ranges of the query corpus */
+  Context expansion;                /**< expansion of the matches (expand to ...) */
+  char *env;                        /**< the compiled EvalEnvironment (without the unused part of its pattern list) */
+  int n_patterns;                   /**< number of entries of the pattern list in env */
+  int n_slots;                      /**< number of comparisons with parameters */
+  PreparedSlot *slots;              /**< the comparisons with parameters */
+} PreparedQuery;
+
+extern PreparedQuery *preparing_query;
+
+PreparedQuery *prepare_query(CorpusList *cl, char *query);
+
+CorpusList *execute_prepared_query(PreparedQuery *pq, CorpusList *cl, char **args, int n_args, char *subcorpus);
+
+void free_prepared_query(PreparedQuery **pq);
+
+/* hooks for the parser (see parse_actions.c) */
+
+int prepared_query_use_param(int param);
+
+void prepared_query_capture(int cut, int keep);
+
+
+#endif
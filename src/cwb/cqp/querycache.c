@@ -0,0 +1,686 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <utime.h>
+
+#include "../cl/cl.h"
+#include "../cl/cwb-globals.h"
+#include "../cl/fileutils.h"
+
+#include "cqp.h"
+#include "options.h"
+#include "corpmanag.h"
+#include "querycache.h"
+
+/** Characters next to which whitespace in a query is not significant */
+#define QUERY_CACHE_DELIMITERS "[](){}=&|!<>,;:"
+
+/** Number of corpus loads whose data version stamps are remembered */
+#define QUERY_CACHE_VERSIONS 16
+
+
+/**
+ * A query result held in the cache.
+ *
+ * Entries form a doubly-linked list, from the most recently used to the least recently used one.
+ */
+typedef struct _QueryCacheEntry {
+  char *key;                        /**< the cache key, see query_cache_key() */
+  unsigned long hash;               /**< hash value of the key (also used for the names of cache files) */
+  CorpusList *result;               /**< the query result (not on the global list of corpora) */
+  MemBlob mapping;                  /**< cache file the arrays of the result point into (if loaded from disk) */
+  size_t bytes;                     /**< memory used by the entry */
+  struct _QueryCacheEntry *prev;
+  struct _QueryCacheEntry *next;
+} QueryCacheEntry;
+
+static QueryCacheEntry *cache_first = NULL;
+static QueryCacheEntry *cache_last = NULL;
+
+/** Data version stamps of recently used corpora, by the serial number of the corpus load (0 = unused) */
+static struct {
+  unsigned long serial;
+  unsigned long version;
+} cache_versions[QUERY_CACHE_VERSIONS];
+static int cache_versions_next = 0;
+
+/** A query result saved in the cache directory (see query_cache_prune_dir()). */
+typedef struct {
+  char *name;                       /**< filename of the query result (without directory) */
+  time_t mtime;                     /**< time of the last use */
+  double bytes;                     /**< size of the query result and its key file */
+} QueryCacheFile;
+
+/** Statistics of the query cache (counters are never reset) */
+QueryCacheStats query_cache_stats = { 0, 0, 0, 0, 0, 0, 0 };
+
+
+/** FNV-1a hash of a string (64 bits where available). */
+static unsigned long
+query_cache_hash(const char *s)
+{
+  unsigned long h = (sizeof(unsigned long) >= 8) ? 14695981039346656037UL : 2166136261UL;
+  unsigned long prime = (sizeof(unsigned long) >= 8) ? 1099511628211UL : 16777619UL;
+
+  for ( ; *s; s++)
+    h = (h ^ (unsigned char)*s) * prime;
+  return h;
+}
+
+/**
+ * Checks that a query string holds a single command.
+ *
+ * Only whitespace and semicolons may follow the first semicolon outside of strings.
+ *
+ * @param query  The query.
+ * @return       Boolean: true if the query is a single command.
+ */
+int
+query_cache_single_command(char *query)
+{
+  char *q, quote = 0;
+  int end = 0;
+
+  for (q = query; *q; q++) {
+    if (quote) {
+      if (*q == '\\' && q[1])
+        q++;
+      else if (*q == quote)
+        quote = 0;
+    }
+    else if (*q == ';')
+      end = 1;
+    else if (isspace((unsigned char)*q))
+      continue;
+    else if (end)
+      return 0;
+    else if (*q == '"' || *q == '\'')
+      quote = *q;
+  }
+  return 1;
+}
+
+/**
+ * Normalises the text of a query for use in a cache key.
+ *
+ * Whitespace is collapsed and removed next to delimiters (outside of strings),
+ * and trailing semicolons are removed. Queries that may depend on state other
+ * than the query corpus (variables, named query results, set operations,
+ * macros) or that consist of several commands cannot be cached.
+ *
+ * @param query  The query.
+ * @return       The normalised query (to be freed by the caller) or NULL if the query cannot be cached.
+ */
+static char *
+query_cache_normalise(char *query)
+{
+  char *norm, *p, *q, quote = 0;
+  int space = 0;
+
+  if (!query_cache_single_command(query))
+    return NULL;
+  while (isspace((unsigned char)*query))
+    query++;
+
+  /* query must begin with a token, a label, a region element, an anchor or MU / TAB */
+  if (!strchr("[\"'(<@", *query) || !*query) {
+    for (q = query; isalnum((unsigned char)*q) || *q == '_'; q++)
+      ;
+    if (q == query)
+      return NULL;
+    if (!(islower((unsigned char)*query) && *q == ':')
+        && !(q - query == 2 && !strncmp(query, "MU", 2))
+        && !(q - query == 3 && !strncmp(query, "TAB", 3)))
+      return NULL;
+  }
+
+  p = norm = (char *)cl_malloc(strlen(query) + 1);
+  for (q = query; *q; q++) {
+    if (quote) {
+      *p++ = *q;
+      if (*q == '\\' && q[1])
+        *p++ = *++q;
+      else if (*q == quote)
+        quote = 0;
+    }
+    else if (isspace((unsigned char)*q))
+      space = 1;
+    else if (*q == ';')
+      continue;
+    else if (*q == '$' || *q == '/') {
+      /* a variable or a macro */
+      cl_free(norm);
+      return NULL;
+    }
+    else {
+      if (space && p > norm && !strchr(QUERY_CACHE_DELIMITERS, p[-1]) && !strchr(QUERY_CACHE_DELIMITERS, *q))
+        *p++ = ' ';
+      space = 0;
+      if (*q == '"' || *q == '\'')
+        quote = *q;
+      *p++ = *q;
+    }
+  }
+  *p = '\0';
+
+  return norm;
+}
+
+/** Adds the modification time and size of a file to a hash value. */
+static unsigned long
+query_cache_stamp_file(unsigned long h, char *filename)
+{
+  struct stat st;
+
+  if (stat(filename, &st) != 0)
+    return h * 16777619UL;
+  h = (h ^ (unsigned long)st.st_mtime) * 16777619UL;
+  return (h ^ (unsigned long)st.st_size) * 16777619UL;
+}
+
+/**
+ * Computes a version stamp of the data of a corpus.
+ *
+ * The stamp is a hash value of the modification times and sizes of the registry file, the
+ * data directory and the files in it, so that results cached on disk are not used after the
+ * corpus has been encoded again. It is computed once per load of the corpus (a corpus that
+ * has been encoded again must be reloaded anyway) and remembered by the serial number of the load.
+ *
+ * @param corpus  The corpus.
+ * @return        The version stamp.
+ */
+static unsigned long
+query_cache_data_version(Corpus *corpus)
+{
+  char filename[CL_MAX_FILENAME_LENGTH];
+  unsigned long h = 2166136261UL;
+  struct dirent *ep;
+  DIR *dp;
+  int i;
+
+  for (i = 0; i < QUERY_CACHE_VERSIONS; i++)
+    if (cache_versions[i].serial == corpus->serial && corpus->serial)
+      return cache_versions[i].version;
+
+  if (corpus->registry_dir && corpus->registry_name) {
+    snprintf(filename, sizeof(filename), "%s%c%s", corpus->registry_dir, SUBDIR_SEPARATOR, corpus->registry_name);
+    h = query_cache_stamp_file(h, filename);
+  }
+  if (corpus->path) {
+    h = query_cache_stamp_file(h, corpus->path);
+    if ((dp = opendir(corpus->path))) {
+      while ((ep = readdir(dp))) {
+        if (ep->d_name[0] == '.')
+          continue;
+        snprintf(filename, sizeof(filename), "%s%c%s", corpus->path, SUBDIR_SEPARATOR, ep->d_name);
+        /* the order of the entries is not defined, so the stamps of the files are combined by addition */
+        h += query_cache_stamp_file(query_cache_hash(ep->d_name), filename);
+      }
+      closedir(dp);
+    }
+  }
+
+  /* the oldest stamp is replaced */
+  cache_versions[cache_versions_next].serial = corpus->serial;
+  cache_versions[cache_versions_next].version = h;
+  cache_versions_next = (cache_versions_next + 1) % QUERY_CACHE_VERSIONS;
+  return h;
+}
+
+/**
+ * Computes the cache key for a query.
+ *
+ * The key combines the normalised query text, the query corpus with its registry, size and
+ * (for subcorpora) a hash value of its intervals, a version stamp of the corpus data (see
+ * query_cache_data_version()), the matching strategy and the other options that affect the
+ * query result.
+ *
+ * @param cl     The corpus the query is run on (system corpus or subcorpus).
+ * @param query  The query (without assignment).
+ * @return       The key (to be freed by the caller) or NULL if the cache is disabled or the query cannot be cached.
+ */
+char *
+query_cache_key(CorpusList *cl, char *query)
+{
+  char *norm, *key, sizes[128];
+  unsigned long h = 0;
+  int i, len;
+
+  if (QueryCacheMemory <= 0 || !cl || !query || !cl->loaded || (cl->type != SYSTEM && cl->type != SUB))
+    return NULL;
+  if (!(norm = query_cache_normalise(query)))
+    return NULL;
+
+  if (cl->type == SUB) {
+    /* the intervals of a subcorpus may change, so they are part of the key */
+    h = 2166136261UL;
+    for (i = 0; i < cl->size; i++)
+      h = ((h ^ (unsigned long)cl->range[i].start) * 16777619UL) ^ ((unsigned long)cl->range[i].end * 31UL);
+  }
+  snprintf(sizes, sizeof(sizes), "%d %d %lx %lx", cl->size, cl->mother_size, h,
+           cl->corpus ? query_cache_data_version(cl->corpus) : 0UL);
+
+  len = strlen(norm) + strlen(sizes) + (cl->registry ? strlen(cl->registry) : 0) + strlen(cl->name)
+        + (cl->mother_name ? strlen(cl->mother_name) : 0) + (def_unbr_attr ? strlen(def_unbr_attr) : 0) + 128;
+  key = (char *)cl_malloc(len);
+  snprintf(key, len, "%s\n%s:%s\n%s\n%d %d %d %d %d %d %s\n%s",
+           cl->registry ? cl->registry : "",
+           (cl->type == SUB && cl->mother_name) ? cl->mother_name : "",
+           cl->name,
+           sizes,
+           (int)matching_strategy, hard_boundary, hard_cut, strict_regions,
+           anchor_number_target, anchor_number_keyword,
+           def_unbr_attr ? def_unbr_attr : "",
+           norm);
+  cl_free(norm);
+
+  return key;
+}
+
+
+/** Frees a query result that is not on the global list of corpora. */
+static void
+query_cache_free_result(CorpusList *cl)
+{
+  if (!cl)
+    return;
+  cl_free(cl->name);
+  cl_free(cl->mother_name);
+  cl_free(cl->registry);
+  cl_free(cl->abs_fn);
+  cl_free(cl->query_corpus);
+  cl_free(cl->query_text);
+  cl_free(cl->range);
+  cl_free(cl->sortidx);
+  cl_free(cl->targets);
+  cl_free(cl->keywords);
+  cl_free(cl);
+}
+
+/** Copies a query result (in corpus order) into a CorpusList object that is not on the global list of corpora. */
+static CorpusList *
+query_cache_copy_result(CorpusList *cl, char *name)
+{
+  CorpusList *copy = (CorpusList *)cl_calloc(1, sizeof(CorpusList));
+
+  copy->name = cl_strdup(name);
+  copy->mother_name = cl_strdup(cl->mother_name);
+  copy->mother_size = cl->mother_size;
+  copy->registry = cl_strdup(cl->registry);
+  copy->type = SUB;
+  copy->query_corpus = cl->query_corpus ? cl_strdup(cl->query_corpus) : NULL;
+  copy->query_text = cl->query_text ? cl_strdup(cl->query_text) : NULL;
+  copy->saved = False;
+  copy->loaded = True;
+  copy->needs_update = True;
+  copy->corpus = cl->corpus;
+  copy->size = cl->size;
+
+  if (cl->size > 0) {
+    copy->range = (Range *)cl_malloc(sizeof(Range) * cl->size);
+    memcpy(copy->range, cl->range, sizeof(Range) * cl->size);
+    if (cl->targets) {
+      copy->targets = (int *)cl_malloc(sizeof(int) * cl->size);
+      memcpy(copy->targets, cl->targets, sizeof(int) * cl->size);
+    }
+    if (cl->keywords) {
+      copy->keywords = (int *)cl_malloc(sizeof(int) * cl->size);
+      memcpy(copy->keywords, cl->keywords, sizeof(int) * cl->size);
+    }
+  }
+
+  return copy;
+}
+
+/** Creates a cache entry for a query result (which is taken over by the entry). */
+static QueryCacheEntry *
+query_cache_new_entry(char *key, unsigned long hash, CorpusList *result)
+{
+  QueryCacheEntry *e = (QueryCacheEntry *)cl_calloc(1, sizeof(QueryCacheEntry));
+
+  e->key = cl_strdup(key);
+  e->hash = hash;
+  e->result = result;
+  e->bytes = sizeof(QueryCacheEntry) + sizeof(CorpusList) + strlen(key) + 1
+             + (size_t)result->size * (sizeof(Range) + (result->targets ? sizeof(int) : 0) + (result->keywords ? sizeof(int) : 0));
+  return e;
+}
+
+/** Removes an entry from the list of cache entries. */
+static void
+query_cache_unlink(QueryCacheEntry *e)
+{
+  if (e->prev)
+    e->prev->next = e->next;
+  else
+    cache_first = e->next;
+  if (e->next)
+    e->next->prev = e->prev;
+  else
+    cache_last = e->prev;
+  e->prev = e->next = NULL;
+  query_cache_stats.entries--;
+  query_cache_stats.bytes -= e->bytes;
+}
+
+/** Inserts an entry at the head of the list of cache entries (i.e. as the most recently used one). */
+static void
+query_cache_link_first(QueryCacheEntry *e)
+{
+  e->prev = NULL;
+  e->next = cache_first;
+  if (cache_first)
+    cache_first->prev = e;
+  else
+    cache_last = e;
+  cache_first = e;
+  query_cache_stats.entries++;
+  query_cache_stats.bytes += e->bytes;
+}
+
+static void
+query_cache_delete_entry(QueryCacheEntry *e)
+{
+  if (e->mapping.data) {
+    /* the arrays are part of the memory-mapped cache file */
+    e->result->range = NULL;
+    e->result->sortidx = NULL;
+    e->result->targets = NULL;
+    e->result->keywords = NULL;
+    free_mblob(&e->mapping);
+  }
+  query_cache_free_result(e->result);
+  cl_free(e->key);
+  cl_free(e);
+}
+
+
+/** Returns the filename of a cache file in the cache directory (without directory, to be freed by the caller). */
+static char *
+query_cache_filename(unsigned long hash, const char *suffix)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "QC%0*lx%s", (int)(2 * sizeof(unsigned long)), hash, suffix);
+  return cl_strdup(buf);
+}
+
+/** Returns the full path of a cache file in the cache directory (to be freed by the caller). */
+static char *
+query_cache_path(unsigned long hash, const char *suffix)
+{
+  char *fn = query_cache_filename(hash, suffix), *path;
+  int len = strlen(QueryCacheDir) + strlen(fn) + 2;
+
+  path = (char *)cl_malloc(len);
+  snprintf(path, len, "%s%c%s", QueryCacheDir, SUBDIR_SEPARATOR, fn);
+  cl_free(fn);
+  return path;
+}
+
+/** Orders files in the cache directory by the time of their last use (oldest first). */
+static int
+query_cache_file_cmp(const void *a, const void *b)
+{
+  const QueryCacheFile *fa = (const QueryCacheFile *)a, *fb = (const QueryCacheFile *)b;
+
+  if (fa->mtime != fb->mtime)
+    return (fa->mtime < fb->mtime) ? -1 : 1;
+  return strcmp(fa->name, fb->name);
+}
+
+/**
+ * Deletes the least recently used query results from the cache directory until the files
+ * fit into the memory budget (option QueryCacheMemory, in MB).
+ */
+static void
+query_cache_prune_dir(void)
+{
+  char filename[CL_MAX_FILENAME_LENGTH];
+  QueryCacheFile *files = NULL;
+  double total = 0, budget = (double)MAX(QueryCacheMemory, 0) * 1024 * 1024;
+  int n = 0, allocated = 0, i, len = 2 + 2 * sizeof(unsigned long);
+  struct dirent *ep;
+  struct stat st;
+  DIR *dp;
+
+  if (!(dp = opendir(QueryCacheDir)))
+    return;
+  while ((ep = readdir(dp))) {
+    /* query results are named QC<hash>, their keys QC<hash>.key */
+    if (strncmp(ep->d_name, "QC", 2) || strlen(ep->d_name) != len || strspn(ep->d_name + 2, "0123456789abcdef") != len - 2)
+      continue;
+    snprintf(filename, sizeof(filename), "%s%c%s", QueryCacheDir, SUBDIR_SEPARATOR, ep->d_name);
+    if (stat(filename, &st) != 0)
+      continue;
+    if (n >= allocated) {
+      allocated = 2 * allocated + 64;
+      files = (QueryCacheFile *)cl_realloc(files, allocated * sizeof(QueryCacheFile));
+    }
+    files[n].name = cl_strdup(ep->d_name);
+    files[n].mtime = st.st_mtime;
+    files[n].bytes = (double)st.st_size;
+    strcat(filename, ".key");
+    if (stat(filename, &st) == 0)
+      files[n].bytes += (double)st.st_size;
+    total += files[n++].bytes;
+  }
+  closedir(dp);
+
+  if (total > budget) {
+    qsort(files, n, sizeof(QueryCacheFile), query_cache_file_cmp);
+    for (i = 0; i < n && total > budget; i++) {
+      /* the key goes first, so that a result is never matched without it */
+      snprintf(filename, sizeof(filename), "%s%c%s.key", QueryCacheDir, SUBDIR_SEPARATOR, files[i].name);
+      remove(filename);
+      filename[strlen(filename) - 4] = '\0';
+      remove(filename);
+      total -= files[i].bytes;
+    }
+  }
+
+  for (i = 0; i < n; i++)
+    cl_free(files[i].name);
+  cl_free(files);
+}
+
+/** Saves a cache entry to the cache directory (the key is stored in a separate file written last). */
+static void
+query_cache_save_entry(QueryCacheEntry *e)
+{
+  char *path;
+  FILE *fd;
+
+  if (!QueryCacheDir || !*QueryCacheDir || !e->result->registry || !e->result->mother_name)
+    return;
+
+  path = query_cache_path(e->hash, "");
+  if (save_binary_subcorpus(e->result, path, subcorpus_format == SubcorpusCompressed)) {
+    cl_free(path);
+    path = query_cache_path(e->hash, ".key");
+    if ((fd = fopen(path, "wb"))) {
+      fwrite(e->key, 1, strlen(e->key), fd);
+      fclose(fd);
+    }
+    query_cache_prune_dir();
+  }
+  cl_free(path);
+}
+
+/** Loads the query result for a key from the cache directory; returns NULL if it is not available. */
+static QueryCacheEntry *
+query_cache_load_entry(char *key, unsigned long hash)
+{
+  char *path, *stored, *fn;
+  FILE *fd;
+  int len, match = 0;
+  CorpusList *result;
+  QueryCacheEntry *e;
+  MemBlob mapping;
+
+  if (!QueryCacheDir || !*QueryCacheDir)
+    return NULL;
+
+  /* compare the key stored in the cache directory */
+  path = query_cache_path(hash, ".key");
+  len = strlen(key);
+  if (file_length(path) == len && (fd = fopen(path, "rb"))) {
+    stored = (char *)cl_malloc(len + 1);
+    match = (fread(stored, 1, len, fd) == len && memcmp(stored, key, len) == 0);
+    cl_free(stored);
+    fclose(fd);
+  }
+  cl_free(path);
+  if (!match)
+    return NULL;
+
+  /* results in the binary format are used directly from the memory-mapped file */
+  fn = query_cache_filename(hash, "");
+  path = query_cache_path(hash, "");
+  result = (CorpusList *)cl_calloc(1, sizeof(CorpusList));
+  result->name = cl_strdup(fn);
+  result->type = SUB;
+  if (!load_binary_subcorpus(result, path, &mapping) && !attach_subcorpus(result, QueryCacheDir, fn)) {
+    cl_free(fn);
+    cl_free(path);
+    query_cache_free_result(result);
+    return NULL;
+  }
+  /* the modification time of the file records its last use (see query_cache_prune_dir()) */
+  utime(path, NULL);
+  cl_free(fn);
+  cl_free(path);
+
+  e = query_cache_new_entry(key, hash, result);
+  e->mapping = mapping;
+  return e;
+}
+
+
+/**
+ * Looks up a query result in the cache.
+ *
+ * If the result is found (in memory or in the cache directory), a copy is
+ * stored as a subcorpus of the query corpus.
+ *
+ * @param cl         The corpus the query is run on (which the key has been computed for).
+ * @param key        Cache key from query_cache_key() (may be NULL).
+ * @param subcorpus  Name of the subcorpus for the query result.
+ * @return           The subcorpus or NULL if the result is not in the cache.
+ */
+CorpusList *
+query_cache_lookup(CorpusList *cl, char *key, char *subcorpus)
+{
+  QueryCacheEntry *e;
+  CorpusList *result;
+  unsigned long hash;
+
+  if (!cl || !key || !subcorpus)
+    return NULL;
+
+  query_cache_stats.lookups++;
+  hash = query_cache_hash(key);
+
+  for (e = cache_first; e; e = e->next)
+    if (e->hash == hash && cl_str_is(e->key, key))
+      break;
+
+  if (e) {
+    query_cache_stats.hits++;
+    query_cache_unlink(e);
+  }
+  else if ((e = query_cache_load_entry(key, hash)))
+    query_cache_stats.disk_hits++;
+  else
+    return NULL;
+  query_cache_link_first(e);
+
+  /* the corpus may have been reloaded since the query result was cached */
+  e->result->corpus = cl->corpus;
+  result = duplicate_corpus(e->result, subcorpus, True);
+  query_cache_trim();
+
+  return result;
+}
+
+/**
+ * Adds a query result to the cache (and saves it to the cache directory if one is set).
+ *
+ * @param key     Cache key from query_cache_key() (may be NULL).
+ * @param result  The query result, which is copied.
+ */
+void
+query_cache_store(char *key, CorpusList *result)
+{
+  QueryCacheEntry *e;
+  unsigned long hash;
+
+  if (!key || !result || result->type != SUB || !result->loaded)
+    return;
+
+  hash = query_cache_hash(key);
+  for (e = cache_first; e; e = e->next)
+    if (e->hash == hash && cl_str_is(e->key, key)) {
+      query_cache_unlink(e);
+      query_cache_delete_entry(e);
+      break;
+    }
+
+  e = query_cache_new_entry(key, hash, query_cache_copy_result(result, result->name));
+  query_cache_save_entry(e);
+  query_cache_link_first(e);
+  query_cache_stats.stores++;
+  query_cache_trim();
+}
+
+/**
+ * Discards the least recently used query results until the cache fits into
+ * the memory budget (option QueryCacheMemory, in MB).
+ */
+void
+query_cache_trim(void)
+{
+  QueryCacheEntry *e;
+  size_t budget = (size_t)MAX(QueryCacheMemory, 0) * 1024 * 1024;
+
+  while (cache_last && query_cache_stats.bytes > budget) {
+    e = cache_last;
+    query_cache_unlink(e);
+    query_cache_delete_entry(e);
+    query_cache_stats.evictions++;
+  }
+}
+
+/**
+ * Discards all query results held in memory (files in the cache directory are kept).
+ */
+void
+query_cache_clear(void)
+{
+  QueryCacheEntry *e;
+
+  while ((e = cache_first)) {
+    query_cache_unlink(e);
+    query_cache_delete_entry(e);
+  }
+}
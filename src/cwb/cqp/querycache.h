@@ -0,0 +1,66 @@
+/*
+ *  IMS Open Corpus Workbench (CWB)
+ *  Copyright (C) 1993-2006 by IMS, University of Stuttgart
+ *  Copyright (C) 2007-     by the respective contributers (see file AUTHORS)
+ *
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 2, or (at your option) any later
+ *  version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details (in the file "COPYING", or available via
+ *  WWW at http://www.gnu.org/copyleft/gpl.html).
+ */
+
+#ifndef _cqp_querycache_h_
+#define _cqp_querycache_h_
+
+#include <stddef.h>
+
+#include "corpmanag.h"
+
+
+/*
+ * CACHE OF QUERY RESULTS
+ *
+ * Query results (ranges, targets and keywords) are kept in memory, keyed by
+ * the normalised query text, the query corpus (including the state of a
+ * subcorpus), the matching strategy and the query options that affect the
+ * result. The least recently used results are discarded when the memory
+ * budget (option QueryCacheMemory) is exceeded. If a cache directory is set
+ * (option QueryCacheDir), results are also saved to disk (in the binary
+ * subcorpus format) and can be reused by later sessions; reloaded results are
+ * used directly from the memory-mapped files. The files are limited by the
+ * same budget, the least recently used ones being deleted.
+ */
+
+/** Statistics of the query cache. */
+typedef struct _QueryCacheStats {
+  int lookups;          /**< number of queries looked up in the cache */
+  int hits;             /**< number of queries found in memory */
+  int disk_hits;        /**< number of queries found in the cache directory */
+  int stores;           /**< number of query results added to the cache */
+  int evictions;        /**< number of query results discarded to stay within the memory budget */
+  int entries;          /**< number of query results currently held in memory */
+  size_t bytes;         /**< memory used by the query results held in memory */
+} QueryCacheStats;
+
+extern QueryCacheStats query_cache_stats;
+
+int query_cache_single_command(char *query);
+
+char *query_cache_key(CorpusList *cl, char *query);
+
+CorpusList *query_cache_lookup(CorpusList *cl, char *key, char *subcorpus);
+
+void query_cache_store(char *key, CorpusList *result);
+
+void query_cache_trim(void);
+
+void query_cache_clear(void);
+
+
+#endif
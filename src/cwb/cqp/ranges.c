@@ -22,6 +22,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <stdint.h>
 
 #include "../cl/cl.h"
 
@@ -31,11 +32,61 @@
 #include "output.h"
 #include "matchlist.h"
 #include "options.h"
+#include "extsort.h"
 
 #include "ranges.h"
 
 #define SORT_DEBUG 0
 
+/**
+ * Removes concordance hits from a query-generated subcorpus, keeping the hits
+ * whose bit in a Bitfield has a given value.
+ *
+ * The hits to keep are found as runs of identical bits, skipping a whole word of
+ * the bitfield at a time, and each run is moved in one go (along with
+ * targets and keywords).
+ *
+ * @param cp     The CorpusList indicating the query to delete from.
+ * @param lines  A Bitfield containing a bit for each query hit.
+ * @param keep   The value (1 or 0) of the bits of the hits to keep.
+ * @return       Boolean: true for success, false for failure.
+ */
+static int
+rs_keep_lines(CorpusList *cp, Bitfield lines, int keep)
+{
+  int first, last, ins;
+
+  ins = 0;
+  first = keep ? bf_next_set_bit(lines, 0) : bf_next_clear_bit(lines, 0);
+  while (first >= 0) {
+    last = keep ? bf_next_clear_bit(lines, first) : bf_next_set_bit(lines, first);
+    if (last < 0)
+      last = cp->size;
+    /* run of hits first .. last-1 is kept */
+    if (first != ins) {
+      memmove(cp->range + ins, cp->range + first, sizeof(Range) * (last - first));
+      if (cp->targets)
+        memmove(cp->targets + ins, cp->targets + first, sizeof(int) * (last - first));
+      if (cp->keywords)
+        memmove(cp->keywords + ins, cp->keywords + first, sizeof(int) * (last - first));
+    }
+    ins += last - first;
+    first = (last >= cp->size) ? -1 : (keep ? bf_next_set_bit(lines, last) : bf_next_clear_bit(lines, last));
+  }
+
+  if (ins != cp->size) {
+    cp->range = (Range *)cl_realloc(cp->range, sizeof(Range) * ins);
+    if (cp->targets)
+      cp->targets = (int *)cl_realloc(cp->targets, sizeof(int) * ins);
+    if (cp->keywords)
+      cp->keywords = (int *)cl_realloc(cp->keywords, sizeof(int) * ins);
+    cp->size = ins;
+    cl_free(cp->sortidx);
+    touch_corpus(cp);
+  }
+  return 1;
+}
+
 /**
  * Delete a whole bunch of concordance hits from a query-generated subcorpus.
  *
@@ -49,10 +100,8 @@
 int
 delete_intervals(CorpusList *cp, Bitfield intervals, int mode)
 {
-  int i;
   int result;    /* boolean to return at the end */
   int modified;  /* count of the number of lines deleted */
-  int bit;       /* temp storage for value retrieved from bitfield */
 
   if (!cp || !(cp->type == SUB || cp->type == TEMP) || cp->size <= 0)
     return 0;
@@ -69,16 +118,8 @@ delete_intervals(CorpusList *cp, Bitfield intervals, int mode)
 
   case SELECTED_LINES:
   case UNSELECTED_LINES:
-    /* for each hit, check whether it is "selected"
-     * then delete, or not, depending on mode */
-    for (i = 0; i < cp->size; i++) {
-      bit = get_bit(intervals, i);
-      if ( (mode == SELECTED_LINES && bit) || (mode == UNSELECTED_LINES && !bit) ) {
-        modified++;
-        cp->range[i].start = -1;
-        cp->range[i].end = -1;
-      }
-    }
+    /* the number of hits to delete is known from the bitfield */
+    modified = (mode == SELECTED_LINES) ? nr_bits_set(intervals) : cp->size - nr_bits_set(intervals);
     break;
 
   default:
@@ -106,7 +147,7 @@ delete_intervals(CorpusList *cp, Bitfield intervals, int mode)
        */
 
       cl_free(cp->sortidx);
-      result = apply_range_set_operation(cp, RReduce, NULL, NULL);
+      result = rs_keep_lines(cp, intervals, (mode == UNSELECTED_LINES));
     }
     /* since at least one hit was modified, touch the CorpusList that represents the query */
     touch_corpus(cp);
@@ -308,25 +349,197 @@ calculate_leftboundary(CorpusList *cl, int cpos, Context spc)
   return (calculate_ranges(cl, cpos, spc, &left, &right)? left : -1);
 }
 
-/** this is a rather specialised utility function for the UNION part of RangeSetop()
-   (copies range + keyword/target (if defined) in corpus into temporary lists)*/
-static void
-rs_cp_range(Range *rng, int *target, int *keyword, int ins, CorpusList *corpus, int j)
+/** Number of consecutive intervals taken from the same operand before rs_merge() switches to exponential search */
+#define RS_MIN_GALLOP 8
+
+/** Compares two intervals in the 'natural' order (by start and end cpos, see RangeSort()); returns -1, 0 or 1. */
+static inline int
+rs_compare(const Range *a, const Range *b)
 {
-  rng[ins].start = corpus->range[j].start;
-  rng[ins].end = corpus->range[j].end;
-  if (target) {         /* target/keyword vectors may be undefined */
-    if (corpus->targets)
-      target[ins] = corpus->targets[j];
+  if (a->start != b->start)
+    return (a->start < b->start) ? -1 : 1;
+  else
+    return (a->end > b->end) - (a->end < b->end);
+}
+
+/**
+ * Finds the end of a run of intervals that come before a given interval.
+ *
+ * Uses exponential search starting from position i, so skipping a run of k
+ * intervals takes O(log k) comparisons.
+ *
+ * @param range  Sorted intervals.
+ * @param i      Start position of the run.
+ * @param n      Number of intervals.
+ * @param key    The interval that ends the run.
+ * @return       First position k >= i such that range[k] does not come before key (or n).
+ */
+static int
+rs_skip_run(const Range *range, int i, int n, const Range *key)
+{
+  int lo, hi, mid, step;
+
+  if (i >= n || rs_compare(range + i, key) >= 0)
+    return i;
+
+  /* range[lo] comes before key; find hi such that range[hi] doesn't (or hi == n) */
+  lo = i;
+  step = 1;
+  while (lo + step < n && rs_compare(range + lo + step, key) < 0) {
+    lo += step;
+    step <<= 1;
+  }
+  hi = (lo + step < n) ? lo + step : n;
+
+  while (hi - lo > 1) {
+    mid = lo + (hi - lo) / 2;
+    if (rs_compare(range + mid, key) < 0)
+      lo = mid;
     else
-      target[ins] = -1;
+      hi = mid;
+  }
+  return hi;
+}
+
+/**
+ * Moves a run of intervals (with targets and keywords) from a subcorpus into the result of a set operation.
+ *
+ * The result vectors may be those of the subcorpus itself (with ins <= from), so data are moved with memmove().
+ * Targets and keywords that are not defined in the subcorpus are set to -1.
+ *
+ * @return  The new insertion point.
+ */
+static int
+rs_move_run(Range *range, int *target, int *keyword, int ins, CorpusList *corpus, int from, int n)
+{
+  int k;
+
+  if (n <= 0)
+    return ins;
+
+  if (range != corpus->range || ins != from)
+    memmove(range + ins, corpus->range + from, n * sizeof(Range));
+  if (target) {         /* target/keyword vectors may be undefined */
+    if (!corpus->targets)
+      for (k = 0; k < n; k++)
+        target[ins + k] = -1;
+    else if (target != corpus->targets || ins != from)
+      memmove(target + ins, corpus->targets + from, n * sizeof(int));
   }
   if (keyword) {
-    if (corpus->keywords)
-      keyword[ins] = corpus->keywords[j];
+    if (!corpus->keywords)
+      for (k = 0; k < n; k++)
+        keyword[ins + k] = -1;
+    else if (keyword != corpus->keywords || ins != from)
+      memmove(keyword + ins, corpus->keywords + from, n * sizeof(int));
+  }
+  return ins + n;
+}
+
+/** Like rs_move_run(), but single intervals (which are much more frequent than long runs in most set operations) are copied inline. */
+static inline int
+rs_copy_run(Range *range, int *target, int *keyword, int ins, CorpusList *corpus, int from, int n)
+{
+  if (n != 1)
+    return rs_move_run(range, target, keyword, ins, corpus, from, n);
+
+  range[ins] = corpus->range[from];
+  if (target)
+    target[ins] = corpus->targets ? corpus->targets[from] : -1;
+  if (keyword)
+    keyword[ins] = corpus->keywords ? corpus->keywords[from] : -1;
+  return ins + 1;
+}
+
+/**
+ * Linear-time merge kernel for the set operations RUnion, RIntersection and RDiff.
+ *
+ * Both subcorpora must be sorted in 'natural' order. Intervals are written to the
+ * result vectors in the same order, so the result needs no further sorting. Runs
+ * of intervals from corpus1 are copied in a single step (not at all if they are
+ * already in place), and once RS_MIN_GALLOP consecutive intervals have been taken
+ * from the same subcorpus, the rest of the run is skipped by exponential search.
+ *
+ * For intersection and difference, the result vectors may be those of corpus1
+ * (which are then compacted in place); for union, they must hold corpus1->size
+ * intervals plus the intervals of corpus2 selected by the restrictor.
+ *
+ * @param corpus1     The first operand (which targets / keywords are taken from for identical intervals).
+ * @param operation   RUnion, RIntersection or RDiff.
+ * @param corpus2     The second operand.
+ * @param restrictor  Specifies which intervals in corpus2 are to be taken notice of by RUnion (may be NULL).
+ * @param range       Result vector of intervals.
+ * @param target      Result vector of targets (may be NULL).
+ * @param keyword     Result vector of keywords (may be NULL).
+ * @return            Number of intervals in the result.
+ */
+static int
+rs_merge(CorpusList *corpus1, RangeSetOp operation, CorpusList *corpus2, Bitfield restrictor,
+         Range *range, int *target, int *keyword)
+{
+  int i = 0, j = 0, k, cmp, ins = 0;
+  int n1 = corpus1->size, n2 = corpus2->size;
+  int keep = 0;                 /* start of the pending run of intervals from corpus1 that go into the result */
+  int run1 = 0, run2 = 0;       /* number of consecutive intervals taken from corpus1 / corpus2 */
+
+  while (i < n1 && j < n2) {
+    cmp = rs_compare(corpus1->range + i, corpus2->range + j);
+    if (cmp < 0) {
+      /* interval (or run of intervals) only found in corpus1 */
+      k = (++run1 < RS_MIN_GALLOP) ? i + 1 : rs_skip_run(corpus1->range, i, n1, corpus2->range + j);
+      run2 = 0;
+      if (operation == RIntersection) {
+        /* drop these intervals */
+        if (i > keep)
+          ins = rs_copy_run(range, target, keyword, ins, corpus1, keep, i - keep);
+        keep = k;
+      }
+      i = k;
+    }
+    else if (cmp > 0) {
+      /* interval (or run of intervals) only found in corpus2 */
+      k = (++run2 < RS_MIN_GALLOP) ? j + 1 : rs_skip_run(corpus2->range, j, n2, corpus1->range + i);
+      run1 = 0;
+      if (operation == RUnion) {
+        /* insert these intervals after the pending run from corpus1 */
+        if (i > keep)
+          ins = rs_copy_run(range, target, keyword, ins, corpus1, keep, i - keep);
+        keep = i;
+        if (!restrictor)
+          ins = rs_copy_run(range, target, keyword, ins, corpus2, j, k - j);
+        else
+          for ( ; j < k; j++)
+            if (get_bit(restrictor, j))
+              ins = rs_copy_run(range, target, keyword, ins, corpus2, j, 1);
+      }
+      j = k;
+    }
+    else {
+      /* identical intervals: keep the one from corpus1 (with its target / keyword) unless this is a difference */
+      run1 = run2 = 0;
+      if (operation == RDiff) {
+        if (i > keep)
+          ins = rs_copy_run(range, target, keyword, ins, corpus1, keep, i - keep);
+        keep = i + 1;
+      }
+      i++;
+      j++;
+    }
+  }
+
+  /* pending run and remaining intervals of corpus1 (dropped by intersection) */
+  ins = rs_copy_run(range, target, keyword, ins, corpus1, keep, (operation == RIntersection ? i : n1) - keep);
+  /* remaining intervals of corpus2 */
+  if (operation == RUnion) {
+    if (!restrictor)
+      ins = rs_copy_run(range, target, keyword, ins, corpus2, j, n2 - j);
     else
-      keyword[ins] = -1;
+      for ( ; j < n2; j++)
+        if (get_bit(restrictor, j))
+          ins = rs_copy_run(range, target, keyword, ins, corpus2, j, 1);
   }
+
+  return ins;
 }
 
 /** Variable used by _RS_compare_ranges; global so data can be passed in
@@ -437,6 +650,30 @@ RangeSort(CorpusList *c, int mk_sortidx)
   cl_free(index);
 }
 
+/**
+ * Shrinks the vectors of a subcorpus whose first n intervals have been kept.
+ *
+ * The sort index is no longer valid if any intervals were removed, so it is deallocated.
+ *
+ * @param cl  The subcorpus.
+ * @param n   The new number of intervals.
+ */
+static void
+rs_truncate(CorpusList *cl, int n)
+{
+  if (n == cl->size)
+    return;
+
+  cl->range = (Range *)cl_realloc(cl->range, sizeof(Range) * n);
+  if (cl->targets)
+    cl->targets = (int *)cl_realloc(cl->targets, sizeof(int) * n);
+  if (cl->keywords)
+    cl->keywords = (int *)cl_realloc(cl->keywords, sizeof(int) * n);
+  cl->size = n;
+
+  cl_free(cl->sortidx); /* the sort index is no longer valid in this case -> make sure it is deallocated and set to NULL */
+}
+
 /**
  * Carries out one of a set of operations on corpus1.
  *
@@ -483,13 +720,9 @@ apply_range_set_operation(CorpusList *corpus1, RangeSetOp operation, CorpusList
       return 1;
     }
     else {
-      if (restrictor) {
+      if (restrictor)
         /* count how many intervals are to be copied to corpus1 */
-        intervals_to_copy = 0;
-        for (i = 0; i < corpus2->size; i++)
-          if (get_bit(restrictor, i))
-            intervals_to_copy++;
-      }
+        intervals_to_copy = nr_bits_set(restrictor);
       else
         /* we have to copy all the intervals from corpus2 */
         intervals_to_copy = corpus2->size;
@@ -509,69 +742,8 @@ apply_range_set_operation(CorpusList *corpus1, RangeSetOp operation, CorpusList
       else
         tmp_keyword = NULL;
 
-      i = 0;                    /* the position in corpus1 */
-      j = 0;                    /* the position in corpus2 */
-      ins = 0;                  /* the insertion point in the (unified) result list */
-
-      /* loop through the intervals in corpus1 and corpus2 to unify them */
-      while ( i < corpus1->size || j < corpus2->size ) {
-        /* while there are intervals left in either corpus... */
-
-        if (j >= corpus2->size ||
-            (i < corpus1->size && (corpus1->range[i].start < corpus2->range[j].start))
-            ) {
-          /* if we have run out of intervals in corpus2, or if the next interval in
-           * corpus2 comes later on than the next interval in corpus1,
-           * copy an item from corpus1 */
-          rs_cp_range(tmp, tmp_target, tmp_keyword, ins, corpus1, i);
-          ins++;
-          /* increment i since we have copied from corpus 1 */
-          i++;
-        }
-        else if (i >= corpus1->size ||
-                           /* NB j < corpus2->size assured in this branch */
-                 (corpus1->range[i].start > corpus2->range[j].start)) {
-          /* if we have run out of intervals in corpus1, or if the next interval in
-           * corpus1 comes later on than the next interval in corpus2,
-           * copy an interval from corpus2 (allowing for the restrictor if necessry) */
-          if (restrictor == NULL || get_bit(restrictor, j)) {
-            rs_cp_range(tmp, tmp_target, tmp_keyword, ins, corpus2, j);
-            ins++;
-          }
-          /* increment j since we have copied from corpus 2 */
-          j++;
-        }
-        else {
-          /* both start positions are identical. Now check whether the end positions are also the same...
-           *
-           * => the ranges are identical and we'll copy target/keyword from corpus1
-           * => the range from corpus1 ends sooner, so we copy that one
-           * => the range from corpus2 ends sooner, so we copy that one, depending on the restrictor
-           *
-           * (for real duplicates, both i and j are incremented; otherwise,
-           * only the one copied is incremented, so the other is still on the
-           * pile of intervals to be whiled through.) */
-
-          if (corpus1->range[i].end == corpus2->range[j].end) {
-            rs_cp_range(tmp, tmp_target, tmp_keyword, ins, corpus1, i);
-            i++;
-            j++;                /* skip the corresponding range in corpus2 */
-            ins++;
-          }
-          else if (corpus1->range[i].end < corpus2->range[j].end) {
-            rs_cp_range(tmp, tmp_target, tmp_keyword, ins, corpus1, i);
-            i++;
-            ins++;
-          }
-          else {
-            if (!restrictor || get_bit(restrictor, j)) {
-              rs_cp_range(tmp, tmp_target, tmp_keyword, ins, corpus2, j);
-              ins++;
-            }
-            j++;
-          }
-        }
-      } /* endwhile there are intervals left in either corpus */
+      /* merge the intervals of corpus1 and corpus2 (identical intervals are copied from corpus1) */
+      ins = rs_merge(corpus1, RUnion, corpus2, restrictor, tmp, tmp_target, tmp_keyword);
 
       assert(ins <= tmp_size);
 
@@ -592,6 +764,8 @@ apply_range_set_operation(CorpusList *corpus1, RangeSetOp operation, CorpusList
       corpus1->range = tmp;
       corpus1->targets = tmp_target; /* may be NULL */
       corpus1->keywords = tmp_keyword; /* may be NULL */
+      if (ins != corpus1->size)
+        cl_free(corpus1->sortidx); /* the sort index is no longer valid */
       corpus1->size = ins;
 
       touch_corpus(corpus1);
@@ -602,89 +776,15 @@ apply_range_set_operation(CorpusList *corpus1, RangeSetOp operation, CorpusList
 
 
   case RIntersection:
-    /*
-     * -------------------- INTERSECTION
-     * targets / keywords are copied from _left_ operand
-     */
-
-    i = 0;                      /* the position in corpus1 */
-    j = 0;                      /* the position in corpus2 */
-
-    while (i < corpus1->size && j < corpus2->size) {
-      /* compare start positions; if not equal, advance subcorpus where start position is smaller */
-      if (corpus1->range[i].start < corpus2->range[j].start) {
-        corpus1->range[i].start = -1;   /* not found -> mark for deletion & advance in corpus1 */
-        i++;
-      }
-      else if (corpus1->range[i].start > corpus2->range[j].start)
-        j++;
-      else {
-        /* both start positions are identical. Now check whether the end positions are also the same */
-        if (corpus1->range[i].end == corpus2->range[j].end) {
-          /* this range is in both subcorpora -> keep & advance both pointers */
-          i++;
-          j++;
-        }
-        else {
-          /* end positions are not the same -> advance subcorpus where end position is smaller */
-          if (corpus1->range[i].end < corpus2->range[j].end) {
-            corpus1->range[i].start = -1;       /* not found -> mark for deletion & advance in corpus1 */
-            i++;
-          }
-          else
-            j++;
-        }
-      }
-    }
-
-    /* remove remaining intervals from corpus1 (if corpus2 reached end first) */
-    while (i < corpus1->size) {
-      corpus1->range[i].start = -1;
-      i++;
-    }
-
-    /* remove ranges marked for deletion */
-    apply_range_set_operation(corpus1, RReduce, NULL, NULL);
-    touch_corpus(corpus1);
-
-    break;
-
-
   case RDiff:
     /*
-     * -------------------- DIFFERENCE
-     * (implementation virtually identical to intersection)
+     * -------------------- INTERSECTION / DIFFERENCE
+     * intersection keeps the intervals of corpus1 that are also in corpus2, difference those that are not;
+     * targets / keywords are copied from _left_ operand, whose vectors are compacted in place
      */
 
-    i = 0;                      /* the position in corpus1 */
-    j = 0;                      /* the position in corpus2 */
-
-    while (i < corpus1->size && j < corpus2->size) {
-      /* compare start positions; if not equal, advance subcorpus where start position is smaller */
-      if (corpus1->range[i].start < corpus2->range[j].start)
-        i++;
-      else if (corpus1->range[i].start > corpus2->range[j].start)
-        j++;
-      else {
-        /* both start positions are identical. Now check whether the end positions are also the same */
-        if (corpus1->range[i].end == corpus2->range[j].end) {
-          /* only ranges found in both subcorpora are deleted */
-          corpus1->range[i].start = -1;
-          i++;
-          j++;
-        }
-        else {
-          /* end positions are not the same -> advance subcorpus where end position is smaller */
-          if (corpus1->range[i].end < corpus2->range[j].end)
-            i++;
-          else
-            j++;
-        }
-      }
-    }
-
-    /* remove ranges marked for deletion */
-    apply_range_set_operation(corpus1, RReduce, NULL, NULL);
+    ins = rs_merge(corpus1, operation, corpus2, NULL, corpus1->range, corpus1->targets, corpus1->keywords);
+    rs_truncate(corpus1, ins);
     touch_corpus(corpus1);
 
     break;
@@ -912,15 +1012,7 @@ apply_range_set_operation(CorpusList *corpus1, RangeSetOp operation, CorpusList
          * we do not have to do anything then.
          * Otherwise, the list was used destructively. Free up used space.
          */
-
-        corpus1->range = (Range *)cl_realloc(corpus1->range, sizeof(Range) * ins);
-        if (corpus1->targets)
-          corpus1->targets = (int *)cl_realloc(corpus1->targets, sizeof(int) * ins);
-        if (corpus1->keywords)
-          corpus1->keywords = (int *)cl_realloc(corpus1->keywords, sizeof(int) * ins);
-        corpus1->size = ins;
-
-        cl_free(corpus1->sortidx); /* the sort index is no longer valid in this case -> make sure it is deallocated and set to NULL */
+        rs_truncate(corpus1, ins);
         touch_corpus(corpus1);
       }
     }
@@ -937,10 +1029,41 @@ apply_range_set_operation(CorpusList *corpus1, RangeSetOp operation, CorpusList
   return 1;
 }
 
+/**
+ * Removes spurious matches from the result of a standard query according to the matching strategy
+ * (the current DFA evaluation strategy often produces several matches for each real match).
+ *
+ * @param cl        The query result.
+ * @param strategy  The matching strategy of the query.
+ */
+void
+apply_matching_strategy(CorpusList *cl, MatchingStrategy strategy)
+{
+  switch (strategy) {
+
+  case shortest_match:
+    apply_range_set_operation(cl, RMinimalMatches, NULL, NULL);         /* select shortest from several nested matches */
+    break;
+
+  case standard_match:
+    apply_range_set_operation(cl, RLeftMaximalMatches, NULL, NULL);     /* reduce multiple matches created by optional query prefix */
+    break;
+
+  case longest_match:
+    apply_range_set_operation(cl, RMaximalMatches, NULL, NULL);         /* select longest from several nested matches */
+    break;
+
+  case traditional:
+  default:
+    /* nothing to do here */
+    break;
+  }
+}
+
 
 /* -------------------------------------------------- SORTING and COUNTING */
 
-/* static data for sort function callbacks (shared by external sorting);
+/* static data for sort function callbacks (shared by sorting on disk);
  * note much of this replicates the contents of a SortClause object, q.v. */
 static CorpusList *srt_cl;              /**< The CorpusList object representing a query to be sorted. */
 static Attribute *srt_attribute;        /**< The )p-)Attribute on which a query is to be sorted. */
@@ -965,238 +1088,280 @@ static int *group_first;        /**< first match for each group of identical (or
 static int *group_size;         /**< number of matches for each group of identical (or equivalent) sort strings */
 static int *current_sortidx;    /**< alias to newly created sortidx, so it can be accessed by the callback function */
 
+/* simulate Perl's spaceship operator A <=> B */
+#define spaceship(A,B) ((A) > (B)) ? 1 : ((A) < (B)) ? -1 : 0
+
+/** Number of bits per digit in the radix sort of query results */
+#define RADIX_BITS 11
+/** Minimum number of matches for running the radix sort in parallel threads */
+#define RADIX_PARALLEL_MIN 100000
+
+/** Shared data of the threads of radix_sort(). */
+typedef struct {
+  uint64_t *keys, *keys_out;    /**< sort keys (input and output of the current pass) */
+  int *idx, *idx_out;           /**< match numbers (input and output of the current pass) */
+  int n;                        /**< number of matches */
+  int shift;                    /**< position of the current digit */
+  int scatter;                  /**< boolean: whether the threads are in the scatter phase */
+  int *counts;                  /**< digit counts (histogram phase) or output positions (scatter phase) of each thread */
+} RadixSort;
+
+/** Worker of radix_sort(): counts the digits of a contiguous chunk of the keys or scatters the chunk. */
+static void
+radix_sort_worker(int thread, int n_threads, void *data)
+{
+  RadixSort *rs = (RadixSort *)data;
+  int *count = rs->counts + thread * (1 << RADIX_BITS);
+  int from = (int)(((int64_t)rs->n * thread) / n_threads);
+  int to = (int)(((int64_t)rs->n * (thread + 1)) / n_threads);
+  int i, d;
+
+  if (!rs->scatter) {
+    memset(count, 0, sizeof(int) * (1 << RADIX_BITS));
+    for (i = from; i < to; i++)
+      count[(rs->keys[i] >> rs->shift) & ((1 << RADIX_BITS) - 1)]++;
+  }
+  else {
+    for (i = from; i < to; i++) {
+      d = count[(rs->keys[i] >> rs->shift) & ((1 << RADIX_BITS) - 1)]++;
+      rs->keys_out[d] = rs->keys[i];
+      rs->idx_out[d] = rs->idx[i];
+    }
+  }
+}
+
 /**
- * Use an external program to sort a query.
+ * Sorts match numbers by 64-bit keys (LSD radix sort).
+ *
+ * The sort is stable, i.e. matches with identical keys remain in their original order.
+ * For large numbers of matches, each pass is split up between cl_threads threads.
  *
- * No parameters - the assumption is that everything is set up
- * already by the SortSubCorpus function which calls this one.
+ * @param keys  The sort keys (permuted along with idx).
+ * @param idx   The match numbers to sort.
+ * @param n     Number of matches.
+ * @param bits  Number of bits used in the keys.
  */
-static int
-SortExternally(void)
+static void
+radix_sort(uint64_t *keys, int *idx, int n, int bits)
 {
-  /* uses settings from static srt_* variables */
-  char temporary_name[TEMP_FILENAME_BUFSIZE];
-  FILE *tmp;
-  FILE *pipe;
-  char sort_call[CL_MAX_LINE_LENGTH];
-
-  if (NULL != (tmp = open_temporary_file(temporary_name))) {
-    int line, p1start, p1end, plen, step, token, l;
-  p1start = -1;
-  p1end = -1;
-
-    line = -1;                  /* will indicate sort failure below if text_size == 0 */
-    if (text_size > 0) {
-      for (line = 0; line < srt_cl->size; line++) {
-        Rprintf("%d ", line);
-
-        /* determine start and end position of sort interval for this match */
-        switch (srt_anchor1) {
-        case MatchField:
-            p1start = srt_cl->range[line].start + srt_offset1;
-            break;
-        case MatchEndField:
-          p1start = srt_cl->range[line].end + srt_offset1;
-          break;
-        case KeywordField:
-          p1start = srt_cl->keywords[line] + srt_offset1;
-          break;
-        case TargetField:
-          p1start = srt_cl->targets[line] + srt_offset1;
-          break;
-        default:
-          assert(0 && "Oopsie -- illegal first anchor in SortExternally()");
-          break;
-        }
-
-        switch (srt_anchor2) {
-        case MatchField:
-          p1end = srt_cl->range[line].start + srt_offset2;
-          break;
-        case MatchEndField:
-          p1end = srt_cl->range[line].end + srt_offset2;
-          break;
-        case KeywordField:
-          p1end = srt_cl->keywords[line] + srt_offset2;
-          break;
-        case TargetField:
-          p1end = srt_cl->targets[line] + srt_offset2;
-          break;
-        default:
-          assert(0 && "Oopsie -- illegal second anchor in SortExternally()");
-          break;
-        }
-
-        /* adjust sort boundaries at start and end of corpus */
-        if (p1start < 0)
-          p1start = 0;
-        else if (p1start >= text_size)
-          p1start = text_size - 1;
-
-        if (p1end < 0)
-          p1end = 0;
-        else if (p1end >= text_size)
-          p1end = text_size - 1;
-
-        /* swap start and end of interval for reverse sorting */
-        if (srt_reverse) {
-          int temp;
-          temp = p1start;
-          p1start = p1end;
-          p1end = temp;
-        }
-
-        /* determine sort direction */
-        step = (p1end >= p1start) ? 1 : -1;
-
-        /* how many tokens to print */
-        plen = abs(p1end - p1start) + 1;
+  RadixSort rs;
+  uint64_t *tmp_keys;
+  int *tmp_idx;
+  int n_threads, t, d, pos;
+
+  n_threads = (n >= RADIX_PARALLEL_MIN) ? cl_get_threads() : 1;
+  rs.counts = (int *)cl_malloc(n_threads * (1 << RADIX_BITS) * sizeof(int));
+  rs.keys_out = (uint64_t *)cl_malloc(n * sizeof(uint64_t));
+  rs.idx_out = (int *)cl_malloc(n * sizeof(int));
+  rs.keys = keys;
+  rs.idx = idx;
+  rs.n = n;
+
+  for (rs.shift = 0; rs.shift < bits; rs.shift += RADIX_BITS) {
+    rs.scatter = 0;
+    cl_parallel(radix_sort_worker, n_threads, &rs);
+    /* convert counts into output positions (in order of digits, then threads => stable) */
+    for (pos = 0, d = 0; d < (1 << RADIX_BITS); d++)
+      for (t = 0; t < n_threads; t++) {
+        int c = rs.counts[t * (1 << RADIX_BITS) + d];
+        rs.counts[t * (1 << RADIX_BITS) + d] = pos;
+        pos += c;
+      }
+    rs.scatter = 1;
+    cl_parallel(radix_sort_worker, n_threads, &rs);
+    tmp_keys = rs.keys; rs.keys = rs.keys_out; rs.keys_out = tmp_keys;
+    tmp_idx = rs.idx; rs.idx = rs.idx_out; rs.idx_out = tmp_idx;
+  }
 
-        /* when using flags, print normalised token sequence first (after applying cl_string_canonical) */
-        if (srt_flags) {
-          token = p1start;
-          for (l=1 ; l <= plen ; l++) {
-            char *value = cl_cpos2str(srt_attribute, token);
-            int del_value = 0;
+  /* after an odd number of passes, the result is in the temporary buffers */
+  if (rs.idx != idx) {
+    memcpy(idx, rs.idx, n * sizeof(int));
+    memcpy(keys, rs.keys, n * sizeof(uint64_t));
+    rs.idx_out = rs.idx;
+    rs.keys_out = rs.keys;
+  }
+  cl_free(rs.idx_out);
+  cl_free(rs.keys_out);
+  cl_free(rs.counts);
+}
 
-            if (value) {
-              int i, p = strlen((char *) value);
-              if (srt_flags) {
-                value = cl_string_canonical(value, srt_cl->corpus->charset, srt_flags, CL_STRING_CANONICAL_STRDUP);
-                del_value = 1;
-              }
-              if (srt_reverse) {
-                char *newvalue = cl_string_reverse(value, srt_cl->corpus->charset);
-                if (del_value)
-                  cl_free(value);
-                value = newvalue;
-                del_value = 1;
-              }
+/*
+ * Internal sorting proceeds in two phases. First, the lexicon IDs of the tokens in the sort
+ * interval of each match are extracted (once), and each lexicon ID occurring there is assigned
+ * its rank in the sort order of the (normalised and/or reversed) strings. Matches are then
+ * compared as sequences of integer ranks, so no strings have to be decoded or normalised during
+ * the sort itself. The matches are sorted with a radix sort on a key composed of the ranks of
+ * the first two tokens; only matches that have identical keys need to be compared in full.
+ */
 
-              for (i = 0; i < p; i++)
-                fputc((unsigned char)value[i], tmp);
-              fputc(' ', tmp);
-              if (del_value)
-                cl_free(value);
-            }
-            token += step;
-          }
-          Rprintf("\t");
-        }
+static int *srt_ids;                    /**< lexicon IDs of the tokens in the sort intervals of all matches (concatenated) */
+static size_t *srt_ids_offset;          /**< offset of the sort interval of each match in srt_ids[] (plus end offset) */
+static int *srt_rank_flags;             /**< rank of each lexicon ID in the sort order of strings normalised with the %cd flags */
+static int *srt_rank_plain;             /**< rank of each lexicon ID in the sort order of unnormalised strings */
+static char **srt_rank_strings;         /**< strings compared while computing the ranks (indexed like the IDs being ranked) */
 
-        /* print sequence of tokens in sort interval */
-        token = p1start;
-        for (l = 1 ; l <= plen ; l++) {
-          char *value = cl_cpos2str(srt_attribute, token);
-          int del_value = 0;
+/** qsort callback used to compute the ranks of lexicon IDs: compares the strings in srt_rank_strings[]. */
+static int
+rank_compare(const void *vidx1, const void *vidx2)
+{
+  return strcmp(srt_rank_strings[*(const int *)vidx1], srt_rank_strings[*(const int *)vidx2]);
+}
 
-          if (value) {
-            int i, p = strlen((char *) value);
-            if (srt_reverse) {
-              del_value = 1;
-              value = cl_string_reverse(value, srt_cl->corpus->charset);
-            }
-            for (i = 0; i < p; i++)
-              fputc((unsigned char) value[i], tmp);
-            fputc(' ', tmp);
-            if (del_value)
-              cl_free(value);
-          }
-          token += step;
-        } /* end for each token */
-        Rprintf("\n");
-      }
+/**
+ * Computes the ranks of the given lexicon IDs in the sort order of their strings.
+ *
+ * Strings are normalised with flags (if non-zero) and reversed for reverse sorting,
+ * exactly as cl_string_qsort_compare() does, then sorted with strcmp(). IDs whose
+ * strings are identical after normalisation get the same rank.
+ *
+ * @param ids    The lexicon IDs to rank.
+ * @param n_ids  Number of IDs.
+ * @param flags  IGNORE_CASE and/or IGNORE_DIAC, or 0.
+ * @param rank   Table indexed by lexicon ID, which receives the rank of each ID.
+ */
+static void
+rank_lexicon_ids(int *ids, int n_ids, int flags, int *rank)
+{
+  int i, r;
+  int *order = (int *)cl_malloc(n_ids * sizeof(int));
+  CorpusCharset charset = srt_cl->corpus->charset;
+
+  srt_rank_strings = (char **)cl_malloc(n_ids * sizeof(char *));
+  for (i = 0; i < n_ids; i++) {
+    char *str = cl_id2str(srt_attribute, ids[i]);
+    /* canonicalise BEFORE reversing (as in cl_string_qsort_compare()) */
+    str = flags ? cl_string_canonical(str, charset, flags, CL_STRING_CANONICAL_STRDUP) : cl_strdup(str);
+    if (srt_reverse) {
+      char *temp = cl_string_reverse(str, charset);
+      cl_free(str);
+      str = temp;
+    }
+    srt_rank_strings[i] = str;
+    order[i] = i;
+  }
 
-      fclose(tmp);
+  qsort(order, n_ids, sizeof(int), rank_compare);
+  for (i = 0, r = 0; i < n_ids; i++) {
+    if (i > 0 && strcmp(srt_rank_strings[order[i-1]], srt_rank_strings[order[i]]) != 0)
+      r++;
+    rank[ids[order[i]]] = r;
+  }
 
-      /* now, execute the external sort command on the temporary file */
-      snprintf(sort_call, CL_MAX_LINE_LENGTH, "%s %s %s | gawk '{print $1}'", ExternalSortCommand, (srt_ascending ? "" : "-r"), temporary_name);
-      if (SORT_DEBUG)
-        Rprintf("Running sort: \n\t%s\n", sort_call);
+  for (i = 0; i < n_ids; i++)
+    cl_free(srt_rank_strings[i]);
+  cl_free(srt_rank_strings);
+  cl_free(order);
+}
 
-      /* run sort cmd and read from pipe */
-      line = -1;                /* will indicate failure of external sort command  */
-      if ((pipe = popen(sort_call, "r")) == NULL) {
-        perror("Failure opening sort pipe");
-        cqpmessage(Error, "Can't execute external sort:\n\t%s\nDisable external sorting with 'set ExternalSort off;'", sort_call);
-      }
-      else {
-        if (! srt_cl->sortidx)
-          srt_cl->sortidx = (int *)cl_malloc(srt_cl->size * sizeof(int));
-        for (line = 0; line < srt_cl->size; line++)
-          srt_cl->sortidx[line] = -1;
-
-        line = 0;
-        while (fgets(sort_call, CL_MAX_LINE_LENGTH, pipe)) {
-          if (line < srt_cl->size) {
-            int num = atoi(sort_call);
-            if (num < 0 || num >= srt_cl->size) {
-              Rprintf("Error in externally sorted file - line number #%d out of range\n", num);
-              break;            /* abort */
-            }
-            srt_cl->sortidx[line] = num;
-            line++;
-          }
-          else
-            Rprintf("Warning: too many lines from external sort command (ignored).\n");
-        }
-        pclose(pipe);
+/**
+ * Extracts the sort keys of all matches (first phase of internal sorting).
+ *
+ * Reads the lexicon IDs in the sort interval of each match into srt_ids[] and computes
+ * the rank tables srt_rank_plain[] and (if srt_flags are set) srt_rank_flags[] for all
+ * lexicon IDs that occur.
+ *
+ * @return  Boolean: true if successful, false if the corpus could not be read.
+ */
+static int
+extract_sort_keys(void)
+{
+  int i, j, k, n_ids, id, lexsize, bits;
+  size_t total;
+  int *ids;
+
+  /* lexicon IDs of sort intervals */
+  srt_ids_offset = (size_t *)cl_malloc((srt_cl->size + 1) * sizeof(size_t));
+  total = 0;
+  for (i = 0; i < srt_cl->size; i++) {
+    srt_ids_offset[i] = total;
+    total += abs(srt_end[i] - srt_start[i]) + 1;
+  }
+  srt_ids_offset[srt_cl->size] = total;
+
+  srt_ids = (int *)cl_malloc(total * sizeof(int));
+
+  if (total <= INT_MAX) {
+    /* decode the tokens in the order of their corpus positions, so that each block of a
+     * compressed attribute is decompressed only once and overlapping intervals are read once */
+    uint64_t *cpos = (uint64_t *)cl_malloc(total * sizeof(uint64_t));
+    int *slot = (int *)cl_malloc(total * sizeof(int));
+    int prev_cpos = -1;
+
+    for (i = 0; i < srt_cl->size; i++) {
+      int step = (srt_end[i] >= srt_start[i]) ? 1 : -1;
+      int len = (int)(srt_ids_offset[i+1] - srt_ids_offset[i]);
+      for (k = 0; k < len; k++) {
+        cpos[srt_ids_offset[i] + k] = (uint64_t)(srt_start[i] + k * step);
+        slot[srt_ids_offset[i] + k] = (int)srt_ids_offset[i] + k;
       }
     }
-
-    if (unlink(temporary_name)) {
-      perror(temporary_name);
-      cqpmessage(Warning, "Couldn't remove temporary file %s (ignored)\n\tPlease remove the file manually.", temporary_name);
+    for (bits = 1; bits < 32 && ((uint64_t)1 << bits) < (uint64_t)text_size; bits++)
+      ;
+    radix_sort(cpos, slot, (int)total, bits);
+
+    for (j = 0, id = -1; (size_t)j < total && EvaluationIsRunning; j++) {
+      if ((int)cpos[j] != prev_cpos) {
+        prev_cpos = (int)cpos[j];
+        if (0 > (id = cl_cpos2id(srt_attribute, prev_cpos)))
+          break;
+      }
+      srt_ids[slot[j]] = id;
     }
-
-    /* now we should have read exactly cl->size lines; otherwise something went wrong */
-    if (line == srt_cl->size)
-      return 1;
-    else {
-      cqpmessage(Error, "External sort failed (reset to default ordering).");
-      cl_free(srt_cl->sortidx);
+    cl_free(cpos);
+    cl_free(slot);
+    if (id < 0 && EvaluationIsRunning) {
+      cqpmessage(Error, "Can't read %s attribute at position %d for sorting (aborted).", srt_attribute->any.name, prev_cpos);
       return 0;
     }
   }
   else {
-    perror("Can't create temporary file");
-    cqpmessage(Error, "Couldn't create temporary file for external sort (aborted).");
-    return 0;
+    for (i = 0; i < srt_cl->size && EvaluationIsRunning; i++) {
+      int step = (srt_end[i] >= srt_start[i]) ? 1 : -1;
+      int len = (int)(srt_ids_offset[i+1] - srt_ids_offset[i]);
+      int *out = srt_ids + srt_ids_offset[i];
+      int cpos = srt_start[i];
+      for (k = 0; k < len; k++, cpos += step) {
+        if (0 > (out[k] = cl_cpos2id(srt_attribute, cpos))) {
+          cqpmessage(Error, "Can't read %s attribute at position %d for sorting (aborted).", srt_attribute->any.name, cpos);
+          return 0;
+        }
+      }
+    }
   }
-}
+  if (!EvaluationIsRunning)
+    return 1;                   /* user interrupt: the caller will abort */
+
+  /* collect distinct lexicon IDs, then rank them */
+  lexsize = cl_max_id(srt_attribute);
+  srt_rank_plain = (int *)cl_malloc(lexsize * sizeof(int));
+  for (id = 0; id < lexsize; id++)
+    srt_rank_plain[id] = -1;
+  ids = (int *)cl_malloc(MIN((size_t)lexsize, total) * sizeof(int) + sizeof(int));
+  n_ids = 0;
+  for (i = 0; (size_t)i < total; i++)
+    if (srt_rank_plain[srt_ids[i]] < 0) {
+      srt_rank_plain[srt_ids[i]] = 0;
+      ids[n_ids++] = srt_ids[i];
+    }
 
-/**
- * Defined if a sort cache is to be used in sorting concordance lines.
- *
- * The sort cache (caching the lexicon IDs of the first two tokens to be compared in each line)
- * is indispensable for the internal sorting algorithm since random accesses to a compressed corpus
- * are painfully slow; when sorting variable length matches such as German NPs on word forms,
- * the current implementation has a hit rate of around 99%.
- */
-#define USE_SORT_CACHE
-/* another tweaking option would be memoization of comparisons results, requiring 2 ints + 1 bit
- * per comp. for storage, probably in a hash; I have no idea how much that would improve the
- * performance, esp. with a fixed hash size; other options are a hash table for identical lines
- * or an incremental sort (sort on first token, group lines for which compare identical, then
- * sort each group on second token, etc.); note that an incremental sort would probably enforce
- * the slightly incorrect semantics of case-/diacritic-insensitive in the current implementation;
- * it might be possible to reuse a custom qsort algorithm implemented for the fdist command (but
- * perhaps I can just fall back on the standard qsort there);
- * external sorting isn't such a bad idea after all :-) */
-
-#ifdef USE_SORT_CACHE
-/** Pointer to the sort cache @see USE_SORT_CACHE */
-static int *sort_id_cache = NULL;
-#endif
+  rank_lexicon_ids(ids, n_ids, 0, srt_rank_plain);
+  if (srt_flags) {
+    srt_rank_flags = (int *)cl_malloc(lexsize * sizeof(int));
+    rank_lexicon_ids(ids, n_ids, srt_flags, srt_rank_flags);
+  }
+  cl_free(ids);
+
+  return 1;
+}
 
 /**
  * Compare two matches according to current sort settings in static variables
  * (qsort callback used in query result sorting).
  *
- * This is the primary query-hit-comparison function. It wraps cl_string_qsort_compare
- * for string comparison, but does much more as well, because we are not just comparing
+ * This is the primary query-hit-comparison function. We are not just comparing
  * individual strings but rather, potentially, whole bundles of strings from various
- * different positions.
+ * different positions: the sort intervals are compared token by token, using
+ * the ranks of the lexicon IDs computed by extract_sort_keys().
  *
  * @param vidx1  Pointer to the integer index of the first of the intervals to be
  *               compared (ie an index into an array of start/end positions).
@@ -1207,13 +1372,10 @@ static int *sort_id_cache = NULL;
 static int
 i2compare(const void *vidx1, const void *vidx2)
 {
-  const int *idx1 = vidx1, *idx2 = vidx2;
+  int idx1 = *(const int *)vidx1, idx2 = *(const int *)vidx2;
 
-  int p1start, p1end;           /* boundaries of sort intervals */
-  int p2start, p2end;
-  int step1, step2;             /* direction of comparison (might actually be different for the two matches *ouch*) */
-
-  int pos1, pos2;
+  int *ids1, *ids2;             /* lexicon IDs of the sort intervals */
+  int *rank;
   int len1, len2, minlen;
   int pass, i;
 
@@ -1222,77 +1384,24 @@ i2compare(const void *vidx1, const void *vidx2)
   if (! EvaluationIsRunning)
     return 0;                   /* user interrupt (Ctrl-C) => force qsort to finish quickly */
 
-  if (*idx1 == *idx2)
+  if (idx1 == idx2)
     return 0;                   /* self-comparison: return equality */
 
-  /* determine start and end position of sort interval for both matches */
-  p1start = srt_start[*idx1];
-  p1end =   srt_end[*idx1];
-  p2start = srt_start[*idx2];
-  p2end =   srt_end[*idx2];
-
-  /* direction of comparison
-     (might be different if inconsistently set targets are used, but that's the user's fault) */
-  step1 = (p1end < p1start) ? -1 : 1;
-  step2 = (p2end < p2start) ? -1 : 1;
-
-  /*
-   * now compare the interval [p1start, p1end] with the interval [p2start, p2end],
-   * incrementing the cpos after each comparison by step1 and step2, respectively
-   * (similar to the standard comparison algorithm in cl_string_qsort_compare() above)
-   */
-  if (SORT_DEBUG)
-    Rprintf("Comparing [%d,%d](%+d) with [%d,%d](%+d)\n", p1start, p1end, step1, p2start, p2end, step2);
-
-  len1 = abs(p1end - p1start) + 1;
-  len2 = abs(p2end - p2start) + 1;
+  ids1 = srt_ids + srt_ids_offset[idx1];
+  ids2 = srt_ids + srt_ids_offset[idx2];
+  len1 = (int)(srt_ids_offset[idx1 + 1] - srt_ids_offset[idx1]);
+  len2 = (int)(srt_ids_offset[idx2 + 1] - srt_ids_offset[idx2]);
   minlen = MIN(len1, len2);
   comp = 0;
 
   /* first pass does case-/diacritic-insensitive comparison (may be skipped), second pass does plain comparison */
   for (pass = (srt_flags) ? 1 : 2 ; pass <= 2 && comp == 0 ; pass++) {
-    pos1 = p1start;
-    pos2 = p2start;
-
-    for (i = 1; (i <= minlen) && (comp == 0); i++) {
-      int id1, id2;
-      unsigned char *s1, *s2;
-
-#ifdef USE_SORT_CACHE
-      /* use cache for first comparison only (to avoid repeated overwriting) */
-      if (i == 1) {
-        id1 = sort_id_cache[2*(*idx1)];
-        id2 = sort_id_cache[2*(*idx2)];
-      }
-      else if (i == 2) {
-        id1 = sort_id_cache[2*(*idx1)+1];
-        id2 = sort_id_cache[2*(*idx2)+1];
-      }
-      else {
-        id1 = cl_cpos2id(srt_attribute, pos1);
-        id2 = cl_cpos2id(srt_attribute, pos2);
-      }
-#else
-      id1 = cl_cpos2id(srt_attribute, pos1);
-      id2 = cl_cpos2id(srt_attribute, pos2);
-#endif
+    rank = (pass == 1) ? srt_rank_flags : srt_rank_plain;
 
-      /* same lexicon IDs always compare equal */
-      if (id1 != id2) {
-        s1 = (unsigned char *)cl_id2str(srt_attribute, id1);
-        s2 = (unsigned char *)cl_id2str(srt_attribute, id2);
-
-        if (pass == 1)
-          /* compare normalised strings in first pass (srt_flags are set in this case) */
-          comp = cl_string_qsort_compare((char *)s1, (char *)s2, srt_cl->corpus->charset, srt_flags, srt_reverse);
-        else
-          /* in pass 2, compare without flags. */
-          comp = cl_string_qsort_compare((char *)s1, (char *)s2, srt_cl->corpus->charset, 0,         srt_reverse);
-      }
-
-      pos1 += step1;
-      pos2 += step2;
-    }
+    /* same lexicon IDs always compare equal */
+    for (i = 0; (i < minlen) && (comp == 0); i++)
+      if (ids1[i] != ids2[i])
+        comp = spaceship(rank[ids1[i]], rank[ids2[i]]);
 
     if (comp == 0) {            /* intervals compared equal up to the length of the shorter one -> compare lengths */
       if (len1 > len2)
@@ -1318,6 +1427,202 @@ i2compare(const void *vidx1, const void *vidx2)
   return comp;
 }
 
+/**
+ * Sorts matches according to current sort settings in static variables (second phase
+ * of internal sorting), producing the same order as qsort() with i2compare().
+ *
+ * Matches are radix-sorted on the ranks of the first two tokens of their sort intervals
+ * (with the %cd flags if given); only groups of matches with the same key are sorted
+ * with i2compare(). A descending sort is the exact reverse of the ascending sort.
+ *
+ * @param sortidx  Initialised with 0 .. n-1; receives the sorted match numbers.
+ */
+static void
+sort_by_keys(int *sortidx)
+{
+  int n = srt_cl->size;
+  int *rank = srt_flags ? srt_rank_flags : srt_rank_plain;
+  uint64_t *keys;
+  int i, j, b, max_rank, bits, need_compare, ascending, lexsize;
+
+  lexsize = cl_max_id(srt_attribute);
+  max_rank = 0;
+  for (i = 0; i < lexsize; i++)
+    if (rank[i] > max_rank)
+      max_rank = rank[i];
+  /* ranks are shifted by 1, since 0 marks the end of a short sort interval */
+  for (b = 1; ((uint64_t)1 << b) <= (uint64_t)max_rank + 1; b++)
+    ;
+  bits = 2 * b;
+
+  keys = (uint64_t *)cl_malloc(n * sizeof(uint64_t));
+  for (i = 0; i < n; i++) {
+    int *ids = srt_ids + srt_ids_offset[i];
+    int len = (int)(srt_ids_offset[i+1] - srt_ids_offset[i]);
+    keys[i] = ((uint64_t)(rank[ids[0]] + 1) << b) | ((len > 1) ? (uint64_t)(rank[ids[1]] + 1) : 0);
+  }
+
+  radix_sort(keys, sortidx, n, bits);
+
+  /* sort groups of matches with identical keys in full (ascending) */
+  ascending = srt_ascending;
+  srt_ascending = 1;
+  for (i = 0; i < n && EvaluationIsRunning; i = j) {
+    need_compare = srt_flags ? 1 : 0;  /* tokens that are equal with %cd may still differ */
+    for (j = i + 1; j < n && keys[j] == keys[i]; j++)
+      if (srt_ids_offset[sortidx[j] + 1] - srt_ids_offset[sortidx[j]] > 2)
+        need_compare = 1;
+    if (j - i > 1 && (need_compare || srt_ids_offset[sortidx[i] + 1] - srt_ids_offset[sortidx[i]] > 2))
+      qsort(sortidx + i, j - i, sizeof(int), i2compare);
+    /* otherwise, matches with identical keys have identical sort strings and are in their original order */
+  }
+  srt_ascending = ascending;
+
+  if (!srt_ascending)
+    for (i = 0, j = n - 1; i < j; i++, j--) {
+      int temp = sortidx[i];
+      sortidx[i] = sortidx[j];
+      sortidx[j] = temp;
+    }
+
+  cl_free(keys);
+}
+
+/**
+ * Compares two records of SortExternally() (callback of the external-memory sort).
+ *
+ * A record consists of the match number, the length of the sort interval and the
+ * ranks of its tokens (with the %cd flags, if given, followed by the plain ranks).
+ * The comparison is equivalent to i2compare() for an ascending sort.
+ */
+static int
+sort_record_compare(const int *rec1, const int *rec2)
+{
+  int len1 = rec1[1], len2 = rec2[1], minlen = MIN(len1, len2);
+  const int *rank1 = rec1 + 2, *rank2 = rec2 + 2;
+  int pass, i, comp = 0;
+
+  for (pass = (srt_flags) ? 1 : 2 ; pass <= 2 && comp == 0 ; pass++) {
+    for (i = 0; (i < minlen) && (comp == 0); i++)
+      comp = spaceship(rank1[i], rank2[i]);
+    if (comp == 0)
+      comp = spaceship(len1, len2);
+    rank1 += len1;
+    rank2 += len2;
+  }
+  if (comp == 0)                /* break ties in order of original matchlist */
+    comp = spaceship(rec1[0], rec2[0]);
+  return comp;
+}
+
+/**
+ * Estimates the memory needed for sorting a query result in memory (in bytes).
+ */
+static size_t
+sort_memory_estimate(void)
+{
+  size_t total = 0;
+  int i;
+
+  for (i = 0; i < srt_cl->size; i++)
+    total += abs(srt_end[i] - srt_start[i]) + 1;
+  /* lexicon IDs, corpus positions and slots of all tokens plus radix sort buffers; keys and offsets for each match */
+  return 28 * total + 32 * (size_t)srt_cl->size;
+}
+
+/**
+ * Sorts a query result on disk, bounded by the memory budget set with the SortMemory option.
+ *
+ * This is used for results that are too large to be sorted in memory, or if the
+ * ExternalSort option is set. The ranks of all lexicon IDs are computed first, so
+ * that the sort intervals of the matches can be converted into records of integer
+ * ranks one by one; the records are sorted by the external-memory sort (see extsort.h).
+ * The resulting order is the same as that of the internal sort.
+ *
+ * Everything is set up already by SortSubcorpus(), which calls this function.
+ *
+ * @return  Boolean: true if successful (or aborted by the user), false on error.
+ */
+static int
+SortExternally(void)
+{
+  ExtSort es;
+  const int *out;
+  int *ids, *rec = NULL;
+  int i, k, id, len, lexsize, n_ranks, rec_size, ok;
+
+  /* rank all lexicon IDs, since the sort intervals are not kept in memory */
+  lexsize = cl_max_id(srt_attribute);
+  if (lexsize < 0) {
+    cqpmessage(Error, "Can't read lexicon of %s attribute for sorting (aborted).", srt_attribute->any.name);
+    cl_free(srt_cl->sortidx);
+    return 0;
+  }
+  ids = (int *)cl_malloc(lexsize * sizeof(int) + sizeof(int));
+  for (id = 0; id < lexsize; id++)
+    ids[id] = id;
+  srt_rank_plain = (int *)cl_malloc(lexsize * sizeof(int) + sizeof(int));
+  rank_lexicon_ids(ids, lexsize, 0, srt_rank_plain);
+  if (srt_flags) {
+    srt_rank_flags = (int *)cl_malloc(lexsize * sizeof(int) + sizeof(int));
+    rank_lexicon_ids(ids, lexsize, srt_flags, srt_rank_flags);
+  }
+  cl_free(ids);
+  n_ranks = (srt_flags) ? 2 : 1;
+
+  es = extsort_new(sort_record_compare, (size_t)MAX(SortMemory, 0) * 1024 * 1024);
+  rec_size = 0;
+  ok = 1;
+  for (i = 0; i < srt_cl->size && ok && EvaluationIsRunning; i++) {
+    int step = (srt_end[i] >= srt_start[i]) ? 1 : -1;
+    int cpos = srt_start[i];
+    len = abs(srt_end[i] - srt_start[i]) + 1;
+    if (2 + n_ranks * len > rec_size) {
+      rec_size = 2 + n_ranks * len;
+      rec = (int *)cl_realloc(rec, rec_size * sizeof(int));
+    }
+    rec[0] = i;
+    rec[1] = len;
+    for (k = 0; k < len; k++, cpos += step) {
+      if (0 > (id = cl_cpos2id(srt_attribute, cpos))) {
+        cqpmessage(Error, "Can't read %s attribute at position %d for sorting (aborted).", srt_attribute->any.name, cpos);
+        ok = 0;
+        break;
+      }
+      rec[2 + k] = (srt_flags) ? srt_rank_flags[id] : srt_rank_plain[id];
+      if (srt_flags)
+        rec[2 + len + k] = srt_rank_plain[id];
+    }
+    if (ok)
+      ok = extsort_add(es, rec, 2 + n_ranks * len);
+  }
+  cl_free(rec);
+
+  if (ok && EvaluationIsRunning)
+    ok = extsort_finish(es);
+  if (SORT_DEBUG)
+    Rprintf("Sorted %d matches with %d run(s) on disk\n", srt_cl->size, extsort_nr_runs(es));
+  if (ok && EvaluationIsRunning) {
+    for (i = 0; i < srt_cl->size && EvaluationIsRunning && (out = extsort_next(es, &len)); i++)
+      srt_cl->sortidx[i] = out[0];
+    if (EvaluationIsRunning && i < srt_cl->size) {
+      cqpmessage(Error, "Sorting on disk failed (reset to default ordering).");
+      ok = 0;
+    }
+    if (ok && !srt_ascending)   /* descending sort is the exact reverse of the ascending sort */
+      for (i = 0, k = srt_cl->size - 1; i < k; i++, k--) {
+        int temp = srt_cl->sortidx[i];
+        srt_cl->sortidx[i] = srt_cl->sortidx[k];
+        srt_cl->sortidx[k] = temp;
+      }
+  }
+  extsort_delete(es);
+
+  if (!ok)
+    cl_free(srt_cl->sortidx);
+  return ok;
+}
+
 /** Compares two groups of equivalent matches by group sizes (descending), breaking ties through i2compare. */
 static int
 group2compare(const void *vidx1, const void *vidx2)
@@ -1339,9 +1644,6 @@ group2compare(const void *vidx1, const void *vidx2)
     return i2compare(&(current_sortidx[group_first[*idx1]]), &(current_sortidx[group_first[*idx2]]));
 }
 
-/* simulate Perl's spaceship operator A <=> B */
-#define spaceship(A,B) ((A) > (B)) ? 1 : ((A) < (B)) ? -1 : 0
-
 /**
  * Sorts hits in random order by comparing random numbers in the vector random_sort_keys[],
  * breaking ties by start and end positions of matches (from *srt_cl) in order to ensure stable sorting.
@@ -1527,210 +1829,199 @@ SortSubcorpus(CorpusList *cl, SortClause sc, int count_mode, struct Redir *redir
 
   ok = 1;
 
-  if (UseExternalSort && !insecure && !count_mode)
-    ok = SortExternally();
+  /* precompute tables for start and end position of sort interval */
+  srt_start = cl_malloc(cl->size * sizeof(int));
+  srt_end   = cl_malloc(cl->size * sizeof(int));
 
-  else {
-    /* precompute tables for start and end position of sort interval */
-    srt_start = cl_malloc(cl->size * sizeof(int));
-    srt_end   = cl_malloc(cl->size * sizeof(int));
-
-    switch (srt_anchor1) {
-    case MatchField:
-      for (i = 0; i < cl->size; i++)
-        srt_start[i] = srt_cl->range[i].start + srt_offset1;
-      break;
-    case MatchEndField:
-      for (i = 0; i < cl->size; i++)
-        srt_start[i] = srt_cl->range[i].end + srt_offset1;
-      break;
-    case KeywordField:
-      for (i = 0; i < cl->size; i++)
-        srt_start[i] = srt_cl->keywords[i] + srt_offset1;
-      break;
-    case TargetField:
-      for (i = 0; i < cl->size; i++)
-        srt_start[i] = srt_cl->targets[i] + srt_offset1;
-      break;
-    case NoField:
-    default:
-      assert(0 && "Critical error -- illegal first anchor in SortSubcorpus()");
-      break;
-    }
+  switch (srt_anchor1) {
+  case MatchField:
     for (i = 0; i < cl->size; i++)
-      if (srt_start[i] < 0)
-        srt_start[i] = 0;
-      else if (srt_start[i] >= text_size)
-        srt_start[i] = text_size - 1;
-
-    switch (srt_anchor2) {
-    case MatchField:
-      for (i = 0; i < cl->size; i++)
-        srt_end[i] = srt_cl->range[i].start + srt_offset2;
-      break;
-    case MatchEndField:
-      for (i = 0; i < cl->size; i++)
-        srt_end[i] = srt_cl->range[i].end + srt_offset2;
-      break;
-    case KeywordField:
-      for (i = 0; i < cl->size; i++)
-        srt_end[i] = srt_cl->keywords[i] + srt_offset2;
-      break;
-    case TargetField:
-      for (i = 0; i < cl->size; i++)
-        srt_end[i] = srt_cl->targets[i] + srt_offset2;
-      break;
-    case NoField:
-    default:
-      assert(0 && "Critical error -- illegal first anchor in SortSubcorpus()");
-      break;
-    }
+      srt_start[i] = srt_cl->range[i].start + srt_offset1;
+    break;
+  case MatchEndField:
+    for (i = 0; i < cl->size; i++)
+      srt_start[i] = srt_cl->range[i].end + srt_offset1;
+    break;
+  case KeywordField:
+    for (i = 0; i < cl->size; i++)
+      srt_start[i] = srt_cl->keywords[i] + srt_offset1;
+    break;
+  case TargetField:
+    for (i = 0; i < cl->size; i++)
+      srt_start[i] = srt_cl->targets[i] + srt_offset1;
+    break;
+  case NoField:
+  default:
+    assert(0 && "Critical error -- illegal first anchor in SortSubcorpus()");
+    break;
+  }
+  for (i = 0; i < cl->size; i++)
+    if (srt_start[i] < 0)
+      srt_start[i] = 0;
+    else if (srt_start[i] >= text_size)
+      srt_start[i] = text_size - 1;
+
+  switch (srt_anchor2) {
+  case MatchField:
+    for (i = 0; i < cl->size; i++)
+      srt_end[i] = srt_cl->range[i].start + srt_offset2;
+    break;
+  case MatchEndField:
+    for (i = 0; i < cl->size; i++)
+      srt_end[i] = srt_cl->range[i].end + srt_offset2;
+    break;
+  case KeywordField:
     for (i = 0; i < cl->size; i++)
-      if (srt_end[i] < 0)
-        srt_end[i] = 0;
-      else if (srt_end[i] >= text_size)
-        srt_end[i] = text_size - 1;
+      srt_end[i] = srt_cl->keywords[i] + srt_offset2;
+    break;
+  case TargetField:
+    for (i = 0; i < cl->size; i++)
+      srt_end[i] = srt_cl->targets[i] + srt_offset2;
+    break;
+  case NoField:
+  default:
+    assert(0 && "Critical error -- illegal first anchor in SortSubcorpus()");
+    break;
+  }
+  for (i = 0; i < cl->size; i++)
+    if (srt_end[i] < 0)
+      srt_end[i] = 0;
+    else if (srt_end[i] >= text_size)
+      srt_end[i] = text_size - 1;
+
+  /* ok, so now the positions have been moved from the srt_cl to the
+   * global sorting-variables. */
+
+  /* swap start and end positions in reverse sort */
+  if (srt_reverse) {
+    int *temp = srt_start;
+    srt_start = srt_end;
+    srt_end = temp;
+  }
 
-    /* ok, so now the positions have been moved from the srt_cl to the
-     * global sorting-variables. */
+  /* allocate and initialise sorted index */
+  if (cl->sortidx == NULL)
+    cl->sortidx = (int *)cl_malloc(cl->size * sizeof(int));
+  for (i = 0; i < cl->size; i++)
+    cl->sortidx[i] = i;
 
-    /* swap start and end positions in reverse sort */
-    if (srt_reverse) {
-      int *temp = srt_start;
-      srt_start = srt_end;
-      srt_end = temp;
-    }
+  /* the business end... the sorting happens here! */
+  EvaluationIsRunning = 1;
+  srt_rank_flags = NULL;
+  if (!count_mode && (UseExternalSort || sort_memory_estimate() > (size_t)MAX(SortMemory, 0) * 1024 * 1024))
+    ok = SortExternally();      /* results that don't fit into the memory budget are sorted on disk */
+  else if (extract_sort_keys() && EvaluationIsRunning)
+    sort_by_keys(cl->sortidx);
+  else if (EvaluationIsRunning) {
+    /* error reading the corpus */
+    EvaluationIsRunning = 0;
+    cl_free(cl->sortidx);
+    ok = 0;
+  }
+  if (ok && ! EvaluationIsRunning) {
+    cqpmessage(Warning, "Sort/count operation aborted by user (reset to default ordering).");
+    if (which_app == cqp)
+      install_signal_handler();
+    cl_free(cl->sortidx);
+    ok = 0;
+  }
+  EvaluationIsRunning = 0;
+  /* note that, unless we are in count mode, this is more or less the end of it.... */
 
-    /* allocate and initialise sorted index */
-    if (cl->sortidx == NULL)
-      cl->sortidx = (int *)cl_malloc(cl->size * sizeof(int));
-    for (i = 0; i < cl->size; i++)
-      cl->sortidx[i] = i;
-
-#ifdef USE_SORT_CACHE
-    /* load up the sort cache.... */
-    sort_id_cache = (int *)cl_malloc(cl->size * 2 * sizeof(int));
-    for (i = 0; i < cl->size; i++) {
-      int cpos1 = srt_start[i];
-      int cpos2 = srt_end[i];
-      int len = abs(cpos2 - cpos1) + 1;
-      int step = (cpos2 >= cpos1) ? 1 : -1;
-      sort_id_cache[2*i] = cl_cpos2id(srt_attribute, cpos1);
-      if (len > 1)
-        sort_id_cache[2*i+1] = cl_cpos2id(srt_attribute, cpos1 + step);
-      else
-        sort_id_cache[2*i+1] = 0;
-    }
-#endif
+  /* in count mode, group identical (or equivalent) sort strings, then sort by group sizes */
+  if (ok && count_mode) {
+    int *groupidx = NULL;
+    int n_groups, first;
+    current_sortidx = cl->sortidx;
+
+    /* worst case: cl->size groups with f = 1 */
+    group_first = cl_malloc(cl->size * sizeof(int));
+    group_size  = cl_malloc(cl->size * sizeof(int));
+
+    break_ties = 0;           /* don't break ties for grouping */
+    n_groups = 0;
+    first = group_first[n_groups] = 0;
 
-    /* the business end... the sorting happens here! */
     EvaluationIsRunning = 1;
-    qsort(cl->sortidx, cl->size, sizeof(int), i2compare);
+    /* collect equivalent matches into groups */
+    for (i = 0; (i < cl->size) && EvaluationIsRunning; i++) {
+      if (i > 0) {
+        if (i2compare(current_sortidx + first, current_sortidx + i)) {
+          group_size[n_groups] = i - first;
+          first = group_first[++n_groups] = i;
+        }
+      }
+    }
+    group_size[n_groups++] = i - first;
+    /* sort groups by their size (= frequency of sort string) in descending order */
+    if (EvaluationIsRunning) {
+      groupidx = cl_malloc(n_groups * sizeof(int));
+      for (i = 0; i < n_groups; i++)
+        groupidx[i] = i;
+      qsort(groupidx, n_groups, sizeof(int), group2compare);
+    }
     if (! EvaluationIsRunning) {
-      cqpmessage(Warning, "Sort/count operation aborted by user (reset to default ordering).");
-      if (which_app == cqp)
-        install_signal_handler();
-      cl_free(cl->sortidx);
+      cqpmessage(Warning, "Count operation aborted by user.");
+      if (which_app == cqp) install_signal_handler();
       ok = 0;
     }
     EvaluationIsRunning = 0;
-    /* note that, unless we are in count mode, this is more or less the end of it.... */
-
-    /* in count mode, group identical (or equivalent) sort strings, then sort by group sizes */
-    if (ok && count_mode) {
-      int *groupidx = NULL;
-      int n_groups, first;
-      current_sortidx = cl->sortidx;
-
-      /* worst case: cl->size groups with f = 1 */
-      group_first = cl_malloc(cl->size * sizeof(int));
-      group_size  = cl_malloc(cl->size * sizeof(int));
-
-      break_ties = 0;           /* don't break ties for grouping */
-      n_groups = 0;
-      first = group_first[n_groups] = 0;
-
-      EvaluationIsRunning = 1;
-      /* collect equivalent matches into groups */
-      for (i = 0; (i < cl->size) && EvaluationIsRunning; i++) {
-        if (i > 0) {
-          if (i2compare(current_sortidx + first, current_sortidx + i)) {
-            group_size[n_groups] = i - first;
-            first = group_first[++n_groups] = i;
-          }
-        }
-      }
-      group_size[n_groups++] = i - first;
-      /* sort groups by their size (= frequency of sort string) in descending order */
-      if (EvaluationIsRunning) {
-        groupidx = cl_malloc(n_groups * sizeof(int));
-        for (i = 0; i < n_groups; i++)
-          groupidx[i] = i;
-        qsort(groupidx, n_groups, sizeof(int), group2compare);
-      }
-      if (! EvaluationIsRunning) {
-        cqpmessage(Warning, "Count operation aborted by user.");
-        if (which_app == cqp) install_signal_handler();
-        ok = 0;
-      }
-      EvaluationIsRunning = 0;
-
-      /* if successful, display groups with their frequencies */
-      if (open_rd_output_stream(redir, cl->corpus->charset)) {
-        for (i = 0; (i < n_groups) && !cl_broken_pipe; i++) {
-          int first = group_first[groupidx[i]];
-          int size = group_size[groupidx[i]];
-          if (size >= count_mode) {
-            int start = srt_start[current_sortidx[first]]; /* cpos range of sort string */
-            int end = srt_end[current_sortidx[first]];
-            int len = abs(end - start) + 1;
-            int step = (end >= start) ? 1 : -1;
-
-            Rprintf("%d\t", size);
-            if (!pretty_print) /* without pretty-printing: show first match in second column, for automatic processing */
-              Rprintf("%d\t", first);
-            for (k = 0; k < len; k++) {
-              int cpos = start + step * k;
-              char *token_readonly = cl_cpos2str(srt_attribute, cpos);
-              /* normalise token if %cd was given */
-              char *token = cl_string_canonical(token_readonly, cl->corpus->charset, sc->flags, CL_STRING_CANONICAL_STRDUP);
-              if (srt_reverse) {
-                /* reverse the token */
-                char *temp = cl_string_reverse(token, cl->corpus->charset);
-                cl_free(token);
-                token = temp;
-              }
-              if (k > 0)
-                Rprintf(" ");
-              Rprintf("%s", token);
+
+    /* if successful, display groups with their frequencies */
+    if (open_rd_output_stream(redir, cl->corpus->charset)) {
+      for (i = 0; (i < n_groups) && !cl_broken_pipe; i++) {
+        int first = group_first[groupidx[i]];
+        int size = group_size[groupidx[i]];
+        if (size >= count_mode) {
+          int start = srt_start[current_sortidx[first]]; /* cpos range of sort string */
+          int end = srt_end[current_sortidx[first]];
+          int len = abs(end - start) + 1;
+          int step = (end >= start) ? 1 : -1;
+
+          Rprintf("%d\t", size);
+          if (!pretty_print) /* without pretty-printing: show first match in second column, for automatic processing */
+            Rprintf("%d\t", first);
+          for (k = 0; k < len; k++) {
+            int cpos = start + step * k;
+            char *token_readonly = cl_cpos2str(srt_attribute, cpos);
+            /* normalise token if %cd was given */
+            char *token = cl_string_canonical(token_readonly, cl->corpus->charset, sc->flags, CL_STRING_CANONICAL_STRDUP);
+            if (srt_reverse) {
+              /* reverse the token */
+              char *temp = cl_string_reverse(token, cl->corpus->charset);
               cl_free(token);
+              token = temp;
             }
-            if (pretty_print) { /* with pretty-printing: append range of matches belonging to group (in sorted corpus) */
-              if (size > 1)
-                Rprintf("  [#%d-#%d]",  first, first + size - 1);
-              else
-                Rprintf("  [#%d]",  first);
-            }
-            Rprintf("\n");
-            fflush(redir->stream);
+            if (k > 0)
+              Rprintf(" ");
+            Rprintf("%s", token);
+            cl_free(token);
+          }
+          if (pretty_print) { /* with pretty-printing: append range of matches belonging to group (in sorted corpus) */
+            if (size > 1)
+              Rprintf("  [#%d-#%d]",  first, first + size - 1);
+            else
+              Rprintf("  [#%d]",  first);
           }
+          Rprintf("\n");
+          fflush(redir->stream);
         }
-        close_rd_output_stream(redir);
       }
-
-      cl_free(groupidx);
-      cl_free(group_first);
-      cl_free(group_size);
+      close_rd_output_stream(redir);
     }
-    /* endif "we are in count mode!" */
 
-#ifdef USE_SORT_CACHE
-    cl_free(sort_id_cache);
-#endif
-    cl_free(srt_start);
-    cl_free(srt_end);
+    cl_free(groupidx);
+    cl_free(group_first);
+    cl_free(group_size);
   }
-  /* end of "if not external sorting" */
+  /* endif "we are in count mode!" */
+
+  cl_free(srt_ids);
+  cl_free(srt_ids_offset);
+  cl_free(srt_rank_plain);
+  cl_free(srt_rank_flags);
+  cl_free(srt_start);
+  cl_free(srt_end);
 
   touch_corpus(cl);
   return ok;
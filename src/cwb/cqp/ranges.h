@@ -91,6 +91,8 @@ int apply_range_set_operation(CorpusList *list1,
                               CorpusList *list2,
                               Bitfield restrictor);
 
+void apply_matching_strategy(CorpusList *cl, MatchingStrategy strategy);
+
 void RangeSort(CorpusList *c, int mk_sortidx);
 
 int SortSubcorpus(CorpusList *cl, SortClause sc, int count_mode, struct Redir *redir);
@@ -213,6 +213,114 @@ set_target(CorpusList *corp, FieldType dest, FieldType source, int source_offset
   return 1;
 }
 
+/**
+ * Finds the first entry >= cpos in a sorted list of corpus positions.
+ *
+ * Successive searches mostly move forward, so the search gallops forward from the result
+ * of the previous search (*hint) and only falls back to a binary search of the entries
+ * before it if cpos lies further back.
+ *
+ * @param positions  Sorted list of corpus positions.
+ * @param n          Number of entries in the list.
+ * @param cpos       The corpus position to look for.
+ * @param hint       Index at which the search starts; updated to the result.
+ * @return           Index of the first entry >= cpos, or n if there is none.
+ */
+static int
+gallop_to_position(int *positions, int n, int cpos, int *hint)
+{
+  int lo, hi, mid, step;
+
+  lo = MIN(*hint, n);
+  if (lo > 0 && positions[lo - 1] >= cpos) {
+    hi = lo - 1;
+    lo = 0;
+  }
+  else {
+    step = 1;
+    hi = lo;
+    while (hi < n && positions[hi] < cpos) {
+      lo = hi + 1;
+      hi += step;
+      step *= 2;
+    }
+    if (hi > n)
+      hi = n;
+  }
+
+  /* positions[lo - 1] < cpos <= positions[hi] */
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (positions[mid] < cpos)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  *hint = lo;
+  return lo;
+}
+
+/**
+ * Selects the target from a sorted list of the corpus positions that satisfy the constraint,
+ * with the same result as evaluating the constraint position by position in evaluate_target().
+ *
+ * @return  The corpus position of the target, or -1 if there is none in the search space.
+ */
+static int
+find_target_position(int *positions, int n, int *hint,
+                     SearchStrategy strategy,
+                     int lbound, int rbound,
+                     int excl_start, int excl_end,
+                     int inclusive)
+{
+  /* the left side of the search space ends at left_end, the right side starts at right_start */
+  int left_end = inclusive ? excl_start : excl_start - 1;
+  int right_start = inclusive ? excl_start : excl_end + 1;
+  int left = -1, right = -1, i;
+
+  switch (strategy) {
+
+  case SearchLeftmost:
+    i = gallop_to_position(positions, n, lbound, hint);
+    if (i < n && !inclusive && positions[i] >= excl_start && positions[i] <= excl_end)
+      i = gallop_to_position(positions, n, excl_end + 1, hint);
+    return (i < n && positions[i] <= rbound) ? positions[i] : -1;
+
+  case SearchRightmost:
+    i = gallop_to_position(positions, n, rbound + 1, hint) - 1;
+    if (i >= 0 && !inclusive && positions[i] >= excl_start && positions[i] <= excl_end)
+      i = gallop_to_position(positions, n, excl_start, hint) - 1;
+    return (i >= 0 && positions[i] >= lbound) ? positions[i] : -1;
+
+  case SearchNearest:
+    i = gallop_to_position(positions, n, left_end + 1, hint) - 1;
+    if (i >= 0 && positions[i] >= lbound)
+      left = positions[i];
+    i = gallop_to_position(positions, n, right_start, hint);
+    if (i < n && positions[i] <= rbound)
+      right = positions[i];
+    /* the left side is searched first, so it wins ties */
+    if (left >= 0 && (right < 0 || excl_start - left <= right - excl_start))
+      return left;
+    return right;
+
+  case SearchFarthest:
+    i = gallop_to_position(positions, n, lbound, hint);
+    if (i < n && positions[i] <= left_end)
+      left = positions[i];
+    i = gallop_to_position(positions, n, rbound + 1, hint) - 1;
+    if (i >= 0 && positions[i] >= right_start)
+      right = positions[i];
+    if (left >= 0 && (right < 0 || excl_start - left >= right - excl_start))
+      return left;
+    return right;
+
+  default:
+    return -1;
+  }
+}
+
 int
 evaluate_target(CorpusList *corp,          /* the corpus */
                 FieldType t_id,            /* the field to set */
@@ -226,6 +334,9 @@ evaluate_target(CorpusList *corp,          /* the corpus */
 {
   Attribute *attr;
   int *table;
+  int *positions, n_positions, hint;
+  double window;
+  CorpusList *mother;
   Context context;
   int i, line, lbound, rbound;
   int excl_start, excl_end;
@@ -317,6 +428,16 @@ evaluate_target(CorpusList *corp,          /* the corpus */
   table = (int *)cl_calloc(corp->size, sizeof(int));
 
   EvaluationIsRunning = 1;
+
+  /* if it's cheaper, look up the positions satisfying the constraint in the index (for the entire corpus,
+   * since search spaces can extend beyond the matches), so that they can be found by galloping search */
+  window = (double) units * ((direction == ctxtdir_leftright) ? 2 : 1) + 1;
+  if (context.space_type == structure && cl_max_struc(attr) > 0)
+    window *= (double) corp->mother_size / cl_max_struc(attr);
+  mother = findcorpus(corp->mother_name, SYSTEM, 0);
+  positions = get_constraint_positions(constr, mother, corp->size, window, &n_positions);
+  hint = 0;
+
   nr_evals = 0;
   percentage = -1;
 
@@ -439,6 +560,13 @@ evaluate_target(CorpusList *corp,          /* the corpus */
           strategy = SearchRightmost;
       }
 
+      if (positions) {
+        table[line] = find_target_position(positions, n_positions, &hint,
+                                           strategy, lbound, rbound,
+                                           excl_start, excl_end, inclusive);
+        continue;
+      }
+
       switch (strategy) {
 
       case SearchFarthest:
@@ -533,6 +661,8 @@ evaluate_target(CorpusList *corp,          /* the corpus */
     }
   }
 
+  cl_free(positions);
+
   if (progress_bar)
     progress_bar_message(1, 1, "  cleaning up");
 
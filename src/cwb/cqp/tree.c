@@ -510,6 +510,8 @@ print_booltree(Constrainttree ctptr, int indent)
       Rprintf("%smembership of %s value in ",
              ctptr->idlist.negated ? "non-" : "",
              ctptr->idlist.attr->any.name);
+    if (ctptr->idlist.param)
+      Rprintf("parameter ?%d: ", ctptr->idlist.param);
     for (i = 0; i < ctptr->idlist.nr_items; i++)
       Rprintf("%d ", ctptr->idlist.items[i]);
     Rprintf("\n");
@@ -844,7 +846,7 @@ try_optimization(Constraint *tree)
       left_attr = left->idlist.attr;
       left_type = id_list;
       left_label = left->idlist.label;
-      if (left->idlist.negated)
+      if (left->idlist.negated || left->idlist.param)
         try_opt = 0;
     }
 
@@ -863,7 +865,7 @@ try_optimization(Constraint *tree)
       right_attr = right->idlist.attr;
       right_type = id_list;
       right_label = right->idlist.label;
-      if (right->idlist.negated)
+      if (right->idlist.negated || right->idlist.param)
         try_opt = 0;
     }
 
@@ -943,6 +945,9 @@ try_optimization(Constraint *tree)
       tree->idlist.nr_items = left_list.tabsize;
       tree->idlist.items = left_list.start;
       tree->idlist.negated = 0;
+      tree->idlist.del = 0;
+      tree->idlist.param = 0;
+      tree->idlist.flags = 0;
     }
   }
 